@@ -0,0 +1,79 @@
+#ifndef UMAPYOGIN_BENCH_BENCHMARK_H
+#define UMAPYOGIN_BENCH_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+
+#include "UmaPyogin/Log.h"
+
+// 性能测试的公共部分，每个性能测试为独立的可执行文件，结果输出到标准输出
+namespace UmaPyogin::Bench
+{
+	using Clock = std::chrono::steady_clock;
+
+	inline double ToNanoseconds(Clock::duration duration)
+	{
+		return static_cast<double>(
+		    std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+	}
+
+	// 执行 rounds 轮、每轮调用 iterations 次 function，返回最快一轮中每次调用的纳秒数
+	template <typename Function>
+	double Measure(std::size_t iterations, Function&& function, std::size_t rounds = 5)
+	{
+		auto best = Clock::duration::max();
+		for (std::size_t round = 0; round < rounds; ++round)
+		{
+			const auto start = Clock::now();
+			for (std::size_t i = 0; i < iterations; ++i)
+			{
+				function(i);
+			}
+			best = std::min(best, Clock::now() - start);
+		}
+		return ToNanoseconds(best) / static_cast<double>(iterations);
+	}
+
+	inline void Report(std::string_view name, double nanoseconds, std::string_view unit = "op")
+	{
+		std::printf("%-48.*s %12.1f ns/%.*s\n", static_cast<int>(name.size()), name.data(),
+		            nanoseconds, static_cast<int>(unit.size()), unit.data());
+		std::fflush(stdout);
+	}
+
+	inline void ReportDuration(std::string_view name, Clock::duration duration)
+	{
+		std::printf("%-48.*s %12.1f ms\n", static_cast<int>(name.size()), name.data(),
+		            ToNanoseconds(duration) / 1e6);
+		std::fflush(stdout);
+	}
+
+	// 仅输出警告与错误，以免日志影响测量结果
+	inline void PrintLog(Log::Level level, const char* message)
+	{
+		if (level >= Log::Level::Warn)
+		{
+			std::fprintf(stderr, "log: %s\n", message);
+		}
+	}
+
+	// 第 index 个命令行参数为数量，不存在或无效时返回 defaultValue
+	inline std::size_t GetCountArgument(int argc, char** argv, int index,
+	                                    std::size_t defaultValue)
+	{
+		if (index < argc)
+		{
+			if (const auto value = std::strtoull(argv[index], nullptr, 10))
+			{
+				return static_cast<std::size_t>(value);
+			}
+		}
+		return defaultValue;
+	}
+} // namespace UmaPyogin::Bench
+
+#endif
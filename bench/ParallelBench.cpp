@@ -0,0 +1,94 @@
+#include "Benchmark.h"
+
+#include "UmaPyogin/Misc.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace UmaPyogin;
+
+namespace
+{
+	// 改为线程池之前的实现：每次调用为每个线程创建一个 std::thread，按下标静态均分，
+	// 不能整除时余下的下标不会被处理
+	template <typename Callable>
+	void LegacyForEachIndex(std::size_t count, Callable&& func, std::size_t concurrentSize)
+	{
+		std::vector<std::thread> threads(concurrentSize);
+		const auto chunkSize = count / concurrentSize;
+		for (std::size_t i = 0; i < concurrentSize; ++i)
+		{
+			threads[i] = std::thread([&, base = i * chunkSize] {
+				for (std::size_t j = 0; j < chunkSize; ++j)
+				{
+					func(base + j);
+				}
+			});
+		}
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	std::atomic<std::uint64_t> s_Sink;
+
+	// 模拟解析一个条目的开销，cost 为循环次数
+	void Work(std::size_t index, std::size_t cost)
+	{
+		std::uint64_t hash = index;
+		for (std::size_t i = 0; i < cost; ++i)
+		{
+			hash = hash * 6364136223846793005 + 1442695040888963407;
+		}
+		s_Sink.fetch_add(hash, std::memory_order_relaxed);
+	}
+
+	template <typename Cost>
+	void Compare(std::string_view name, std::size_t calls, std::size_t count,
+	             std::size_t threadCount, Cost cost)
+	{
+		const std::string prefix(name);
+		const auto item = [&](std::size_t i) { Work(i, cost(i)); };
+		const auto perCall = [&](auto&& forEach) {
+			return Bench::Measure(calls, [&](std::size_t) { forEach(); });
+		};
+
+		Bench::Report(prefix + " (thread per call)", perCall([&] {
+			              LegacyForEachIndex(count, item, threadCount);
+		              }),
+		              "call");
+		Bench::Report(prefix + " (pool)", perCall([&] {
+			              Misc::Parallel::ForEachIndex(count, item, threadCount);
+		              }),
+		              "call");
+	}
+} // namespace
+
+// 用法：UmaPyoginParallelBench [线程数]
+// 对比线程池上的 ForEachIndex 与改用线程池之前的实现，线程数默认为硬件线程数
+int main(int argc, char** argv)
+{
+	Log::SetLogHandler(Bench::PrintLog);
+
+	const auto threadCount =
+	    Bench::GetCountArgument(argc, argv, 1, std::max(std::thread::hardware_concurrency(), 1u));
+	// 预先创建线程池，不计入测量
+	Misc::Parallel::ThreadPool::GetInstance();
+
+	std::printf("%zu threads, pool of %zu workers\n", threadCount,
+	            Misc::Parallel::ThreadPool::GetInstance().GetThreadCount());
+
+	// 下标数为线程数的倍数，使旧实现不会丢弃余下的下标
+	const auto roundUp = [&](std::size_t count) {
+		return (count + threadCount - 1) / threadCount * threadCount;
+	};
+
+	// 加载单个小字典时的情形，调用开销占主要部分
+	Compare("64 light items", 2000, roundUp(64), threadCount, [](std::size_t) { return 100; });
+	// 每 16 个条目中有一个开销为其余的 50 倍，静态均分时各线程的负载不均
+	Compare("4096 uneven items", 20, roundUp(4096), threadCount,
+	        [](std::size_t i) { return i % 16 ? 200 : 10000; });
+	Compare("4096 even items", 20, roundUp(4096), threadCount, [](std::size_t) { return 1000; });
+}
@@ -0,0 +1,94 @@
+#include "Benchmark.h"
+
+#include "Support/FakeIl2Cpp.h"
+#include "Support/LocalizationFiles.h"
+
+using namespace UmaPyogin;
+using namespace UmaPyogin::Fake;
+
+namespace
+{
+	constexpr std::size_t CategoryCount = 50;
+
+	struct QueryFunctions
+	{
+		decltype(&Game::Query_ctor) ctor;
+		decltype(&Game::PreparedQuery_BindInt) BindInt;
+		decltype(&Game::Query_Step) Step;
+		decltype(&Game::Query_GetText) GetText;
+		decltype(&Game::Query_Dispose) Dispose;
+	};
+
+	// 与游戏相同，每次查询构造 Query 并在读取后释放，category 依次取 firstCategory 之后的
+	// CategoryCount 个值
+	double MeasureQuery(QueryFunctions const& functions, std::size_t iterations,
+	                    std::u16string_view sql, std::size_t firstCategory)
+	{
+		auto& game = Game::GetInstance();
+		const auto sqlString = Runtime::GetInstance().NewString(sql);
+		std::vector<Il2CppObject*> queries;
+		for (std::size_t i = 0; i < 64; ++i)
+		{
+			queries.push_back(game.NewQuery());
+		}
+
+		return Bench::Measure(iterations, [&](std::size_t i) {
+			const auto query = queries[i % queries.size()];
+			const auto category = firstCategory + i / 1000 % CategoryCount;
+			functions.ctor(query, nullptr, sqlString);
+			functions.BindInt(query, 1, static_cast<std::int32_t>(category));
+			functions.BindInt(query, 2, static_cast<std::int32_t>(i % 1000));
+			functions.Step(query);
+			functions.GetText(query, 0);
+			functions.Dispose(query);
+		});
+	}
+} // namespace
+
+// 用法：UmaPyoginSqlBench [每轮查询数]
+// 经由钩子执行完整的 text_data 查询，包括构造、绑定、Step、GetText 与 Dispose
+int main(int argc, char** argv)
+{
+	Log::SetLogHandler(Bench::PrintLog);
+
+	const auto iterations = Bench::GetCountArgument(argc, argv, 1, 200000);
+
+	const Test::TemporaryDirectory directory;
+	const auto& root = directory.GetPath();
+	Test::TextGenerator chinese(Test::Script::Chinese);
+
+	std::vector<Test::NestedDictionaryEntry> textData;
+	for (std::size_t i = 0; i < CategoryCount * 1000; ++i)
+	{
+		textData.push_back({ i / 1000, i % 1000, chinese.Next(4 + i % 32) });
+	}
+	Test::WriteNestedDictionary(root / "text_data.json", textData);
+
+	Config config{};
+	config.TextDataDictPath = (root / "text_data.json").string();
+	config.LoadLocalizationSynchronously = true;
+	auto& installer = InstallPlugin(std::move(config));
+	InitIl2Cpp(installer);
+
+	const QueryFunctions hooked{
+		installer.Resolve(&Game::Query_ctor),    installer.Resolve(&Game::PreparedQuery_BindInt),
+		installer.Resolve(&Game::Query_Step),    installer.Resolve(&Game::Query_GetText),
+		installer.Resolve(&Game::Query_Dispose),
+	};
+	const QueryFunctions original{
+		&Game::Query_ctor,    &Game::PreparedQuery_BindInt, &Game::Query_Step,
+		&Game::Query_GetText, &Game::Query_Dispose,
+	};
+
+	constexpr auto TextDataSql =
+	    u"SELECT `text` FROM `text_data` WHERE `category`=? AND `index`=?;";
+	Bench::Report("text_data (original)", MeasureQuery(original, iterations, TextDataSql, 0),
+	              "query");
+	Bench::Report("text_data (hit)", MeasureQuery(hooked, iterations, TextDataSql, 0), "query");
+	Bench::Report("text_data (miss)",
+	              MeasureQuery(hooked, iterations, TextDataSql, CategoryCount), "query");
+	Bench::Report("other table",
+	              MeasureQuery(hooked, iterations,
+	                           u"SELECT `name` FROM `chara_data` WHERE `id`=? AND `type`=?;", 0),
+	              "query");
+}
@@ -0,0 +1,90 @@
+#include "Benchmark.h"
+
+#include "Support/FakeIl2Cpp.h"
+#include "Support/LocalizationFiles.h"
+
+#include "UmaPyogin/Localization.h"
+
+using namespace UmaPyogin;
+using namespace UmaPyogin::Fake;
+
+// 用法：UmaPyoginStartupBench [静态文本数] [剧情文件数] [sync|background]
+// 生成对应规模的翻译文件后模拟游戏启动，测量 il2cpp_init 返回、首个钩子返回译文与全部数据集
+// 加载完成时距启动的时间，background 时在后台加载且钩子等待加载完成
+int main(int argc, char** argv)
+{
+	Log::SetLogHandler(Bench::PrintLog);
+
+	const auto background = argc > 3 && std::string_view(argv[3]) == "background";
+	const auto staticCount = Bench::GetCountArgument(argc, argv, 1, 20000);
+	const auto storyCount = Bench::GetCountArgument(argc, argv, 2, 2000);
+	constexpr std::size_t BlocksPerStory = 50;
+	constexpr std::size_t TextDataCount = 50000;
+
+	const Test::TemporaryDirectory directory;
+	const auto& root = directory.GetPath();
+	Test::TextGenerator japanese(Test::Script::Japanese);
+	Test::TextGenerator chinese(Test::Script::Chinese);
+
+	std::vector<std::u16string> sources;
+	std::vector<std::pair<std::u16string, std::u16string>> staticEntries;
+	for (std::size_t i = 0; i < staticCount; ++i)
+	{
+		auto source = japanese.Next(4 + i % 24) + Misc::ToUTF16(std::to_string(i));
+		staticEntries.emplace_back(source, chinese.Next(4 + i % 24));
+		sources.push_back(std::move(source));
+	}
+	Test::WriteStaticLocalization(root / "static.json", staticEntries);
+	Game::GetInstance().SetStaticSources(std::move(sources));
+
+	for (std::size_t i = 0; i < storyCount; ++i)
+	{
+		std::vector<StoryBlock> blocks(BlocksPerStory);
+		for (auto& block : blocks)
+		{
+			block.Name = chinese.Next(3);
+			block.Text = chinese.Next(40);
+		}
+		Test::WriteStoryTimeline(root / "story" / std::to_string(i / 100), 100000000 + i,
+		                         chinese.Next(8), blocks);
+	}
+
+	std::vector<Test::NestedDictionaryEntry> textData;
+	for (std::size_t i = 0; i < TextDataCount; ++i)
+	{
+		textData.push_back({ i / 1000, i % 1000, chinese.Next(4 + i % 32) });
+	}
+	Test::WriteNestedDictionary(root / "text_data.json", textData);
+
+	Config config{};
+	config.StaticLocalizationFilePath = (root / "static.json").string();
+	config.StoryLocalizationDirPath = (root / "story").string();
+	config.TextDataDictPath = (root / "text_data.json").string();
+	config.LoadLocalizationSynchronously = !background;
+	config.LocalizationWaitTimeout = 60000;
+
+	std::printf("%zu static texts, %zu stories, %zu text_data entries, %s loading\n", staticCount,
+	            storyCount, TextDataCount, background ? "background" : "synchronous");
+
+	auto& installer = InstallPlugin(std::move(config));
+	const auto get = installer.Resolve(&Game::LocalizeJP_Get);
+
+	const auto start = Bench::Clock::now();
+	InitIl2Cpp(installer);
+	Bench::ReportDuration("il2cpp_init returned", Bench::Clock::now() - start);
+
+	get(0);
+	Bench::ReportDuration("first LocalizeJP_Get returned", Bench::Clock::now() - start);
+
+	auto& status = Localization::LoadingStatus::GetInstance();
+	for (const auto dataset : { Localization::Dataset::Static, Localization::Dataset::Story,
+	                            Localization::Dataset::Database })
+	{
+		status.WaitUntilReady(dataset);
+	}
+	Bench::ReportDuration("all localization loaded", Bench::Clock::now() - start);
+
+	Bench::Report("LocalizeJP_Get", Bench::Measure(staticCount, [&](std::size_t i) {
+		              get(static_cast<std::int32_t>(i));
+	              }));
+}
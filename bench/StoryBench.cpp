@@ -0,0 +1,83 @@
+#include "Benchmark.h"
+
+#include "Support/FakeIl2Cpp.h"
+#include "Support/LocalizationFiles.h"
+
+using namespace UmaPyogin;
+using namespace UmaPyogin::Fake;
+
+// 用法：UmaPyoginStoryBench [剧情数] [每个剧情的块数]
+// 经由 AssetBundle.LoadAsset 的钩子加载剧情，分别测量首次加载（包括解析翻译文件）与再次加载的耗时
+int main(int argc, char** argv)
+{
+	Log::SetLogHandler(Bench::PrintLog);
+
+	// 默认的块数与较长的主线剧情相当，逐块读写字段的开销在结果中占主要部分
+	const auto storyCount = Bench::GetCountArgument(argc, argv, 1, 40);
+	const auto blockCount = Bench::GetCountArgument(argc, argv, 2, 500);
+
+	const Test::TemporaryDirectory directory;
+	const auto& root = directory.GetPath();
+	Test::TextGenerator japanese(Test::Script::Japanese);
+	Test::TextGenerator chinese(Test::Script::Chinese);
+
+	auto& game = Game::GetInstance();
+	const auto assetBundle = game.AddAssetBundle("data/story.bundle");
+	std::vector<Il2CppString*> assetNames;
+	for (std::size_t i = 0; i < storyCount; ++i)
+	{
+		const auto storyId = 100000000 + i;
+		std::vector<StoryBlock> sourceBlocks(blockCount);
+		std::vector<StoryBlock> localizedBlocks(blockCount);
+		for (std::size_t j = 0; j < blockCount; ++j)
+		{
+			const std::size_t choiceCount = j % 10 ? 0 : 3;
+			for (std::size_t k = 0; k < choiceCount; ++k)
+			{
+				sourceBlocks[j].ChoiceDataList.push_back(japanese.Next(12));
+				localizedBlocks[j].ChoiceDataList.push_back(chinese.Next(12));
+			}
+			sourceBlocks[j].Name = japanese.Next(4);
+			sourceBlocks[j].Text = japanese.Next(60);
+			localizedBlocks[j].Name = chinese.Next(3);
+			localizedBlocks[j].Text = chinese.Next(50);
+		}
+		Test::WriteStoryTimeline(root / "story", storyId, chinese.Next(8), localizedBlocks);
+
+		const auto storyIdString = Misc::ToUTF16(std::to_string(storyId));
+		const auto assetName = u"story/data/storytimeline_" + storyIdString;
+		game.AddAsset(assetBundle, assetName,
+		              game.NewStoryTimelineData(storyIdString, japanese.Next(10), sourceBlocks));
+		assetNames.push_back(Runtime::GetInstance().NewString(assetName));
+	}
+
+	// 额外的资源包不存在时每次 LoadAsset 都会重试加载，因此提供一个空的资源包
+	game.AddAssetBundle("data/extra.bundle");
+
+	Config config{};
+	config.StoryLocalizationDirPath = (root / "story").string();
+	config.ExtraAssetBundlePath = "data/extra.bundle";
+	config.LoadLocalizationSynchronously = true;
+	auto& installer = InstallPlugin(std::move(config));
+	InitIl2Cpp(installer);
+
+	std::printf("%zu stories, %zu blocks per story\n", storyCount, blockCount);
+
+	const auto loadAsset = installer.Resolve(&Game::AssetBundle_LoadAsset);
+	const auto blocks = static_cast<double>(blockCount);
+
+	const auto cold = Bench::Measure(
+	    storyCount, [&](std::size_t i) { loadAsset(assetBundle, assetNames[i], nullptr); }, 1);
+	Bench::Report("LoadAsset (first load)", cold, "story");
+	Bench::Report("LoadAsset (first load)", cold / blocks, "block");
+
+	const auto warm = Bench::Measure(
+	    storyCount, [&](std::size_t i) { loadAsset(assetBundle, assetNames[i], nullptr); });
+	Bench::Report("LoadAsset (cached)", warm, "story");
+	Bench::Report("LoadAsset (cached)", warm / blocks, "block");
+
+	const auto original = Bench::Measure(storyCount, [&](std::size_t i) {
+		Game::AssetBundle_LoadAsset(assetBundle, assetNames[i], nullptr);
+	});
+	Bench::Report("LoadAsset (original)", original, "story");
+}
@@ -0,0 +1,65 @@
+#include "Benchmark.h"
+
+#include "Support/LocalizationFiles.h"
+
+#include "UmaPyogin/Misc.h"
+
+#include <string>
+#include <vector>
+
+using namespace UmaPyogin;
+
+namespace
+{
+	void MeasureScript(std::string_view name, Test::Script script, std::size_t stringCount,
+	                   std::size_t length)
+	{
+		Test::TextGenerator generator(script);
+		std::vector<std::u16string> utf16Strings;
+		std::vector<std::string> utf8Strings;
+		std::size_t charCount = 0;
+		for (std::size_t i = 0; i < stringCount; ++i)
+		{
+			// 长度在 length 附近变化，使各个字符串的结尾落在不同的向量位置
+			auto text = generator.Next(length / 2 + i % (length + 1));
+			charCount += text.size();
+			utf8Strings.push_back(Misc::ToUTF8(text));
+			utf16Strings.push_back(std::move(text));
+		}
+		const auto perChar = static_cast<double>(stringCount) / static_cast<double>(charCount);
+		const std::string prefix(name);
+
+		const auto toUTF16 =
+		    Bench::Measure(stringCount, [&](std::size_t i) { Misc::ToUTF16(utf8Strings[i]); });
+		Bench::Report(prefix + " ToUTF16", toUTF16 * perChar, "char");
+
+		std::u16string utf16Buffer;
+		const auto toUTF16Reused = Bench::Measure(
+		    stringCount, [&](std::size_t i) { Misc::ToUTF16(utf8Strings[i], utf16Buffer); });
+		Bench::Report(prefix + " ToUTF16 (reused buffer)", toUTF16Reused * perChar, "char");
+
+		const auto toUTF8 =
+		    Bench::Measure(stringCount, [&](std::size_t i) { Misc::ToUTF8(utf16Strings[i]); });
+		Bench::Report(prefix + " ToUTF8", toUTF8 * perChar, "char");
+
+		std::string utf8Buffer;
+		const auto toUTF8Reused = Bench::Measure(
+		    stringCount, [&](std::size_t i) { Misc::ToUTF8(utf16Strings[i], utf8Buffer); });
+		Bench::Report(prefix + " ToUTF8 (reused buffer)", toUTF8Reused * perChar, "char");
+	}
+} // namespace
+
+// 用法：UmaPyoginUnicodeBench [平均字符数] [字符串数]
+// 以生成的日文与中文文本测量 UTF-8 与 UTF-16 之间的转换，结果为每个字符的纳秒数
+int main(int argc, char** argv)
+{
+	Log::SetLogHandler(Bench::PrintLog);
+
+	const auto length = Bench::GetCountArgument(argc, argv, 1, 32);
+	const auto stringCount = Bench::GetCountArgument(argc, argv, 2, 20000);
+
+	std::printf("%zu strings of about %zu characters\n", stringCount, length);
+
+	MeasureScript("Japanese", Test::Script::Japanese, stringCount, length);
+	MeasureScript("Chinese", Test::Script::Chinese, stringCount, length);
+}
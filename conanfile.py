@@ -11,7 +11,7 @@ class UmaPyoginConan(ConanFile):
 
     generators = "cmake"
 
-    exports_sources = "CMakeLists.txt", "src/*"
+    exports_sources = "CMakeLists.txt", "src/*", "tools/*", "tests/*", "bench/*"
 
     def configure_cmake(self):
         cmake = CMake(self)
@@ -0,0 +1,131 @@
+#include "AssetNameIndex.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace UmaPyogin
+{
+	std::uint64_t HashAssetName(std::u16string_view name)
+	{
+		constexpr std::uint64_t Multiplier = 0x9E3779B97F4A7C15ull;
+		const auto bytes = reinterpret_cast<const std::byte*>(name.data());
+		const auto size = name.size() * sizeof(char16_t);
+
+		auto hash = static_cast<std::uint64_t>(size) * Multiplier;
+		std::size_t offset = 0;
+		for (; offset + sizeof(std::uint64_t) <= size; offset += sizeof(std::uint64_t))
+		{
+			std::uint64_t word;
+			std::memcpy(&word, bytes + offset, sizeof(word));
+			hash = (std::rotl(hash, 5) ^ word) * Multiplier;
+		}
+		if (offset < size)
+		{
+			std::uint64_t word{};
+			std::memcpy(&word, bytes + offset, size - offset);
+			hash = (std::rotl(hash, 5) ^ word) * Multiplier;
+		}
+		return hash ^ (hash >> 32);
+	}
+
+	void AssetNameIndex::Add(std::u16string_view name)
+	{
+		m_Entries.push_back({ static_cast<std::uint32_t>(m_Chars.size()),
+		                      static_cast<std::uint32_t>(name.size()) });
+		m_Chars.insert(m_Chars.end(), name.begin(), name.end());
+	}
+
+	void AssetNameIndex::Build()
+	{
+		// 负载因子不超过 1/2，过滤器每个名称占用 16 位，误判率约为 1.4%
+		const auto capacity = std::bit_ceil(std::max<std::size_t>(m_Entries.size() * 2, 16));
+		m_Slots.assign(capacity, Slot{});
+		const auto bloomBits = std::bit_ceil(std::max<std::size_t>(m_Entries.size() * 16, 64));
+		m_Bloom.assign(bloomBits / 64, 0);
+		m_Size = 0;
+
+		for (std::size_t i = 0; i < m_Entries.size(); ++i)
+		{
+			const auto name = GetName(m_Entries[i]);
+			const auto hash = HashAssetName(name);
+			if (Find(name, hash))
+			{
+				continue;
+			}
+
+			for (auto index = hash & (capacity - 1);; index = (index + 1) & (capacity - 1))
+			{
+				auto& slot = m_Slots[index];
+				if (!slot.Entry)
+				{
+					slot = { static_cast<std::uint32_t>(hash), static_cast<std::uint32_t>(i + 1) };
+					break;
+				}
+			}
+			for (const auto bit : BloomBits(hash))
+			{
+				m_Bloom[bit / 64] |= std::uint64_t(1) << (bit % 64);
+			}
+			++m_Size;
+		}
+	}
+
+	bool AssetNameIndex::Contains(std::u16string_view name) const
+	{
+		if (m_Slots.empty())
+		{
+			return false;
+		}
+
+		const auto hash = HashAssetName(name);
+		for (const auto bit : BloomBits(hash))
+		{
+			if (!(m_Bloom[bit / 64] & (std::uint64_t(1) << (bit % 64))))
+			{
+				return false;
+			}
+		}
+		return Find(name, hash);
+	}
+
+	std::size_t AssetNameIndex::GetSize() const
+	{
+		return m_Size;
+	}
+
+	std::size_t AssetNameIndex::GetCapacity() const
+	{
+		return m_Slots.size();
+	}
+
+	std::u16string_view AssetNameIndex::GetName(Entry const& entry) const
+	{
+		return std::u16string_view(m_Chars.data() + entry.Offset, entry.Length);
+	}
+
+	std::array<std::size_t, 2> AssetNameIndex::BloomBits(std::uint64_t hash) const
+	{
+		const auto mask = m_Bloom.size() * 64 - 1;
+		return { static_cast<std::size_t>(hash >> 32) & mask,
+			     static_cast<std::size_t>(hash >> 48 | hash << 16) & mask };
+	}
+
+	bool AssetNameIndex::Find(std::u16string_view name, std::uint64_t hash) const
+	{
+		const auto mask = m_Slots.size() - 1;
+		for (auto index = hash & mask;; index = (index + 1) & mask)
+		{
+			const auto& slot = m_Slots[index];
+			if (!slot.Entry)
+			{
+				return false;
+			}
+			if (slot.Hash == static_cast<std::uint32_t>(hash) &&
+			    GetName(m_Entries[slot.Entry - 1]) == name)
+			{
+				return true;
+			}
+		}
+	}
+} // namespace UmaPyogin
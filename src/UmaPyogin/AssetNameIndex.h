@@ -0,0 +1,59 @@
+#ifndef UMAPYOGIN_ASSET_NAME_INDEX_H
+#define UMAPYOGIN_ASSET_NAME_INDEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace UmaPyogin
+{
+	// 每次处理 4 个 UTF-16 字符，末尾不足 8 字节的部分补零
+	std::uint64_t HashAssetName(std::u16string_view name);
+
+	// 加载资源时建立、之后只读的资源名集合，名称连续存放，查找不分配内存也不加锁
+	// 游戏加载的资源绝大多数不在额外的资源包中，因此先以布隆过滤器排除
+	class AssetNameIndex
+	{
+	public:
+		void Add(std::u16string_view name);
+		// 添加全部名称后调用
+		void Build();
+
+		bool Contains(std::u16string_view name) const;
+
+		// 不含重复的名称
+		std::size_t GetSize() const;
+		// 开放寻址表的槽数，为 2 的幂
+		std::size_t GetCapacity() const;
+
+	private:
+		struct Entry
+		{
+			std::uint32_t Offset;
+			std::uint32_t Length;
+		};
+
+		struct Slot
+		{
+			// 哈希值的低 32 位，用于在比较名称之前排除大部分冲突
+			std::uint32_t Hash;
+			// m_Entries 中的序号加 1，为 0 时表示空槽
+			std::uint32_t Entry;
+		};
+
+		std::vector<char16_t> m_Chars;
+		std::vector<Entry> m_Entries;
+		std::vector<Slot> m_Slots;
+		std::vector<std::uint64_t> m_Bloom;
+		std::size_t m_Size{};
+
+		std::u16string_view GetName(Entry const& entry) const;
+		// 槽位序号取哈希值的低位，过滤器取高位
+		std::array<std::size_t, 2> BloomBits(std::uint64_t hash) const;
+		bool Find(std::u16string_view name, std::uint64_t hash) const;
+	};
+} // namespace UmaPyogin
+
+#endif
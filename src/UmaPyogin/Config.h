@@ -50,7 +50,16 @@ namespace UmaPyogin
 	X(String, RaceJikkyoMessageDataDictPath)                                                       \
 	X(String, ExtraAssetBundlePath)                                                                \
 	X(String, ReplaceFontPath)                                                                     \
-	X(Int, OverrideFPS)
+	X(Int, OverrideFPS)                                                                            \
+	X(String, LocalizationPackPath)                                                                \
+	X(Int, StringCacheBudget)                                                                      \
+	X(Int, StoryCacheBudget)                                                                       \
+	X(Int, LocalizationWaitTimeout)                                                                \
+	X(Bool, LoadLocalizationSynchronously)                                                         \
+	X(Bool, EnableHotReload)                                                                       \
+	X(Int, LogLevel)                                                                               \
+	X(Bool, EnableAsyncLog)                                                                        \
+	X(String, TraceFilePath)
 
 	struct Config
 	{
@@ -1,20 +1,38 @@
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
-#include <regex>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <shared_mutex>
 #include <string_view>
 #include <thread>
-#include <unordered_set>
+#include <unordered_map>
+#include <utility>
 #include <variant>
+#include <vector>
 
+#include "AssetNameIndex.h"
 #include "Hook.h"
 #include "Il2Cpp.h"
 #include "Localization.h"
+#include "LocalizationPack.h"
 #include "Log.h"
 #include "Misc.h"
 #include "Plugin.h"
+#include "Profiler.h"
+#include "Sql.h"
+#include "StringCache.h"
+#include "Trace.h"
+#include "Watcher.h"
 
 using namespace UmaPyogin;
 using namespace Il2CppSymbols;
@@ -77,30 +95,115 @@ namespace
 	Il2CppClass* IListClass;
 	Il2CppString* (*Environment_get_StackTrace)();
 
-	template <typename Receiver>
-	void IterateIList(Il2CppObject* container, Receiver&& receiver)
+	// 以类为键、只增不删的缓存，查找无锁，插入时加锁
+	// 类在运行期间不会卸载，因此无需删除，表满后不再缓存新类
+	template <typename T, std::size_t Capacity>
+	class ClassCache
 	{
-		using namespace std::literals::string_view_literals;
+		static_assert((Capacity & (Capacity - 1)) == 0);
 
-		const auto containerClass = il2cpp_object_get_class(container);
+	public:
+		// resolver 返回 std::optional<T>，解析失败时不缓存
+		template <typename Resolver>
+		std::optional<T> Get(Il2CppClass* klass, Resolver&& resolver)
+		{
+			if (const auto value = Find(klass))
+			{
+				return value;
+			}
+
+			const auto value = std::forward<Resolver>(resolver)();
+			if (!value)
+			{
+				return std::nullopt;
+			}
+
+			std::unique_lock lock(m_WriteMutex);
+			auto index = Hash(klass);
+			for (std::size_t i = 0; i < Capacity; ++i, index = (index + 1) & (Capacity - 1))
+			{
+				auto& slot = m_Slots[index];
+				const auto key = slot.Key.load(std::memory_order_relaxed);
+				if (key == klass)
+				{
+					break;
+				}
+				if (!key)
+				{
+					slot.Value = *value;
+					slot.Key.store(klass, std::memory_order_release);
+					break;
+				}
+			}
+			return value;
+		}
+
+	private:
+		struct Slot
+		{
+			std::atomic<Il2CppClass*> Key{};
+			T Value{};
+		};
+
+		static std::size_t Hash(Il2CppClass* klass)
+		{
+			const auto value = reinterpret_cast<std::uintptr_t>(klass) >> 3;
+			return static_cast<std::size_t>((static_cast<std::uint64_t>(value) *
+			                                 0x9E3779B97F4A7C15ull) >>
+			                                (64 - std::countr_zero(Capacity)));
+		}
+
+		std::optional<T> Find(Il2CppClass* klass) const
+		{
+			auto index = Hash(klass);
+			for (std::size_t i = 0; i < Capacity; ++i, index = (index + 1) & (Capacity - 1))
+			{
+				const auto& slot = m_Slots[index];
+				const auto key = slot.Key.load(std::memory_order_acquire);
+				if (key == klass)
+				{
+					return slot.Value;
+				}
+				if (!key)
+				{
+					break;
+				}
+			}
+			return std::nullopt;
+		}
+
+		Slot m_Slots[Capacity];
+		std::mutex m_WriteMutex;
+	};
+
+	struct IListMethods
+	{
+		std::int32_t (*get_Count)(Il2CppObject*);
+		Il2CppObject* (*get_Item)(Il2CppObject*, std::int32_t);
+		// 对于元素为引用类型的 System.Collections.Generic.List<T>，直接读取 _items 与 _size，
+		// 偏移为 -1 表示不可用
+		std::int32_t ItemsOffset;
+		std::int32_t SizeOffset;
+	};
+
+	ClassCache<IListMethods, 256> IListMethodsCache;
+
+	std::optional<IListMethods> ResolveIListMethods(Il2CppObject* container,
+	                                                Il2CppClass* containerClass)
+	{
 		if (!il2cpp_class_is_assignable_from(IListClass, containerClass))
 		{
 			Log::Error("UmaPyogin: IterateIList: container({}) is not IList",
 			           il2cpp_class_get_name(containerClass));
-			return;
+			return std::nullopt;
 		}
-		std::int32_t size;
+
 		const auto get_Count_Method = FindMethodFromName(containerClass, "get_Count");
-		if (get_Count_Method)
-		{
-			size = reinterpret_cast<std::int32_t (*)(Il2CppObject*)>(
-			    get_Count_Method->methodPointer)(container);
-		}
-		else
+		if (!get_Count_Method)
 		{
 			Log::Error("UmaPyogin: IterateIList: Failed to get get_Count method from class {}",
 			           il2cpp_class_get_name(containerClass));
-			return;
+			return std::nullopt;
 		}
 
 		const auto get_Item_Method = FindMethodFromName(containerClass, "get_Item");
@@ -108,56 +211,137 @@ namespace
 		{
 			Log::Error("UmaPyogin: IterateIList: Failed to get get_Item method from class {}.",
 			           il2cpp_class_get_name(containerClass));
+			return std::nullopt;
+		}
+
+		IListMethods methods{
+			reinterpret_cast<decltype(IListMethods::get_Count)>(get_Count_Method->methodPointer),
+			reinterpret_cast<decltype(IListMethods::get_Item)>(get_Item_Method->methodPointer),
+			-1,
+			-1,
+		};
+
+		const auto head = reinterpret_cast<const Il2CppClassHead*>(containerClass);
+		if (head->namespaze == "System.Collections.Generic"sv && head->name == "List`1"sv)
+		{
+			const auto itemsField = il2cpp_class_get_field_from_name(containerClass, "_items");
+			const auto sizeField = il2cpp_class_get_field_from_name(containerClass, "_size");
+			if (itemsField && sizeField)
+			{
+				// 元素为值类型时不能作为对象指针读取，此时仍调用 get_Item
+				Il2CppObject* items;
+				il2cpp_field_get_value(container, itemsField, &items);
+				if (items && il2cpp_array_element_size(il2cpp_object_get_class(items)) ==
+				                 sizeof(Il2CppObject*))
+				{
+					methods.ItemsOffset = itemsField->offset;
+					methods.SizeOffset = sizeField->offset;
+				}
+			}
+		}
+
+		return methods;
+	}
+
+	template <typename Receiver>
+	void IterateIList(Il2CppObject* container, Receiver&& receiver)
+	{
+		const auto containerClass = il2cpp_object_get_class(container);
+		const auto methods = IListMethodsCache.Get(
+		    containerClass, [&] { return ResolveIListMethods(container, containerClass); });
+		if (!methods)
+		{
 			return;
 		}
 
+		if (methods->ItemsOffset != -1)
+		{
+			const auto base = reinterpret_cast<std::byte*>(container);
+			const auto items = *reinterpret_cast<Il2CppArray**>(base + methods->ItemsOffset);
+			const auto size = *reinterpret_cast<std::int32_t*>(base + methods->SizeOffset);
+			if (items && size >= 0 && static_cast<std::uintptr_t>(size) <= items->max_length)
+			{
+				const auto elements = reinterpret_cast<Il2CppObject**>(items + 1);
+				for (std::int32_t i = 0; i < size; ++i)
+				{
+					std::forward<Receiver>(receiver)(i, elements[i]);
+				}
+				return;
+			}
+		}
+
+		const auto size = methods->get_Count(container);
 		for (std::int32_t i = 0; i < size; ++i)
 		{
-			const auto item = reinterpret_cast<Il2CppObject* (*) (Il2CppObject*, std::int32_t)>(
-			    get_Item_Method->methodPointer)(container, i);
-			std::forward<Receiver>(receiver)(i, item);
+			std::forward<Receiver>(receiver)(i, methods->get_Item(container, i));
 		}
 	}
 
+	ClassCache<Il2CppObject* (*) (Il2CppObject*), 256> GetEnumeratorCache;
+
+	struct IEnumeratorMethods
+	{
+		bool (*MoveNext)(Il2CppObject*);
+		Il2CppObject* (*get_Current)(Il2CppObject*);
+	};
+
+	ClassCache<IEnumeratorMethods, 256> IEnumeratorMethodsCache;
+
 	template <typename Receiver>
 	void IterateIEnumerable(Il2CppObject* enumerable, Receiver&& receiver)
 	{
-		using namespace std::literals::string_view_literals;
-
 		const auto enumerableClass = il2cpp_object_get_class(enumerable);
-		const auto get_Enumerator_Method =
-		    il2cpp_class_get_method_from_name(enumerableClass, "GetEnumerator", 0);
-		if (!get_Enumerator_Method)
+		const auto getEnumerator = GetEnumeratorCache.Get(
+		    enumerableClass, [&]() -> std::optional<Il2CppObject* (*) (Il2CppObject*)> {
+			    const auto get_Enumerator_Method =
+			        il2cpp_class_get_method_from_name(enumerableClass, "GetEnumerator", 0);
+			    if (!get_Enumerator_Method)
+			    {
+				    Log::Error("UmaPyogin: Failed to get GetEnumerator method.");
+				    return std::nullopt;
+			    }
+			    return reinterpret_cast<Il2CppObject* (*) (Il2CppObject*)>(
+			        get_Enumerator_Method->methodPointer);
+		    });
+		if (!getEnumerator)
 		{
-			Log::Error("UmaPyogin: Failed to get GetEnumerator method.");
 			return;
 		}
 
-		const auto enumerator = reinterpret_cast<Il2CppObject* (*) (Il2CppObject*)>(
-		    get_Enumerator_Method->methodPointer)(enumerable);
+		const auto enumerator = (*getEnumerator)(enumerable);
 		const auto enumeratorClass = il2cpp_object_get_class(enumerator);
-		const auto move_Next_Method =
-		    il2cpp_class_get_method_from_name(enumeratorClass, "MoveNext", 0);
-		if (!move_Next_Method)
-		{
-			Log::Error("UmaPyogin: Failed to get MoveNext method.");
-			return;
-		}
-
-		const auto get_Current_Method =
-		    il2cpp_class_get_method_from_name(enumeratorClass, "get_Current", 0);
-		if (!get_Current_Method)
+		const auto methods = IEnumeratorMethodsCache.Get(
+		    enumeratorClass, [&]() -> std::optional<IEnumeratorMethods> {
+			    const auto move_Next_Method =
+			        il2cpp_class_get_method_from_name(enumeratorClass, "MoveNext", 0);
+			    if (!move_Next_Method)
+			    {
+				    Log::Error("UmaPyogin: Failed to get MoveNext method.");
+				    return std::nullopt;
+			    }
+
+			    const auto get_Current_Method =
+			        il2cpp_class_get_method_from_name(enumeratorClass, "get_Current", 0);
+			    if (!get_Current_Method)
+			    {
+				    Log::Error("UmaPyogin: Failed to get get_Current method.");
+				    return std::nullopt;
+			    }
+
+			    return IEnumeratorMethods{
+				    reinterpret_cast<bool (*)(Il2CppObject*)>(move_Next_Method->methodPointer),
+				    reinterpret_cast<Il2CppObject* (*) (Il2CppObject*)>(
+				        get_Current_Method->methodPointer),
+			    };
+		    });
+		if (!methods)
 		{
-			Log::Error("UmaPyogin: Failed to get get_Current method.");
 			return;
 		}
 
-		while (
-		    reinterpret_cast<bool (*)(Il2CppObject*)>(move_Next_Method->methodPointer)(enumerator))
+		while (methods->MoveNext(enumerator))
 		{
-			const auto item = reinterpret_cast<Il2CppObject* (*) (Il2CppObject*)>(
-			    get_Current_Method->methodPointer)(enumerator);
-			std::forward<Receiver>(receiver)(item);
+			std::forward<Receiver>(receiver)(methods->get_Current(enumerator));
 		}
 	}
 
@@ -166,18 +350,57 @@ namespace
 		return il2cpp_string_new(reinterpret_cast<const char*>(str.data()));
 	}
 
+	// 仅用于本地化文本，结果可能来自缓存，调用方不得修改
 	Il2CppString* ToIl2CppString(std::u16string_view str)
 	{
-		return il2cpp_string_new_utf16(str.data(), str.size());
+		return Il2CppStringCache::GetInstance().Get(str);
+	}
+
+	// 以下直接按偏移读写实例字段，省去每次调用 il2cpp_field_get_value_object 等函数的开销
+	Il2CppObject* GetObjectField(Il2CppObject* obj, FieldInfo* field)
+	{
+		return *reinterpret_cast<Il2CppObject**>(reinterpret_cast<std::byte*>(obj) +
+		                                         field->offset);
+	}
+
+	void SetObjectField(Il2CppObject* obj, FieldInfo* field, Il2CppObject* value)
+	{
+		// 写入引用需经过写屏障，运行时未导出时交由 il2cpp_field_set_value_object 处理
+		if (il2cpp_gc_wbarrier_set_field)
+		{
+			il2cpp_gc_wbarrier_set_field(
+			    obj, reinterpret_cast<void**>(reinterpret_cast<std::byte*>(obj) + field->offset),
+			    value);
+		}
+		else
+		{
+			il2cpp_field_set_value_object(obj, field, value);
+		}
+	}
+
+	void SetStringField(Il2CppObject* obj, FieldInfo* field, std::u16string_view str)
+	{
+		SetObjectField(obj, field, reinterpret_cast<Il2CppObject*>(ToIl2CppString(str)));
 	}
 
 	DEFINE_HOOK(Il2CppString*, LocalizeJP_Get, (std::int32_t id))
 	{
+		UMAPYOGIN_PROFILE_HOOK(LocalizeJP_Get);
+		if (Trace::IsActive())
+		{
+			Trace::RecordLocalizeJP_Get(id);
+		}
+		// 加载完成时会等待读端退出，因此在进入读端之前等待
+		Localization::LoadingStatus::GetInstance().WaitUntilReady(Localization::Dataset::Static);
+		// 热重载可能随时替换译文，在转换为托管字符串之前需保持旧数据存活
+		const Misc::Rcu::ReadGuard guard;
 		const auto localizedString = Localization::StaticLocalization::GetInstance().Localize(id);
 		if (localizedString)
 		{
-			return il2cpp_string_new_utf16(localizedString->c_str(), localizedString->size());
+			UMAPYOGIN_PROFILE_HIT();
+			return ToIl2CppString(*localizedString);
 		}
+		UMAPYOGIN_PROFILE_MISS();
 		return LocalizeJP_Get_Orig(id);
 	}
 
@@ -203,8 +426,22 @@ namespace
 	void LocalizeStoryTimelineData(Il2CppObject* timelineData)
 	{
 		const auto storyIdStr = reinterpret_cast<Il2CppString*>(
-		    il2cpp_field_get_value_object(StoryTimelineDataClass_StoryIdField, timelineData));
-		const auto storyId = std::stoull(Misc::ToUTF8(storyIdStr->chars));
+		    GetObjectField(timelineData, StoryTimelineDataClass_StoryIdField));
+		// StoryId 仅由数字组成，直接从 UTF-16 解析，无需转换编码
+		const std::u16string_view storyIdView(storyIdStr->chars, storyIdStr->length);
+		if (storyIdView.empty())
+		{
+			return;
+		}
+		std::size_t storyId{};
+		for (const auto c : storyIdView)
+		{
+			if (c < u'0' || c > u'9')
+			{
+				return;
+			}
+			storyId = storyId * 10 + (c - u'0');
+		}
 
 		const auto localizedStory =
 		    Localization::StoryLocalization::GetInstance().GetStoryTextData(storyId);
@@ -213,12 +450,9 @@ namespace
 			return;
 		}
 
-		il2cpp_field_set_value_object(
-		    timelineData, StoryTimelineDataClass_TitleField,
-		    reinterpret_cast<Il2CppObject*>(ToIl2CppString(localizedStory->Title)));
+		SetStringField(timelineData, StoryTimelineDataClass_TitleField, localizedStory->Title);
 
-		const auto blockList =
-		    il2cpp_field_get_value_object(StoryTimelineDataClass_BlockListField, timelineData);
+		const auto blockList = GetObjectField(timelineData, StoryTimelineDataClass_BlockListField);
 		IterateIList(blockList, [&](std::size_t i, Il2CppObject* block) {
 			const auto& textClip = localizedStory->TextBlockList[i];
 			if (!textClip)
@@ -227,38 +461,35 @@ namespace
 			}
 
 			const auto textTrack =
-			    il2cpp_field_get_value_object(StoryTimelineBlockDataClass_TextTrackField, block);
+			    GetObjectField(block, StoryTimelineBlockDataClass_TextTrackField);
 			if (!textTrack)
 			{
 				return;
 			}
 
 			const auto clipList =
-			    il2cpp_field_get_value_object(StoryTimelineTrackDataClass_ClipListField, textTrack);
+			    GetObjectField(textTrack, StoryTimelineTrackDataClass_ClipListField);
 			IterateIList(clipList, [&](std::size_t, Il2CppObject* clipData) {
-				il2cpp_field_set_value_object(
-				    clipData, StoryTimelineTextClipDataClass_NameField,
-				    reinterpret_cast<Il2CppObject*>(ToIl2CppString(textClip->Name)));
-				il2cpp_field_set_value_object(
-				    clipData, StoryTimelineTextClipDataClass_TextField,
-				    reinterpret_cast<Il2CppObject*>(ToIl2CppString(textClip->Text)));
-
-				const auto choiceDataList = il2cpp_field_get_value_object(
-				    StoryTimelineTextClipDataClass_ChoiceDataList, clipData);
+				SetStringField(clipData, StoryTimelineTextClipDataClass_NameField, textClip->Name);
+				SetStringField(clipData, StoryTimelineTextClipDataClass_TextField, textClip->Text);
+
+				const auto choiceDataList =
+				    GetObjectField(clipData, StoryTimelineTextClipDataClass_ChoiceDataList);
+				const auto localizedChoiceDataList = localizedStory->GetChoiceDataList(*textClip);
 				IterateIList(choiceDataList, [&](std::size_t i, Il2CppObject* choiceData) {
-					const auto& choiceText = textClip->ChoiceDataList[i];
-					il2cpp_field_set_value_object(
-					    choiceData, StoryTimelineTextClipDataClass_ChoiceDataClass_TextField,
-					    reinterpret_cast<Il2CppObject*>(ToIl2CppString(choiceText)));
+					SetStringField(choiceData,
+					               StoryTimelineTextClipDataClass_ChoiceDataClass_TextField,
+					               localizedChoiceDataList[i]);
 				});
 
-				const auto colorTextInfoList = il2cpp_field_get_value_object(
-				    StoryTimelineTextClipDataClass_ColorTextInfoListField, clipData);
+				const auto colorTextInfoList =
+				    GetObjectField(clipData, StoryTimelineTextClipDataClass_ColorTextInfoListField);
+				const auto localizedColorTextInfoList =
+				    localizedStory->GetColorTextInfoList(*textClip);
 				IterateIList(colorTextInfoList, [&](std::size_t i, Il2CppObject* colorTextInfo) {
-					const auto& colorText = textClip->ColorTextInfoList[i];
-					il2cpp_field_set_value_object(
-					    colorTextInfo, StoryTimelineTextClipDataClass_ColorTextInfoClass_TextField,
-					    reinterpret_cast<Il2CppObject*>(ToIl2CppString(colorText)));
+					SetStringField(colorTextInfo,
+					               StoryTimelineTextClipDataClass_ColorTextInfoClass_TextField,
+					               localizedColorTextInfoList[i]);
 				});
 			});
 		});
@@ -278,16 +509,40 @@ namespace
 			return;
 		}
 
-		const auto textData =
-		    il2cpp_field_get_value_object(StoryRaceTextAssetClass_textDataField, raceTextAsset);
+		const auto textData = GetObjectField(raceTextAsset, StoryRaceTextAssetClass_textDataField);
 		IterateIList(textData, [&](std::size_t i, Il2CppObject* key) {
-			const auto& text = localizedRaceData->textData[i];
-			il2cpp_field_set_value_object(key, StoryRaceTextAssetClass_KeyClass_textField,
-			                              reinterpret_cast<Il2CppObject*>(ToIl2CppString(text)));
+			SetStringField(key, StoryRaceTextAssetClass_KeyClass_textField,
+			               localizedRaceData->textData[i]);
 		});
 	}
 
-	std::uint32_t ExtraAssetBundleHandle;
+	std::size_t ParseRaceId(const char16_t* assetName)
+	{
+		const auto assetPath = std::filesystem::path(assetName).stem();
+#ifdef _WIN32
+		const auto assetNameStr = assetPath.string();
+		const auto name = static_cast<std::string_view>(assetNameStr);
+#else
+		const auto name = static_cast<std::string_view>(assetPath.native());
+#endif
+		constexpr const char RacePrefix[] = "storyrace_";
+		assert(name.starts_with(RacePrefix));
+		return static_cast<std::size_t>(std::atoll(name.substr(std::size(RacePrefix) - 1).data()));
+	}
+
+	void TraceLoadAsset(Il2CppString* name, Il2CppObject* asset)
+	{
+		if (Trace::IsActive())
+		{
+			Trace::RecordAssetBundle_LoadAsset(
+			    std::u16string_view(name->chars, name->length),
+			    asset ? il2cpp_class_get_name(il2cpp_object_get_class(asset)) : "");
+		}
+	}
+
+	std::atomic<std::uint32_t> ExtraAssetBundleHandle;
+	// 多个线程同时首次加载资源时只加载一次
+	std::mutex LoadResourcesMutex;
 
 	void LoadResources();
 
@@ -299,8 +554,15 @@ namespace
 		using std::hash<std::u16string_view>::operator();
 	};
 
-	std::unordered_set<std::u16string, TransparentStringHash, std::equal_to<void>>
-	    ExtraAssetBundleAssetNameSet;
+	// 由 LoadResources 发布，查找时需持有 Misc::Rcu::ReadGuard
+	std::atomic<const AssetNameIndex*> ExtraAssetBundleAssetNames;
+
+	bool IsExtraAsset(Il2CppString* name)
+	{
+		const Misc::Rcu::ReadGuard guard;
+		const auto assetNames = ExtraAssetBundleAssetNames.load(std::memory_order_acquire);
+		return assetNames && assetNames->Contains(std::u16string_view(name->chars, name->length));
+	}
 
 	Il2CppObject* (*AssetBundle_LoadFromFile)(Il2CppString* path);
 	Il2CppObject* (*AssetBundle_GetAllAssetNames)(Il2CppObject* self);
@@ -308,43 +570,34 @@ namespace
 	DEFINE_HOOK(Il2CppObject*, AssetBundle_LoadAsset,
 	            (Il2CppObject * self, Il2CppString* name, Il2CppReflectionType* type))
 	{
+		UMAPYOGIN_PROFILE_HOOK(AssetBundle_LoadAsset);
 		if (!ExtraAssetBundleHandle)
 		{
 			LoadResources();
 		}
-		const auto extraAssetBundle = il2cpp_gchandle_get_target(ExtraAssetBundleHandle);
-		if (ExtraAssetBundleAssetNameSet.find(
-#if __cpp_lib_generic_unordered_lookup >= 201811L
-		        std::u16string_view(name->chars)
-#else
-		        std::u16string(name->chars)
-#endif
-		            ) != ExtraAssetBundleAssetNameSet.end())
+		if (IsExtraAsset(name))
 		{
-			return AssetBundle_LoadAsset_Orig(extraAssetBundle, name, type);
+			UMAPYOGIN_PROFILE_HIT();
+			const auto extraAssetBundle = il2cpp_gchandle_get_target(ExtraAssetBundleHandle);
+			const auto asset = AssetBundle_LoadAsset_Orig(extraAssetBundle, name, type);
+			TraceLoadAsset(name, asset);
+			return asset;
 		}
+		UMAPYOGIN_PROFILE_MISS();
 		const auto asset = AssetBundle_LoadAsset_Orig(self, name, type);
+		TraceLoadAsset(name, asset);
 		if (asset)
 		{
 			const auto assetClass = il2cpp_object_get_class(asset);
 			if (assetClass == StoryTimelineDataClass)
 			{
+				UMAPYOGIN_PROFILE_HIT();
 				LocalizeStoryTimelineData(asset);
 			}
 			else if (assetClass == StoryRaceTextAssetClass)
 			{
-				const auto assetPath = std::filesystem::path(name->chars).stem();
-#ifdef _WIN32
-				const auto assetNameStr = assetPath.string();
-				const auto assetName = static_cast<std::string_view>(assetNameStr);
-#else
-				const auto assetName = static_cast<std::string_view>(assetPath.native());
-#endif
-				constexpr const char RacePrefix[] = "storyrace_";
-				assert(assetName.starts_with(RacePrefix));
-				const auto raceId = static_cast<std::size_t>(
-				    std::atoll(assetName.substr(std::size(RacePrefix) - 1).data()));
-				LocalizeStoryRaceTextAsset(asset, raceId);
+				UMAPYOGIN_PROFILE_HIT();
+				LocalizeStoryRaceTextAsset(asset, ParseRaceId(name->chars));
 			}
 		}
 		return asset;
@@ -376,6 +629,7 @@ namespace
 
 	DEFINE_HOOK(void, TextCommon_Awake, (Il2CppObject * self))
 	{
+		UMAPYOGIN_PROFILE_HOOK(TextCommon_Awake);
 		TextCommon_Awake_Orig(self);
 
 		Il2CppObject* replaceFont{};
@@ -414,10 +668,12 @@ namespace
 	FontAlive:
 		if (replaceFont)
 		{
+			UMAPYOGIN_PROFILE_HIT();
 			Text_set_font(self, replaceFont);
 		}
 		else
 		{
+			UMAPYOGIN_PROFILE_MISS();
 			Text_AssignDefaultFont(self);
 		}
 
@@ -427,7 +683,7 @@ namespace
 		Text_set_lineSpacing(self, 1.03f);
 	}
 
-	int (*Query_GetInt)(void* self, int idx);
+	Hook::QueryGetIntFunction Query_GetInt;
 
 	struct ColumnIndex
 	{
@@ -451,51 +707,68 @@ namespace
 
 	using QueryIndex = std::variant<std::monostate, ColumnIndex, BindingParam>;
 
+	// 查询对象就地构造于 LocalizationQueryTable 的槽位中，各实现的大小不能超过此值
+	constexpr std::size_t LocalizationQueryStorageSize = 128;
+
 	struct ILocalizationQuery
 	{
 		virtual ~ILocalizationQuery() = default;
 
-		virtual void AddColumn(std::size_t index, std::string_view column)
+		// 在 storage 上构造自身的副本
+		virtual ILocalizationQuery* CloneTo(void* storage) const = 0;
+
+		virtual void AddColumn(std::size_t /*index*/, std::u16string_view /*column*/)
 		{
 		}
 
-		virtual void AddParam(std::size_t index, std::string_view param)
+		virtual void AddParam(std::size_t /*index*/, std::u16string_view /*param*/)
 		{
 		}
 
-		virtual void Bind(std::size_t index, std::size_t value)
+		virtual void Bind(std::size_t /*index*/, std::size_t /*value*/)
 		{
 		}
 
-		virtual void Step(void* query)
+		virtual void Step(void* /*query*/, Hook::QueryGetIntFunction /*getInt*/)
 		{
 		}
 
-		virtual const std::u16string* GetString(std::size_t index) = 0;
+		virtual std::optional<std::u16string_view> GetString(std::size_t index) = 0;
 	};
 
-	struct TextDataQuery : ILocalizationQuery
+	template <typename Derived>
+	struct LocalizationQueryBase : ILocalizationQuery
+	{
+		ILocalizationQuery* CloneTo(void* storage) const override
+		{
+			static_assert(sizeof(Derived) <= LocalizationQueryStorageSize);
+			static_assert(alignof(Derived) <= alignof(std::max_align_t));
+			return new (storage) Derived(static_cast<Derived const&>(*this));
+		}
+	};
+
+	struct TextDataQuery : LocalizationQueryBase<TextDataQuery>
 	{
 		QueryIndex Category;
 		QueryIndex Index;
 
 		QueryIndex Text;
 
-		void AddColumn(std::size_t index, std::string_view column) override
+		void AddColumn(std::size_t index, std::u16string_view column) override
 		{
-			if (column == "text"sv)
+			if (column == u"text"sv)
 			{
 				Text.emplace<ColumnIndex>(index);
 			}
 		}
 
-		void AddParam(std::size_t index, std::string_view param) override
+		void AddParam(std::size_t index, std::u16string_view param) override
 		{
-			if (param == "category"sv)
+			if (param == u"category"sv)
 			{
 				Category.emplace<BindingParam>(index);
 			}
-			else if (param == "index"sv)
+			else if (param == u"index"sv)
 			{
 				Index.emplace<BindingParam>(index);
 			}
@@ -521,7 +794,7 @@ namespace
 			}
 		}
 
-		const std::u16string* GetString(std::size_t index) override
+		std::optional<std::u16string_view> GetString(std::size_t index) override
 		{
 			if (index == std::get<ColumnIndex>(Text).Value)
 			{
@@ -530,36 +803,36 @@ namespace
 				return Localization::DatabaseLocalization::GetInstance().GetTextData(category,
 				                                                                     index);
 			}
-			return nullptr;
+			return std::nullopt;
 		}
 	};
 
-	struct CharacterSystemTextQuery : ILocalizationQuery
+	struct CharacterSystemTextQuery : LocalizationQueryBase<CharacterSystemTextQuery>
 	{
 		QueryIndex CharacterId;
 		QueryIndex VoiceId;
 
 		QueryIndex Text;
 
-		void AddColumn(std::size_t index, std::string_view column) override
+		void AddColumn(std::size_t index, std::u16string_view column) override
 		{
-			if (column == "text"sv)
+			if (column == u"text"sv)
 			{
 				Text.emplace<ColumnIndex>(index);
 			}
-			else if (column == "voice_id"sv)
+			else if (column == u"voice_id"sv)
 			{
 				VoiceId.emplace<ColumnIndex>(index);
 			}
 		}
 
-		void AddParam(std::size_t index, std::string_view param) override
+		void AddParam(std::size_t index, std::u16string_view param) override
 		{
-			if (param == "character_id"sv)
+			if (param == u"character_id"sv)
 			{
 				CharacterId.emplace<BindingParam>(index);
 			}
-			else if (param == "voice_id"sv)
+			else if (param == u"voice_id"sv)
 			{
 				VoiceId.emplace<BindingParam>(index);
 			}
@@ -585,17 +858,17 @@ namespace
 			}
 		}
 
-		void Step(void* query) override
+		void Step(void* query, Hook::QueryGetIntFunction getInt) override
 		{
 			assert(std::holds_alternative<BindingParam>(CharacterId));
 			if (const auto p = std::get_if<ColumnIndex>(&VoiceId))
 			{
-				const auto voiceId = Query_GetInt(query, p->Value);
+				const auto voiceId = getInt(query, p->Value);
 				p->QueryResult.emplace(voiceId);
 			}
 		}
 
-		const std::u16string* GetString(std::size_t index) override
+		std::optional<std::u16string_view> GetString(std::size_t index) override
 		{
 			if (index == std::get<ColumnIndex>(Text).Value)
 			{
@@ -614,31 +887,31 @@ namespace
 				return Localization::DatabaseLocalization::GetInstance().GetCharacterSystemTextData(
 				    characterId, voiceId);
 			}
-			return nullptr;
+			return std::nullopt;
 		}
 	};
 
-	struct RaceJikkyoCommentQuery : ILocalizationQuery
+	struct RaceJikkyoCommentQuery : LocalizationQueryBase<RaceJikkyoCommentQuery>
 	{
 		QueryIndex Id;
 
 		QueryIndex Message;
 
-		void AddColumn(std::size_t index, std::string_view column) override
+		void AddColumn(std::size_t index, std::u16string_view column) override
 		{
-			if (column == "message"sv)
+			if (column == u"message"sv)
 			{
 				Message.emplace<ColumnIndex>(index);
 			}
-			else if (column == "id"sv)
+			else if (column == u"id"sv)
 			{
 				Id.emplace<ColumnIndex>(index);
 			}
 		}
 
-		void AddParam(std::size_t index, std::string_view param) override
+		void AddParam(std::size_t index, std::u16string_view param) override
 		{
-			if (param == "id"sv)
+			if (param == u"id"sv)
 			{
 				Id.emplace<BindingParam>(index);
 			}
@@ -655,16 +928,16 @@ namespace
 			}
 		}
 
-		void Step(void* query) override
+		void Step(void* query, Hook::QueryGetIntFunction getInt) override
 		{
 			if (const auto p = std::get_if<ColumnIndex>(&Id))
 			{
-				const auto id = Query_GetInt(query, p->Value);
+				const auto id = getInt(query, p->Value);
 				p->QueryResult.emplace(id);
 			}
 		}
 
-		const std::u16string* GetString(std::size_t index) override
+		std::optional<std::u16string_view> GetString(std::size_t index) override
 		{
 			if (index == std::get<ColumnIndex>(Message).Value)
 			{
@@ -681,31 +954,31 @@ namespace
 				return Localization::DatabaseLocalization::GetInstance().GetRaceJikkyoCommentData(
 				    id);
 			}
-			return nullptr;
+			return std::nullopt;
 		}
 	};
 
-	struct RaceJikkyoMessageQuery : ILocalizationQuery
+	struct RaceJikkyoMessageQuery : LocalizationQueryBase<RaceJikkyoMessageQuery>
 	{
 		QueryIndex Id;
 
 		QueryIndex Message;
 
-		void AddColumn(std::size_t index, std::string_view column) override
+		void AddColumn(std::size_t index, std::u16string_view column) override
 		{
-			if (column == "message"sv)
+			if (column == u"message"sv)
 			{
 				Message.emplace<ColumnIndex>(index);
 			}
-			else if (column == "id"sv)
+			else if (column == u"id"sv)
 			{
 				Id.emplace<ColumnIndex>(index);
 			}
 		}
 
-		void AddParam(std::size_t index, std::string_view param) override
+		void AddParam(std::size_t index, std::u16string_view param) override
 		{
-			if (param == "id"sv)
+			if (param == u"id"sv)
 			{
 				Id.emplace<BindingParam>(index);
 			}
@@ -722,16 +995,16 @@ namespace
 			}
 		}
 
-		void Step(void* query) override
+		void Step(void* query, Hook::QueryGetIntFunction getInt) override
 		{
 			if (const auto p = std::get_if<ColumnIndex>(&Id))
 			{
-				const auto id = Query_GetInt(query, p->Value);
+				const auto id = getInt(query, p->Value);
 				p->QueryResult.emplace(id);
 			}
 		}
 
-		const std::u16string* GetString(std::size_t index) override
+		std::optional<std::u16string_view> GetString(std::size_t index) override
 		{
 			if (index == std::get<ColumnIndex>(Message).Value)
 			{
@@ -748,87 +1021,496 @@ namespace
 				return Localization::DatabaseLocalization::GetInstance().GetRaceJikkyoMessageData(
 				    id);
 			}
-			return nullptr;
+			return std::nullopt;
 		}
 	};
 
-	std::unordered_map<void*, std::unique_ptr<ILocalizationQuery>> TextQueries;
+	enum class LocalizedTable
+	{
+		TextData,
+		CharacterSystemText,
+		RaceJikkyoComment,
+		RaceJikkyoMessage,
+
+		Count
+	};
+
+	constexpr std::u16string_view LocalizedTableNames[] = {
+		u"text_data"sv,
+		u"character_system_text"sv,
+		u"race_jikkyo_comment"sv,
+		u"race_jikkyo_message"sv,
+	};
 
-	DEFINE_HOOK(void*, Query_ctor, (void* self, void* conn, Il2CppString* sql))
+	static_assert(std::size(LocalizedTableNames) ==
+	              static_cast<std::size_t>(LocalizedTable::Count));
+
+	// 编译期为需要本地化的表名生成完美哈希，使得判断表名只需一次哈希及一次比较
+	constexpr std::size_t LocalizedTableHashSize = 8;
+
+	constexpr std::size_t LocalizedTableHash(std::u16string_view name, std::size_t multiplier)
 	{
-		const auto sqlStr = Misc::ToUTF8(sql->chars);
+		return (name.size() * multiplier + name.front() + name.back()) % LocalizedTableHashSize;
+	}
 
-		static const std::regex statementPattern(R"(SELECT (.+?) FROM `(.+?)`(?: WHERE (.+))?;)");
-		static const std::regex columnPattern(R"(,?`(\w+)`)");
-		static const std::regex whereClausePattern(R"((?:AND )?`(\w+)=?`)");
+	constexpr std::size_t FindLocalizedTableHashMultiplier()
+	{
+		for (std::size_t multiplier = 1; multiplier < 256; ++multiplier)
+		{
+			bool used[LocalizedTableHashSize]{};
+			bool collided = false;
+			for (const auto name : LocalizedTableNames)
+			{
+				auto& slot = used[LocalizedTableHash(name, multiplier)];
+				if (slot)
+				{
+					collided = true;
+					break;
+				}
+				slot = true;
+			}
+			if (!collided)
+			{
+				return multiplier;
+			}
+		}
+		return 0;
+	}
+
+	constexpr auto LocalizedTableHashMultiplier = FindLocalizedTableHashMultiplier();
+	static_assert(LocalizedTableHashMultiplier != 0, "No perfect hash for localized table names");
 
-		std::cmatch matches;
-		if (std::regex_match(sqlStr.c_str(), matches, statementPattern))
+	constexpr auto LocalizedTableSlots = [] {
+		std::array<LocalizedTable, LocalizedTableHashSize> slots{};
+		slots.fill(LocalizedTable::Count);
+		for (std::size_t i = 0; i < std::size(LocalizedTableNames); ++i)
 		{
-			const auto columns = matches[1].str();
-			const auto table = matches[2].str();
-			const auto whereClause =
-			    matches.size() == 4 ? std::optional(matches[3].str()) : std::nullopt;
+			slots[LocalizedTableHash(LocalizedTableNames[i], LocalizedTableHashMultiplier)] =
+			    static_cast<LocalizedTable>(i);
+		}
+		return slots;
+	}();
 
-			std::unique_ptr<ILocalizationQuery> query;
+	// 不是需要本地化的表时返回 LocalizedTable::Count
+	LocalizedTable FindLocalizedTable(std::u16string_view name)
+	{
+		if (name.empty())
+		{
+			return LocalizedTable::Count;
+		}
+		const auto table =
+		    LocalizedTableSlots[LocalizedTableHash(name, LocalizedTableHashMultiplier)];
+		if (table != LocalizedTable::Count &&
+		    LocalizedTableNames[static_cast<std::size_t>(table)] == name)
+		{
+			return table;
+		}
+		return LocalizedTable::Count;
+	}
+
+	std::unique_ptr<ILocalizationQuery> CreateLocalizationQuery(std::u16string_view table)
+	{
+		switch (FindLocalizedTable(table))
+		{
+		case LocalizedTable::TextData:
+			return std::make_unique<TextDataQuery>();
+		case LocalizedTable::CharacterSystemText:
+			return std::make_unique<CharacterSystemTextQuery>();
+		case LocalizedTable::RaceJikkyoComment:
+			return std::make_unique<RaceJikkyoCommentQuery>();
+		case LocalizedTable::RaceJikkyoMessage:
+			return std::make_unique<RaceJikkyoMessageQuery>();
+		default:
+			return nullptr;
+		}
+	}
 
-			if (table == "text_data"sv)
+	std::unique_ptr<ILocalizationQuery> ParseLocalizationQuery(std::u16string_view sql)
+	{
+		struct Receiver
+		{
+			std::unique_ptr<ILocalizationQuery> Query;
+
+			bool Table(std::u16string_view table)
 			{
-				query = std::make_unique<TextDataQuery>();
+				Query = CreateLocalizationQuery(table);
+				return Query != nullptr;
 			}
-			else if (table == "character_system_text"sv)
+
+			void Column(std::size_t index, std::u16string_view column)
 			{
-				query = std::make_unique<CharacterSystemTextQuery>();
+				Query->AddColumn(index, column);
 			}
-			else if (table == "race_jikkyo_comment"sv)
+
+			void Param(std::size_t index, std::u16string_view param)
 			{
-				query = std::make_unique<RaceJikkyoCommentQuery>();
+				Query->AddParam(index, param);
 			}
-			else if (table == "race_jikkyo_message"sv)
+		} receiver;
+
+		if (!Sql::ParseSelect(sql, receiver))
+		{
+			return nullptr;
+		}
+
+		return std::move(receiver.Query);
+	}
+
+	// 游戏使用的 SQL 语句基本固定，按文本缓存解析得到的查询原型，之后只需复制原型
+	// 无法解析的语句缓存为空指针，其数量受 MaxQueryPlanCacheSize 限制
+	constexpr std::size_t MaxQueryPlanCacheSize = 4096;
+
+	std::shared_mutex QueryPlanCacheMutex;
+	std::unordered_map<std::u16string, std::unique_ptr<const ILocalizationQuery>,
+	                   TransparentStringHash, std::equal_to<void>>
+	    QueryPlanCache;
+
+	// 缓存中的原型不会被移除，返回的指针始终有效
+	const ILocalizationQuery* FindQueryPlan(std::u16string_view sql)
+	{
+		{
+			std::shared_lock lock(QueryPlanCacheMutex);
+			if (const auto iter = QueryPlanCache.find(
+#if __cpp_lib_generic_unordered_lookup >= 201811L
+			        sql
+#else
+			        std::u16string(sql)
+#endif
+			        );
+			    iter != QueryPlanCache.end())
 			{
-				query = std::make_unique<RaceJikkyoMessageQuery>();
+				return iter->second.get();
 			}
-			else
+		}
+
+		auto plan = ParseLocalizationQuery(sql);
+
+		std::unique_lock lock(QueryPlanCacheMutex);
+		if (!plan && QueryPlanCache.size() >= MaxQueryPlanCacheSize)
+		{
+			return nullptr;
+		}
+		return QueryPlanCache.try_emplace(std::u16string(sql), std::move(plan))
+		    .first->second.get();
+	}
+
+	// 以 Query 对象地址为键的开放寻址表，查询对象直接存放在槽位中
+	// 查找不加锁且至多探测一轮，插入与删除由 m_WriteMutex 串行化
+	// 同一 Query 对象的各个调用总在同一线程上发生，因此删除时无需等待其他线程的读者
+	// 最新的段过满时在其前面加入容量加倍的新段，其他线程可能正在使用旧段中的查询对象，
+	// 因此已有的查询不迁移，各段也不再释放，查找从新到旧依次探测各段
+	class LocalizationQueryTable
+	{
+	public:
+		LocalizationQueryTable() : m_Head(new Segment(InitialCapacity, nullptr))
+		{
+		}
+
+		LocalizationQueryTable(LocalizationQueryTable const&) = delete;
+		LocalizationQueryTable& operator=(LocalizationQueryTable const&) = delete;
+
+		bool Insert(void* key, ILocalizationQuery const& plan)
+		{
+			std::unique_lock lock(m_WriteMutex);
+
+			// 同一地址上的旧 Query 未经 Dispose 即被回收，直接复用其槽位
+			for (auto segment = m_Head.load(std::memory_order_relaxed); segment;
+			     segment = segment->Older)
 			{
-				goto NormalPath;
+				if (const auto slot = segment->FindSlot(key))
+				{
+					slot->Query->~ILocalizationQuery();
+					slot->Query = plan.CloneTo(slot->Storage);
+					return true;
+				}
 			}
 
-			auto columnsPtr = columns.c_str();
-			std::size_t columnIndex{};
-			while (std::regex_search(columnsPtr, matches, columnPattern))
+			auto head = m_Head.load(std::memory_order_relaxed);
+			auto target = head->FindInsertSlot(key);
+			if (!target)
 			{
-				const auto column = matches[1].str();
-				query->AddColumn(columnIndex++, column);
+				if (head->Capacity >= MaxCapacity)
+				{
+					return false;
+				}
+				head = new Segment(head->Capacity * 2, head);
+				m_Head.store(head, std::memory_order_release);
+				Log::Info("UmaPyogin: Too many active localization queries, grew query table to {} "
+				          "slots",
+				          head->Capacity);
+				target = head->FindInsertSlot(key);
+			}
 
-				columnsPtr = matches.suffix().first;
+			if (!target->Key.load(std::memory_order_relaxed))
+			{
+				++head->UsedCount;
 			}
+			target->Query = plan.CloneTo(target->Storage);
+			target->Key.store(key, std::memory_order_release);
+			return true;
+		}
 
-			// 有 WHERE 子句的查询
-			if (whereClause)
+		ILocalizationQuery* Find(void* key) const
+		{
+			for (auto segment = m_Head.load(std::memory_order_acquire); segment;
+			     segment = segment->Older)
 			{
-				auto whereClausePtr = whereClause->c_str();
-				std::size_t paramIndex = 1;
-				while (std::regex_search(whereClausePtr, matches, whereClausePattern))
+				if (const auto slot = segment->FindSlot(key))
 				{
-					const auto param = matches[1].str();
-					query->AddParam(paramIndex++, param);
+					return slot->Query;
+				}
+			}
+			return nullptr;
+		}
+
+		void Erase(void* key)
+		{
+			if (!Find(key))
+			{
+				return;
+			}
 
-					whereClausePtr = matches.suffix().first;
+			std::unique_lock lock(m_WriteMutex);
+			for (auto segment = m_Head.load(std::memory_order_relaxed); segment;
+			     segment = segment->Older)
+			{
+				if (segment->Erase(key))
+				{
+					return;
 				}
 			}
+		}
+
+	private:
+		static constexpr std::size_t InitialCapacity = 1024;
+		static constexpr std::size_t MaxCapacity = InitialCapacity << 4;
+		static_assert((InitialCapacity & (InitialCapacity - 1)) == 0);
+
+		struct Slot
+		{
+			std::atomic<void*> Key{};
+			ILocalizationQuery* Query{};
+			alignas(std::max_align_t) std::byte Storage[LocalizationQueryStorageSize];
+		};
 
-			TextQueries.emplace(self, std::move(query));
+		static void* Tombstone()
+		{
+			static char tombstone;
+			return &tombstone;
+		}
+
+		struct Segment
+		{
+			const std::size_t Capacity;
+			const std::unique_ptr<Slot[]> Slots;
+			Segment* const Older;
+			// 非空槽位（含墓碑）的数量，仅在持有 m_WriteMutex 时访问
+			std::size_t UsedCount{};
+
+			Segment(std::size_t capacity, Segment* older)
+			    : Capacity(capacity), Slots(new Slot[capacity]), Older(older)
+			{
+			}
+
+			std::size_t Hash(void* key) const
+			{
+				// Fibonacci 哈希，取高位
+				const auto value = reinterpret_cast<std::uintptr_t>(key) >> 3;
+				return static_cast<std::size_t>((static_cast<std::uint64_t>(value) *
+				                                 0x9E3779B97F4A7C15ull) >>
+				                                (64 - std::countr_zero(Capacity)));
+			}
+
+			std::size_t Next(std::size_t index) const
+			{
+				return (index + 1) & (Capacity - 1);
+			}
+
+			std::size_t Prev(std::size_t index) const
+			{
+				return (index - 1) & (Capacity - 1);
+			}
+
+			Slot* FindSlot(void* key) const
+			{
+				for (std::size_t i = 0, index = Hash(key); i < Capacity; ++i, index = Next(index))
+				{
+					auto& slot = Slots[index];
+					const auto slotKey = slot.Key.load(std::memory_order_acquire);
+					if (slotKey == key)
+					{
+						return &slot;
+					}
+					if (!slotKey)
+					{
+						break;
+					}
+				}
+				return nullptr;
+			}
+
+			// 返回第一个墓碑或空槽，负载因子将超过 3/4 时返回空指针，须在持有 m_WriteMutex 时调用
+			Slot* FindInsertSlot(void* key)
+			{
+				for (std::size_t i = 0, index = Hash(key); i < Capacity; ++i, index = Next(index))
+				{
+					auto& slot = Slots[index];
+					const auto slotKey = slot.Key.load(std::memory_order_relaxed);
+					if (slotKey == Tombstone())
+					{
+						return &slot;
+					}
+					if (!slotKey)
+					{
+						return (UsedCount + 1) * 4 <= Capacity * 3 ? &slot : nullptr;
+					}
+				}
+				return nullptr;
+			}
+
+			// 须在持有 m_WriteMutex 时调用
+			bool Erase(void* key)
+			{
+				for (std::size_t i = 0, index = Hash(key); i < Capacity; ++i, index = Next(index))
+				{
+					auto& slot = Slots[index];
+					const auto slotKey = slot.Key.load(std::memory_order_relaxed);
+					if (slotKey == key)
+					{
+						slot.Query->~ILocalizationQuery();
+						slot.Query = nullptr;
+						slot.Key.store(Tombstone(), std::memory_order_release);
+						ReclaimTombstones(index);
+						return true;
+					}
+					if (!slotKey)
+					{
+						return false;
+					}
+				}
+				return false;
+			}
+
+			// 若墓碑之后紧跟空槽，则不存在探测路径需要越过该墓碑，可将其恢复为空槽
+			void ReclaimTombstones(std::size_t index)
+			{
+				if (Slots[Next(index)].Key.load(std::memory_order_relaxed))
+				{
+					return;
+				}
+				for (std::size_t i = 0; i < Capacity; ++i, index = Prev(index))
+				{
+					auto& slot = Slots[index];
+					if (slot.Key.load(std::memory_order_relaxed) != Tombstone())
+					{
+						break;
+					}
+					slot.Key.store(nullptr, std::memory_order_release);
+					--UsedCount;
+				}
+			}
+		};
+
+		std::atomic<Segment*> m_Head;
+		std::mutex m_WriteMutex;
+	};
+
+	LocalizationQueryTable TextQueries;
+
+	// 因表名不需要本地化而直接跳过的查询数
+	std::atomic<std::uint64_t> RejectedQueryCount;
+
+	// 以下函数为查询钩子中不依赖 il2cpp 的部分，亦供回放使用，返回是否需要本地化
+	bool BeginLocalizationQuery(void* self, std::u16string_view sql)
+	{
+		if (FindLocalizedTable(Sql::FindTableName(sql)) == LocalizedTable::Count)
+		{
+			RejectedQueryCount.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		if (const auto plan = FindQueryPlan(sql))
+		{
+			if (TextQueries.Insert(self, *plan))
+			{
+				return true;
+			}
+			Log::Warn("UmaPyogin: Localization query table is full, query will not be "
+			          "localized");
+		}
+		return false;
+	}
+
+	bool BindLocalizationQuery(void* self, std::int32_t idx, std::int32_t value)
+	{
+		if (const auto query = TextQueries.Find(self))
+		{
+			query->Bind(idx, value);
+			return true;
+		}
+		return false;
+	}
+
+	bool StepLocalizationQuery(void* self, Hook::QueryGetIntFunction getInt)
+	{
+		if (const auto query = TextQueries.Find(self))
+		{
+			query->Step(self, getInt);
+			return true;
+		}
+		return false;
+	}
+
+	// 录制时记录 Step 中读取的整数列，供回放时代替游戏的 Query.GetInt
+	thread_local std::array<Trace::ColumnValue, Trace::MaxStepColumns> TracedStepColumns;
+	thread_local std::size_t TracedStepColumnCount;
+
+	int TracedQueryGetInt(void* self, int idx)
+	{
+		const auto value = Query_GetInt(self, idx);
+		if (TracedStepColumnCount < TracedStepColumns.size())
+		{
+			TracedStepColumns[TracedStepColumnCount++] = { idx, value };
+		}
+		return value;
+	}
+
+	DEFINE_HOOK(void*, Query_ctor, (void* self, void* conn, Il2CppString* sql))
+	{
+		UMAPYOGIN_PROFILE_HOOK(Query_ctor);
+		const std::u16string_view sqlStr(sql->chars, sql->length);
+		if (Trace::IsActive())
+		{
+			Trace::RecordQuery_ctor(self, sqlStr);
+		}
+
+		if (BeginLocalizationQuery(self, sqlStr))
+		{
+			UMAPYOGIN_PROFILE_HIT();
+		}
+		else
+		{
+			UMAPYOGIN_PROFILE_MISS();
 		}
 
-	NormalPath:
 		return Query_ctor_Orig(self, conn, sql);
 	}
 
 	DEFINE_HOOK(void, PreparedQuery_BindInt, (void* self, std::int32_t idx, std::int32_t value))
 	{
-		if (const auto iter = TextQueries.find(self); iter != TextQueries.end())
+		UMAPYOGIN_PROFILE_HOOK(PreparedQuery_BindInt);
+		if (Trace::IsActive())
+		{
+			Trace::RecordPreparedQuery_BindInt(self, idx, value);
+		}
+
+		if (BindLocalizationQuery(self, idx, value))
+		{
+			UMAPYOGIN_PROFILE_HIT();
+		}
+		else
 		{
-			iter->second->Bind(idx, value);
+			UMAPYOGIN_PROFILE_MISS();
 		}
 
 		PreparedQuery_BindInt_Orig(self, idx, value);
@@ -836,11 +1518,30 @@ namespace
 
 	DEFINE_HOOK(bool, Query_Step, (void* self))
 	{
+		UMAPYOGIN_PROFILE_HOOK(Query_Step);
 		const auto result = Query_Step_Orig(self);
 
-		if (const auto iter = TextQueries.find(self); iter != TextQueries.end())
+		if (Trace::IsActive())
+		{
+			TracedStepColumnCount = 0;
+			if (StepLocalizationQuery(self, TracedQueryGetInt))
+			{
+				UMAPYOGIN_PROFILE_HIT();
+			}
+			else
+			{
+				UMAPYOGIN_PROFILE_MISS();
+			}
+			Trace::RecordQuery_Step(self, result,
+			                        std::span(TracedStepColumns.data(), TracedStepColumnCount));
+		}
+		else if (StepLocalizationQuery(self, Query_GetInt))
 		{
-			iter->second->Step(self);
+			UMAPYOGIN_PROFILE_HIT();
+		}
+		else
+		{
+			UMAPYOGIN_PROFILE_MISS();
 		}
 
 		return result;
@@ -848,10 +1549,21 @@ namespace
 
 	DEFINE_HOOK(Il2CppString*, Query_GetText, (void* self, std::int32_t idx))
 	{
-		if (const auto iter = TextQueries.find(self); iter != TextQueries.end())
+		UMAPYOGIN_PROFILE_HOOK(Query_GetText);
+		if (Trace::IsActive())
+		{
+			Trace::RecordQuery_GetText(self, idx);
+		}
+
+		UMAPYOGIN_PROFILE_MISS();
+		if (const auto query = TextQueries.Find(self))
 		{
-			if (const auto localizedStr = iter->second->GetString(idx))
+			Localization::LoadingStatus::GetInstance().WaitUntilReady(
+			    Localization::Dataset::Database);
+			const Misc::Rcu::ReadGuard guard;
+			if (const auto localizedStr = query->GetString(idx))
 			{
+				UMAPYOGIN_PROFILE_HIT();
 				return ToIl2CppString(*localizedStr);
 			}
 		}
@@ -861,7 +1573,13 @@ namespace
 
 	DEFINE_HOOK(void, Query_Dispose, (void* self))
 	{
-		TextQueries.erase(self);
+		UMAPYOGIN_PROFILE_HOOK(Query_Dispose);
+		if (Trace::IsActive())
+		{
+			Trace::RecordQuery_Dispose(self);
+		}
+
+		TextQueries.Erase(self);
 		Query_Dispose_Orig(self);
 	}
 
@@ -1213,6 +1931,12 @@ namespace
 
 	void LoadResources()
 	{
+		const std::lock_guard lock(LoadResourcesMutex);
+		if (ExtraAssetBundleHandle)
+		{
+			return;
+		}
+
 		Log::Info("UmaPyogin: LoadResources");
 
 		const auto& config = Plugin::GetInstance().GetConfig();
@@ -1224,40 +1948,205 @@ namespace
 		const auto allAssetNames = AssetBundle_GetAllAssetNames(extraAssetBundle);
 		CHECK_NULL(allAssetNames);
 
-		IterateIList(allAssetNames, [](std::size_t, Il2CppObject* name) {
-			ExtraAssetBundleAssetNameSet.emplace(reinterpret_cast<Il2CppString*>(name)->chars);
+		AssetNameIndex assetNames;
+		IterateIList(allAssetNames, [&](std::size_t, Il2CppObject* name) {
+			const auto nameStr = reinterpret_cast<Il2CppString*>(name);
+			assetNames.Add(std::u16string_view(nameStr->chars, nameStr->length));
 		});
+		assetNames.Build();
 
+		// 先设置句柄再发布名称，查到名称的线程总能取得资源包
 		ExtraAssetBundleHandle = il2cpp_gchandle_new(extraAssetBundle, false);
+		Misc::Rcu::Replace(ExtraAssetBundleAssetNames,
+		                   std::make_unique<const AssetNameIndex>(std::move(assetNames)));
+	}
+
+	void LoadLocalization()
+	{
+		const auto startTime = std::chrono::steady_clock::now();
+		const auto& config = Plugin::GetInstance().GetConfig();
+		auto& status = Localization::LoadingStatus::GetInstance();
+
+		// 出错时仍需标记完成，以免查询一直等待
+		const auto runLoader = [&](Localization::Dataset dataset, auto&& loader) {
+			try
+			{
+				loader();
+				status.FinishLoading(dataset, true);
+			}
+			catch (const std::exception& e)
+			{
+				Log::Error("UmaPyogin: Failed to load localization: {}", e.what());
+				status.FinishLoading(dataset, false);
+			}
+		};
+
+		std::shared_ptr<const Localization::LocalizationPack> pack;
+		if (!config.LocalizationPackPath.empty())
+		{
+			pack = Localization::LocalizationPack::Open(config.LocalizationPackPath);
+			if (!pack)
+			{
+				Log::Warn("UmaPyogin: Failed to load localization pack, fallback to json files");
+			}
+		}
+
+		Misc::Parallel::TaskGroup group;
+
+		group.Run([&] {
+			runLoader(Localization::Dataset::Story, [&] {
+				auto& storyLocalization = Localization::StoryLocalization::GetInstance();
+				if (pack)
+				{
+					storyLocalization.LoadFrom(pack);
+					return;
+				}
+
+				const std::filesystem::path storyLocalizationDirPath =
+				    config.StoryLocalizationDirPath;
+				if (std::filesystem::is_directory(storyLocalizationDirPath))
+				{
+					storyLocalization.LoadFrom(storyLocalizationDirPath);
+				}
+			});
+		});
+
+		group.Run([&] {
+			runLoader(Localization::Dataset::Database, [&] {
+				auto& databaseLocalization = Localization::DatabaseLocalization::GetInstance();
+				if (pack)
+				{
+					databaseLocalization.LoadFrom(pack);
+					return;
+				}
+
+				databaseLocalization.LoadFrom(
+				    config.TextDataDictPath, config.CharacterSystemTextDataDictPath,
+				    config.RaceJikkyoCommentDataDictPath, config.RaceJikkyoMessageDataDictPath);
+			});
+		});
+
+		// 原文已由 il2cpp_init 的钩子在游戏线程上取得，此处只需读取文件
+		runLoader(Localization::Dataset::Static, [&] {
+			auto& staticLocalization = Localization::StaticLocalization::GetInstance();
+			if (pack)
+			{
+				staticLocalization.LoadFrom(pack);
+				return;
+			}
+
+			const std::filesystem::path staticLocalizationFilePath =
+			    config.StaticLocalizationFilePath;
+			if (std::filesystem::is_regular_file(staticLocalizationFilePath))
+			{
+				staticLocalization.LoadFrom(staticLocalizationFilePath);
+			}
+		});
+
+		group.Wait();
+
+		Log::Info("UmaPyogin: Localization files loaded in {}ms",
+		          std::chrono::duration_cast<std::chrono::milliseconds>(
+		              std::chrono::steady_clock::now() - startTime)
+		              .count());
+
+		// 翻译包为只读的单个文件，不支持热重载
+		if (config.EnableHotReload && !pack)
+		{
+			Localization::LocalizationWatcher::GetInstance().Start(config);
+		}
 	}
 
+	// 在后台加载翻译文件的线程，进程退出时等待其结束
+	// 加载中用到的单例需在 Start 之前构造，使其析构晚于本对象
+	class LocalizationLoader
+	{
+	public:
+		static LocalizationLoader& GetInstance()
+		{
+			static LocalizationLoader s_Instance;
+			return s_Instance;
+		}
+
+		~LocalizationLoader()
+		{
+			Wait();
+		}
+
+		void Start()
+		{
+			Wait();
+			m_Thread = std::thread(LoadLocalization);
+		}
+
+		void Wait()
+		{
+			if (m_Thread.joinable())
+			{
+				m_Thread.join();
+			}
+		}
+
+		LocalizationLoader(LocalizationLoader const&) = delete;
+		LocalizationLoader& operator=(LocalizationLoader const&) = delete;
+
+	private:
+		LocalizationLoader() = default;
+
+		std::thread m_Thread;
+	};
+
 	DEFINE_HOOK(int, il2cpp_init, (const char* domain_name))
 	{
 		const auto ret = il2cpp_init_Orig(domain_name);
 		InjectFunctions();
 
-		Log::Info("UmaPyogin: Loading localization files");
-
 		const auto& config = Plugin::GetInstance().GetConfig();
 
-		const std::filesystem::path staticLocalizationFilePath = config.StaticLocalizationFilePath;
-		if (std::filesystem::is_regular_file(staticLocalizationFilePath))
+		if (config.StringCacheBudget >= 0)
 		{
-			auto& staticLocalization = Localization::StaticLocalization::GetInstance();
-			staticLocalization.LoadFrom(staticLocalizationFilePath);
+			Il2CppStringCache::GetInstance().SetBudget(
+			    config.StringCacheBudget ? static_cast<std::size_t>(config.StringCacheBudget)
+			                             : Il2CppStringCache::DefaultBudget);
 		}
 
-		const std::filesystem::path storyLocalizationDirPath = config.StoryLocalizationDirPath;
-		if (std::filesystem::is_directory(storyLocalizationDirPath))
+		// StoryCacheBudget 为 0 时使用默认值，负数表示不限制
+		if (config.StoryCacheBudget)
 		{
-			auto& storyLocalization = Localization::StoryLocalization::GetInstance();
-			storyLocalization.LoadFrom(storyLocalizationDirPath);
+			Localization::StoryLocalization::GetInstance().SetCacheBudget(
+			    config.StoryCacheBudget > 0 ? static_cast<std::size_t>(config.StoryCacheBudget)
+			                                : 0);
 		}
 
-		auto& databaseLocalization = Localization::DatabaseLocalization::GetInstance();
-		databaseLocalization.LoadFrom(
-		    config.TextDataDictPath, config.CharacterSystemTextDataDictPath,
-		    config.RaceJikkyoCommentDataDictPath, config.RaceJikkyoMessageDataDictPath);
+		auto& status = Localization::LoadingStatus::GetInstance();
+		status.SetWaitTimeout(std::chrono::milliseconds(config.LocalizationWaitTimeout));
+		// 在返回前标记为加载中，保证查询不会读取到加载中的数据
+		for (std::size_t i = 0; i < static_cast<std::size_t>(Localization::Dataset::Count); ++i)
+		{
+			status.BeginLoading(static_cast<Localization::Dataset>(i));
+		}
+
+		// 取得原文需调用游戏的函数，在当前线程上完成，加载线程仅读取文件
+		if (!config.StaticLocalizationFilePath.empty() || !config.LocalizationPackPath.empty())
+		{
+			Localization::StaticLocalization::GetInstance().CaptureSources();
+		}
+
+		if (config.LoadLocalizationSynchronously)
+		{
+			Log::Info("UmaPyogin: Loading localization files");
+			LoadLocalization();
+		}
+		else
+		{
+			Log::Info("UmaPyogin: Loading localization files in background");
+			Localization::StaticLocalization::GetInstance();
+			Localization::StoryLocalization::GetInstance();
+			Localization::DatabaseLocalization::GetInstance();
+			Localization::LocalizationWatcher::GetInstance();
+			Misc::Parallel::ThreadPool::GetInstance();
+			LocalizationLoader::GetInstance().Start();
+		}
 
 		Log::Info("UmaPyogin: Initialized");
 		return ret;
@@ -1271,13 +2160,88 @@ namespace UmaPyogin::Hook
 		return LocalizeJP_Get_Orig(id);
 	}
 
+	std::uint64_t GetRejectedQueryCount()
+	{
+		return RejectedQueryCount.load(std::memory_order_relaxed);
+	}
+
+	bool ReplayLocalizeJP_Get(std::int32_t id)
+	{
+		Localization::LoadingStatus::GetInstance().WaitUntilReady(Localization::Dataset::Static);
+		const Misc::Rcu::ReadGuard guard;
+		return Localization::StaticLocalization::GetInstance().Localize(id).has_value();
+	}
+
+	bool ReplayAssetBundle_LoadAsset(std::u16string_view name, std::string_view className)
+	{
+		// 与 LocalizeStoryTimelineData 不同，剧情 id 取自资源名末尾的数字而非资源中的字段
+		if (className == "StoryTimelineData"sv)
+		{
+			const auto digits = name.substr(name.find_last_of(u'_') + 1);
+			std::size_t storyId{};
+			for (const auto c : digits)
+			{
+				if (c < u'0' || c > u'9')
+				{
+					break;
+				}
+				storyId = storyId * 10 + (c - u'0');
+			}
+			return Localization::StoryLocalization::GetInstance().GetStoryTextData(storyId) !=
+			       nullptr;
+		}
+		if (className == "StoryRaceTextAsset"sv)
+		{
+			const std::u16string nameStr(name);
+			return Localization::StoryLocalization::GetInstance().GetRaceTextData(
+			           ParseRaceId(nameStr.c_str())) != nullptr;
+		}
+		return false;
+	}
+
+	bool ReplayQuery_ctor(void* query, std::u16string_view sql)
+	{
+		return BeginLocalizationQuery(query, sql);
+	}
+
+	bool ReplayPreparedQuery_BindInt(void* query, std::int32_t idx, std::int32_t value)
+	{
+		return BindLocalizationQuery(query, idx, value);
+	}
+
+	bool ReplayQuery_Step(void* query, QueryGetIntFunction getInt)
+	{
+		return StepLocalizationQuery(query, getInt);
+	}
+
+	bool ReplayQuery_GetText(void* query, std::int32_t idx)
+	{
+		if (const auto localizationQuery = TextQueries.Find(query))
+		{
+			Localization::LoadingStatus::GetInstance().WaitUntilReady(
+			    Localization::Dataset::Database);
+			const Misc::Rcu::ReadGuard guard;
+			return localizationQuery->GetString(idx).has_value();
+		}
+		return false;
+	}
+
+	void ReplayQuery_Dispose(void* query)
+	{
+		TextQueries.Erase(query);
+	}
+
 	void Install()
 	{
 		const auto hookInstaller = Plugin::GetInstance().GetHookInstaller();
 
 		Log::Info("UmaPyogin: Installing hook");
 
-		LoadIl2CppSymbols();
+		if (!LoadIl2CppSymbols())
+		{
+			Log::Error("UmaPyogin: Missing il2cpp symbols, hook will not be installed");
+			return;
+		}
 
 		HOOK_FUNC(il2cpp_init,
 		          Plugin::GetInstance().GetHookInstaller()->LookupSymbol("il2cpp_init"));
@@ -1,6 +1,9 @@
 #ifndef UMAPYOGIN_HOOK_H
 #define UMAPYOGIN_HOOK_H
 
+#include <cstdint>
+#include <string_view>
+
 #include "Il2Cpp.h"
 #include "Misc.h"
 
@@ -9,6 +12,22 @@ namespace UmaPyogin::Hook
 	void Install();
 
 	Il2CppString* LocalizeJP_Get(std::int32_t id);
+
+	// 表名预筛选直接放行的查询数
+	std::uint64_t GetRejectedQueryCount();
+
+	using QueryGetIntFunction = int (*)(void* query, int idx);
+
+	// 以下函数供 UmaPyoginTraceReplay 在游戏之外执行钩子中查找译文的部分，返回是否找到或需要本地化
+	// query 仅用于区分不同的查询，不会被解引用
+	bool ReplayLocalizeJP_Get(std::int32_t id);
+	bool ReplayAssetBundle_LoadAsset(std::u16string_view name, std::string_view className);
+	bool ReplayQuery_ctor(void* query, std::u16string_view sql);
+	bool ReplayPreparedQuery_BindInt(void* query, std::int32_t idx, std::int32_t value);
+	// getInt 代替游戏的 Query.GetInt，提供 Step 时读取的整数列
+	bool ReplayQuery_Step(void* query, QueryGetIntFunction getInt);
+	bool ReplayQuery_GetText(void* query, std::int32_t idx);
+	void ReplayQuery_Dispose(void* query);
 } // namespace UmaPyogin::Hook
 
 #endif
@@ -0,0 +1,105 @@
+#include "IdIndex.h"
+
+#include <bit>
+#include <cassert>
+
+namespace UmaPyogin::Localization
+{
+	void IdIndex::Build(std::span<const std::uint64_t> ids)
+	{
+		Clear();
+		if (ids.empty())
+		{
+			return;
+		}
+
+		m_BaseId = ids.front() & ~(PageSize - 1);
+		const auto pageCount = ((ids.back() - m_BaseId) >> PageBits) + 1;
+		m_PageBlocks.assign((pageCount + 63) / 64, Block{});
+
+		std::uint64_t currentPage = UINT64_MAX;
+		for (std::size_t i = 0; i < ids.size(); ++i)
+		{
+			assert(i == 0 || ids[i - 1] < ids[i]);
+
+			const auto relativeId = ids[i] - m_BaseId;
+			const auto page = relativeId >> PageBits;
+			if (page != currentPage)
+			{
+				currentPage = page;
+				m_PageBlocks[page / 64].Bits |= std::uint64_t(1) << (page % 64);
+				m_IdBlocks.resize(m_IdBlocks.size() + BlocksPerPage, Block{});
+			}
+
+			const auto offset = relativeId & (PageSize - 1);
+			m_IdBlocks[m_IdBlocks.size() - BlocksPerPage + offset / 64].Bits |=
+			    std::uint64_t(1) << (offset % 64);
+		}
+
+		std::uint32_t rank = 0;
+		for (auto& block : m_PageBlocks)
+		{
+			block.Rank = rank;
+			rank += std::popcount(block.Bits);
+		}
+		rank = 0;
+		for (auto& block : m_IdBlocks)
+		{
+			block.Rank = rank;
+			rank += std::popcount(block.Bits);
+		}
+
+		m_IdBlocks.shrink_to_fit();
+		m_Size = ids.size();
+	}
+
+	void IdIndex::Clear()
+	{
+		m_BaseId = 0;
+		m_PageBlocks.clear();
+		m_IdBlocks.clear();
+		m_Size = 0;
+	}
+
+	std::optional<std::size_t> IdIndex::Find(std::uint64_t id) const
+	{
+		if (id < m_BaseId)
+		{
+			return std::nullopt;
+		}
+
+		const auto relativeId = id - m_BaseId;
+		const auto page = relativeId >> PageBits;
+		if (page / 64 >= m_PageBlocks.size())
+		{
+			return std::nullopt;
+		}
+
+		const auto& pageBlock = m_PageBlocks[page / 64];
+		const auto pageBit = std::uint64_t(1) << (page % 64);
+		if (!(pageBlock.Bits & pageBit))
+		{
+			return std::nullopt;
+		}
+		const auto pageIndex = pageBlock.Rank + std::popcount(pageBlock.Bits & (pageBit - 1));
+
+		const auto offset = relativeId & (PageSize - 1);
+		const auto& idBlock = m_IdBlocks[pageIndex * BlocksPerPage + offset / 64];
+		const auto idBit = std::uint64_t(1) << (offset % 64);
+		if (!(idBlock.Bits & idBit))
+		{
+			return std::nullopt;
+		}
+		return idBlock.Rank + std::popcount(idBlock.Bits & (idBit - 1));
+	}
+
+	std::size_t IdIndex::GetSize() const
+	{
+		return m_Size;
+	}
+
+	std::size_t IdIndex::GetMemoryUsage() const
+	{
+		return (m_PageBlocks.capacity() + m_IdBlocks.capacity()) * sizeof(Block);
+	}
+} // namespace UmaPyogin::Localization
@@ -0,0 +1,49 @@
+#ifndef UMAPYOGIN_ID_INDEX_H
+#define UMAPYOGIN_ID_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace UmaPyogin::Localization
+{
+	// 将整数 id 映射为稠密下标的只读索引，适用于成簇分布的剧情 id
+	// 两级位图：第一级每位对应一页连续的 id，第二级每位对应一个 id
+	// 每 64 位附带之前置位的累计数量，查找只需读取两个块并计算 popcount
+	class IdIndex
+	{
+	public:
+		// ids 须严格递增，第 i 个 id 的下标为 i
+		void Build(std::span<const std::uint64_t> ids);
+		void Clear();
+
+		std::optional<std::size_t> Find(std::uint64_t id) const;
+
+		std::size_t GetSize() const;
+		// 索引本身占用的内存（字节）
+		std::size_t GetMemoryUsage() const;
+
+	private:
+		struct Block
+		{
+			std::uint64_t Bits;
+			// 此块之前置位的总数
+			std::uint32_t Rank;
+		};
+
+		static constexpr unsigned PageBits = 10;
+		static constexpr std::uint64_t PageSize = std::uint64_t(1) << PageBits;
+		static constexpr std::size_t BlocksPerPage = PageSize / 64;
+
+		// 第一页的起始 id，按页对齐
+		std::uint64_t m_BaseId{};
+		std::vector<Block> m_PageBlocks;
+		// 各页的第二级位图依次相连，每页 BlocksPerPage 个块
+		std::vector<Block> m_IdBlocks;
+		std::size_t m_Size{};
+	};
+} // namespace UmaPyogin::Localization
+
+#endif
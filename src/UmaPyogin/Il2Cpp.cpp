@@ -7,23 +7,36 @@ namespace UmaPyogin::Il2CppSymbols
 #define DEFINE_FUNCTION_POINTERS(returnType, name, params) returnType(*name) params;
 
 	LOAD_FUNCTIONS(DEFINE_FUNCTION_POINTERS)
+	LOAD_OPTIONAL_FUNCTIONS(DEFINE_FUNCTION_POINTERS)
 
 #undef DEFINE_FUNCTION_POINTERS
 
-	void LoadIl2CppSymbols()
+	bool LoadIl2CppSymbols()
 	{
 		const auto hookInstaller = Plugin::GetInstance().GetHookInstaller();
 
 #define LOAD_SYM(returnType, name, params)                                                         \
 	if (name = reinterpret_cast<decltype(name)>(hookInstaller->LookupSymbol(#name)); !name)        \
 	{                                                                                              \
-		Log::Info("UmaPyogin: Failed to load symbol: " #name);                                     \
-		return;                                                                                    \
+		Log::Error("UmaPyogin: Failed to load symbol: " #name);                                    \
+		return false;                                                                              \
 	}
 
 		LOAD_FUNCTIONS(LOAD_SYM)
 
 #undef LOAD_SYM
+
+#define LOAD_OPTIONAL_SYM(returnType, name, params)                                                \
+	if (name = reinterpret_cast<decltype(name)>(hookInstaller->LookupSymbol(#name)); !name)        \
+	{                                                                                              \
+		Log::Info("UmaPyogin: Optional symbol " #name " is not available");                       \
+	}
+
+		LOAD_OPTIONAL_FUNCTIONS(LOAD_OPTIONAL_SYM)
+
+#undef LOAD_OPTIONAL_SYM
+
+		return true;
 	}
 
 } // namespace UmaPyogin::Il2CppSymbols
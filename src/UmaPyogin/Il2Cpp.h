@@ -60,6 +60,14 @@ namespace UmaPyogin
 		void* monitor;
 	};
 
+	struct Il2CppArray
+	{
+		Il2CppObject obj;
+		void* bounds;
+		uintptr_t max_length;
+		// 元素紧随其后
+	};
+
 	using Il2CppChar = char16_t;
 
 	struct Il2CppString
@@ -153,17 +161,25 @@ namespace UmaPyogin
 	X(void, il2cpp_gchandle_free, (uint32_t gchandle))                                             \
 	X(Il2CppObject*, il2cpp_type_get_object, (const Il2CppType* type))                             \
 	X(bool, il2cpp_class_is_assignable_from, (Il2CppClass * klass, Il2CppClass * oklass))          \
-	X(const char*, il2cpp_class_get_name, (Il2CppClass * klass))
+	X(const char*, il2cpp_class_get_name, (Il2CppClass * klass))                                   \
+	X(int, il2cpp_array_element_size, (const Il2CppClass* array_class))
+
+// 部分版本的运行时未导出，加载失败时为 nullptr，接受 X(returnType, name, params)
+#define LOAD_OPTIONAL_FUNCTIONS(X)                                                                 \
+	X(void, il2cpp_gc_wbarrier_set_field,                                                          \
+	  (Il2CppObject * obj, void** targetAddress, void* object))
 
 	namespace Il2CppSymbols
 	{
 #define DECLARE_FUNCTION_POINTERS(returnType, name, params) extern returnType(*name) params;
 
 		LOAD_FUNCTIONS(DECLARE_FUNCTION_POINTERS)
+		LOAD_OPTIONAL_FUNCTIONS(DECLARE_FUNCTION_POINTERS)
 
 #undef DECLARE_FUNCTION_POINTERS
 
-		void LoadIl2CppSymbols();
+		// 通过 HookInstaller::LookupSymbol 取得全部函数，缺少必需的函数时返回 false
+		bool LoadIl2CppSymbols();
 	} // namespace Il2CppSymbols
 } // namespace UmaPyogin
 
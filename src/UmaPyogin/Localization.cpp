@@ -1,10 +1,16 @@
 #include "Localization.h"
 #include "Hook.h"
+#include "LocalizationPack.h"
 #include "Log.h"
 #include "Misc.h"
 
+#include <algorithm>
+#include <cassert>
 #include <charconv>
+#include <chrono>
+#include <cstring>
 #include <fstream>
+#include <utility>
 
 #include <simdjson.h>
 
@@ -18,531 +24,1602 @@ namespace UmaPyogin::Localization
 {
 	namespace
 	{
-		std::optional<std::vector<char>> ReadFileWithPadding(std::filesystem::path const& path)
+		// 超过此大小的缓冲区与解析器用完后直接释放，不在线程中保留
+		constexpr std::size_t MaxPooledCapacity = 256 * 1024;
+
+		// 读取缓冲区的分配次数与解析器内部缓冲区的扩充次数
+		std::atomic<std::size_t> ReadBufferAllocationCount;
+		std::atomic<std::size_t> ParserAllocationCount;
+
+		// 提供带有 simdjson 所需填充的文件内容
+		// 文件以只读方式映射，最后一页中超出文件的部分足够作为填充时直接使用映射，
+		// 否则复制到缓冲区，缓冲区在当前线程中复用
+		class JsonSource
+		{
+		public:
+			explicit JsonSource(std::filesystem::path const& path) : m_File(path)
+			{
+				if (!m_File.IsOpen())
+				{
+					Log::Error("UmaPyogin: Failed to open localization file {}", PATH_STR(path));
+					return;
+				}
+				m_File.AdviseSequential();
+
+				if (m_File.TailSize() >= simdjson::SIMDJSON_PADDING)
+				{
+					m_Data = reinterpret_cast<const char*>(m_File.Data());
+					return;
+				}
+
+				const auto capacity = m_File.Size() + simdjson::SIMDJSON_PADDING;
+				if (t_SpareCapacity >= capacity)
+				{
+					m_Buffer = std::move(t_SpareBuffer);
+					m_BufferCapacity = std::exchange(t_SpareCapacity, 0);
+				}
+				else
+				{
+					m_Buffer.reset(new char[capacity]);
+					m_BufferCapacity = capacity;
+					ReadBufferAllocationCount.fetch_add(1, std::memory_order_relaxed);
+				}
+				std::memcpy(m_Buffer.get(), m_File.Data(), m_File.Size());
+				m_Data = m_Buffer.get();
+				// 内容已复制，不再需要映射
+				m_Size = m_File.Size();
+				m_File = {};
+			}
+
+			~JsonSource()
+			{
+				if (m_Buffer && m_BufferCapacity > t_SpareCapacity &&
+				    m_BufferCapacity <= MaxPooledCapacity)
+				{
+					t_SpareBuffer = std::move(m_Buffer);
+					t_SpareCapacity = m_BufferCapacity;
+				}
+			}
+
+			JsonSource(JsonSource const&) = delete;
+			JsonSource& operator=(JsonSource const&) = delete;
+
+			explicit operator bool() const
+			{
+				return m_Data != nullptr;
+			}
+
+			const char* Data() const
+			{
+				return m_Data;
+			}
+
+			std::size_t Size() const
+			{
+				return m_Buffer ? m_Size : m_File.Size();
+			}
+
+			// 包括填充在内可读取的字节数
+			std::size_t Capacity() const
+			{
+				return m_Buffer ? m_BufferCapacity : m_File.Size() + m_File.TailSize();
+			}
+
+		private:
+			// 同一线程中同时存在多个需要复制的 JsonSource 时，只有一个能复用缓冲区
+			static thread_local std::unique_ptr<char[]> t_SpareBuffer;
+			static thread_local std::size_t t_SpareCapacity;
+
+			Misc::MappedFile m_File;
+			const char* m_Data{};
+			std::unique_ptr<char[]> m_Buffer;
+			std::size_t m_BufferCapacity{};
+			std::size_t m_Size{};
+		};
+
+		thread_local std::unique_ptr<char[]> JsonSource::t_SpareBuffer;
+		thread_local std::size_t JsonSource::t_SpareCapacity;
+
+		// 在当前线程中复用的 simdjson 解析器
+		// 解析器按文档大小扩充内部缓冲区且不会收缩，容量超过 MaxPooledCapacity 的解析器用完后释放
+		// 解析结果引用解析器内的缓冲区，使用期间可能执行其他任务，故以借出的方式使用，
+		// 同一线程中同时借出多个时另行创建
+		template <typename Parser>
+		class PooledParser
+		{
+		public:
+			PooledParser() : m_Parser(std::move(t_Spare))
+			{
+				if (!m_Parser)
+				{
+					m_Parser = std::make_unique<Parser>();
+				}
+				m_Capacity = m_Parser->capacity();
+			}
+
+			~PooledParser()
+			{
+				const auto capacity = m_Parser->capacity();
+				if (capacity != m_Capacity)
+				{
+					ParserAllocationCount.fetch_add(1, std::memory_order_relaxed);
+				}
+				if (!t_Spare && capacity <= MaxPooledCapacity)
+				{
+					t_Spare = std::move(m_Parser);
+				}
+			}
+
+			PooledParser(PooledParser const&) = delete;
+			PooledParser& operator=(PooledParser const&) = delete;
+
+			Parser& operator*() const
+			{
+				return *m_Parser;
+			}
+
+			Parser* operator->() const
+			{
+				return m_Parser.get();
+			}
+
+		private:
+			static thread_local std::unique_ptr<Parser> t_Spare;
+
+			std::unique_ptr<Parser> m_Parser;
+			std::size_t m_Capacity;
+		};
+
+		template <typename Parser>
+		thread_local std::unique_ptr<Parser> PooledParser<Parser>::t_Spare;
+
+		// 统计一段时间内的堆分配次数，并发进行的其他加载也会计入
+		class AllocationCounter
+		{
+		public:
+			AllocationCounter()
+			    : m_ReadBuffers(ReadBufferAllocationCount.load(std::memory_order_relaxed)),
+			      m_Parsers(ParserAllocationCount.load(std::memory_order_relaxed))
+			{
+			}
+
+			std::size_t GetReadBufferAllocations() const
+			{
+				return ReadBufferAllocationCount.load(std::memory_order_relaxed) - m_ReadBuffers;
+			}
+
+			std::size_t GetParserAllocations() const
+			{
+				return ParserAllocationCount.load(std::memory_order_relaxed) - m_Parsers;
+			}
+
+		private:
+			std::size_t m_ReadBuffers;
+			std::size_t m_Parsers;
+		};
+
+		// 解析一个文件时先将文本依次写入线程中复用的缓冲区，完成后复制为长度恰好的一块内存，
+		// 每个文件的全部文本只需一次分配
+		class StringArena
+		{
+		public:
+			// capacity 为全部文本 UTF-8 字节数的上界，可取文件大小
+			explicit StringArena(std::size_t capacity)
+			{
+				if (t_Buffer.size() < capacity)
+				{
+					t_Buffer.resize(capacity);
+				}
+			}
+
+			~StringArena()
+			{
+				if (t_Buffer.size() * sizeof(char16_t) > MaxPooledCapacity)
+				{
+					t_Buffer = {};
+				}
+			}
+
+			StringArena(StringArena const&) = delete;
+			StringArena& operator=(StringArena const&) = delete;
+
+			// simdjson 已验证文档为合法的 UTF-8，转换不会失败
+			std::u16string_view Store(std::string_view str)
+			{
+				const auto begin = t_Buffer.data() + m_Used;
+				const auto result = Misc::ToUTF16(str, begin);
+				m_Used += result.Length;
+				return { begin, result.Length };
+			}
+
+			std::vector<char16_t> Finish() const
+			{
+				return std::vector<char16_t>(t_Buffer.data(), t_Buffer.data() + m_Used);
+			}
+
+			// 将引用缓冲区的视图改为引用 Finish 返回的 storage 中的相同位置
+			void Rebase(std::u16string_view& view, std::vector<char16_t> const& storage) const
+			{
+				view = { storage.data() + (view.data() - t_Buffer.data()), view.size() };
+			}
+
+		private:
+			// 同一线程中不会嵌套解析，无需借出
+			static thread_local std::vector<char16_t> t_Buffer;
+
+			std::size_t m_Used{};
+		};
+
+		thread_local std::vector<char16_t> StringArena::t_Buffer;
+	} // namespace
+
+	LoadingStatus& LoadingStatus::GetInstance()
+	{
+		static LoadingStatus s_Instance;
+		return s_Instance;
+	}
+
+	void LoadingStatus::SetWaitTimeout(std::chrono::milliseconds timeout)
+	{
+		m_WaitTimeout.store(timeout.count(), std::memory_order_relaxed);
+	}
+
+	void LoadingStatus::BeginLoading(Dataset dataset)
+	{
+		m_States[static_cast<std::size_t>(dataset)].store(LoadState::Loading,
+		                                                  std::memory_order_release);
+	}
+
+	void LoadingStatus::FinishLoading(Dataset dataset, bool succeeded)
+	{
+		{
+			// 持有锁以免等待方错过通知
+			std::unique_lock lock(m_Mutex);
+			m_States[static_cast<std::size_t>(dataset)].store(
+			    succeeded ? LoadState::Ready : LoadState::Failed, std::memory_order_release);
+		}
+		m_Condition.notify_all();
+	}
+
+	LoadState LoadingStatus::GetState(Dataset dataset) const
+	{
+		return m_States[static_cast<std::size_t>(dataset)].load(std::memory_order_acquire);
+	}
+
+	float LoadingStatus::GetProgress() const
+	{
+		std::size_t scheduled{};
+		std::size_t finished{};
+		for (const auto& state : m_States)
+		{
+			switch (state.load(std::memory_order_acquire))
+			{
+			case LoadState::Idle:
+				break;
+			case LoadState::Loading:
+				++scheduled;
+				break;
+			default:
+				++scheduled;
+				++finished;
+				break;
+			}
+		}
+		return scheduled ? static_cast<float>(finished) / scheduled : 1.0f;
+	}
+
+	bool LoadingStatus::IsReady(Dataset dataset) const
+	{
+		return GetState(dataset) != LoadState::Loading;
+	}
+
+	bool LoadingStatus::WaitUntilReady(Dataset dataset) const
+	{
+		auto& state = m_States[static_cast<std::size_t>(dataset)];
+		if (state.load(std::memory_order_acquire) != LoadState::Loading)
+		{
+			return true;
+		}
+
+		const std::chrono::milliseconds timeout(m_WaitTimeout.load(std::memory_order_relaxed));
+		if (timeout.count() <= 0)
+		{
+			return false;
+		}
+
+		std::unique_lock lock(m_Mutex);
+		return m_Condition.wait_for(lock, timeout, [&] {
+			return state.load(std::memory_order_acquire) != LoadState::Loading;
+		});
+	}
+
+	LoadAllocationStatistics GetLoadAllocationStatistics()
+	{
+		return { ReadBufferAllocationCount.load(std::memory_order_relaxed),
+			     ParserAllocationCount.load(std::memory_order_relaxed) };
+	}
+
+	StaticLocalization& StaticLocalization::GetInstance()
+	{
+		static StaticLocalization s_Instance;
+		return s_Instance;
+	}
+
+	StaticLocalization::~StaticLocalization()
+	{
+		delete m_Snapshot.load(std::memory_order_relaxed);
+	}
+
+	void StaticLocalization::CaptureSources()
+	{
+		m_Sources = SnapshotStaticSources();
+	}
+
+	void StaticLocalization::LoadFrom(std::filesystem::path const& path)
+	{
+		m_Path = path;
+		if (auto snapshot = BuildSnapshot(path))
+		{
+			Misc::Rcu::Replace(m_Snapshot, std::move(snapshot));
+		}
+	}
+
+	void StaticLocalization::LoadFrom(std::shared_ptr<const LocalizationPack> pack)
+	{
+		m_Path.clear();
+
+		auto snapshot = std::make_unique<Snapshot>();
+		snapshot->Pack = std::move(pack);
+		snapshot->LocalizedStrings.assign(m_Sources.size(), std::nullopt);
+
+		Misc::Parallel::ForEachIndex(m_Sources.size(), [&](std::size_t i) {
+			if (!m_Sources[i].empty())
+			{
+				snapshot->LocalizedStrings[i] = snapshot->Pack->FindStatic(m_Sources[i]);
+			}
+		});
+
+		Misc::Rcu::Replace(m_Snapshot, std::unique_ptr<const Snapshot>(std::move(snapshot)));
+	}
+
+	void StaticLocalization::Reload()
+	{
+		if (m_Path.empty())
+		{
+			return;
+		}
+
+		if (auto snapshot = BuildSnapshot(m_Path))
+		{
+			Misc::Rcu::Replace(m_Snapshot, std::move(snapshot));
+		}
+	}
+
+	std::unique_ptr<const StaticLocalization::Snapshot>
+	StaticLocalization::BuildSnapshot(std::filesystem::path const& path) const
+	{
+		const JsonSource source(path);
+		if (!source)
+		{
+			return nullptr;
+		}
+
+		const PooledParser<simdjson::dom::parser> parser;
+		simdjson::dom::object dictionary;
+		if (const auto error = parser->parse(source.Data(), source.Size(), false).get(dictionary))
+		{
+			Log::Error("UmaPyogin: Failed to parse localization file {}(error: {})", PATH_STR(path),
+			           simdjson::error_message(error));
+			return nullptr;
+		}
+
+		// dom::object 按键查找需要线性扫描，先建立散列表；键与值均引用 parser 内的字符串
+		std::unordered_map<std::string_view, std::string_view> textMap;
+		textMap.reserve(dictionary.size());
+		for (const auto& [source, text] : dictionary)
+		{
+			std::string_view textValue;
+			if (!text.get(textValue))
+			{
+				textMap.emplace(source, textValue);
+			}
+		}
+
+		auto snapshot = std::make_unique<Snapshot>();
+		snapshot->Storage.assign(m_Sources.size(), {});
+		snapshot->LocalizedStrings.assign(m_Sources.size(), std::nullopt);
+
+		// 每个 id 只写入各自的元素，无需同步
+		Misc::Parallel::ForEachIndex(m_Sources.size(), [&](std::size_t i) {
+			if (m_Sources[i].empty())
+			{
+				return;
+			}
+
+			thread_local std::string sourceString;
+			if (!Misc::ToUTF8(m_Sources[i], sourceString))
+			{
+				return;
+			}
+
+			if (const auto iter = textMap.find(sourceString); iter != textMap.end())
+			{
+				snapshot->Storage[i] = Misc::ToUTF16(iter->second);
+				snapshot->LocalizedStrings[i] = snapshot->Storage[i];
+			}
+		});
+
+		return snapshot;
+	}
+
+	std::vector<std::u16string> StaticLocalization::SnapshotStaticSources()
+	{
+		// 游戏的文本 id 中间可能存在空缺，仅在连续多个 id 均无原文时才视为结束
+		constexpr std::size_t MaxMissingIdRun = 1024;
+
+		std::vector<std::u16string> sources;
+		std::size_t missingIdRun = 0;
+		for (std::int32_t id = 0; missingIdRun < MaxMissingIdRun; ++id)
+		{
+			const auto source = Hook::LocalizeJP_Get(id);
+			if (!source || !source->length)
+			{
+				++missingIdRun;
+				sources.emplace_back();
+				continue;
+			}
+
+			missingIdRun = 0;
+			sources.emplace_back(source->chars, source->length);
+		}
+
+		sources.resize(sources.size() - MaxMissingIdRun);
+		return sources;
+	}
+
+	std::optional<std::u16string_view> StaticLocalization::Localize(std::int32_t id) const
+	{
+		if (!LoadingStatus::GetInstance().IsReady(Dataset::Static))
+		{
+			return std::nullopt;
+		}
+
+		const auto snapshot = m_Snapshot.load(std::memory_order_acquire);
+		if (snapshot && id >= 0 && static_cast<std::size_t>(id) < snapshot->LocalizedStrings.size())
+		{
+			return snapshot->LocalizedStrings[id];
+		}
+		return std::nullopt;
+	}
+
+#define CHECK_ERROR(expr)                                                                          \
+	if (const auto err = expr.error(); err != simdjson::SUCCESS)                                   \
+	{                                                                                              \
+		Log::Error("UmaPyogin: Malformed localization file {}, error {} while get " #expr,         \
+		           PATH_STR(path), simdjson::error_message(err));                                  \
+		return nullptr;                                                                            \
+	}
+
+	StoryLocalization& StoryLocalization::GetInstance()
+	{
+		static StoryLocalization s_Instance;
+		return s_Instance;
+	}
+
+	namespace
+	{
+#ifdef _WIN32
+#define PATH_LITERAL(x) L##x
+#else
+#define PATH_LITERAL(x) x
+#endif
+		constexpr const std::filesystem::path::value_type StoryTimelinePrefix[] =
+		    PATH_LITERAL("storytimeline_");
+		constexpr const std::filesystem::path::value_type StoryRacePrefix[] =
+		    PATH_LITERAL("storyrace_");
+#undef PATH_LITERAL
+
+		enum class StoryEntryKind : std::uint64_t
+		{
+			Timeline,
+			Race,
+		};
+
+		constexpr std::uint64_t MakeCacheKey(StoryEntryKind kind, std::size_t id)
+		{
+			return (static_cast<std::uint64_t>(kind) << 63) | id;
+		}
+
+		// 剧情 id 不超过 32 位，以限制 IdIndex 第一级位图的大小
+		std::optional<std::size_t> ParseId(std::string_view str)
+		{
+			std::uint32_t value;
+			if (const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+			    ec != std::errc{} || ptr != str.data() + str.size())
+			{
+				return std::nullopt;
+			}
+			return value;
+		}
+
+		// index.bin 格式：文件头，剧情条目，比赛条目，最后为 UTF-8 编码的相对路径
+		constexpr char StoryIndexMagic[4] = { 'U', 'P', 'S', 'I' };
+		constexpr std::uint32_t StoryIndexVersion = 1;
+
+		struct StoryIndexHeader
+		{
+			char Magic[4];
+			std::uint32_t Version;
+			std::uint32_t TimelineCount;
+			std::uint32_t RaceCount;
+		};
+
+		struct StoryIndexEntry
+		{
+			std::uint64_t Id;
+			std::uint32_t PathOffset;
+			std::uint32_t PathLength;
+		};
+
+		std::optional<std::pair<StoryEntryKind, std::size_t>>
+		ParseStoryFileName(std::filesystem::path const& path)
+		{
+			if (path.extension() != ".json")
+			{
+				return std::nullopt;
+			}
+
+			const auto fileStem = path.stem();
+			if (fileStem.native().starts_with(StoryTimelinePrefix))
+			{
+				if (const auto id =
+				        ParseId(fileStem.string().substr(std::size(StoryTimelinePrefix) - 1)))
+				{
+					return std::pair(StoryEntryKind::Timeline, *id);
+				}
+			}
+			else if (fileStem.native().starts_with(StoryRacePrefix))
+			{
+				if (const auto id =
+				        ParseId(fileStem.string().substr(std::size(StoryRacePrefix) - 1)))
+				{
+					return std::pair(StoryEntryKind::Race, *id);
+				}
+			}
+			return std::nullopt;
+		}
+
+		// 估算译文占用的内存，用于缓存淘汰
+		std::size_t EstimateSize(StoryLocalization::StoryTextData const& data)
+		{
+			return sizeof(data) + data.Storage.capacity() * sizeof(char16_t) +
+			       data.TextBlockList.capacity() * sizeof(data.TextBlockList[0]) +
+			       data.StringList.capacity() * sizeof(std::u16string_view);
+		}
+
+		std::size_t EstimateSize(StoryLocalization::RaceTextData const& data)
+		{
+			return sizeof(data) + data.Storage.capacity() * sizeof(char16_t) +
+			       data.textData.capacity() * sizeof(std::u16string_view);
+		}
+
+		// 每次领取的文件数，减少争用同一计数器的次数
+		constexpr std::size_t LoadChunkSize = 32;
+
+		// 按块并行解析全部文件，每块的结果先存入各自的 vector，最后按块计算位置并行移入结果，
+		// 全程无需加锁，结果保持 paths 的顺序，解析失败的文件不出现在结果中
+		template <typename Data, typename Loader>
+		std::vector<std::pair<std::size_t, std::shared_ptr<const Data>>>
+		LoadAll(std::vector<std::pair<std::size_t, std::filesystem::path>> const& paths,
+		        Loader&& loader)
+		{
+			using Result = std::vector<std::pair<std::size_t, std::shared_ptr<const Data>>>;
+
+			const auto chunkCount = (paths.size() + LoadChunkSize - 1) / LoadChunkSize;
+			std::vector<Result> chunks(chunkCount);
+			Misc::Parallel::ForEachIndex(chunkCount, [&](std::size_t chunk) {
+				const auto begin = chunk * LoadChunkSize;
+				const auto end = std::min(begin + LoadChunkSize, paths.size());
+				Result local;
+				local.reserve(end - begin);
+				for (auto i = begin; i < end; ++i)
+				{
+					if (auto data = loader(paths[i].second))
+					{
+						local.emplace_back(paths[i].first, std::move(data));
+					}
+				}
+				chunks[chunk] = std::move(local);
+			});
+
+			std::vector<std::size_t> offsets(chunkCount + 1);
+			for (std::size_t i = 0; i < chunkCount; ++i)
+			{
+				offsets[i + 1] = offsets[i] + chunks[i].size();
+			}
+
+			Result result(offsets.back());
+			Misc::Parallel::ForEachIndex(chunkCount, [&](std::size_t chunk) {
+				std::move(chunks[chunk].begin(), chunks[chunk].end(),
+				          result.begin() + offsets[chunk]);
+			});
+			return result;
+		}
+	} // namespace
+
+	StoryLocalization::~StoryLocalization()
+	{
+		delete m_Index.load(std::memory_order_relaxed);
+	}
+
+	void StoryLocalization::LoadFrom(std::filesystem::path const& path)
+	{
+		assert(std::filesystem::is_directory(path));
+
+		auto index = LoadIndex(path);
+		Log::Info("UmaPyogin: Indexed {} story timelines and {} story races, using {} bytes",
+		          index->StoryTimelinePaths.Entries.size(), index->StoryRacePaths.Entries.size(),
+		          index->StoryTimelinePaths.Ids.GetMemoryUsage() +
+		              index->StoryRacePaths.Ids.GetMemoryUsage());
+
+		Misc::Rcu::Replace(m_Index, std::unique_ptr<const Index>(std::move(index)));
+		InvalidateCache(std::nullopt);
+	}
+
+	void StoryLocalization::LoadFrom(std::shared_ptr<const LocalizationPack> pack)
+	{
+		m_Pack = std::move(pack);
+	}
+
+	void StoryLocalization::ReloadFile(std::filesystem::path const& path)
+	{
+		// 只有加载线程会替换索引，此处读取无需 ReadGuard
+		const auto current = m_Index.load(std::memory_order_acquire);
+		if (!current)
+		{
+			return;
+		}
+
+		if (path == current->Root / "index.bin" || path == current->Root / "index.json")
+		{
+			LoadFrom(current->Root);
+			return;
+		}
+
+		const auto entry = ParseStoryFileName(path);
+		if (!entry)
+		{
+			return;
+		}
+		const auto [kind, id] = *entry;
+
+		auto index = std::make_unique<Index>(*current);
+		auto& paths =
+		    kind == StoryEntryKind::Timeline ? index->StoryTimelinePaths : index->StoryRacePaths;
+		auto entries = std::move(paths.Entries);
+		const auto iter = std::lower_bound(entries.begin(), entries.end(), id,
+		                                   [](const auto& entry, std::size_t value) {
+			                                   return entry.first < value;
+		                                   });
+		const auto found = iter != entries.end() && iter->first == id;
+		if (std::filesystem::is_regular_file(path))
+		{
+			if (found)
+			{
+				iter->second = path;
+			}
+			else
+			{
+				entries.emplace(iter, id, path);
+			}
+		}
+		else if (found && iter->second == path)
+		{
+			entries.erase(iter);
+		}
+		paths = MakePathTable(std::move(entries));
+
+		Misc::Rcu::Replace(m_Index, std::unique_ptr<const Index>(std::move(index)));
+		InvalidateCache(MakeCacheKey(kind, id));
+	}
+
+	void StoryLocalization::SetCacheBudget(std::size_t budget)
+	{
+		std::unique_lock lock(m_CacheMutex);
+		m_CacheBudget = budget;
+		TrimCache();
+	}
+
+	std::shared_ptr<const StoryLocalization::StoryTextData>
+	StoryLocalization::GetStoryTextData(std::size_t id) const
+	{
+		if (!LoadingStatus::GetInstance().WaitUntilReady(Dataset::Story))
+		{
+			return nullptr;
+		}
+
+		return GetOrLoad<StoryTextData>(
+		    MakeCacheKey(StoryEntryKind::Timeline, id),
+		    [&]() -> std::shared_ptr<const StoryTextData> {
+			    if (m_Pack)
+			    {
+				    if (auto data = m_Pack->FindStoryTextData(id))
+				    {
+					    return std::make_shared<const StoryTextData>(std::move(*data));
+				    }
+				    return nullptr;
+			    }
+
+			    const auto path = FindPath(&Index::StoryTimelinePaths, id);
+			    return path.empty() ? nullptr : LoadTimeline(path);
+		    });
+	}
+
+	std::shared_ptr<const StoryLocalization::RaceTextData>
+	StoryLocalization::GetRaceTextData(std::size_t id) const
+	{
+		if (!LoadingStatus::GetInstance().WaitUntilReady(Dataset::Story))
+		{
+			return nullptr;
+		}
+
+		return GetOrLoad<RaceTextData>(
+		    MakeCacheKey(StoryEntryKind::Race, id), [&]() -> std::shared_ptr<const RaceTextData> {
+			    if (m_Pack)
+			    {
+				    if (auto data = m_Pack->FindRaceTextData(id))
+				    {
+					    return std::make_shared<const RaceTextData>(std::move(*data));
+				    }
+				    return nullptr;
+			    }
+
+			    const auto path = FindPath(&Index::StoryRacePaths, id);
+			    return path.empty() ? nullptr : LoadRace(path);
+		    });
+	}
+
+	template <typename Data, typename Loader>
+	std::shared_ptr<const Data> StoryLocalization::GetOrLoad(std::uint64_t key,
+	                                                         Loader&& loader) const
+	{
+		std::uint64_t generation;
 		{
-			std::ifstream file(path, std::ios_base::binary | std::ios_base::ate);
-			if (!file.is_open())
+			std::unique_lock lock(m_CacheMutex);
+			if (const auto iter = m_CacheIndex.find(key); iter != m_CacheIndex.end())
 			{
-				Log::Error("UmaPyogin: Failed to open localization file {}", PATH_STR(path));
-				return {};
+				m_CacheList.splice(m_CacheList.begin(), m_CacheList, iter->second);
+				return std::static_pointer_cast<const Data>(iter->second->Data);
 			}
+			generation = m_CacheGeneration;
+		}
+
+		// 在锁外解析，避免阻塞其他线程的查询；同一译文被并发加载时以先插入者为准
+		auto data = loader();
+		if (!data)
+		{
+			return nullptr;
+		}
+		const auto size = EstimateSize(*data);
 
-			const auto size = static_cast<std::size_t>(file.tellg());
-			file.seekg(0, std::ios_base::beg);
+		std::unique_lock lock(m_CacheMutex);
+		if (generation != m_CacheGeneration)
+		{
+			// 加载期间文件已变化，结果可能已过期，不放入缓存
+			return data;
+		}
+		if (const auto iter = m_CacheIndex.find(key); iter != m_CacheIndex.end())
+		{
+			m_CacheList.splice(m_CacheList.begin(), m_CacheList, iter->second);
+			return std::static_pointer_cast<const Data>(iter->second->Data);
+		}
 
-			std::vector<char> buffer(size + simdjson::SIMDJSON_PADDING);
-			file.read(buffer.data(), size);
+		m_CacheList.push_front({ key, data, size });
+		m_CacheIndex.emplace(key, m_CacheList.begin());
+		m_CacheSize += size;
+		TrimCache();
+		return data;
+	}
 
-			return std::move(buffer);
+	void StoryLocalization::TrimCache() const
+	{
+		// 至少保留最近使用的一项
+		while (m_CacheBudget && m_CacheSize > m_CacheBudget && m_CacheList.size() > 1)
+		{
+			const auto& entry = m_CacheList.back();
+			m_CacheSize -= entry.Size;
+			m_CacheIndex.erase(entry.Key);
+			m_CacheList.pop_back();
 		}
-	} // namespace
+	}
 
-	StaticLocalization& StaticLocalization::GetInstance()
+	void StoryLocalization::InvalidateCache(std::optional<std::uint64_t> key)
 	{
-		static StaticLocalization s_Instance;
-		return s_Instance;
+		std::unique_lock lock(m_CacheMutex);
+		++m_CacheGeneration;
+		if (!key)
+		{
+			m_CacheList.clear();
+			m_CacheIndex.clear();
+			m_CacheSize = 0;
+		}
+		else if (const auto iter = m_CacheIndex.find(*key); iter != m_CacheIndex.end())
+		{
+			m_CacheSize -= iter->second->Size;
+			m_CacheList.erase(iter->second);
+			m_CacheIndex.erase(iter);
+		}
 	}
 
-	void StaticLocalization::LoadFrom(std::filesystem::path const& path)
+	std::filesystem::path StoryLocalization::FindPath(PathTable Index::*paths,
+	                                                  std::size_t id) const
 	{
-		auto buffer = ReadFileWithPadding(path);
-		if (!buffer)
+		Misc::Rcu::ReadGuard guard;
+		const auto index = m_Index.load(std::memory_order_acquire);
+		if (!index)
 		{
-			return;
+			return {};
 		}
+		const auto& table = index->*paths;
+		const auto position = table.Ids.Find(id);
+		return position ? table.Entries[*position].second : std::filesystem::path();
+	}
 
-		simdjson::dom::parser parser;
-		auto document =
-		    parser.parse(buffer->data(), buffer->size() - simdjson::SIMDJSON_PADDING, false);
-		if (document.error() != simdjson::SUCCESS)
+	StoryLocalization::PathTable StoryLocalization::MakePathTable(
+	    std::vector<std::pair<std::size_t, std::filesystem::path>> entries)
+	{
+		std::stable_sort(entries.begin(), entries.end(),
+		                 [](const auto& a, const auto& b) { return a.first < b.first; });
+		entries.erase(std::unique(entries.begin(), entries.end(),
+		                          [](const auto& a, const auto& b) { return a.first == b.first; }),
+		              entries.end());
+
+		std::vector<std::uint64_t> ids;
+		ids.reserve(entries.size());
+		for (const auto& [id, path] : entries)
 		{
-			Log::Error("UmaPyogin: Failed to parse localization file {}(error: {})", PATH_STR(path),
-			           document.error());
-			return;
+			ids.push_back(id);
+		}
+
+		PathTable table;
+		table.Ids.Build(ids);
+		table.Entries = std::move(entries);
+		return table;
+	}
+
+	std::unique_ptr<StoryLocalization::Index>
+	StoryLocalization::LoadIndex(std::filesystem::path const& path)
+	{
+		auto index = std::make_unique<Index>();
+		index->Root = path;
+		if (!ReadBinaryIndexFile(path, *index) && !ReadIndexFile(path, *index))
+		{
+			BuildIndex(path, *index);
+		}
+		return index;
+	}
+
+	bool StoryLocalization::ReadBinaryIndexFile(std::filesystem::path const& path, Index& index)
+	{
+		const auto indexPath = path / "index.bin";
+		if (!std::filesystem::is_regular_file(indexPath))
+		{
+			return false;
 		}
 
-		std::int32_t i = 0;
-		auto lastIsNull = false;
-		while (true)
+		const Misc::MappedFile file(indexPath);
+		if (!file.IsOpen() || file.Size() < sizeof(StoryIndexHeader))
 		{
-			const auto source = Hook::LocalizeJP_Get(i++);
-			if (!source || !source->chars[0])
+			Log::Error("UmaPyogin: Failed to read story index {}", PATH_STR(indexPath));
+			return false;
+		}
+
+		StoryIndexHeader header;
+		std::memcpy(&header, file.Data(), sizeof(header));
+		if (std::memcmp(header.Magic, StoryIndexMagic, sizeof(StoryIndexMagic)) != 0 ||
+		    header.Version != StoryIndexVersion)
+		{
+			Log::Error("UmaPyogin: {} is not a supported story index", PATH_STR(indexPath));
+			return false;
+		}
+
+		const auto entryCount =
+		    static_cast<std::size_t>(header.TimelineCount) + header.RaceCount;
+		const auto stringsOffset = sizeof(StoryIndexHeader) + entryCount * sizeof(StoryIndexEntry);
+		if (file.Size() < stringsOffset)
+		{
+			Log::Error("UmaPyogin: Story index {} is truncated", PATH_STR(indexPath));
+			return false;
+		}
+		const std::string_view strings(reinterpret_cast<const char*>(file.Data()) + stringsOffset,
+		                               file.Size() - stringsOffset);
+
+		const auto readSection = [&](std::size_t first, std::size_t count) {
+			std::vector<std::pair<std::size_t, std::filesystem::path>> entries;
+			entries.reserve(count);
+			for (std::size_t i = first; i < first + count; ++i)
 			{
-				if (lastIsNull)
+				StoryIndexEntry entry;
+				std::memcpy(&entry,
+				            file.Data() + sizeof(StoryIndexHeader) + i * sizeof(StoryIndexEntry),
+				            sizeof(entry));
+				if (entry.Id > UINT32_MAX || entry.PathOffset > strings.size() ||
+				    entry.PathLength > strings.size() - entry.PathOffset)
 				{
-					break;
+					Log::Error("UmaPyogin: Invalid entry {} in story index {}", i,
+					           PATH_STR(indexPath));
+					continue;
 				}
-				lastIsNull = true;
-				m_LocalizedStrings.emplace_back(std::nullopt);
-				continue;
+				entries.emplace_back(entry.Id,
+				                     path / std::filesystem::u8path(strings.substr(
+				                                entry.PathOffset, entry.PathLength)));
 			}
+			return MakePathTable(std::move(entries));
+		};
+
+		index.StoryTimelinePaths = readSection(0, header.TimelineCount);
+		index.StoryRacePaths = readSection(header.TimelineCount, header.RaceCount);
+		return true;
+	}
+
+	bool StoryLocalization::WriteIndexFile(std::filesystem::path const& path)
+	{
+		Index index;
+		index.Root = path;
+		BuildIndex(path, index);
+
+		StoryIndexHeader header{};
+		std::memcpy(header.Magic, StoryIndexMagic, sizeof(StoryIndexMagic));
+		header.Version = StoryIndexVersion;
+		header.TimelineCount = static_cast<std::uint32_t>(index.StoryTimelinePaths.Entries.size());
+		header.RaceCount = static_cast<std::uint32_t>(index.StoryRacePaths.Entries.size());
 
-			lastIsNull = false;
-			const auto sourceString = Misc::ToUTF8(source->chars);
-			const auto localizedString = document[sourceString].get_string();
-			if (localizedString.error())
+		std::vector<StoryIndexEntry> entries;
+		std::string strings;
+		for (const auto table : { &index.StoryTimelinePaths, &index.StoryRacePaths })
+		{
+			for (const auto& [id, entryPath] : table->Entries)
 			{
-				m_LocalizedStrings.emplace_back(std::nullopt);
-				continue;
+				const auto relativePath = entryPath.lexically_relative(path).generic_u8string();
+				entries.push_back({ id, static_cast<std::uint32_t>(strings.size()),
+				                    static_cast<std::uint32_t>(relativePath.size()) });
+				strings.append(reinterpret_cast<const char*>(relativePath.data()),
+				               relativePath.size());
 			}
+		}
 
-			m_LocalizedStrings.emplace_back(Misc::ToUTF16(localizedString.value_unsafe()));
+		const auto indexPath = path / "index.bin";
+		std::ofstream file(indexPath, std::ios::binary);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(entries.data()),
+		           entries.size() * sizeof(StoryIndexEntry));
+		file.write(strings.data(), strings.size());
+		if (!file)
+		{
+			Log::Error("UmaPyogin: Failed to write story index {}", PATH_STR(indexPath));
+			return false;
 		}
+		return true;
 	}
 
-	const std::u16string* StaticLocalization::Localize(std::int32_t id) const
+	// index.json 格式：
+	// { "StoryTimeline": { "<id>": "<相对路径>", ... }, "StoryRace": { "<id>": "<相对路径>", ... } }
+	bool StoryLocalization::ReadIndexFile(std::filesystem::path const& path, Index& index)
 	{
-		if (id < m_LocalizedStrings.size())
+		const auto indexPath = path / "index.json";
+		if (!std::filesystem::is_regular_file(indexPath))
 		{
-			const auto& maybeStr = m_LocalizedStrings[id];
-			return maybeStr ? &*maybeStr : nullptr;
+			return false;
 		}
-		return nullptr;
-	}
 
-#define CHECK_ERROR(expr)                                                                          \
-	if (const auto err = expr.error(); err != simdjson::SUCCESS)                                   \
-	{                                                                                              \
-		Log::Error("UmaPyogin: Malformed localization file {}, error {} while get " #expr,         \
-		           PATH_STR(path), err);                                                           \
-		return;                                                                                    \
-	}
+		const JsonSource source(indexPath);
+		if (!source)
+		{
+			return false;
+		}
 
-	StoryLocalization& StoryLocalization::GetInstance()
-	{
-		static StoryLocalization s_Instance;
-		return s_Instance;
-	}
+		const PooledParser<simdjson::dom::parser> parser;
+		simdjson::dom::object document;
+		if (const auto error = parser->parse(source.Data(), source.Size(), false).get(document))
+		{
+			Log::Error("UmaPyogin: Failed to parse story index {}(error: {})", PATH_STR(indexPath),
+			           simdjson::error_message(error));
+			return false;
+		}
 
-	void StoryLocalization::LoadFrom(std::filesystem::path const& path)
-	{
-#ifdef _WIN32
-#define PATH_LITERAL(x) L##x
-#else
-#define PATH_LITERAL(x) x
-#endif
-		constexpr const std::filesystem::path::value_type StoryTimelinePrefix[] =
-		    PATH_LITERAL("storytimeline_");
-		constexpr const std::filesystem::path::value_type StoryRacePrefix[] =
-		    PATH_LITERAL("storyrace_");
-#undef PATH_LITERAL
+		const auto loadSection = [&](const char* name, PathTable& paths) {
+			simdjson::dom::object section;
+			if (document[name].get(section))
+			{
+				return;
+			}
+			std::vector<std::pair<std::size_t, std::filesystem::path>> entries;
+			for (const auto& [key, value] : section)
+			{
+				const auto id = ParseId(key);
+				std::string_view relativePath;
+				if (!id || value.get(relativePath))
+				{
+					Log::Error("UmaPyogin: Invalid entry {} in story index {}", key,
+					           PATH_STR(indexPath));
+					continue;
+				}
+				entries.emplace_back(*id, path / std::filesystem::u8path(relativePath));
+			}
+			paths = MakePathTable(std::move(entries));
+		};
 
-		assert(std::filesystem::is_directory(path));
+		loadSection("StoryTimeline", index.StoryTimelinePaths);
+		loadSection("StoryRace", index.StoryRacePaths);
+		return true;
+	}
 
+	void StoryLocalization::BuildIndex(std::filesystem::path const& path, Index& index)
+	{
+		std::vector<std::pair<std::size_t, std::filesystem::path>> timelineEntries;
+		std::vector<std::pair<std::size_t, std::filesystem::path>> raceEntries;
 		try
 		{
-			std::mutex timeLineMutex;
-			std::mutex raceMutex;
-			Misc::Parallel::OnePassForEach(
-			    std::filesystem::recursive_directory_iterator(
-			        path, std::filesystem::directory_options::follow_directory_symlink),
-			    std::filesystem::recursive_directory_iterator(),
-			    [&](std::filesystem::directory_entry const& entry) {
-				    if (!entry.is_regular_file() || entry.path().extension() != ".json")
-				    {
-					    return;
-				    }
+			for (const auto& entry : std::filesystem::recursive_directory_iterator(
+			         path, std::filesystem::directory_options::follow_directory_symlink))
+			{
+				if (!entry.is_regular_file())
+				{
+					continue;
+				}
 
-				    const auto filePath = entry.path();
-				    const auto fileStem = filePath.stem();
-				    if (fileStem.native().starts_with(StoryTimelinePrefix))
-				    {
-					    const auto timelineId =
-					        std::stoi(fileStem.native().substr(sizeof(StoryTimelinePrefix) - 1));
-					    LoadTimeline(timelineId, filePath, timeLineMutex);
-				    }
-				    else if (fileStem.native().starts_with(StoryRacePrefix))
-				    {
-					    const auto raceId =
-					        std::stoi(fileStem.native().substr(sizeof(StoryRacePrefix) - 1));
-					    LoadRace(raceId, filePath, raceMutex);
-				    }
-			    });
+				if (const auto storyEntry = ParseStoryFileName(entry.path()))
+				{
+					const auto [kind, id] = *storyEntry;
+					(kind == StoryEntryKind::Timeline ? timelineEntries : raceEntries)
+					    .emplace_back(id, entry.path());
+				}
+			}
 		}
 		catch (const std::exception& e)
 		{
 			Log::Error("UmaPyogin: Failed to load story localization from {}: {}", PATH_STR(path),
 			           e.what());
 		}
+
+		index.StoryTimelinePaths = MakePathTable(std::move(timelineEntries));
+		index.StoryRacePaths = MakePathTable(std::move(raceEntries));
 	}
 
-	const StoryLocalization::StoryTextData*
-	StoryLocalization::GetStoryTextData(std::size_t id) const
+	std::vector<std::pair<std::size_t, std::shared_ptr<const StoryLocalization::StoryTextData>>>
+	StoryLocalization::LoadAllStoryTextData() const
 	{
-		if (const auto iter = m_StoryTextDataMap.find(id); iter != m_StoryTextDataMap.end())
+		std::vector<std::pair<std::size_t, std::filesystem::path>> paths;
 		{
-			return &iter->second;
+			Misc::Rcu::ReadGuard guard;
+			if (const auto index = m_Index.load(std::memory_order_acquire))
+			{
+				paths = index->StoryTimelinePaths.Entries;
+			}
 		}
-		return nullptr;
+
+		const AllocationCounter counter;
+		auto result = LoadAll<StoryTextData>(paths, &LoadTimeline);
+		Log::Info("UmaPyogin: Loaded {} story timelines, allocated {} read buffers and {} parser "
+		          "buffers",
+		          result.size(), counter.GetReadBufferAllocations(),
+		          counter.GetParserAllocations());
+		return result;
 	}
 
-	const StoryLocalization::RaceTextData* StoryLocalization::GetRaceTextData(std::size_t id) const
+	std::vector<std::pair<std::size_t, std::shared_ptr<const StoryLocalization::RaceTextData>>>
+	StoryLocalization::LoadAllRaceTextData() const
 	{
-		if (const auto iter = m_RaceTextDataMap.find(id); iter != m_RaceTextDataMap.end())
+		std::vector<std::pair<std::size_t, std::filesystem::path>> paths;
 		{
-			return &iter->second;
+			Misc::Rcu::ReadGuard guard;
+			if (const auto index = m_Index.load(std::memory_order_acquire))
+			{
+				paths = index->StoryRacePaths.Entries;
+			}
 		}
-		return nullptr;
+
+		const AllocationCounter counter;
+		auto result = LoadAll<RaceTextData>(paths, &LoadRace);
+		Log::Info("UmaPyogin: Loaded {} story races, allocated {} read buffers and {} parser "
+		          "buffers",
+		          result.size(), counter.GetReadBufferAllocations(),
+		          counter.GetParserAllocations());
+		return result;
 	}
 
-	void StoryLocalization::LoadTimeline(std::size_t timelineId, std::filesystem::path const& path,
-	                                     std::mutex& mutex)
+	std::shared_ptr<const StoryLocalization::StoryTextData>
+	StoryLocalization::LoadTimeline(std::filesystem::path const& path)
 	{
-		auto buffer = ReadFileWithPadding(path);
-		if (!buffer)
+		const JsonSource source(path);
+		if (!source)
 		{
-			return;
+			return nullptr;
 		}
 
-		simdjson::dom::parser parser;
-		auto document =
-		    parser.parse(buffer->data(), buffer->size() - simdjson::SIMDJSON_PADDING, false);
+		const PooledParser<simdjson::dom::parser> parser;
+		auto document = parser->parse(source.Data(), source.Size(), false);
 		if (document.error() != simdjson::SUCCESS)
 		{
 			Log::Error("UmaPyogin: Failed to parse localization file {}(error: {})", PATH_STR(path),
-			           document.error());
-			return;
+			           simdjson::error_message(document.error()));
+			return nullptr;
 		}
 
-		StoryTextData data;
+		auto data = std::make_shared<StoryTextData>();
+		StringArena arena(source.Size());
 
 		const auto title = document["Title"].get_string();
 		CHECK_ERROR(title);
-		data.Title = Misc::ToUTF16(title.value_unsafe());
+		data->Title = arena.Store(title.value_unsafe());
 		const auto textBlockList = document["TextBlockList"].get_array();
 		CHECK_ERROR(textBlockList);
+		data->TextBlockList.reserve(textBlockList.size());
+
+		// 先统计选项与颜色文本的总数，使 StringList 只分配一次，格式错误留待下面报告
+		std::size_t stringListSize = 0;
+		for (const auto block : textBlockList)
+		{
+			for (const auto key : { "ChoiceDataList", "ColorTextInfoList" })
+			{
+				if (const auto list = block[key].get_array(); !list.error())
+				{
+					stringListSize += list.value_unsafe().size();
+				}
+			}
+		}
+		data->StringList.reserve(stringListSize);
+
 		for (const auto block : textBlockList)
 		{
 			if (block.is_null())
 			{
-				data.TextBlockList.emplace_back();
+				data->TextBlockList.emplace_back();
 			}
 			else
 			{
 				StoryTextBlock textBlock;
 				const auto name = block["Name"].get_string();
 				CHECK_ERROR(name);
-				textBlock.Name = Misc::ToUTF16(name.value_unsafe());
+				textBlock.Name = arena.Store(name.value_unsafe());
 				const auto text = block["Text"].get_string();
 				CHECK_ERROR(text);
-				textBlock.Text = Misc::ToUTF16(text.value_unsafe());
+				textBlock.Text = arena.Store(text.value_unsafe());
 				const auto choiceDataList = block["ChoiceDataList"].get_array();
 				CHECK_ERROR(choiceDataList);
+				textBlock.ChoiceDataBegin = static_cast<std::uint32_t>(data->StringList.size());
 				for (const auto choiceData : choiceDataList)
 				{
 					const auto choiceDataText = choiceData.get_string();
 					CHECK_ERROR(choiceDataText);
-					textBlock.ChoiceDataList.emplace_back(
-					    Misc::ToUTF16(choiceDataText.value_unsafe()));
+					data->StringList.emplace_back(arena.Store(choiceDataText.value_unsafe()));
 				}
+				textBlock.ChoiceDataCount =
+				    static_cast<std::uint32_t>(data->StringList.size()) - textBlock.ChoiceDataBegin;
 				const auto colorTextInfoList = block["ColorTextInfoList"].get_array();
 				CHECK_ERROR(colorTextInfoList);
+				textBlock.ColorTextInfoBegin = static_cast<std::uint32_t>(data->StringList.size());
 				for (const auto colorTextInfo : colorTextInfoList)
 				{
 					const auto colorTextInfoText = colorTextInfo.get_string();
 					CHECK_ERROR(colorTextInfoText);
-					textBlock.ColorTextInfoList.emplace_back(
-					    Misc::ToUTF16(colorTextInfoText.value_unsafe()));
+					data->StringList.emplace_back(arena.Store(colorTextInfoText.value_unsafe()));
 				}
+				textBlock.ColorTextInfoCount = static_cast<std::uint32_t>(data->StringList.size()) -
+				                               textBlock.ColorTextInfoBegin;
+				data->TextBlockList.emplace_back(textBlock);
+			}
+		}
 
-				data.TextBlockList.emplace_back(std::move(textBlock));
+		data->Storage = arena.Finish();
+		arena.Rebase(data->Title, data->Storage);
+		for (auto& block : data->TextBlockList)
+		{
+			if (block)
+			{
+				arena.Rebase(block->Name, data->Storage);
+				arena.Rebase(block->Text, data->Storage);
 			}
 		}
+		for (auto& str : data->StringList)
+		{
+			arena.Rebase(str, data->Storage);
+		}
 
-		std::unique_lock lock(mutex);
-		m_StoryTextDataMap.emplace(timelineId, std::move(data));
+		return data;
 	}
 
-	void StoryLocalization::LoadRace(std::size_t raceId, std::filesystem::path const& path,
-	                                 std::mutex& mutex)
+	std::shared_ptr<const StoryLocalization::RaceTextData>
+	StoryLocalization::LoadRace(std::filesystem::path const& path)
 	{
-		auto buffer = ReadFileWithPadding(path);
-		if (!buffer)
+		const JsonSource source(path);
+		if (!source)
 		{
-			return;
+			return nullptr;
 		}
 
-		simdjson::dom::parser parser;
-		auto document =
-		    parser.parse(buffer->data(), buffer->size() - simdjson::SIMDJSON_PADDING, false);
+		const PooledParser<simdjson::dom::parser> parser;
+		auto document = parser->parse(source.Data(), source.Size(), false);
 		if (document.error() != simdjson::SUCCESS)
 		{
 			Log::Error("UmaPyogin: Failed to parse localization file {}(error: {})", PATH_STR(path),
-			           document.error());
-			return;
+			           simdjson::error_message(document.error()));
+			return nullptr;
 		}
 
-		RaceTextData data;
+		auto data = std::make_shared<RaceTextData>();
+		StringArena arena(source.Size());
 
 		const auto array = document.get_array();
 		CHECK_ERROR(array);
 
+		data->textData.reserve(array.size());
 		for (const auto item : array)
 		{
 			const auto text = item.get_string();
 			CHECK_ERROR(text);
-			data.textData.emplace_back(Misc::ToUTF16(text.value_unsafe()));
+			data->textData.emplace_back(arena.Store(text.value_unsafe()));
 		}
 
-		std::unique_lock lock(mutex);
-		m_RaceTextDataMap.emplace(raceId, std::move(data));
-	}
+		data->Storage = arena.Finish();
+		for (auto& text : data->textData)
+		{
+			arena.Rebase(text, data->Storage);
+		}
 
-	DatabaseLocalization& DatabaseLocalization::GetInstance()
-	{
-		static DatabaseLocalization s_Instance;
-		return s_Instance;
+		return data;
 	}
 
-	void
-	DatabaseLocalization::LoadFrom(std::filesystem::path const& textDataDictPath,
-	                               std::filesystem::path const& characterSystemTextDataDictPath,
-	                               std::filesystem::path const& raceJikkyoCommentDataDictPath,
-	                               std::filesystem::path const& raceJikkyoMessageDataDictPath)
+	namespace
 	{
-		// TextData
+		bool ParseUInt32(std::string_view str, std::uint32_t& value)
+		{
+			const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+			return ec == std::errc{};
+		}
+
+		// 依次以键与值调用 handler，handler 返回错误码时停止
+		template <typename Handler>
+		simdjson::error_code ForEachField(simdjson::ondemand::object& object, Handler&& handler)
 		{
-			auto buffer = ReadFileWithPadding(textDataDictPath);
-			if (buffer)
+			for (auto field : object)
 			{
-				simdjson::dom::parser parser;
-				auto document = parser.parse(buffer->data(),
-				                             buffer->size() - simdjson::SIMDJSON_PADDING, false);
-				if (document.error() != simdjson::SUCCESS)
+				std::string_view key;
+				if (const auto error = field.unescaped_key().get(key))
 				{
-					Log::Error("UmaPyogin: Failed to parse localization file {}(error: {})",
-					           PATH_STR(textDataDictPath), document.error());
-					return;
+					return error;
 				}
-
-				if (document.is_object())
+				simdjson::ondemand::value value;
+				if (const auto error = field.value().get(value))
 				{
-					for (const auto& [category, indexTextMap] : document.get_object())
-					{
-						std::size_t categoryValue;
-						if (const auto [ptr, ec] = std::from_chars(
-						        category.data(), category.data() + category.size(), categoryValue);
-						    ec != std::errc{})
-						{
-							Log::Error("UmaPyogin: Failed to parse category {}(in file {})",
-							           category, PATH_STR(textDataDictPath));
-							continue;
-						}
-
-						if (indexTextMap.is_object())
-						{
-							auto& map = m_TextDataMap[categoryValue];
-
-							for (const auto& [index, text] : indexTextMap.get_object())
-							{
-								if (text.is_string())
-								{
-									std::size_t indexValue;
-									if (const auto [ptr, ec] = std::from_chars(
-									        index.data(), index.data() + index.size(), indexValue);
-									    ec != std::errc{})
-									{
-										Log::Error(
-										    "UmaPyogin: Failed to parse index {}(in file {})",
-										    index, PATH_STR(textDataDictPath));
-										continue;
-									}
-
-									map.emplace(indexValue, Misc::ToUTF16(text.get_string()));
-								}
-							}
-						}
-					}
+					return error;
+				}
+				if (const auto error = handler(key, value))
+				{
+					return error;
 				}
 			}
+			return simdjson::SUCCESS;
 		}
 
-		// CharacterSystemTextData
+		// 值不是字符串时跳过
+		simdjson::error_code AddText(TextTable& table, std::uint64_t key,
+		                             simdjson::ondemand::value& value)
 		{
-			auto buffer = ReadFileWithPadding(characterSystemTextDataDictPath);
-			if (buffer)
+			simdjson::ondemand::json_type type;
+			if (const auto error = value.type().get(type))
 			{
-				simdjson::dom::parser parser;
-				auto document = parser.parse(buffer->data(),
-				                             buffer->size() - simdjson::SIMDJSON_PADDING, false);
-				if (document.error() != simdjson::SUCCESS)
-				{
-					Log::Error("UmaPyogin: Failed to parse localization file {}(error: {})",
-					           PATH_STR(textDataDictPath), document.error());
-					return;
-				}
+				return error;
+			}
+			if (type != simdjson::ondemand::json_type::string)
+			{
+				return simdjson::SUCCESS;
+			}
 
-				if (document.is_object())
+			// 不含转义的字符串直接引用输入缓冲区，不写入解析器的字符串缓冲区，以降低内存峰值
+			// raw_json_token 不会消费该值，之后前进时会自动跳过
+			const auto token = value.raw_json_token();
+			if (const auto end = token.find('"', 1); end != std::string_view::npos)
+			{
+				if (const auto text = token.substr(1, end - 1);
+				    text.find('\\') == std::string_view::npos)
 				{
-					for (const auto& [characterId, voiceIdTextMap] : document.get_object())
-					{
-						std::size_t characterIdValue;
-						if (const auto [ptr, ec] = std::from_chars(
-						        characterId.data(), characterId.data() + characterId.size(),
-						        characterIdValue);
-						    ec != std::errc{})
-						{
-							Log::Error("UmaPyogin: Failed to parse characterId {}(in file {})",
-							           characterId, PATH_STR(characterSystemTextDataDictPath));
-							continue;
-						}
-
-						if (voiceIdTextMap.is_object())
-						{
-							auto& map = m_CharacterSystemTextDataMap[characterIdValue];
-
-							for (const auto& [voiceId, text] : voiceIdTextMap.get_object())
-							{
-								if (text.is_string())
-								{
-									std::size_t voiceIdValue;
-
-									if (const auto [ptr, ec] = std::from_chars(
-									        voiceId.data(), voiceId.data() + voiceId.size(),
-									        voiceIdValue);
-									    ec != std::errc{})
-									{
-										Log::Error(
-										    "UmaPyogin: Failed to parse voiceId {}(in file {})",
-										    voiceId, PATH_STR(characterSystemTextDataDictPath));
-										continue;
-									}
-
-									map.emplace(voiceIdValue, Misc::ToUTF16(text.get_string()));
-								}
-							}
-						}
-					}
+					table.Add(key, text);
+					return simdjson::SUCCESS;
 				}
 			}
+
+			std::string_view text;
+			if (const auto error = value.get_string().get(text))
+			{
+				return error;
+			}
+			table.Add(key, text);
+			return simdjson::SUCCESS;
 		}
 
-		// RaceJikkyoCommentData
+		// 以 On-Demand API 边解析边写入，不构造 DOM，出错时保留已读取的部分
+		template <typename Handler>
+		void LoadDictionary(std::filesystem::path const& path, TextTable& table, Handler&& handler)
 		{
-			auto buffer = ReadFileWithPadding(raceJikkyoCommentDataDictPath);
-			if (buffer)
+			const JsonSource source(path);
+			if (!source)
+			{
+				return;
+			}
+
+			// 每个 UTF-8 字节至多转换为一个 UTF-16 代码单元，文件大小即为文本长度的上限
+			// 预留的空间在写入前不占用物理内存，Seal 时收缩到实际大小
+			table.Reserve(source.Size());
+
+			const PooledParser<simdjson::ondemand::parser> parser;
+			simdjson::ondemand::document document;
+			simdjson::ondemand::object object;
+			auto error =
+			    parser->iterate(source.Data(), source.Size(), source.Capacity()).get(document);
+			if (!error)
+			{
+				error = document.get_object().get(object);
+			}
+			if (!error)
+			{
+				error = ForEachField(object, handler);
+			}
+			if (error)
 			{
-				simdjson::dom::parser parser;
-				auto document = parser.parse(buffer->data(),
-				                             buffer->size() - simdjson::SIMDJSON_PADDING, false);
-				if (document.error() != simdjson::SUCCESS)
+				Log::Error("UmaPyogin: Failed to parse localization file {}(error: {})",
+				           PATH_STR(path), simdjson::error_message(error));
+			}
+		}
+
+		// 形如 { "outer": { "inner": "text" } } 的字典，键为 (outer << 32) | inner
+		void LoadNestedDictionary(std::filesystem::path const& path, TextTable& table,
+		                          const char* outerName, const char* innerName)
+		{
+			const auto handleOuter = [&](std::string_view outer, simdjson::ondemand::value& value) {
+				std::uint32_t outerValue;
+				if (!ParseUInt32(outer, outerValue))
 				{
-					Log::Error("UmaPyogin: Failed to parse localization file {}(error: {})",
-					           PATH_STR(raceJikkyoCommentDataDictPath), document.error());
-					return;
+					Log::Error("UmaPyogin: Failed to parse {} {}(in file {})", outerName, outer,
+					           PATH_STR(path));
+					return simdjson::SUCCESS;
 				}
 
-				if (document.is_object())
+				simdjson::ondemand::json_type type;
+				if (const auto error = value.type().get(type))
 				{
-					for (const auto& [id, text] : document.get_object())
-					{
-						std::size_t idValue;
-						if (const auto [ptr, ec] =
-						        std::from_chars(id.data(), id.data() + id.size(), idValue);
-						    ec != std::errc{})
-						{
-							Log::Error("UmaPyogin: Failed to parse id {}(in file {})", id,
-							           PATH_STR(raceJikkyoCommentDataDictPath));
-							continue;
-						}
-
-						if (text.is_string())
-						{
-							m_RaceJikkyoCommentDataMap.emplace(idValue,
-							                                   Misc::ToUTF16(text.get_string()));
-						}
-					}
+					return error;
+				}
+				if (type != simdjson::ondemand::json_type::object)
+				{
+					return simdjson::SUCCESS;
 				}
-			}
-		}
 
-		// RaceJikkyoMessageData
-		{
-			auto buffer = ReadFileWithPadding(raceJikkyoMessageDataDictPath);
-			if (buffer)
-			{
-				simdjson::dom::parser parser;
-				auto document = parser.parse(buffer->data(),
-				                             buffer->size() - simdjson::SIMDJSON_PADDING, false);
-				if (document.error() != simdjson::SUCCESS)
+				simdjson::ondemand::object innerTextMap;
+				if (const auto error = value.get_object().get(innerTextMap))
 				{
-					Log::Error("UmaPyogin: Failed to parse localization file {}(error: {})",
-					           PATH_STR(raceJikkyoMessageDataDictPath), document.error());
-					return;
+					return error;
 				}
+				return ForEachField(
+				    innerTextMap, [&](std::string_view inner, simdjson::ondemand::value& text) {
+					    std::uint32_t innerValue;
+					    if (!ParseUInt32(inner, innerValue))
+					    {
+						    Log::Error("UmaPyogin: Failed to parse {} {}(in file {})", innerName,
+						               inner, PATH_STR(path));
+						    return simdjson::SUCCESS;
+					    }
+					    return AddText(table, Pack::MakeKey(outerValue, innerValue), text);
+				    });
+			};
+			LoadDictionary(path, table, handleOuter);
+		}
 
-				if (document.is_object())
+		// 形如 { "id": "text" } 的字典
+		void LoadFlatDictionary(std::filesystem::path const& path, TextTable& table)
+		{
+			LoadDictionary(path, table, [&](std::string_view id, simdjson::ondemand::value& text) {
+				std::uint32_t idValue;
+				if (!ParseUInt32(id, idValue))
 				{
-					for (const auto& [id, text] : document.get_object())
-					{
-						std::size_t idValue;
-						if (const auto [ptr, ec] =
-						        std::from_chars(id.data(), id.data() + id.size(), idValue);
-						    ec != std::errc{})
-						{
-							Log::Error("UmaPyogin: Failed to parse id {}(in file {})", id,
-							           PATH_STR(raceJikkyoMessageDataDictPath));
-							continue;
-						}
-
-						if (text.is_string())
-						{
-							m_RaceJikkyoMessageDataMap.emplace(idValue,
-							                                   Misc::ToUTF16(text.get_string()));
-						}
-					}
+					Log::Error("UmaPyogin: Failed to parse id {}(in file {})", id,
+					           PATH_STR(path));
+					return simdjson::SUCCESS;
 				}
-			}
+				return AddText(table, idValue, text);
+			});
 		}
+	} // namespace
+
+	DatabaseLocalization& DatabaseLocalization::GetInstance()
+	{
+		static DatabaseLocalization s_Instance;
+		return s_Instance;
 	}
 
-	const std::u16string* DatabaseLocalization::GetTextData(std::size_t category, std::size_t index)
+	DatabaseLocalization::~DatabaseLocalization()
+	{
+		delete m_Snapshot.load(std::memory_order_relaxed);
+	}
+
+	void
+	DatabaseLocalization::LoadFrom(std::filesystem::path const& textDataDictPath,
+	                               std::filesystem::path const& characterSystemTextDataDictPath,
+	                               std::filesystem::path const& raceJikkyoCommentDataDictPath,
+	                               std::filesystem::path const& raceJikkyoMessageDataDictPath)
 	{
-		if (const auto iter = m_TextDataMap.find(category); iter != m_TextDataMap.end())
+		m_Paths[static_cast<std::size_t>(Table::TextData)] = textDataDictPath;
+		m_Paths[static_cast<std::size_t>(Table::CharacterSystemTextData)] =
+		    characterSystemTextDataDictPath;
+		m_Paths[static_cast<std::size_t>(Table::RaceJikkyoCommentData)] =
+		    raceJikkyoCommentDataDictPath;
+		m_Paths[static_cast<std::size_t>(Table::RaceJikkyoMessageData)] =
+		    raceJikkyoMessageDataDictPath;
+
+		const auto startTime = std::chrono::steady_clock::now();
+		const AllocationCounter counter;
+
+		// 各字典互不相关，分别在线程池中解析
+		auto snapshot = std::make_unique<Snapshot>();
 		{
-			if (const auto iter2 = iter->second.find(index); iter2 != iter->second.end())
+			Misc::Parallel::TaskGroup group;
+			for (std::size_t i = 0; i < TableCount; ++i)
 			{
-				return &iter2->second;
+				group.Run([&, i] {
+					snapshot->Tables[i] = LoadTable(static_cast<Table>(i), m_Paths[i]);
+				});
 			}
+			group.Wait();
 		}
+		Misc::Rcu::Replace(m_Snapshot, std::unique_ptr<const Snapshot>(std::move(snapshot)));
+
+		Log::Info("UmaPyogin: Database localization loaded in {}ms, peak RSS is {} KiB, allocated "
+		          "{} read buffers and {} parser buffers",
+		          std::chrono::duration_cast<std::chrono::milliseconds>(
+		              std::chrono::steady_clock::now() - startTime)
+		              .count(),
+		          Misc::GetPeakResidentSetSize() / 1024, counter.GetReadBufferAllocations(),
+		          counter.GetParserAllocations());
+	}
 
-		return nullptr;
+	void DatabaseLocalization::LoadFrom(std::shared_ptr<const LocalizationPack> pack)
+	{
+		m_Pack = std::move(pack);
 	}
 
-	const std::u16string* DatabaseLocalization::GetCharacterSystemTextData(std::size_t characterId,
-	                                                                       std::size_t voiceId)
+	void DatabaseLocalization::Reload(std::filesystem::path const& path)
 	{
-		if (const auto iter = m_CharacterSystemTextDataMap.find(characterId);
-		    iter != m_CharacterSystemTextDataMap.end())
+		const auto current = m_Snapshot.load(std::memory_order_acquire);
+		if (!current)
+		{
+			return;
+		}
+
+		// 只有热重载线程会替换快照，此处读取的旧快照不会被释放
+		auto snapshot = std::make_unique<Snapshot>(*current);
+		auto changed = false;
+		for (std::size_t i = 0; i < TableCount; ++i)
 		{
-			if (const auto iter2 = iter->second.find(voiceId); iter2 != iter->second.end())
+			if (!m_Paths[i].empty() && m_Paths[i] == path)
 			{
-				return &iter2->second;
+				snapshot->Tables[i] = LoadTable(static_cast<Table>(i), path);
+				changed = true;
 			}
 		}
+		if (changed)
+		{
+			Misc::Rcu::Replace(m_Snapshot, std::unique_ptr<const Snapshot>(std::move(snapshot)));
+		}
+	}
+
+	std::shared_ptr<const TextTable>
+	DatabaseLocalization::LoadTable(Table table, std::filesystem::path const& path)
+	{
+		constexpr const char* TableNames[] = {
+			"TextData",
+			"CharacterSystemTextData",
+			"RaceJikkyoCommentData",
+			"RaceJikkyoMessageData",
+		};
+		static_assert(std::size(TableNames) == TableCount);
+
+		auto result = std::make_shared<TextTable>();
+		switch (table)
+		{
+		case Table::TextData:
+			LoadNestedDictionary(path, *result, "category", "index");
+			break;
+		case Table::CharacterSystemTextData:
+			LoadNestedDictionary(path, *result, "characterId", "voiceId");
+			break;
+		default:
+			LoadFlatDictionary(path, *result);
+			break;
+		}
+
+		result->Seal();
+		if (result->GetSize())
+		{
+			Log::Info("UmaPyogin: {} has {} entries, using {} bytes (node-based maps would use "
+			          "about {} bytes)",
+			          TableNames[static_cast<std::size_t>(table)], result->GetSize(),
+			          result->GetMemoryUsage(), result->EstimateNodeBasedMemoryUsage());
+		}
+		return result;
+	}
+
+	std::optional<std::u16string_view> DatabaseLocalization::Find(Table table,
+	                                                              std::uint64_t key) const
+	{
+		const auto snapshot = m_Snapshot.load(std::memory_order_acquire);
+		if (!snapshot || !snapshot->Tables[static_cast<std::size_t>(table)])
+		{
+			return std::nullopt;
+		}
+		return snapshot->Tables[static_cast<std::size_t>(table)]->Find(key);
+	}
+
+	std::optional<std::u16string_view> DatabaseLocalization::GetTextData(std::size_t category,
+	                                                                     std::size_t index)
+	{
+		if (!LoadingStatus::GetInstance().IsReady(Dataset::Database))
+		{
+			return std::nullopt;
+		}
+
+		if (m_Pack)
+		{
+			return m_Pack->FindTextData(category, index);
+		}
+
+		return Find(Table::TextData, Pack::MakeKey(category, index));
+	}
+
+	std::optional<std::u16string_view>
+	DatabaseLocalization::GetCharacterSystemTextData(std::size_t characterId, std::size_t voiceId)
+	{
+		if (!LoadingStatus::GetInstance().IsReady(Dataset::Database))
+		{
+			return std::nullopt;
+		}
+
+		if (m_Pack)
+		{
+			return m_Pack->FindCharacterSystemTextData(characterId, voiceId);
+		}
 
-		return nullptr;
+		return Find(Table::CharacterSystemTextData, Pack::MakeKey(characterId, voiceId));
 	}
 
-	const std::u16string* DatabaseLocalization::GetRaceJikkyoCommentData(std::size_t id)
+	std::optional<std::u16string_view>
+	DatabaseLocalization::GetRaceJikkyoCommentData(std::size_t id)
 	{
-		if (const auto iter = m_RaceJikkyoCommentDataMap.find(id);
-		    iter != m_RaceJikkyoCommentDataMap.end())
+		if (!LoadingStatus::GetInstance().IsReady(Dataset::Database))
+		{
+			return std::nullopt;
+		}
+
+		if (m_Pack)
 		{
-			return &iter->second;
+			return m_Pack->FindRaceJikkyoCommentData(id);
 		}
 
-		return nullptr;
+		return Find(Table::RaceJikkyoCommentData, id);
 	}
 
-	const std::u16string* DatabaseLocalization::GetRaceJikkyoMessageData(std::size_t id)
+	std::optional<std::u16string_view>
+	DatabaseLocalization::GetRaceJikkyoMessageData(std::size_t id)
 	{
-		if (const auto iter = m_RaceJikkyoMessageDataMap.find(id);
-		    iter != m_RaceJikkyoMessageDataMap.end())
+		if (!LoadingStatus::GetInstance().IsReady(Dataset::Database))
+		{
+			return std::nullopt;
+		}
+
+		if (m_Pack)
 		{
-			return &iter->second;
+			return m_Pack->FindRaceJikkyoMessageData(id);
 		}
 
-		return nullptr;
+		return Find(Table::RaceJikkyoMessageData, id);
 	}
 } // namespace UmaPyogin::Localization
@@ -1,31 +1,134 @@
 #ifndef UMAPYOGIN_LOCALIZATION_H
 #define UMAPYOGIN_LOCALIZATION_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <filesystem>
+#include <list>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
+#include "IdIndex.h"
+#include "Misc.h"
+#include "TextTable.h"
+
 namespace UmaPyogin::Localization
 {
+	class LocalizationPack;
+
+	enum class Dataset
+	{
+		Static,
+		Story,
+		Database,
+
+		Count,
+	};
+
+	enum class LoadState
+	{
+		// 未安排加载，查询直接使用当前数据
+		Idle,
+		Loading,
+		Ready,
+		// 加载过程中出错，查询使用已加载的部分
+		Failed,
+	};
+
+	// 记录各数据集的后台加载进度，查询在数据集加载完成前不会读取其数据
+	class LoadingStatus
+	{
+	public:
+		static LoadingStatus& GetInstance();
+
+		// 查询遇到正在加载的数据集时至多等待的时长，为 0 时不等待而直接使用原文
+		void SetWaitTimeout(std::chrono::milliseconds timeout);
+
+		void BeginLoading(Dataset dataset);
+		void FinishLoading(Dataset dataset, bool succeeded);
+
+		LoadState GetState(Dataset dataset) const;
+		// 已完成加载的数据集占已安排加载的数据集的比例，未安排加载时为 1
+		float GetProgress() const;
+
+		// 返回数据集是否可供查询，不等待
+		bool IsReady(Dataset dataset) const;
+		// 返回数据集是否可供查询，正在加载时至多等待 SetWaitTimeout 设置的时长
+		// 加载完成时会发布新数据并等待读端退出，因此不能在持有 Misc::Rcu::ReadGuard 时调用
+		bool WaitUntilReady(Dataset dataset) const;
+
+		LoadingStatus(LoadingStatus const&) = delete;
+		LoadingStatus& operator=(LoadingStatus const&) = delete;
+
+	private:
+		LoadingStatus() = default;
+
+		std::atomic<LoadState> m_States[static_cast<std::size_t>(Dataset::Count)]{};
+		std::atomic<std::chrono::milliseconds::rep> m_WaitTimeout{};
+
+		mutable std::mutex m_Mutex;
+		mutable std::condition_variable m_Condition;
+	};
+
+	// 自启动以来读取缓冲区的分配次数与解析器内部缓冲区的扩充次数，并发进行的加载均会计入
+	struct LoadAllocationStatistics
+	{
+		std::size_t ReadBuffers;
+		std::size_t Parsers;
+	};
+
+	LoadAllocationStatistics GetLoadAllocationStatistics();
+
 	class StaticLocalization
 	{
 	public:
 		static StaticLocalization& GetInstance();
 
+		// 通过 Hook::LocalizeJP_Get 取得全部原文，需在 il2cpp 初始化后于游戏线程上调用，
+		// 之后的 LoadFrom 与 Reload 均使用此时取得的原文
+		void CaptureSources();
+
+		// 以 CaptureSources 取得的原文查找译文，仅读取文件，可在任意线程调用
 		void LoadFrom(std::filesystem::path const& path);
+		void LoadFrom(std::shared_ptr<const LocalizationPack> pack);
+		// 重新读取上次加载的 JSON 文件，沿用加载时取得的原文，可在任意线程调用
+		void Reload();
 
-		const std::u16string* Localize(std::int32_t id) const;
+		// 调用方需持有 Misc::Rcu::ReadGuard 直至不再使用返回的文本，正在加载时不等待
+		std::optional<std::u16string_view> Localize(std::int32_t id) const;
 
 		StaticLocalization(StaticLocalization const&) = delete;
 		StaticLocalization& operator=(StaticLocalization const&) = delete;
 
 	private:
 		StaticLocalization() = default;
+		~StaticLocalization();
+
+		struct Snapshot
+		{
+			std::shared_ptr<const LocalizationPack> Pack;
+			// 从 JSON 加载时持有文本，下标与 id 一致
+			std::vector<std::u16string> Storage;
+			std::vector<std::optional<std::u16string_view>> LocalizedStrings;
+		};
+
+		std::filesystem::path m_Path;
+		// 原文的副本，托管字符串可能被游戏释放，不能直接引用
+		std::vector<std::u16string> m_Sources;
+		std::atomic<const Snapshot*> m_Snapshot{};
 
-		std::vector<std::optional<std::u16string>> m_LocalizedStrings;
+		std::unique_ptr<const Snapshot> BuildSnapshot(std::filesystem::path const& path) const;
+
+		// 依次取得各 id 的原文，需在已附加到 il2cpp 的线程上调用
+		static std::vector<std::u16string> SnapshotStaticSources();
 	};
 
 	class StoryLocalization
@@ -33,42 +136,150 @@ namespace UmaPyogin::Localization
 	public:
 		struct StoryTextBlock
 		{
-			std::u16string Name;
-			std::u16string Text;
-			std::vector<std::u16string> ChoiceDataList;
-			std::vector<std::u16string> ColorTextInfoList;
+			std::u16string_view Name;
+			std::u16string_view Text;
+			// 以下均为 StoryTextData::StringList 中的下标
+			std::uint32_t ChoiceDataBegin;
+			std::uint32_t ChoiceDataCount;
+			std::uint32_t ColorTextInfoBegin;
+			std::uint32_t ColorTextInfoCount;
 		};
 
+		// 文本视图引用 Storage 或翻译包，从翻译包加载时 Storage 为空
+		// 同一文件的全部文本连续存放于 Storage，vector 移动时元素地址不变
+		// 各块的选项与颜色文本依次存放于 StringList，块中仅记录范围，因此分配次数与块数无关
 		struct StoryTextData
 		{
-			std::u16string Title;
+			std::u16string_view Title;
 			std::vector<std::optional<StoryTextBlock>> TextBlockList;
+			std::vector<std::u16string_view> StringList;
+			std::vector<char16_t> Storage;
+
+			std::span<const std::u16string_view>
+			GetChoiceDataList(StoryTextBlock const& block) const
+			{
+				return std::span(StringList).subspan(block.ChoiceDataBegin, block.ChoiceDataCount);
+			}
+
+			std::span<const std::u16string_view>
+			GetColorTextInfoList(StoryTextBlock const& block) const
+			{
+				return std::span(StringList)
+				    .subspan(block.ColorTextInfoBegin, block.ColorTextInfoCount);
+			}
 		};
 
 		struct RaceTextData
 		{
-			std::vector<std::u16string> textData;
+			std::vector<std::u16string_view> textData;
+			std::vector<char16_t> Storage;
 		};
 
+		static constexpr std::size_t DefaultCacheBudget = 32 * 1024 * 1024;
+
 		static StoryLocalization& GetInstance();
 
+		// 仅建立 id 到文件的索引，译文在首次访问时解析
+		// 目录下存在 index.bin 或 index.json 时直接使用其中的索引，否则根据文件名建立
 		void LoadFrom(std::filesystem::path const& path);
+		void LoadFrom(std::shared_ptr<const LocalizationPack> pack);
+		// 目录中的文件被修改、新增或删除后调用，更新索引并丢弃已缓存的译文
+		void ReloadFile(std::filesystem::path const& path);
+
+		// 遍历目录并将索引写入其中的 index.bin，之后加载时无需再遍历目录
+		static bool WriteIndexFile(std::filesystem::path const& path);
+
+		// 按需解析的译文所占内存的上限（字节），超出时淘汰最久未使用的译文，0 表示不限制
+		void SetCacheBudget(std::size_t budget);
 
-		const StoryTextData* GetStoryTextData(std::size_t id) const;
-		const RaceTextData* GetRaceTextData(std::size_t id) const;
+		// 可在任意线程调用，返回的数据在被淘汰后仍然有效
+		std::shared_ptr<const StoryTextData> GetStoryTextData(std::size_t id) const;
+		std::shared_ptr<const RaceTextData> GetRaceTextData(std::size_t id) const;
+
+		// 解析索引中的全部文件并按 id 顺序访问，不经过缓存，仅适用于从目录加载的情况
+		template <typename Visitor>
+		void ForEachStoryTextData(Visitor&& visitor) const
+		{
+			for (const auto& [id, data] : LoadAllStoryTextData())
+			{
+				visitor(id, *data);
+			}
+		}
+
+		template <typename Visitor>
+		void ForEachRaceTextData(Visitor&& visitor) const
+		{
+			for (const auto& [id, data] : LoadAllRaceTextData())
+			{
+				visitor(id, *data);
+			}
+		}
 
 		StoryLocalization(StoryLocalization const&) = delete;
 		StoryLocalization& operator=(StoryLocalization const&) = delete;
 
 	private:
 		StoryLocalization() = default;
+		~StoryLocalization();
+
+		struct CacheEntry
+		{
+			std::uint64_t Key;
+			std::shared_ptr<const void> Data;
+			std::size_t Size;
+		};
+
+		// Entries 按 id 升序排列，下标与 Ids 中的下标一致
+		struct PathTable
+		{
+			IdIndex Ids;
+			std::vector<std::pair<std::size_t, std::filesystem::path>> Entries;
+		};
+
+		struct Index
+		{
+			std::filesystem::path Root;
+			PathTable StoryTimelinePaths;
+			PathTable StoryRacePaths;
+		};
+
+		std::shared_ptr<const LocalizationPack> m_Pack;
+
+		// 仅由加载线程替换，读取时需持有 Misc::Rcu::ReadGuard
+		std::atomic<const Index*> m_Index{};
+
+		// 最近使用的译文位于链表头部，以下成员均由 m_CacheMutex 保护
+		mutable std::mutex m_CacheMutex;
+		mutable std::list<CacheEntry> m_CacheList;
+		mutable std::unordered_map<std::uint64_t, std::list<CacheEntry>::iterator> m_CacheIndex;
+		mutable std::size_t m_CacheSize{};
+		// 每次丢弃缓存时递增，使丢弃前开始的加载结果不再进入缓存
+		std::uint64_t m_CacheGeneration{};
+		std::size_t m_CacheBudget = DefaultCacheBudget;
+
+		template <typename Data, typename Loader>
+		std::shared_ptr<const Data> GetOrLoad(std::uint64_t key, Loader&& loader) const;
+		void TrimCache() const;
+		void InvalidateCache(std::optional<std::uint64_t> key);
+
+		std::filesystem::path FindPath(PathTable Index::*paths, std::size_t id) const;
+
+		// 同一 id 出现多次时保留先出现的条目
+		static PathTable
+		MakePathTable(std::vector<std::pair<std::size_t, std::filesystem::path>> entries);
 
-		std::unordered_map<std::size_t, StoryTextData> m_StoryTextDataMap;
-		std::unordered_map<std::size_t, RaceTextData> m_RaceTextDataMap;
+		static std::unique_ptr<Index> LoadIndex(std::filesystem::path const& path);
+		static bool ReadBinaryIndexFile(std::filesystem::path const& path, Index& index);
+		static bool ReadIndexFile(std::filesystem::path const& path, Index& index);
+		static void BuildIndex(std::filesystem::path const& path, Index& index);
 
-		void LoadTimeline(std::size_t timelineId, std::filesystem::path const& path,
-		                  std::mutex& mutex);
-		void LoadRace(std::size_t raceId, std::filesystem::path const& path, std::mutex& mutex);
+		std::vector<std::pair<std::size_t, std::shared_ptr<const StoryTextData>>>
+		LoadAllStoryTextData() const;
+		std::vector<std::pair<std::size_t, std::shared_ptr<const RaceTextData>>>
+		LoadAllRaceTextData() const;
+
+		static std::shared_ptr<const StoryTextData> LoadTimeline(std::filesystem::path const& path);
+		static std::shared_ptr<const RaceTextData> LoadRace(std::filesystem::path const& path);
 	};
 
 	class DatabaseLocalization
@@ -80,32 +291,102 @@ namespace UmaPyogin::Localization
 		              std::filesystem::path const& characterSystemTextDataDictPath,
 		              std::filesystem::path const& raceJikkyoCommentDataDictPath,
 		              std::filesystem::path const& raceJikkyoMessageDataDictPath);
+		void LoadFrom(std::shared_ptr<const LocalizationPack> pack);
+		// 重新读取路径为 path 的字典，其余字典保持不变，可在任意线程调用
+		void Reload(std::filesystem::path const& path);
+
+		// 调用方需持有 Misc::Rcu::ReadGuard 直至不再使用返回的文本，正在加载时不等待
+		std::optional<std::u16string_view> GetTextData(std::size_t category, std::size_t index);
+		std::optional<std::u16string_view> GetCharacterSystemTextData(std::size_t characterId,
+		                                                              std::size_t voiceId);
+		std::optional<std::u16string_view> GetRaceJikkyoCommentData(std::size_t id);
+		std::optional<std::u16string_view> GetRaceJikkyoMessageData(std::size_t id);
 
-		const std::u16string* GetTextData(std::size_t category, std::size_t index);
-		const std::u16string* GetCharacterSystemTextData(std::size_t characterId,
-		                                                 std::size_t voiceId);
-		const std::u16string* GetRaceJikkyoCommentData(std::size_t id);
-		const std::u16string* GetRaceJikkyoMessageData(std::size_t id);
+		template <typename Visitor>
+		void ForEachTextData(Visitor&& visitor) const
+		{
+			ForEachEntry(Table::TextData, [&](std::uint64_t key, std::u16string_view text) {
+				visitor(static_cast<std::size_t>(key >> 32),
+				        static_cast<std::size_t>(key & 0xFFFFFFFF), text);
+			});
+		}
+
+		template <typename Visitor>
+		void ForEachCharacterSystemTextData(Visitor&& visitor) const
+		{
+			ForEachEntry(Table::CharacterSystemTextData,
+			             [&](std::uint64_t key, std::u16string_view text) {
+				             visitor(static_cast<std::size_t>(key >> 32),
+				                     static_cast<std::size_t>(key & 0xFFFFFFFF), text);
+			             });
+		}
+
+		template <typename Visitor>
+		void ForEachRaceJikkyoCommentData(Visitor&& visitor) const
+		{
+			ForEachEntry(Table::RaceJikkyoCommentData,
+			             [&](std::uint64_t key, std::u16string_view text) {
+				             visitor(static_cast<std::size_t>(key), text);
+			             });
+		}
+
+		template <typename Visitor>
+		void ForEachRaceJikkyoMessageData(Visitor&& visitor) const
+		{
+			ForEachEntry(Table::RaceJikkyoMessageData,
+			             [&](std::uint64_t key, std::u16string_view text) {
+				             visitor(static_cast<std::size_t>(key), text);
+			             });
+		}
 
 		DatabaseLocalization(DatabaseLocalization const&) = delete;
 		DatabaseLocalization& operator=(DatabaseLocalization const&) = delete;
 
 	private:
 		DatabaseLocalization() = default;
+		~DatabaseLocalization();
 
-		// { category: { index: text } }
-		std::unordered_map<std::size_t, std::unordered_map<std::size_t, std::u16string>>
-		    m_TextDataMap;
+		enum class Table : std::size_t
+		{
+			// 键为 (category << 32) | index
+			TextData,
+			// 键为 (character_id << 32) | voice_id
+			CharacterSystemTextData,
+			// 键为 id
+			RaceJikkyoCommentData,
+			// 键为 id
+			RaceJikkyoMessageData,
+
+			Count,
+		};
 
-		// { character_id: { voice_id: text } }
-		std::unordered_map<std::size_t, std::unordered_map<std::size_t, std::u16string>>
-		    m_CharacterSystemTextDataMap;
+		static constexpr auto TableCount = static_cast<std::size_t>(Table::Count);
 
-		// { id: text }
-		std::unordered_map<std::size_t, std::u16string> m_RaceJikkyoCommentDataMap;
+		// 未变化的字典在新旧快照间共享
+		struct Snapshot
+		{
+			std::shared_ptr<const TextTable> Tables[TableCount];
+		};
+
+		std::shared_ptr<const LocalizationPack> m_Pack;
+		std::filesystem::path m_Paths[TableCount];
+		std::atomic<const Snapshot*> m_Snapshot{};
+
+		std::optional<std::u16string_view> Find(Table table, std::uint64_t key) const;
+
+		template <typename Visitor>
+		void ForEachEntry(Table table, Visitor&& visitor) const
+		{
+			Misc::Rcu::ReadGuard guard;
+			const auto snapshot = m_Snapshot.load(std::memory_order_acquire);
+			if (snapshot && snapshot->Tables[static_cast<std::size_t>(table)])
+			{
+				snapshot->Tables[static_cast<std::size_t>(table)]->ForEach(visitor);
+			}
+		}
 
-		// { id: text }
-		std::unordered_map<std::size_t, std::u16string> m_RaceJikkyoMessageDataMap;
+		static std::shared_ptr<const TextTable> LoadTable(Table table,
+		                                                  std::filesystem::path const& path);
 	};
 } // namespace UmaPyogin::Localization
 
@@ -0,0 +1,424 @@
+#include "LocalizationPack.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define PATH_STR(path) (path).string()
+#else
+#define PATH_STR(path) (path).native()
+#endif
+
+namespace UmaPyogin::Localization
+{
+	namespace
+	{
+		template <typename Entry>
+		const Entry* FindById(std::span<const Entry> entries, std::uint64_t id)
+		{
+			const auto iter = std::lower_bound(
+			    entries.begin(), entries.end(), id,
+			    [](Entry const& entry, std::uint64_t value) { return entry.Id < value; });
+			if (iter != entries.end() && iter->Id == id)
+			{
+				return &*iter;
+			}
+			return nullptr;
+		}
+
+		constexpr std::size_t AlignUp(std::size_t value, std::size_t alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+	} // namespace
+
+	LocalizationPack::LocalizationPack(Misc::MappedFile&& file) : m_File(std::move(file))
+	{
+	}
+
+	std::shared_ptr<const LocalizationPack>
+	LocalizationPack::Open(std::filesystem::path const& path)
+	{
+		Misc::MappedFile file(path);
+		if (!file.IsOpen())
+		{
+			Log::Error("UmaPyogin: Failed to map localization pack {}", PATH_STR(path));
+			return nullptr;
+		}
+
+		std::shared_ptr<LocalizationPack> pack(new LocalizationPack(std::move(file)));
+		if (!pack->Validate(path))
+		{
+			return nullptr;
+		}
+
+		return pack;
+	}
+
+	bool LocalizationPack::Validate(std::filesystem::path const& path)
+	{
+		if (m_File.Size() < sizeof(Pack::Header))
+		{
+			Log::Error("UmaPyogin: Localization pack {} is truncated", PATH_STR(path));
+			return false;
+		}
+
+		const auto header = reinterpret_cast<const Pack::Header*>(m_File.Data());
+		if (std::memcmp(header->Magic, Pack::Magic, sizeof(Pack::Magic)) != 0)
+		{
+			Log::Error("UmaPyogin: {} is not a localization pack", PATH_STR(path));
+			return false;
+		}
+
+		if (header->Version != Pack::Version ||
+		    header->SectionCount != static_cast<std::uint32_t>(Pack::SectionKind::Count))
+		{
+			Log::Error("UmaPyogin: Localization pack {} has unsupported version {}(expected {})",
+			           PATH_STR(path), header->Version, Pack::Version);
+			return false;
+		}
+
+		for (const auto& section : header->Sections)
+		{
+			if (section.Offset % alignof(std::uint64_t) != 0 || section.Offset > m_File.Size() ||
+			    section.Size > m_File.Size() - section.Offset)
+			{
+				Log::Error("UmaPyogin: Localization pack {} is malformed", PATH_STR(path));
+				return false;
+			}
+		}
+
+		m_StringPool = GetSection<char16_t>(Pack::SectionKind::StringPool);
+		m_StringList = GetSection<Pack::StringRef>(Pack::SectionKind::StringList);
+		m_Static = GetSection<Pack::StaticEntry>(Pack::SectionKind::Static);
+		m_TextData = GetSection<Pack::IdEntry>(Pack::SectionKind::TextData);
+		m_CharacterSystemTextData =
+		    GetSection<Pack::IdEntry>(Pack::SectionKind::CharacterSystemTextData);
+		m_RaceJikkyoCommentData =
+		    GetSection<Pack::IdEntry>(Pack::SectionKind::RaceJikkyoCommentData);
+		m_RaceJikkyoMessageData =
+		    GetSection<Pack::IdEntry>(Pack::SectionKind::RaceJikkyoMessageData);
+		m_StoryTimeline = GetSection<Pack::StoryTimelineEntry>(Pack::SectionKind::StoryTimeline);
+		m_StoryTimelineBlock =
+		    GetSection<Pack::StoryTimelineBlockEntry>(Pack::SectionKind::StoryTimelineBlock);
+		m_StoryRace = GetSection<Pack::StoryRaceEntry>(Pack::SectionKind::StoryRace);
+
+		return true;
+	}
+
+	template <typename T>
+	std::span<const T> LocalizationPack::GetSection(Pack::SectionKind kind) const
+	{
+		const auto header = reinterpret_cast<const Pack::Header*>(m_File.Data());
+		const auto& section = header->Sections[static_cast<std::size_t>(kind)];
+		return { reinterpret_cast<const T*>(m_File.Data() + section.Offset),
+			     static_cast<std::size_t>(section.Size / sizeof(T)) };
+	}
+
+	std::u16string_view LocalizationPack::GetString(Pack::StringRef ref) const
+	{
+		if (static_cast<std::size_t>(ref.Offset) + ref.Length > m_StringPool.size())
+		{
+			return {};
+		}
+		return { m_StringPool.data() + ref.Offset, ref.Length };
+	}
+
+	std::optional<std::u16string_view>
+	LocalizationPack::FindStatic(std::u16string_view source) const
+	{
+		const auto iter =
+		    std::lower_bound(m_Static.begin(), m_Static.end(), source,
+		                     [this](Pack::StaticEntry const& entry, std::u16string_view value) {
+			                     return GetString(entry.Source) < value;
+		                     });
+		if (iter != m_Static.end() && GetString(iter->Source) == source)
+		{
+			return GetString(iter->Text);
+		}
+		return std::nullopt;
+	}
+
+	std::optional<std::u16string_view> LocalizationPack::FindTextData(std::size_t category,
+	                                                                  std::size_t index) const
+	{
+		if (const auto entry = FindById(m_TextData, Pack::MakeKey(category, index)))
+		{
+			return GetString(entry->Text);
+		}
+		return std::nullopt;
+	}
+
+	std::optional<std::u16string_view>
+	LocalizationPack::FindCharacterSystemTextData(std::size_t characterId,
+	                                              std::size_t voiceId) const
+	{
+		if (const auto entry =
+		        FindById(m_CharacterSystemTextData, Pack::MakeKey(characterId, voiceId)))
+		{
+			return GetString(entry->Text);
+		}
+		return std::nullopt;
+	}
+
+	std::optional<std::u16string_view>
+	LocalizationPack::FindRaceJikkyoCommentData(std::size_t id) const
+	{
+		if (const auto entry = FindById(m_RaceJikkyoCommentData, id))
+		{
+			return GetString(entry->Text);
+		}
+		return std::nullopt;
+	}
+
+	std::optional<std::u16string_view>
+	LocalizationPack::FindRaceJikkyoMessageData(std::size_t id) const
+	{
+		if (const auto entry = FindById(m_RaceJikkyoMessageData, id))
+		{
+			return GetString(entry->Text);
+		}
+		return std::nullopt;
+	}
+
+	std::optional<StoryLocalization::StoryTextData>
+	LocalizationPack::FindStoryTextData(std::size_t id) const
+	{
+		const auto entry = FindById(m_StoryTimeline, id);
+		if (!entry || static_cast<std::size_t>(entry->BlockBegin) + entry->BlockCount >
+		                  m_StoryTimelineBlock.size())
+		{
+			return std::nullopt;
+		}
+
+		const auto blocks = m_StoryTimelineBlock.subspan(entry->BlockBegin, entry->BlockCount);
+		StoryLocalization::StoryTextData data;
+
+		// 范围超出 StringList 段的列表视为空
+		const auto isValidList = [&](std::uint32_t begin, std::uint32_t count) {
+			return static_cast<std::size_t>(begin) + count <= m_StringList.size();
+		};
+		std::size_t stringListSize = 0;
+		for (const auto& block : blocks)
+		{
+			if (isValidList(block.ChoiceDataBegin, block.ChoiceDataCount))
+			{
+				stringListSize += block.ChoiceDataCount;
+			}
+			if (isValidList(block.ColorTextInfoBegin, block.ColorTextInfoCount))
+			{
+				stringListSize += block.ColorTextInfoCount;
+			}
+		}
+		data.StringList.reserve(stringListSize);
+
+		// 将 StringList 段中的列表追加到 data.StringList，写入新的起始下标与数量
+		const auto addStringList = [&](std::uint32_t begin, std::uint32_t count,
+		                               std::uint32_t& outBegin, std::uint32_t& outCount) {
+			outBegin = static_cast<std::uint32_t>(data.StringList.size());
+			outCount = 0;
+			if (isValidList(begin, count))
+			{
+				for (const auto ref : m_StringList.subspan(begin, count))
+				{
+					data.StringList.emplace_back(GetString(ref));
+				}
+				outCount = count;
+			}
+		};
+
+		data.Title = GetString(entry->Title);
+		data.TextBlockList.reserve(entry->BlockCount);
+		for (const auto& block : blocks)
+		{
+			if (!block.Present)
+			{
+				data.TextBlockList.emplace_back();
+				continue;
+			}
+
+			auto& textBlock = data.TextBlockList.emplace_back(std::in_place).value();
+			textBlock.Name = GetString(block.Name);
+			textBlock.Text = GetString(block.Text);
+			addStringList(block.ChoiceDataBegin, block.ChoiceDataCount, textBlock.ChoiceDataBegin,
+			              textBlock.ChoiceDataCount);
+			addStringList(block.ColorTextInfoBegin, block.ColorTextInfoCount,
+			              textBlock.ColorTextInfoBegin, textBlock.ColorTextInfoCount);
+		}
+
+		return data;
+	}
+
+	std::optional<StoryLocalization::RaceTextData>
+	LocalizationPack::FindRaceTextData(std::size_t id) const
+	{
+		const auto entry = FindById(m_StoryRace, id);
+		if (!entry ||
+		    static_cast<std::size_t>(entry->TextBegin) + entry->TextCount > m_StringList.size())
+		{
+			return std::nullopt;
+		}
+
+		StoryLocalization::RaceTextData data;
+		data.textData.reserve(entry->TextCount);
+		for (const auto ref : m_StringList.subspan(entry->TextBegin, entry->TextCount))
+		{
+			data.textData.emplace_back(GetString(ref));
+		}
+
+		return data;
+	}
+
+	Pack::StringRef LocalizationPackWriter::AddString(std::u16string_view str)
+	{
+		const auto [iter, inserted] = m_StringIndex.try_emplace(std::u16string(str));
+		if (inserted)
+		{
+			iter->second = { static_cast<std::uint32_t>(m_StringPool.size()),
+				             static_cast<std::uint32_t>(str.size()) };
+			m_StringPool.append(str);
+		}
+		return iter->second;
+	}
+
+	void LocalizationPackWriter::AddStatic(std::u16string_view source, std::u16string_view text)
+	{
+		m_Static.emplace_back(source, AddString(text));
+	}
+
+	void LocalizationPackWriter::AddTextData(std::size_t category, std::size_t index,
+	                                         std::u16string_view text)
+	{
+		m_TextData.push_back({ Pack::MakeKey(category, index), AddString(text) });
+	}
+
+	void LocalizationPackWriter::AddCharacterSystemTextData(std::size_t characterId,
+	                                                        std::size_t voiceId,
+	                                                        std::u16string_view text)
+	{
+		m_CharacterSystemTextData.push_back(
+		    { Pack::MakeKey(characterId, voiceId), AddString(text) });
+	}
+
+	void LocalizationPackWriter::AddRaceJikkyoCommentData(std::size_t id, std::u16string_view text)
+	{
+		m_RaceJikkyoCommentData.push_back({ id, AddString(text) });
+	}
+
+	void LocalizationPackWriter::AddRaceJikkyoMessageData(std::size_t id, std::u16string_view text)
+	{
+		m_RaceJikkyoMessageData.push_back({ id, AddString(text) });
+	}
+
+	void LocalizationPackWriter::AddStoryTextData(std::size_t id,
+	                                              StoryLocalization::StoryTextData const& data)
+	{
+		const auto addStringList = [&](std::span<const std::u16string_view> list) {
+			const auto begin = static_cast<std::uint32_t>(m_StringList.size());
+			for (const auto str : list)
+			{
+				m_StringList.emplace_back(AddString(str));
+			}
+			return begin;
+		};
+
+		Pack::StoryTimelineEntry entry{};
+		entry.Id = id;
+		entry.Title = AddString(data.Title);
+		entry.BlockBegin = static_cast<std::uint32_t>(m_StoryTimelineBlock.size());
+		entry.BlockCount = static_cast<std::uint32_t>(data.TextBlockList.size());
+
+		for (const auto& block : data.TextBlockList)
+		{
+			Pack::StoryTimelineBlockEntry blockEntry{};
+			if (block)
+			{
+				blockEntry.Present = 1;
+				blockEntry.Name = AddString(block->Name);
+				blockEntry.Text = AddString(block->Text);
+				blockEntry.ChoiceDataBegin = addStringList(data.GetChoiceDataList(*block));
+				blockEntry.ChoiceDataCount = block->ChoiceDataCount;
+				blockEntry.ColorTextInfoBegin = addStringList(data.GetColorTextInfoList(*block));
+				blockEntry.ColorTextInfoCount = block->ColorTextInfoCount;
+			}
+			m_StoryTimelineBlock.emplace_back(blockEntry);
+		}
+
+		m_StoryTimeline.emplace_back(entry);
+	}
+
+	void LocalizationPackWriter::AddRaceTextData(std::size_t id,
+	                                             StoryLocalization::RaceTextData const& data)
+	{
+		Pack::StoryRaceEntry entry{};
+		entry.Id = id;
+		entry.TextBegin = static_cast<std::uint32_t>(m_StringList.size());
+		entry.TextCount = static_cast<std::uint32_t>(data.textData.size());
+		for (const auto str : data.textData)
+		{
+			m_StringList.emplace_back(AddString(str));
+		}
+		m_StoryRace.emplace_back(entry);
+	}
+
+	bool LocalizationPackWriter::WriteTo(std::filesystem::path const& path)
+	{
+		const auto byId = [](auto const& a, auto const& b) { return a.Id < b.Id; };
+		std::sort(m_TextData.begin(), m_TextData.end(), byId);
+		std::sort(m_CharacterSystemTextData.begin(), m_CharacterSystemTextData.end(), byId);
+		std::sort(m_RaceJikkyoCommentData.begin(), m_RaceJikkyoCommentData.end(), byId);
+		std::sort(m_RaceJikkyoMessageData.begin(), m_RaceJikkyoMessageData.end(), byId);
+		std::sort(m_StoryTimeline.begin(), m_StoryTimeline.end(), byId);
+		std::sort(m_StoryRace.begin(), m_StoryRace.end(), byId);
+		std::sort(m_Static.begin(), m_Static.end(),
+		          [](auto const& a, auto const& b) { return a.first < b.first; });
+
+		// 键也存入字符串池，需在计算布局之前完成
+		std::vector<Pack::StaticEntry> staticEntries;
+		staticEntries.reserve(m_Static.size());
+		for (const auto& [source, text] : m_Static)
+		{
+			staticEntries.push_back({ AddString(source), text });
+		}
+
+		std::string content(sizeof(Pack::Header), '\0');
+		Pack::Header header{};
+		std::memcpy(header.Magic, Pack::Magic, sizeof(Pack::Magic));
+		header.Version = Pack::Version;
+		header.SectionCount = static_cast<std::uint32_t>(Pack::SectionKind::Count);
+
+		const auto appendSection = [&](Pack::SectionKind kind, const void* data, std::size_t size) {
+			content.resize(AlignUp(content.size(), alignof(std::uint64_t)));
+			header.Sections[static_cast<std::size_t>(kind)] = { content.size(), size };
+			content.append(static_cast<const char*>(data), size);
+		};
+		const auto appendVector = [&](Pack::SectionKind kind, auto const& vec) {
+			appendSection(kind, vec.data(), vec.size() * sizeof(vec[0]));
+		};
+
+		appendSection(Pack::SectionKind::StringPool, m_StringPool.data(),
+		              m_StringPool.size() * sizeof(char16_t));
+		appendVector(Pack::SectionKind::StringList, m_StringList);
+		appendVector(Pack::SectionKind::Static, staticEntries);
+		appendVector(Pack::SectionKind::TextData, m_TextData);
+		appendVector(Pack::SectionKind::CharacterSystemTextData, m_CharacterSystemTextData);
+		appendVector(Pack::SectionKind::RaceJikkyoCommentData, m_RaceJikkyoCommentData);
+		appendVector(Pack::SectionKind::RaceJikkyoMessageData, m_RaceJikkyoMessageData);
+		appendVector(Pack::SectionKind::StoryTimeline, m_StoryTimeline);
+		appendVector(Pack::SectionKind::StoryTimelineBlock, m_StoryTimelineBlock);
+		appendVector(Pack::SectionKind::StoryRace, m_StoryRace);
+
+		std::memcpy(content.data(), &header, sizeof(header));
+
+		std::ofstream file(path, std::ios_base::binary | std::ios_base::trunc);
+		if (!file.is_open())
+		{
+			Log::Error("UmaPyogin: Failed to open {} for writing", PATH_STR(path));
+			return false;
+		}
+		file.write(content.data(), content.size());
+		return static_cast<bool>(file);
+	}
+} // namespace UmaPyogin::Localization
@@ -0,0 +1,184 @@
+#ifndef UMAPYOGIN_LOCALIZATION_PACK_H
+#define UMAPYOGIN_LOCALIZATION_PACK_H
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Localization.h"
+#include "Misc.h"
+
+namespace UmaPyogin::Localization
+{
+	// 预编译翻译包格式
+	// 文件按本机字节序（小端）存储，所有段均按 8 字节对齐，字符串以 UTF-16 存放于字符串池中，
+	// 各查找表均已按键排序以便二分查找
+	namespace Pack
+	{
+		inline constexpr char Magic[8] = { 'U', 'M', 'A', 'P', 'A', 'C', 'K', '\0' };
+		inline constexpr std::uint32_t Version = 1;
+
+		// Offset 与 Length 均以 char16_t 为单位，相对于字符串池起始位置
+		struct StringRef
+		{
+			std::uint32_t Offset;
+			std::uint32_t Length;
+		};
+
+		enum class SectionKind : std::uint32_t
+		{
+			StringPool,
+			StringList,
+			Static,
+			TextData,
+			CharacterSystemTextData,
+			RaceJikkyoCommentData,
+			RaceJikkyoMessageData,
+			StoryTimeline,
+			StoryTimelineBlock,
+			StoryRace,
+
+			Count
+		};
+
+		struct Section
+		{
+			std::uint64_t Offset;
+			std::uint64_t Size;
+		};
+
+		struct Header
+		{
+			char Magic[8];
+			std::uint32_t Version;
+			std::uint32_t SectionCount;
+			Section Sections[static_cast<std::size_t>(SectionKind::Count)];
+		};
+
+		// 按 Source 排序
+		struct StaticEntry
+		{
+			StringRef Source;
+			StringRef Text;
+		};
+
+		// 按 Id 排序，二维键由 MakeKey 合成
+		struct IdEntry
+		{
+			std::uint64_t Id;
+			StringRef Text;
+		};
+
+		struct StoryTimelineEntry
+		{
+			std::uint64_t Id;
+			StringRef Title;
+			std::uint32_t BlockBegin;
+			std::uint32_t BlockCount;
+		};
+
+		struct StoryTimelineBlockEntry
+		{
+			std::uint32_t Present;
+			StringRef Name;
+			StringRef Text;
+			// 以下均为 StringList 段中的下标
+			std::uint32_t ChoiceDataBegin;
+			std::uint32_t ChoiceDataCount;
+			std::uint32_t ColorTextInfoBegin;
+			std::uint32_t ColorTextInfoCount;
+		};
+
+		struct StoryRaceEntry
+		{
+			std::uint64_t Id;
+			std::uint32_t TextBegin;
+			std::uint32_t TextCount;
+		};
+
+		constexpr std::uint64_t MakeKey(std::size_t high, std::size_t low)
+		{
+			return (static_cast<std::uint64_t>(high) << 32) | static_cast<std::uint32_t>(low);
+		}
+	} // namespace Pack
+
+	class LocalizationPack
+	{
+	public:
+		// 失败时记录错误并返回空指针
+		static std::shared_ptr<const LocalizationPack> Open(std::filesystem::path const& path);
+
+		std::optional<std::u16string_view> FindStatic(std::u16string_view source) const;
+		std::optional<std::u16string_view> FindTextData(std::size_t category,
+		                                                std::size_t index) const;
+		std::optional<std::u16string_view> FindCharacterSystemTextData(std::size_t characterId,
+		                                                               std::size_t voiceId) const;
+		std::optional<std::u16string_view> FindRaceJikkyoCommentData(std::size_t id) const;
+		std::optional<std::u16string_view> FindRaceJikkyoMessageData(std::size_t id) const;
+
+		// 从包中构造视图，返回的数据引用包内存，生命周期不得超过本对象
+		std::optional<StoryLocalization::StoryTextData> FindStoryTextData(std::size_t id) const;
+		std::optional<StoryLocalization::RaceTextData> FindRaceTextData(std::size_t id) const;
+
+	private:
+		explicit LocalizationPack(Misc::MappedFile&& file);
+
+		bool Validate(std::filesystem::path const& path);
+
+		std::u16string_view GetString(Pack::StringRef ref) const;
+
+		template <typename T>
+		std::span<const T> GetSection(Pack::SectionKind kind) const;
+
+		Misc::MappedFile m_File;
+		std::span<const char16_t> m_StringPool;
+		std::span<const Pack::StringRef> m_StringList;
+		std::span<const Pack::StaticEntry> m_Static;
+		std::span<const Pack::IdEntry> m_TextData;
+		std::span<const Pack::IdEntry> m_CharacterSystemTextData;
+		std::span<const Pack::IdEntry> m_RaceJikkyoCommentData;
+		std::span<const Pack::IdEntry> m_RaceJikkyoMessageData;
+		std::span<const Pack::StoryTimelineEntry> m_StoryTimeline;
+		std::span<const Pack::StoryTimelineBlockEntry> m_StoryTimelineBlock;
+		std::span<const Pack::StoryRaceEntry> m_StoryRace;
+	};
+
+	class LocalizationPackWriter
+	{
+	public:
+		void AddStatic(std::u16string_view source, std::u16string_view text);
+		void AddTextData(std::size_t category, std::size_t index, std::u16string_view text);
+		void AddCharacterSystemTextData(std::size_t characterId, std::size_t voiceId,
+		                                std::u16string_view text);
+		void AddRaceJikkyoCommentData(std::size_t id, std::u16string_view text);
+		void AddRaceJikkyoMessageData(std::size_t id, std::u16string_view text);
+		void AddStoryTextData(std::size_t id, StoryLocalization::StoryTextData const& data);
+		void AddRaceTextData(std::size_t id, StoryLocalization::RaceTextData const& data);
+
+		bool WriteTo(std::filesystem::path const& path);
+
+	private:
+		Pack::StringRef AddString(std::u16string_view str);
+
+		std::u16string m_StringPool;
+		// 相同文本只存储一份
+		std::unordered_map<std::u16string, Pack::StringRef> m_StringIndex;
+		std::vector<Pack::StringRef> m_StringList;
+		std::vector<std::pair<std::u16string, Pack::StringRef>> m_Static;
+		std::vector<Pack::IdEntry> m_TextData;
+		std::vector<Pack::IdEntry> m_CharacterSystemTextData;
+		std::vector<Pack::IdEntry> m_RaceJikkyoCommentData;
+		std::vector<Pack::IdEntry> m_RaceJikkyoMessageData;
+		std::vector<Pack::StoryTimelineEntry> m_StoryTimeline;
+		std::vector<Pack::StoryTimelineBlockEntry> m_StoryTimelineBlock;
+		std::vector<Pack::StoryRaceEntry> m_StoryRace;
+	};
+} // namespace UmaPyogin::Localization
+
+#endif
@@ -1,17 +1,349 @@
 #include "Log.h"
 
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
 namespace UmaPyogin
 {
+	// 多生产者、单消费者的有界无锁队列，每个槽位的序号表示其状态：
+	// 等于写入位置时可写入，等于写入位置 + 1 时可读取，读取后增加 Capacity 供下一轮写入
+	class Log::AsyncBackend
+	{
+	public:
+		static constexpr std::size_t Capacity = 1024;
+
+		static AsyncBackend& GetInstance()
+		{
+			static AsyncBackend s_Instance;
+			return s_Instance;
+		}
+
+		void Start(OverflowPolicy policy)
+		{
+			std::unique_lock lock(m_ControlMutex);
+			if (m_Thread.joinable())
+			{
+				return;
+			}
+
+			if (!m_Slots)
+			{
+				m_Slots = std::make_unique<Slot[]>(Capacity);
+				for (std::size_t i = 0; i < Capacity; ++i)
+				{
+					m_Slots[i].Sequence.store(i, std::memory_order_relaxed);
+				}
+			}
+			m_Policy = policy;
+			m_Stopping.store(false, std::memory_order_relaxed);
+			m_Thread = std::thread(&AsyncBackend::Run, this);
+			s_Async.store(true, std::memory_order_release);
+		}
+
+		void Stop()
+		{
+			std::unique_lock lock(m_ControlMutex);
+			if (!m_Thread.joinable())
+			{
+				return;
+			}
+
+			// 等待已开始写入的线程完成，之后不会再有新的消息
+			s_Async.store(false);
+			while (m_ActiveWriters.load())
+			{
+				std::this_thread::yield();
+			}
+
+			m_Stopping.store(true);
+			Notify();
+			m_Thread.join();
+		}
+
+		void Flush()
+		{
+			if (!s_Async.load(std::memory_order_acquire) || t_IsLogThread)
+			{
+				return;
+			}
+
+			const auto target = m_EnqueuePosition.load();
+			Notify();
+			auto processed = m_ProcessedPosition.load(std::memory_order_acquire);
+			while (processed < target)
+			{
+				m_ProcessedPosition.wait(processed, std::memory_order_acquire);
+				processed = m_ProcessedPosition.load(std::memory_order_acquire);
+			}
+		}
+
+		Record* Acquire()
+		{
+			m_ActiveWriters.fetch_add(1);
+			if (!s_Async.load())
+			{
+				m_ActiveWriters.fetch_sub(1);
+				return nullptr;
+			}
+
+			auto position = m_EnqueuePosition.load(std::memory_order_relaxed);
+			while (true)
+			{
+				auto& slot = m_Slots[position % Capacity];
+				const auto sequence = slot.Sequence.load(std::memory_order_acquire);
+				const auto diff = static_cast<std::ptrdiff_t>(sequence - position);
+				if (diff == 0)
+				{
+					if (m_EnqueuePosition.compare_exchange_weak(position, position + 1,
+					                                            std::memory_order_relaxed))
+					{
+						return &slot.Data;
+					}
+				}
+				else if (diff < 0)
+				{
+					// 日志线程等待自己腾出空间将导致死锁，总是丢弃
+					if (m_Policy == OverflowPolicy::Drop || t_IsLogThread)
+					{
+						m_DroppedCount.fetch_add(1, std::memory_order_relaxed);
+						m_ActiveWriters.fetch_sub(1);
+						return nullptr;
+					}
+					Notify();
+					std::this_thread::yield();
+					position = m_EnqueuePosition.load(std::memory_order_relaxed);
+				}
+				else
+				{
+					position = m_EnqueuePosition.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		void Publish(Record* record)
+		{
+			const auto offset =
+			    reinterpret_cast<std::byte*>(record) - reinterpret_cast<std::byte*>(m_Slots.get());
+			const auto index = static_cast<std::size_t>(offset) / sizeof(Slot);
+			auto& sequence = m_Slots[index].Sequence;
+			sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+			m_ActiveWriters.fetch_sub(1);
+			Notify();
+		}
+
+		AsyncBackend(AsyncBackend const&) = delete;
+		AsyncBackend& operator=(AsyncBackend const&) = delete;
+
+	private:
+		struct Slot
+		{
+			std::atomic<std::size_t> Sequence;
+			Record Data;
+		};
+
+		static thread_local bool t_IsLogThread;
+
+		std::unique_ptr<Slot[]> m_Slots;
+		std::atomic<std::size_t> m_EnqueuePosition{};
+		// 仅由日志线程访问
+		std::size_t m_DequeuePosition{};
+		std::atomic<std::size_t> m_ProcessedPosition{};
+		std::atomic<std::size_t> m_ActiveWriters{};
+		std::atomic<std::size_t> m_DroppedCount{};
+		// 日志线程休眠时等待此值变化，写入者仅在日志线程休眠时唤醒它
+		std::atomic<std::uint32_t> m_Wakeups{};
+		std::atomic<bool> m_Sleeping{};
+		std::atomic<bool> m_Stopping{};
+		OverflowPolicy m_Policy{};
+		std::mutex m_ControlMutex;
+		std::thread m_Thread;
+
+		AsyncBackend() = default;
+
+		~AsyncBackend()
+		{
+			Stop();
+		}
+
+		void Notify()
+		{
+			m_Wakeups.fetch_add(1);
+			if (m_Sleeping.load())
+			{
+				m_Wakeups.notify_one();
+			}
+		}
+
+		bool IsReadable() const
+		{
+			return m_Slots[m_DequeuePosition % Capacity].Sequence.load(std::memory_order_acquire) ==
+			       m_DequeuePosition + 1;
+		}
+
+		static void Handle(Record& record, fmt::memory_buffer& buffer)
+		{
+			const char* text;
+			if (record.Format)
+			{
+				buffer.clear();
+				record.Format(record.FormatString, record.Payload, buffer);
+				buffer.push_back('\0');
+				text = buffer.data();
+			}
+			else if (record.Text)
+			{
+				text = record.Text;
+			}
+			else
+			{
+				text = reinterpret_cast<const char*>(record.Payload);
+			}
+
+			s_Handler(record.MessageLevel, text);
+			delete[] std::exchange(record.Text, nullptr);
+		}
+
+		void Run()
+		{
+			t_IsLogThread = true;
+
+			fmt::memory_buffer buffer;
+			while (true)
+			{
+				bool processed = false;
+				while (IsReadable())
+				{
+					auto& slot = m_Slots[m_DequeuePosition % Capacity];
+					Handle(slot.Data, buffer);
+					slot.Sequence.store(m_DequeuePosition + Capacity, std::memory_order_release);
+					++m_DequeuePosition;
+					m_ProcessedPosition.store(m_DequeuePosition, std::memory_order_release);
+					processed = true;
+				}
+				if (processed)
+				{
+					m_ProcessedPosition.notify_all();
+				}
+
+				if (const auto dropped = m_DroppedCount.exchange(0, std::memory_order_relaxed))
+				{
+					s_Handler(Level::Warn,
+					          fmt::format("UmaPyogin: {} log messages were dropped because the log "
+					                      "buffer is full",
+					                      dropped)
+					              .c_str());
+				}
+
+				if (m_Stopping.load() && m_DequeuePosition == m_EnqueuePosition.load())
+				{
+					break;
+				}
+
+				m_Sleeping.store(true);
+				const auto wakeups = m_Wakeups.load();
+				if (!IsReadable() && !m_Stopping.load())
+				{
+					m_Wakeups.wait(wakeups);
+				}
+				m_Sleeping.store(false);
+			}
+		}
+	};
+
+	thread_local bool Log::AsyncBackend::t_IsLogThread;
 
 	Log::LogHandler Log::s_Handler = nullptr;
+	std::atomic<Log::Level> Log::s_Level{ Log::Level::Debug };
+	std::atomic<bool> Log::s_Async{};
 
 	void Log::SetLogHandler(LogHandler handler)
 	{
 		s_Handler = handler;
 	}
 
+	void Log::SetLevel(Level level)
+	{
+		s_Level.store(level, std::memory_order_relaxed);
+	}
+
+	Log::Level Log::GetLevel()
+	{
+		return s_Level.load(std::memory_order_relaxed);
+	}
+
+	void Log::StartAsync(OverflowPolicy policy)
+	{
+		AsyncBackend::GetInstance().Start(policy);
+	}
+
+	void Log::Flush()
+	{
+		if (s_Async.load(std::memory_order_acquire))
+		{
+			AsyncBackend::GetInstance().Flush();
+		}
+	}
+
+	void Log::Shutdown()
+	{
+		if (s_Async.load(std::memory_order_acquire))
+		{
+			AsyncBackend::GetInstance().Stop();
+		}
+	}
+
 	void Log::Message(Level level, const char* message)
 	{
+		if (!IsEnabled(level))
+		{
+			return;
+		}
+
+		if (s_Async.load(std::memory_order_acquire))
+		{
+			if (const auto record = AcquireRecord())
+			{
+				FillRecord(*record, level, message);
+				PublishRecord(record);
+				return;
+			}
+			if (s_Async.load(std::memory_order_relaxed))
+			{
+				return;
+			}
+		}
+
 		s_Handler(level, message);
 	}
+
+	Log::Record* Log::AcquireRecord()
+	{
+		return AsyncBackend::GetInstance().Acquire();
+	}
+
+	void Log::PublishRecord(Record* record)
+	{
+		AsyncBackend::GetInstance().Publish(record);
+	}
+
+	void Log::FillRecord(Record& record, Level level, std::string_view text)
+	{
+		record.MessageLevel = level;
+		record.Format = nullptr;
+		if (text.size() < Record::PayloadSize)
+		{
+			std::memcpy(record.Payload, text.data(), text.size());
+			record.Payload[text.size()] = std::byte{};
+			record.Text = nullptr;
+		}
+		else
+		{
+			record.Text = new char[text.size() + 1];
+			std::memcpy(record.Text, text.data(), text.size());
+			record.Text[text.size()] = '\0';
+		}
+		record.Size = text.size();
+	}
 } // namespace UmaPyogin
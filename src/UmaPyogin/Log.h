@@ -1,9 +1,21 @@
 #ifndef UMAPYOGIN_LOG_H
 #define UMAPYOGIN_LOG_H
 
+#include <atomic>
 #include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <fmt/format.h>
 
+// 低于此级别的日志在编译期即被移除，可定义为 Debug、Info、Warn 或 Error
+#ifndef UMAPYOGIN_LOG_MIN_LEVEL
+#define UMAPYOGIN_LOG_MIN_LEVEL Debug
+#endif
+
 namespace UmaPyogin
 {
 	class Log final
@@ -22,15 +34,60 @@ namespace UmaPyogin
 #undef DEFINE_LEVEL_ENUM
 		};
 
+		static constexpr Level MinLevel = Level::UMAPYOGIN_LOG_MIN_LEVEL;
+
 		using LogHandler = void (*)(Level level, const char* message);
 
+		// 异步模式下缓冲区已满时的处理方式
+		enum class OverflowPolicy
+		{
+			// 丢弃新消息，之后输出一条记录丢弃数量的警告
+			Drop,
+			// 等待后台线程腾出空间
+			Block,
+		};
+
 		static void SetLogHandler(LogHandler handler);
 
+		// 低于 level 的消息在格式化之前即被丢弃
+		static void SetLevel(Level level);
+		static Level GetLevel();
+
+		static bool IsEnabled(Level level)
+		{
+			return level >= MinLevel && level >= s_Level.load(std::memory_order_relaxed);
+		}
+
+		// 之后的消息写入环形缓冲区，由后台线程格式化并调用日志处理函数，处理函数只会在该线程上调用
+		// 格式字符串须为字面量，参数为算术类型、有 formatter 的枚举或字符串时推迟到后台线程格式化，否则在调用线程上格式化
+		static void StartAsync(OverflowPolicy policy = OverflowPolicy::Drop);
+		// 等待此前写入的消息全部交给日志处理函数
+		static void Flush();
+		// 处理剩余的消息并停止后台线程，之后的消息恢复在调用线程上同步处理，退出时自动调用
+		static void Shutdown();
+
 		static void Message(Level level, const char* message);
 
 		template <typename... Args>
 		static void Message(Level level, fmt::format_string<Args...> message, Args&&... args)
 		{
+			static_assert((IsLoggableArg<Args> && ...),
+			              "enum arguments need a fmt::formatter specialization");
+
+			if (!IsEnabled(level))
+			{
+				return;
+			}
+
+			if constexpr ((IsDeferrable<Args> && ...))
+			{
+				if (s_Async.load(std::memory_order_acquire) &&
+				    PostDeferred(level, fmt::string_view(message), args...))
+				{
+					return;
+				}
+			}
+
 			Message(level, fmt::format(message, std::forward<Args>(args)...).c_str());
 		}
 
@@ -38,14 +95,159 @@ namespace UmaPyogin
 	template <typename... Args>                                                                    \
 	static void name(fmt::format_string<Args...> message, Args&&... args)                          \
 	{                                                                                              \
-		Message(Level::name, message, std::forward<Args>(args)...);                                \
+		if constexpr (Level::name >= MinLevel)                                                     \
+		{                                                                                          \
+			Message(Level::name, message, std::forward<Args>(args)...);                            \
+		}                                                                                          \
 	}
 
 		LOG_LEVELS(DEFINE_LOG_FORWARDER)
 
 #undef DEFINE_LOG_FORWARDER
+
 	private:
+		// 环形缓冲区中的一条消息，参数按顺序紧凑存放，字符串存放长度与内容
+		struct Record
+		{
+			static constexpr std::size_t PayloadSize = 448;
+
+			using Formatter = void (*)(fmt::string_view format, const std::byte* payload,
+			                           fmt::memory_buffer& output);
+
+			Log::Level MessageLevel;
+			// 为空时 Payload 为已格式化的文本，文本过长时另行分配于 Text
+			Formatter Format;
+			fmt::string_view FormatString;
+			char* Text;
+			std::size_t Size;
+			std::byte Payload[PayloadSize];
+		};
+
+		class AsyncBackend;
+
 		static LogHandler s_Handler;
+		static std::atomic<Level> s_Level;
+		static std::atomic<bool> s_Async;
+
+		template <typename T>
+		static constexpr bool IsStringArg = std::is_convertible_v<const T&, std::string_view>;
+
+		// 没有 formatter 的枚举会经由 fmt 已弃用的隐式转换输出为数值，不允许作为参数
+		template <typename T>
+		static constexpr bool IsFormattableEnum =
+		    std::is_enum_v<T> && fmt::has_formatter<T, fmt::format_context>::value;
+
+		template <typename T>
+		static constexpr bool IsLoggableArg =
+		    !std::is_enum_v<std::decay_t<T>> || IsFormattableEnum<std::decay_t<T>>;
+
+		template <typename T>
+		static constexpr bool IsDeferrable =
+		    IsStringArg<std::decay_t<T>> || std::is_arithmetic_v<std::decay_t<T>> ||
+		    IsFormattableEnum<std::decay_t<T>>;
+
+		template <typename T>
+		using DecodedArg = std::conditional_t<IsStringArg<std::decay_t<T>>, std::string_view,
+		                                      std::decay_t<T>>;
+
+		template <typename T>
+		static bool EncodeArg(std::byte* payload, std::size_t& offset, T const& arg)
+		{
+			if constexpr (IsStringArg<T>)
+			{
+				const std::string_view str(arg);
+				if (Record::PayloadSize - offset < sizeof(std::size_t) ||
+				    Record::PayloadSize - offset - sizeof(std::size_t) < str.size())
+				{
+					return false;
+				}
+				const auto size = str.size();
+				std::memcpy(payload + offset, &size, sizeof(size));
+				std::memcpy(payload + offset + sizeof(size), str.data(), size);
+				offset += sizeof(size) + size;
+			}
+			else
+			{
+				if (Record::PayloadSize - offset < sizeof(T))
+				{
+					return false;
+				}
+				std::memcpy(payload + offset, &arg, sizeof(T));
+				offset += sizeof(T);
+			}
+			return true;
+		}
+
+		template <typename T>
+		static DecodedArg<T> DecodeArg(const std::byte* payload, std::size_t& offset)
+		{
+			if constexpr (IsStringArg<std::decay_t<T>>)
+			{
+				std::size_t size;
+				std::memcpy(&size, payload + offset, sizeof(size));
+				const auto data = reinterpret_cast<const char*>(payload + offset + sizeof(size));
+				offset += sizeof(size) + size;
+				return std::string_view(data, size);
+			}
+			else
+			{
+				std::decay_t<T> value;
+				std::memcpy(&value, payload + offset, sizeof(value));
+				offset += sizeof(value);
+				return value;
+			}
+		}
+
+		template <typename... Args>
+		// 无参数时不会读取 payload
+		static void FormatDeferred(fmt::string_view format,
+		                           [[maybe_unused]] const std::byte* payload,
+		                           fmt::memory_buffer& output)
+		{
+			[[maybe_unused]] std::size_t offset = 0;
+			// 花括号初始化保证按从左到右的顺序解码
+			const std::tuple<DecodedArg<Args>...> args{ DecodeArg<Args>(payload, offset)... };
+			std::apply(
+			    [&](const auto&... values) {
+				    fmt::vformat_to(fmt::appender(output), format,
+				                    fmt::make_format_args(values...));
+			    },
+			    args);
+		}
+
+		template <typename... Args>
+		static bool PostDeferred(Level level, fmt::string_view format, const Args&... args)
+		{
+			const auto record = AcquireRecord();
+			if (!record)
+			{
+				// 已丢弃或后台线程已停止，后者返回 false 以同步处理
+				return s_Async.load(std::memory_order_relaxed);
+			}
+
+			std::size_t offset = 0;
+			if ((EncodeArg(record->Payload, offset, args) && ...))
+			{
+				record->MessageLevel = level;
+				record->Format = &FormatDeferred<Args...>;
+				record->FormatString = format;
+				record->Text = nullptr;
+				record->Size = offset;
+			}
+			else
+			{
+				// 参数过长，改为在调用线程上格式化
+				FillRecord(*record, level, fmt::vformat(format, fmt::make_format_args(args...)));
+			}
+			PublishRecord(record);
+			return true;
+		}
+
+		// 异步模式下返回可写入的记录，写入后需调用 PublishRecord
+		// 缓冲区已满而丢弃消息或后台线程已停止时返回 nullptr
+		static Record* AcquireRecord();
+		static void PublishRecord(Record* record);
+		static void FillRecord(Record& record, Level level, std::string_view text);
 	};
 } // namespace UmaPyogin
 
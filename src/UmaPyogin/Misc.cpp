@@ -1,19 +1,512 @@
 #include "Misc.h"
 
-#include <codecvt>
-#include <locale>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace UmaPyogin::Misc
 {
-	std::u16string ToUTF16(const std::string_view& str)
+	MappedFile::MappedFile(std::filesystem::path const& path)
+	{
+#ifdef _WIN32
+		const auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return;
+		}
+		m_FileHandle = file;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			Close();
+			return;
+		}
+
+		m_MappingHandle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!m_MappingHandle)
+		{
+			Close();
+			return;
+		}
+
+		m_Data = static_cast<const std::byte*>(
+		    MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+		if (!m_Data)
+		{
+			Close();
+			return;
+		}
+		m_Size = static_cast<std::size_t>(size.QuadPart);
+#else
+		const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd == -1)
+		{
+			return;
+		}
+
+		struct stat st;
+		if (fstat(fd, &st) == -1 || st.st_size == 0)
+		{
+			close(fd);
+			return;
+		}
+
+		const auto size = static_cast<std::size_t>(st.st_size);
+		const auto data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+		// 映射建立后即可关闭文件描述符
+		close(fd);
+		if (data == MAP_FAILED)
+		{
+			return;
+		}
+
+		m_Data = static_cast<const std::byte*>(data);
+		m_Size = size;
+#endif
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+	    : m_Data(std::exchange(other.m_Data, nullptr)), m_Size(std::exchange(other.m_Size, 0))
+#ifdef _WIN32
+	      ,
+	      m_FileHandle(std::exchange(other.m_FileHandle, nullptr)),
+	      m_MappingHandle(std::exchange(other.m_MappingHandle, nullptr))
+#endif
+	{
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Close();
+			m_Data = std::exchange(other.m_Data, nullptr);
+			m_Size = std::exchange(other.m_Size, 0);
+#ifdef _WIN32
+			m_FileHandle = std::exchange(other.m_FileHandle, nullptr);
+			m_MappingHandle = std::exchange(other.m_MappingHandle, nullptr);
+#endif
+		}
+		return *this;
+	}
+
+	bool MappedFile::IsOpen() const
+	{
+		return m_Data != nullptr;
+	}
+
+	const std::byte* MappedFile::Data() const
+	{
+		return m_Data;
+	}
+
+	std::size_t MappedFile::Size() const
 	{
-		std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> utf16conv;
-		return utf16conv.from_bytes(str.data(), str.data() + str.size());
+		return m_Size;
 	}
 
-	std::string ToUTF8(const std::u16string_view& str)
+	std::size_t MappedFile::TailSize() const
 	{
-		std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> utf16conv;
-		return utf16conv.to_bytes(str.data(), str.data() + str.size());
+		if (!m_Data)
+		{
+			return 0;
+		}
+
+#ifdef _WIN32
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		const auto pageSize = static_cast<std::size_t>(info.dwPageSize);
+#else
+		static const auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+		const auto remainder = m_Size % pageSize;
+		return remainder ? pageSize - remainder : 0;
+	}
+
+	void MappedFile::AdviseSequential() const
+	{
+#ifndef _WIN32
+		if (m_Data)
+		{
+			madvise(const_cast<std::byte*>(m_Data), m_Size, MADV_SEQUENTIAL);
+		}
+#endif
+	}
+
+	void MappedFile::Close()
+	{
+#ifdef _WIN32
+		if (m_Data)
+		{
+			UnmapViewOfFile(m_Data);
+		}
+		if (m_MappingHandle)
+		{
+			CloseHandle(m_MappingHandle);
+		}
+		if (m_FileHandle)
+		{
+			CloseHandle(m_FileHandle);
+		}
+		m_FileHandle = nullptr;
+		m_MappingHandle = nullptr;
+#else
+		if (m_Data)
+		{
+			munmap(const_cast<std::byte*>(m_Data), m_Size);
+		}
+#endif
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+
+	std::size_t GetPeakResidentSetSize()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		{
+			return 0;
+		}
+		return counters.PeakWorkingSetSize;
+#else
+		rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) == -1)
+		{
+			return 0;
+		}
+#ifdef __APPLE__
+		return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+		// Linux 以 KiB 为单位
+		return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
 	}
 } // namespace UmaPyogin::Misc
+
+namespace UmaPyogin::Misc::Rcu
+{
+	namespace
+	{
+		// 每个进入过读端的线程占用一条记录，线程退出后记录可被复用，记录本身不会释放
+		struct ReaderRecord
+		{
+			// 所在读端开始时的全局纪元，0 表示不在读端内
+			std::atomic<std::uint64_t> Epoch{};
+			std::atomic<bool> InUse{};
+			ReaderRecord* Next{};
+			// 仅由所属线程访问
+			std::size_t Nesting{};
+		};
+
+		std::atomic<ReaderRecord*> s_Readers;
+		std::atomic<std::uint64_t> s_GlobalEpoch{ 1 };
+
+		ReaderRecord* AcquireRecord()
+		{
+			for (auto record = s_Readers.load(std::memory_order_acquire); record;
+			     record = record->Next)
+			{
+				auto expected = false;
+				if (!record->InUse.load(std::memory_order_relaxed) &&
+				    record->InUse.compare_exchange_strong(expected, true,
+				                                          std::memory_order_acquire))
+				{
+					return record;
+				}
+			}
+
+			const auto record = new ReaderRecord;
+			record->InUse.store(true, std::memory_order_relaxed);
+			record->Next = s_Readers.load(std::memory_order_relaxed);
+			while (!s_Readers.compare_exchange_weak(record->Next, record,
+			                                        std::memory_order_release,
+			                                        std::memory_order_relaxed))
+			{
+			}
+			return record;
+		}
+
+		struct ThreadRecord
+		{
+			ReaderRecord* Record = AcquireRecord();
+
+			~ThreadRecord()
+			{
+				Record->InUse.store(false, std::memory_order_release);
+			}
+		};
+
+		thread_local ThreadRecord t_Record;
+	} // namespace
+
+	ReadGuard::ReadGuard()
+	{
+		const auto record = t_Record.Record;
+		if (record->Nesting++)
+		{
+			return;
+		}
+		record->Epoch.store(s_GlobalEpoch.load(std::memory_order_relaxed),
+		                    std::memory_order_relaxed);
+		// 保证纪元先于之后读取的指针对写入方可见
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+
+	ReadGuard::~ReadGuard()
+	{
+		const auto record = t_Record.Record;
+		if (--record->Nesting)
+		{
+			return;
+		}
+		record->Epoch.store(0, std::memory_order_release);
+	}
+
+	void Synchronize()
+	{
+		// 纪元不大于 epoch 的读端可能仍持有旧指针，之后进入的读端只能读到新指针
+		const auto epoch = s_GlobalEpoch.fetch_add(1, std::memory_order_seq_cst);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		for (auto record = s_Readers.load(std::memory_order_acquire); record;
+		     record = record->Next)
+		{
+			while (true)
+			{
+				const auto readerEpoch = record->Epoch.load(std::memory_order_acquire);
+				if (!readerEpoch || readerEpoch > epoch)
+				{
+					break;
+				}
+				std::this_thread::yield();
+			}
+		}
+	}
+} // namespace UmaPyogin::Misc::Rcu
+
+namespace UmaPyogin::Misc::Parallel
+{
+	namespace
+	{
+		// 当前线程所属的线程池及其队列下标，用于让工作线程提交的任务优先进入自己的队列
+		thread_local ThreadPool* t_CurrentPool;
+		thread_local std::size_t t_CurrentQueue;
+	} // namespace
+
+	ThreadPool::ThreadPool(std::size_t threadCount)
+	{
+		threadCount = std::max<std::size_t>(threadCount, 1);
+		m_Queues.reserve(threadCount);
+		for (std::size_t i = 0; i < threadCount; ++i)
+		{
+			m_Queues.emplace_back(std::make_unique<TaskQueue>());
+		}
+		m_Threads.reserve(threadCount);
+		for (std::size_t i = 0; i < threadCount; ++i)
+		{
+			m_Threads.emplace_back([this, i] { WorkerMain(i); });
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::unique_lock lock(m_SleepMutex);
+			m_Stopping = true;
+		}
+		m_SleepCondition.notify_all();
+		for (auto& thread : m_Threads)
+		{
+			thread.join();
+		}
+	}
+
+	ThreadPool& ThreadPool::GetInstance()
+	{
+		static ThreadPool s_Instance;
+		return s_Instance;
+	}
+
+	std::size_t ThreadPool::GetThreadCount() const
+	{
+		return m_Threads.size();
+	}
+
+	void ThreadPool::Submit(std::function<void()> task)
+	{
+		const auto queueIndex = t_CurrentPool == this
+		                            ? t_CurrentQueue
+		                            : m_NextQueue.fetch_add(1, std::memory_order_relaxed) %
+		                                  m_Queues.size();
+		{
+			auto& queue = *m_Queues[queueIndex];
+			std::unique_lock lock(queue.Mutex);
+			queue.Tasks.emplace_back(std::move(task));
+		}
+		{
+			std::unique_lock lock(m_SleepMutex);
+			++m_PendingCount;
+		}
+		m_SleepCondition.notify_one();
+	}
+
+	bool ThreadPool::RunPendingTask()
+	{
+		const auto task = TakeTask(t_CurrentPool == this ? t_CurrentQueue : 0);
+		if (!task)
+		{
+			return false;
+		}
+		task();
+		return true;
+	}
+
+	std::function<void()> ThreadPool::TakeTask(std::size_t preferredQueue)
+	{
+		std::function<void()> task;
+		// 自己的队列从尾部取出，以保持局部性；窃取时从其他队列头部取出
+		{
+			auto& queue = *m_Queues[preferredQueue];
+			std::unique_lock lock(queue.Mutex);
+			if (!queue.Tasks.empty())
+			{
+				task = std::move(queue.Tasks.back());
+				queue.Tasks.pop_back();
+			}
+		}
+		for (std::size_t i = 1; !task && i < m_Queues.size(); ++i)
+		{
+			auto& queue = *m_Queues[(preferredQueue + i) % m_Queues.size()];
+			std::unique_lock lock(queue.Mutex);
+			if (!queue.Tasks.empty())
+			{
+				task = std::move(queue.Tasks.front());
+				queue.Tasks.pop_front();
+			}
+		}
+
+		if (task)
+		{
+			std::unique_lock lock(m_SleepMutex);
+			--m_PendingCount;
+		}
+		return task;
+	}
+
+	void ThreadPool::WorkerMain(std::size_t index)
+	{
+		t_CurrentPool = this;
+		t_CurrentQueue = index;
+
+		while (true)
+		{
+			if (const auto task = TakeTask(index))
+			{
+				task();
+				continue;
+			}
+
+			std::unique_lock lock(m_SleepMutex);
+			m_SleepCondition.wait(lock, [this] { return m_Stopping || m_PendingCount; });
+			if (m_Stopping)
+			{
+				return;
+			}
+		}
+	}
+
+	TaskGroup::TaskGroup(ThreadPool& pool) : m_Pool(pool)
+	{
+	}
+
+	TaskGroup::~TaskGroup()
+	{
+		try
+		{
+			Wait();
+		}
+		catch (...)
+		{
+		}
+	}
+
+	void TaskGroup::Run(std::function<void()> task)
+	{
+		{
+			std::unique_lock lock(m_Mutex);
+			++m_PendingCount;
+		}
+		m_Pool.Submit([this, task = std::move(task)] {
+			try
+			{
+				task();
+			}
+			catch (...)
+			{
+				std::unique_lock lock(m_Mutex);
+				if (!m_Exception)
+				{
+					m_Exception = std::current_exception();
+				}
+			}
+
+			std::unique_lock lock(m_Mutex);
+			if (!--m_PendingCount)
+			{
+				m_Condition.notify_all();
+			}
+		});
+	}
+
+	void TaskGroup::Wait()
+	{
+		while (true)
+		{
+			{
+				std::unique_lock lock(m_Mutex);
+				if (!m_PendingCount)
+				{
+					break;
+				}
+			}
+
+			// 协助执行任务，避免在工作线程中等待时发生死锁
+			if (m_Pool.RunPendingTask())
+			{
+				continue;
+			}
+
+			std::unique_lock lock(m_Mutex);
+			m_Condition.wait_for(lock, std::chrono::milliseconds(1),
+			                     [this] { return !m_PendingCount; });
+		}
+
+		std::unique_lock lock(m_Mutex);
+		if (const auto exception = std::exchange(m_Exception, nullptr))
+		{
+			std::rethrow_exception(exception);
+		}
+	}
+} // namespace UmaPyogin::Misc::Parallel
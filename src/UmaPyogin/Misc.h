@@ -1,7 +1,17 @@
 #ifndef UMAPYOGIN_MISC_H
 #define UMAPYOGIN_MISC_H
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
 #include <iterator>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
 #include <thread>
@@ -22,11 +32,207 @@ namespace UmaPyogin
 
 	namespace Misc
 	{
+		struct TranscodeResult
+		{
+			// 写入输出的代码单元数
+			std::size_t Length;
+			// 首个非法序列在输入中的位置，转换成功时为 npos
+			std::size_t ErrorPosition;
+
+			static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+			explicit operator bool() const
+			{
+				return ErrorPosition == npos;
+			}
+		};
+
+		// 非法序列以 U+FFFD 替换，不会抛出异常
 		std::u16string ToUTF16(const std::string_view& str);
 		std::string ToUTF8(const std::u16string_view& str);
 
+		// 严格转换，遇到非法序列时停止并报告其位置
+		// 写入调用方提供的缓冲区时，output 至少需容纳 str.size() 个代码单元
+		TranscodeResult ToUTF16(std::string_view str, char16_t* output);
+		// output 原有内容被覆盖，长度调整为实际写入的长度，可复用其已分配的空间
+		TranscodeResult ToUTF16(std::string_view str, std::u16string& output);
+		// output 至少需容纳 str.size() * 3 个字节
+		TranscodeResult ToUTF8(std::u16string_view str, char* output);
+		TranscodeResult ToUTF8(std::u16string_view str, std::string& output);
+
+		// 只读映射整个文件，映射失败时 IsOpen() 返回 false
+		class MappedFile
+		{
+		public:
+			MappedFile() = default;
+			explicit MappedFile(std::filesystem::path const& path);
+			~MappedFile();
+
+			MappedFile(MappedFile&& other) noexcept;
+			MappedFile& operator=(MappedFile&& other) noexcept;
+
+			MappedFile(MappedFile const&) = delete;
+			MappedFile& operator=(MappedFile const&) = delete;
+
+			bool IsOpen() const;
+			const std::byte* Data() const;
+			std::size_t Size() const;
+			// 文件末尾之后仍可读取的字节数，即最后一页中超出文件的部分，其内容为 0
+			std::size_t TailSize() const;
+
+			// 提示将顺序读取整个映射，以便系统预读并尽早回收已读的页
+			void AdviseSequential() const;
+
+		private:
+			void Close();
+
+			const std::byte* m_Data{};
+			std::size_t m_Size{};
+#ifdef _WIN32
+			void* m_FileHandle{};
+			void* m_MappingHandle{};
+#endif
+		};
+
+		// 进程启动以来的峰值常驻内存（字节），无法取得时返回 0
+		std::size_t GetPeakResidentSetSize();
+
+		// 读端无锁的数据发布：读取方在 ReadGuard 的作用域内读取指针并使用其指向的数据，
+		// 写入方替换指针后等待此前进入的读端全部退出，再释放旧数据
+		namespace Rcu
+		{
+			// 可嵌套，不会阻塞
+			class ReadGuard
+			{
+			public:
+				ReadGuard();
+				~ReadGuard();
+
+				ReadGuard(ReadGuard const&) = delete;
+				ReadGuard& operator=(ReadGuard const&) = delete;
+			};
+
+			// 等待调用前已进入的读端全部退出，不能在读端内调用
+			void Synchronize();
+
+			// 发布新数据，并在读端不再持有旧数据后将其释放
+			template <typename T>
+			void Replace(std::atomic<const T*>& target, std::unique_ptr<const T> value)
+			{
+				const std::unique_ptr<const T> old(
+				    target.exchange(value.release(), std::memory_order_seq_cst));
+				if (old)
+				{
+					Synchronize();
+				}
+			}
+		} // namespace Rcu
+
 		namespace Parallel
 		{
+			// 常驻线程池，每个工作线程拥有自己的任务队列，空闲时从其他队列窃取任务
+			class ThreadPool
+			{
+			public:
+				explicit ThreadPool(std::size_t threadCount = std::thread::hardware_concurrency());
+				~ThreadPool();
+
+				static ThreadPool& GetInstance();
+
+				std::size_t GetThreadCount() const;
+
+				void Submit(std::function<void()> task);
+
+				// 在当前线程执行一个待处理的任务，没有任务时返回 false
+				bool RunPendingTask();
+
+				ThreadPool(ThreadPool const&) = delete;
+				ThreadPool& operator=(ThreadPool const&) = delete;
+
+			private:
+				struct TaskQueue
+				{
+					std::mutex Mutex;
+					std::deque<std::function<void()>> Tasks;
+				};
+
+				void WorkerMain(std::size_t index);
+				std::function<void()> TakeTask(std::size_t preferredQueue);
+
+				std::vector<std::unique_ptr<TaskQueue>> m_Queues;
+				std::vector<std::thread> m_Threads;
+				std::atomic<std::size_t> m_NextQueue{};
+
+				std::mutex m_SleepMutex;
+				std::condition_variable m_SleepCondition;
+				std::size_t m_PendingCount{};
+				bool m_Stopping{};
+			};
+
+			// 一组可等待的任务，等待时当前线程会协助执行线程池中的任务
+			// 任务抛出的第一个异常会在 Wait 中重新抛出
+			class TaskGroup
+			{
+			public:
+				explicit TaskGroup(ThreadPool& pool = ThreadPool::GetInstance());
+				~TaskGroup();
+
+				void Run(std::function<void()> task);
+				void Wait();
+
+				TaskGroup(TaskGroup const&) = delete;
+				TaskGroup& operator=(TaskGroup const&) = delete;
+
+			private:
+				ThreadPool& m_Pool;
+				std::mutex m_Mutex;
+				std::condition_variable m_Condition;
+				std::size_t m_PendingCount{};
+				std::exception_ptr m_Exception;
+			};
+
+			// 对 [0, count) 中的每个下标调用 func，各线程动态领取下标，调用方线程也参与执行
+			template <typename Callable>
+			void ForEachIndex(std::size_t count, Callable&& func,
+			                  std::size_t concurrentSize = std::thread::hardware_concurrency())
+			{
+				if (!count)
+				{
+					return;
+				}
+
+				std::atomic<std::size_t> next{};
+				const auto worker = [&] {
+					for (auto i = next.fetch_add(1, std::memory_order_relaxed); i < count;
+					     i = next.fetch_add(1, std::memory_order_relaxed))
+					{
+						func(i);
+					}
+				};
+
+				const auto workerCount = std::min(std::max<std::size_t>(concurrentSize, 1), count);
+				TaskGroup group;
+				for (std::size_t i = 1; i < workerCount; ++i)
+				{
+					group.Run(worker);
+				}
+				// 调用方线程的异常需等待其他任务结束后再传播，避免任务引用已销毁的局部变量
+				std::exception_ptr exception;
+				try
+				{
+					worker();
+				}
+				catch (...)
+				{
+					exception = std::current_exception();
+				}
+				group.Wait();
+				if (exception)
+				{
+					std::rethrow_exception(exception);
+				}
+			}
+
 #if HAS_CONCEPTS
 			template <std::forward_iterator ForwardIterator, typename Sentinel, typename Callable>
 			void
@@ -39,32 +245,13 @@ namespace UmaPyogin
 			ForEach(ForwardIterator begin, Sentinel end, Callable&& func,
 			        std::size_t concurrentSize = std::thread::hardware_concurrency())
 			{
-				std::vector<std::thread> threads(concurrentSize);
-				std::size_t totalSize = 0;
-				auto it = begin;
-				// std::distance 无法处理 Sentinel，因此手动计算
-				while (it != end)
+				std::vector<ForwardIterator> iterators;
+				for (auto it = begin; it != end; ++it)
 				{
-					++totalSize;
-					++it;
-				}
-				const auto chunkSize = totalSize / concurrentSize;
-				it = begin;
-				for (auto i = 0; i < concurrentSize; ++i)
-				{
-					it = std::next(it, chunkSize);
-					threads[i] = std::thread([&, it]() mutable {
-						for (auto j = 0; j < chunkSize; ++j)
-						{
-							std::forward<Callable>(func)(*it);
-							++it;
-						}
-					});
-				}
-				for (auto& t : threads)
-				{
-					t.join();
+					iterators.emplace_back(it);
 				}
+				ForEachIndex(
+				    iterators.size(), [&](std::size_t i) { func(*iterators[i]); }, concurrentSize);
 			}
 
 #if HAS_CONCEPTS
@@ -79,23 +266,10 @@ namespace UmaPyogin
 			OnePassForEach(InputIterator begin, Sentinel end, Callable&& func,
 			               std::size_t concurrentSize = std::thread::hardware_concurrency())
 			{
-				std::vector<std::thread> threads(concurrentSize);
 				std::vector values(begin, end);
-				const auto totalSize = values.size();
-				const auto chunkSize = totalSize / concurrentSize;
-				for (auto i = 0; i < concurrentSize; ++i)
-				{
-					threads[i] = std::thread([&, base = i * chunkSize]() {
-						for (auto j = 0; j < chunkSize; ++j)
-						{
-							std::forward<Callable>(func)(std::move(values[base + j]));
-						}
-					});
-				}
-				for (auto& t : threads)
-				{
-					t.join();
-				}
+				ForEachIndex(
+				    values.size(), [&](std::size_t i) { func(std::move(values[i])); },
+				    concurrentSize);
 			}
 		} // namespace Parallel
 	}     // namespace Misc
@@ -2,6 +2,8 @@
 #include "Hook.h"
 #include "Localization.h"
 
+#include <algorithm>
+
 namespace UmaPyogin
 {
 	HookInstaller::~HookInstaller()
@@ -22,6 +24,17 @@ namespace UmaPyogin
 	void Plugin::LoadConfig(Config&& config)
 	{
 		m_Config = std::move(config);
+
+		Log::SetLevel(static_cast<Log::Level>(
+		    std::clamp<std::int64_t>(m_Config.LogLevel, 0, static_cast<int>(Log::Level::Error))));
+		if (m_Config.EnableAsyncLog)
+		{
+			Log::StartAsync();
+		}
+		if (!m_Config.TraceFilePath.empty())
+		{
+			Trace::Start(m_Config.TraceFilePath);
+		}
 	}
 
 	void Plugin::InstallHook(std::unique_ptr<HookInstaller>&& hookInstaller)
@@ -39,4 +52,38 @@ namespace UmaPyogin
 	{
 		return m_HookInstaller.get();
 	}
+
+	std::array<Profiler::HookStatistics, Profiler::HookCount> Plugin::GetHookStatistics() const
+	{
+		return Profiler::Collect();
+	}
+
+	std::vector<Profiler::ThreadStatistics> Plugin::GetHookStatisticsPerThread() const
+	{
+		return Profiler::CollectPerThread();
+	}
+
+	Il2CppStringCache::Statistics Plugin::GetStringCacheStatistics() const
+	{
+		return Il2CppStringCache::GetInstance().GetStatistics();
+	}
+
+	void Plugin::DumpHookStatistics() const
+	{
+		Profiler::Dump();
+
+		const auto cache = GetStringCacheStatistics();
+		Log::Info("UmaPyogin: String cache: {} hits, {} misses, {} evictions, {} entries, {} bytes",
+		          cache.Hits, cache.Misses, cache.Evictions, cache.Entries, cache.Bytes);
+	}
+
+	bool Plugin::StartTrace(std::filesystem::path const& path)
+	{
+		return Trace::Start(path);
+	}
+
+	void Plugin::StopTrace()
+	{
+		Trace::Stop();
+	}
 } // namespace UmaPyogin
@@ -6,14 +6,21 @@
 #include "Config.h"
 #include "Log.h"
 #include "Misc.h"
+#include "Profiler.h"
+#include "StringCache.h"
+#include "Trace.h"
 
 namespace UmaPyogin
 {
+	// 插件对宿主环境的全部依赖：il2cpp 的函数均通过 LookupSymbol 取得，不直接访问进程中的符号，
+	// 因此实现返回进程内模拟函数的 HookInstaller 即可在游戏之外运行 Plugin::InstallHook 之后的全部流程
 	struct HookInstaller
 	{
 		virtual ~HookInstaller();
+		// 使对 addr 的调用转到 hook，并将调用原函数所用的地址写入 *orig
 		virtual void InstallHook(OpaqueFunctionPointer addr, OpaqueFunctionPointer hook,
 		                         OpaqueFunctionPointer* orig) = 0;
+		// 找不到时返回 nullptr
 		virtual OpaqueFunctionPointer LookupSymbol(const char* name) = 0;
 	};
 
@@ -29,6 +36,18 @@ namespace UmaPyogin
 		Config const& GetConfig() const;
 		HookInstaller* GetHookInstaller() const;
 
+		// 各钩子的调用统计，未以 UMAPYOGIN_ENABLE_PROFILING 构建时均为 0
+		std::array<Profiler::HookStatistics, Profiler::HookCount> GetHookStatistics() const;
+		std::vector<Profiler::ThreadStatistics> GetHookStatisticsPerThread() const;
+		// 本地化文本的托管字符串缓存的命中与淘汰统计，不依赖 UMAPYOGIN_ENABLE_PROFILING
+		Il2CppStringCache::Statistics GetStringCacheStatistics() const;
+		// 同时输出字符串缓存的统计
+		void DumpHookStatistics() const;
+
+		// 将钩子收到的调用录制到 path，供 UmaPyoginTraceReplay 回放
+		bool StartTrace(std::filesystem::path const& path);
+		void StopTrace();
+
 		Plugin(Plugin const&) = delete;
 		Plugin& operator=(Plugin const&) = delete;
 
@@ -0,0 +1,268 @@
+#include "Profiler.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+
+namespace UmaPyogin::Profiler
+{
+	namespace
+	{
+		constexpr const char* HookNames[] = {
+#define DEFINE_HOOK_NAME(name) #name,
+			UMAPYOGIN_PROFILED_HOOKS(DEFINE_HOOK_NAME)
+#undef DEFINE_HOOK_NAME
+		};
+
+		// 计数器只由所属线程写入，无需原子的读-改-写，使用原子变量只是为了其他线程可以并发读取
+		void Add(std::atomic<std::uint64_t>& counter, std::uint64_t value)
+		{
+			counter.store(counter.load(std::memory_order_relaxed) + value,
+			              std::memory_order_relaxed);
+		}
+
+		struct HookCounters
+		{
+			std::atomic<std::uint64_t> CallCount;
+			std::atomic<std::uint64_t> HitCount;
+			std::atomic<std::uint64_t> MissCount;
+			std::atomic<std::uint64_t> TotalNanoseconds;
+			std::atomic<std::uint64_t> MaxNanoseconds;
+			std::array<std::atomic<std::uint64_t>, Histogram::BucketCount> Buckets;
+		};
+
+		// 每个线程独占一份记录，记录加入无锁链表后不再释放，线程退出后可被新线程接管
+		struct alignas(64) ThreadRecord
+		{
+			std::size_t Index;
+			std::atomic<bool> InUse;
+			ThreadRecord* Next;
+			std::array<HookCounters, HookCount> Hooks;
+		};
+
+		std::atomic<ThreadRecord*> ThreadRecordList;
+		std::atomic<std::size_t> ThreadRecordCount;
+
+		ThreadRecord* AcquireThreadRecord()
+		{
+			for (auto record = ThreadRecordList.load(std::memory_order_acquire); record;
+			     record = record->Next)
+			{
+				bool inUse = false;
+				if (!record->InUse.load(std::memory_order_relaxed) &&
+				    record->InUse.compare_exchange_strong(inUse, true, std::memory_order_acquire))
+				{
+					return record;
+				}
+			}
+
+			const auto record = new ThreadRecord{};
+			record->Index = ThreadRecordCount.fetch_add(1, std::memory_order_relaxed);
+			record->InUse.store(true, std::memory_order_relaxed);
+			record->Next = ThreadRecordList.load(std::memory_order_relaxed);
+			while (!ThreadRecordList.compare_exchange_weak(
+			    record->Next, record, std::memory_order_release, std::memory_order_relaxed))
+			{
+			}
+			return record;
+		}
+
+		struct ThreadRecordHolder
+		{
+			ThreadRecord* Record = AcquireThreadRecord();
+
+			~ThreadRecordHolder()
+			{
+				Record->InUse.store(false, std::memory_order_release);
+			}
+		};
+
+		HookStatistics Snapshot(HookCounters const& counters)
+		{
+			HookStatistics statistics{};
+			statistics.CallCount = counters.CallCount.load(std::memory_order_relaxed);
+			statistics.HitCount = counters.HitCount.load(std::memory_order_relaxed);
+			statistics.MissCount = counters.MissCount.load(std::memory_order_relaxed);
+			statistics.TotalNanoseconds = counters.TotalNanoseconds.load(std::memory_order_relaxed);
+			statistics.MaxNanoseconds = counters.MaxNanoseconds.load(std::memory_order_relaxed);
+			for (std::size_t i = 0; i < Histogram::BucketCount; ++i)
+			{
+				statistics.Latency.Buckets[i] = counters.Buckets[i].load(std::memory_order_relaxed);
+			}
+			return statistics;
+		}
+	} // namespace
+
+	const char* GetHookName(HookId hook)
+	{
+		return HookNames[static_cast<std::size_t>(hook)];
+	}
+
+	std::size_t Histogram::GetBucketIndex(std::uint64_t nanoseconds)
+	{
+		if (nanoseconds < SubBucketCount)
+		{
+			return static_cast<std::size_t>(nanoseconds);
+		}
+
+		const auto exponent = static_cast<std::size_t>(std::bit_width(nanoseconds)) - 1;
+		if (exponent >= MaxExponent)
+		{
+			return BucketCount - 1;
+		}
+		const auto subBucket = (nanoseconds >> (exponent - SubBucketBits)) & (SubBucketCount - 1);
+		return (exponent - SubBucketBits + 1) * SubBucketCount +
+		       static_cast<std::size_t>(subBucket);
+	}
+
+	std::uint64_t Histogram::GetBucketLowerBound(std::size_t index)
+	{
+		if (index < SubBucketCount)
+		{
+			return index;
+		}
+
+		const auto exponent = index / SubBucketCount + SubBucketBits - 1;
+		const auto subBucket = index % SubBucketCount;
+		return static_cast<std::uint64_t>(SubBucketCount + subBucket) << (exponent - SubBucketBits);
+	}
+
+	Histogram& Histogram::operator+=(Histogram const& other)
+	{
+		for (std::size_t i = 0; i < BucketCount; ++i)
+		{
+			Buckets[i] += other.Buckets[i];
+		}
+		return *this;
+	}
+
+	std::uint64_t Histogram::GetCount() const
+	{
+		std::uint64_t count{};
+		for (const auto bucket : Buckets)
+		{
+			count += bucket;
+		}
+		return count;
+	}
+
+	std::uint64_t Histogram::GetPercentile(double ratio) const
+	{
+		const auto count = GetCount();
+		if (!count)
+		{
+			return 0;
+		}
+
+		const auto target = std::max<std::uint64_t>(
+		    static_cast<std::uint64_t>(std::ceil(static_cast<double>(count) * ratio)), 1);
+		std::uint64_t accumulated{};
+		for (std::size_t i = 0; i < BucketCount; ++i)
+		{
+			accumulated += Buckets[i];
+			if (accumulated >= target)
+			{
+				return i + 1 < BucketCount ? GetBucketLowerBound(i + 1) : GetBucketLowerBound(i);
+			}
+		}
+		return GetBucketLowerBound(BucketCount - 1);
+	}
+
+	HookStatistics& HookStatistics::operator+=(HookStatistics const& other)
+	{
+		CallCount += other.CallCount;
+		HitCount += other.HitCount;
+		MissCount += other.MissCount;
+		TotalNanoseconds += other.TotalNanoseconds;
+		MaxNanoseconds = std::max(MaxNanoseconds, other.MaxNanoseconds);
+		Latency += other.Latency;
+		return *this;
+	}
+
+	std::vector<ThreadStatistics> CollectPerThread()
+	{
+		std::vector<ThreadStatistics> result;
+		for (auto record = ThreadRecordList.load(std::memory_order_acquire); record;
+		     record = record->Next)
+		{
+			auto& thread = result.emplace_back();
+			thread.ThreadIndex = record->Index;
+			for (std::size_t i = 0; i < HookCount; ++i)
+			{
+				thread.Hooks[i] = Snapshot(record->Hooks[i]);
+			}
+		}
+
+		std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
+			return a.ThreadIndex < b.ThreadIndex;
+		});
+		return result;
+	}
+
+	std::array<HookStatistics, HookCount> Collect()
+	{
+		std::array<HookStatistics, HookCount> result{};
+		for (auto record = ThreadRecordList.load(std::memory_order_acquire); record;
+		     record = record->Next)
+		{
+			for (std::size_t i = 0; i < HookCount; ++i)
+			{
+				result[i] += Snapshot(record->Hooks[i]);
+			}
+		}
+		return result;
+	}
+
+	void Dump()
+	{
+		if (!IsEnabled())
+		{
+			Log::Info("UmaPyogin: Hook profiling is disabled, configure with "
+			          "-DUMAPYOGIN_ENABLE_PROFILING=ON to enable it");
+			return;
+		}
+
+		const auto statistics = Collect();
+		Log::Info("UmaPyogin: Hook statistics from {} threads",
+		          ThreadRecordCount.load(std::memory_order_relaxed));
+		for (std::size_t i = 0; i < HookCount; ++i)
+		{
+			const auto& hook = statistics[i];
+			if (!hook.CallCount)
+			{
+				continue;
+			}
+
+			Log::Info("UmaPyogin: {}: {} calls, {} hits, {} misses, mean {}ns, p50 {}ns, p99 {}ns, "
+			          "p99.9 {}ns, max {}ns",
+			          HookNames[i], hook.CallCount, hook.HitCount, hook.MissCount,
+			          hook.TotalNanoseconds / hook.CallCount, hook.Latency.GetPercentile(0.5),
+			          hook.Latency.GetPercentile(0.99), hook.Latency.GetPercentile(0.999),
+			          hook.MaxNanoseconds);
+		}
+	}
+
+	void Record(HookId hook, std::uint64_t nanoseconds, Outcome outcome)
+	{
+		thread_local ThreadRecordHolder holder;
+
+		auto& counters = holder.Record->Hooks[static_cast<std::size_t>(hook)];
+		Add(counters.CallCount, 1);
+		if (outcome == Outcome::Hit)
+		{
+			Add(counters.HitCount, 1);
+		}
+		else if (outcome == Outcome::Miss)
+		{
+			Add(counters.MissCount, 1);
+		}
+		Add(counters.TotalNanoseconds, nanoseconds);
+		if (nanoseconds > counters.MaxNanoseconds.load(std::memory_order_relaxed))
+		{
+			counters.MaxNanoseconds.store(nanoseconds, std::memory_order_relaxed);
+		}
+		Add(counters.Buckets[Histogram::GetBucketIndex(nanoseconds)], 1);
+	}
+} // namespace UmaPyogin::Profiler
@@ -0,0 +1,154 @@
+#ifndef UMAPYOGIN_PROFILER_H
+#define UMAPYOGIN_PROFILER_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 以 -DUMAPYOGIN_ENABLE_PROFILING=ON 配置时记录各钩子的调用次数、命中次数与耗时分布
+// 未启用时 UMAPYOGIN_PROFILE_* 宏展开为空，钩子中不会产生任何额外开销
+#define UMAPYOGIN_PROFILED_HOOKS(X)                                                                \
+	X(LocalizeJP_Get)                                                                              \
+	X(AssetBundle_LoadAsset)                                                                       \
+	X(TextCommon_Awake)                                                                            \
+	X(Query_ctor)                                                                                  \
+	X(Query_Step)                                                                                  \
+	X(Query_GetText)                                                                               \
+	X(PreparedQuery_BindInt)                                                                       \
+	X(Query_Dispose)
+
+namespace UmaPyogin::Profiler
+{
+	enum class HookId : std::size_t
+	{
+#define DEFINE_HOOK_ID(name) name,
+		UMAPYOGIN_PROFILED_HOOKS(DEFINE_HOOK_ID)
+#undef DEFINE_HOOK_ID
+		Count,
+	};
+
+	constexpr std::size_t HookCount = static_cast<std::size_t>(HookId::Count);
+
+	const char* GetHookName(HookId hook);
+
+	// 耗时以纳秒计，按 2 的幂分段，每段再均分为 4 个桶，相对误差不超过 25%
+	class Histogram
+	{
+	public:
+		static constexpr std::size_t SubBucketBits = 2;
+		static constexpr std::size_t SubBucketCount = std::size_t(1) << SubBucketBits;
+		// 超过 2^40 纳秒（约 18 分钟）的耗时计入最后一个桶
+		static constexpr std::size_t MaxExponent = 40;
+		static constexpr std::size_t BucketCount =
+		    (MaxExponent - SubBucketBits + 1) * SubBucketCount;
+
+		static std::size_t GetBucketIndex(std::uint64_t nanoseconds);
+		// 桶所含耗时的下界，上界为下一个桶的下界
+		static std::uint64_t GetBucketLowerBound(std::size_t index);
+
+		std::array<std::uint64_t, BucketCount> Buckets{};
+
+		Histogram& operator+=(Histogram const& other);
+
+		std::uint64_t GetCount() const;
+		// 返回满足比例 ratio 的耗时上界，例如 0.99 对应 p99
+		std::uint64_t GetPercentile(double ratio) const;
+	};
+
+	struct HookStatistics
+	{
+		std::uint64_t CallCount;
+		// 钩子找到译文或实际进行了替换时计为命中，未记录结果的调用不计入两者
+		std::uint64_t HitCount;
+		std::uint64_t MissCount;
+		std::uint64_t TotalNanoseconds;
+		std::uint64_t MaxNanoseconds;
+		Histogram Latency;
+
+		HookStatistics& operator+=(HookStatistics const& other);
+	};
+
+	struct ThreadStatistics
+	{
+		// 按线程首次调用钩子的顺序编号，线程退出后编号可被新线程复用
+		std::size_t ThreadIndex;
+		std::array<HookStatistics, HookCount> Hooks;
+	};
+
+	constexpr bool IsEnabled()
+	{
+#ifdef UMAPYOGIN_ENABLE_PROFILING
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// 可在任意线程调用，读取过程中不会阻塞正在记录的线程，结果可能略微滞后
+	std::vector<ThreadStatistics> CollectPerThread();
+	std::array<HookStatistics, HookCount> Collect();
+
+	// 将汇总结果输出到日志
+	void Dump();
+
+	enum class Outcome : std::uint8_t
+	{
+		None,
+		Hit,
+		Miss,
+	};
+
+	void Record(HookId hook, std::uint64_t nanoseconds, Outcome outcome);
+
+	// 记录所在作用域的耗时，std::chrono::steady_clock 在 Linux 与 Android 上为 vDSO 的
+	// clock_gettime(CLOCK_MONOTONIC)，在 Windows 上为 QueryPerformanceCounter，均不陷入内核
+	class ScopedTimer
+	{
+	public:
+		explicit ScopedTimer(HookId hook) : m_Hook(hook), m_Start(std::chrono::steady_clock::now())
+		{
+		}
+
+		~ScopedTimer()
+		{
+			const auto elapsed = std::chrono::steady_clock::now() - m_Start;
+			Record(m_Hook,
+			       static_cast<std::uint64_t>(
+			           std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+			       m_Outcome);
+		}
+
+		ScopedTimer(ScopedTimer const&) = delete;
+		ScopedTimer& operator=(ScopedTimer const&) = delete;
+
+		void Hit()
+		{
+			m_Outcome = Outcome::Hit;
+		}
+
+		void Miss()
+		{
+			m_Outcome = Outcome::Miss;
+		}
+
+	private:
+		HookId m_Hook;
+		Outcome m_Outcome{};
+		std::chrono::steady_clock::time_point m_Start;
+	};
+} // namespace UmaPyogin::Profiler
+
+#ifdef UMAPYOGIN_ENABLE_PROFILING
+#define UMAPYOGIN_PROFILE_HOOK(name)                                                               \
+	::UmaPyogin::Profiler::ScopedTimer profilerTimer(::UmaPyogin::Profiler::HookId::name)
+#define UMAPYOGIN_PROFILE_HIT() profilerTimer.Hit()
+#define UMAPYOGIN_PROFILE_MISS() profilerTimer.Miss()
+#else
+#define UMAPYOGIN_PROFILE_HOOK(name) static_cast<void>(0)
+#define UMAPYOGIN_PROFILE_HIT() static_cast<void>(0)
+#define UMAPYOGIN_PROFILE_MISS() static_cast<void>(0)
+#endif
+
+#endif
@@ -0,0 +1,154 @@
+#include "Sql.h"
+
+#include <bit>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define UMAPYOGIN_SQL_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define UMAPYOGIN_SQL_NEON 1
+#endif
+
+namespace UmaPyogin::Sql
+{
+	namespace
+	{
+		constexpr bool IsSpace(char16_t c)
+		{
+			return c == u' ' || c == u'\t' || c == u'\r' || c == u'\n';
+		}
+
+		constexpr bool IsWordChar(char16_t c)
+		{
+			return (c >= u'a' && c <= u'z') || (c >= u'A' && c <= u'Z') ||
+			       (c >= u'0' && c <= u'9') || c == u'_';
+		}
+
+		// 每次比较 8 个 UTF-16 代码单元
+		std::size_t FindChar(std::u16string_view str, char16_t c, std::size_t pos)
+		{
+			const auto size = str.size();
+#if UMAPYOGIN_SQL_SSE2
+			const auto needle = _mm_set1_epi16(static_cast<short>(c));
+			for (; pos + 8 <= size; pos += 8)
+			{
+				const auto chunk =
+				    _mm_loadu_si128(reinterpret_cast<const __m128i*>(str.data() + pos));
+				const auto mask = static_cast<unsigned>(
+				    _mm_movemask_epi8(_mm_cmpeq_epi16(chunk, needle)));
+				if (mask)
+				{
+					return pos + std::countr_zero(mask) / 2;
+				}
+			}
+#elif UMAPYOGIN_SQL_NEON
+			const auto needle = vdupq_n_u16(c);
+			for (; pos + 8 <= size; pos += 8)
+			{
+				const auto chunk =
+				    vld1q_u16(reinterpret_cast<const std::uint16_t*>(str.data() + pos));
+				// 每个 16 位比较结果收窄为 8 位，得到 64 位掩码
+				const auto mask = vget_lane_u64(
+				    vreinterpret_u64_u8(vshrn_n_u16(vceqq_u16(chunk, needle), 4)), 0);
+				if (mask)
+				{
+					return pos + std::countr_zero(mask) / 8;
+				}
+			}
+#endif
+			for (; pos < size; ++pos)
+			{
+				if (str[pos] == c)
+				{
+					return pos;
+				}
+			}
+			return std::u16string_view::npos;
+		}
+
+		bool EndsWithFromKeyword(std::u16string_view str)
+		{
+			using namespace std::literals::string_view_literals;
+
+			while (!str.empty() && IsSpace(str.back()))
+			{
+				str.remove_suffix(1);
+			}
+			if (!str.ends_with(u"FROM"sv))
+			{
+				return false;
+			}
+			str.remove_suffix(4);
+			return str.empty() || !IsWordChar(str.back());
+		}
+	} // namespace
+
+	std::u16string_view FindTableName(std::u16string_view sql)
+	{
+		std::size_t pos = 0;
+		while (true)
+		{
+			const auto open = FindChar(sql, u'`', pos);
+			if (open == std::u16string_view::npos)
+			{
+				return {};
+			}
+			const auto close = FindChar(sql, u'`', open + 1);
+			if (close == std::u16string_view::npos)
+			{
+				return {};
+			}
+			if (EndsWithFromKeyword(sql.substr(pos, open - pos)))
+			{
+				return sql.substr(open + 1, close - open - 1);
+			}
+			pos = close + 1;
+		}
+	}
+
+	Token Tokenizer::Next()
+	{
+		std::size_t pos = 0;
+		while (pos < m_Remaining.size() && IsSpace(m_Remaining[pos]))
+		{
+			++pos;
+		}
+		m_Remaining.remove_prefix(pos);
+
+		if (m_Remaining.empty())
+		{
+			return { TokenType::End, {} };
+		}
+
+		const auto c = m_Remaining.front();
+		if (c == u'`')
+		{
+			const auto end = m_Remaining.find(u'`', 1);
+			if (end == std::u16string_view::npos)
+			{
+				return { TokenType::Invalid, m_Remaining };
+			}
+			const auto text = m_Remaining.substr(1, end - 1);
+			m_Remaining.remove_prefix(end + 1);
+			return { TokenType::QuotedIdentifier, text };
+		}
+
+		if (IsWordChar(c))
+		{
+			std::size_t end = 1;
+			while (end < m_Remaining.size() && IsWordChar(m_Remaining[end]))
+			{
+				++end;
+			}
+			const auto text = m_Remaining.substr(0, end);
+			m_Remaining.remove_prefix(end);
+			return { TokenType::Word, text };
+		}
+
+		const auto text = m_Remaining.substr(0, 1);
+		m_Remaining.remove_prefix(1);
+		return { TokenType::Punctuation, text };
+	}
+} // namespace UmaPyogin::Sql
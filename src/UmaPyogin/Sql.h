@@ -0,0 +1,174 @@
+#ifndef UMAPYOGIN_SQL_H
+#define UMAPYOGIN_SQL_H
+
+#include <cstddef>
+#include <string_view>
+
+namespace UmaPyogin::Sql
+{
+	enum class TokenType
+	{
+		End,
+		// SELECT、FROM 等未加引号的单词
+		Word,
+		// `name`，Text 不包含反引号
+		QuotedIdentifier,
+		// 单个符号字符，如 , = ? ; ( )
+		Punctuation,
+		Invalid,
+	};
+
+	struct Token
+	{
+		TokenType Type;
+		std::u16string_view Text;
+
+		bool Is(TokenType type, std::u16string_view text) const
+		{
+			return Type == type && Text == text;
+		}
+	};
+
+	// 仅切分游戏使用的 SQL 子集，不分配内存
+	class Tokenizer
+	{
+	public:
+		explicit Tokenizer(std::u16string_view sql) : m_Remaining(sql)
+		{
+		}
+
+		Token Next();
+
+	private:
+		std::u16string_view m_Remaining;
+	};
+
+	// 查找 FROM 之后以反引号包围的表名，未找到时返回空
+	// 仅扫描 sql 本身，不分配内存
+	std::u16string_view FindTableName(std::u16string_view sql);
+
+	// 解析 SELECT `a`,`b` FROM `table` [WHERE `c`=? AND `d`=? ...];
+	// receiver 需提供：
+	//   bool Table(std::u16string_view table)，返回 false 时停止解析
+	//   void Column(std::size_t index, std::u16string_view column)，index 从 0 开始
+	//   void Param(std::size_t index, std::u16string_view column)，index 从 1 开始，与绑定参数序号一致
+	// 语句不符合上述格式时返回 false
+	template <typename Receiver>
+	bool ParseSelect(std::u16string_view sql, Receiver&& receiver)
+	{
+		using namespace std::literals::string_view_literals;
+
+		Tokenizer tokenizer(sql);
+		auto token = tokenizer.Next();
+		if (!token.Is(TokenType::Word, u"SELECT"sv))
+		{
+			return false;
+		}
+
+		// 列表达式只由单个带引号的标识符组成时才视为列名，但每一项都占用一个列序号
+		std::size_t columnIndex{};
+		std::u16string_view columnName;
+		std::size_t columnTokenCount{};
+		struct PendingColumn
+		{
+			std::size_t Index;
+			std::u16string_view Name;
+		};
+		// 表名确定之前暂不回调列，最多记录少量列以保持不分配
+		constexpr std::size_t MaxPendingColumns = 32;
+		PendingColumn pendingColumns[MaxPendingColumns];
+		std::size_t pendingColumnCount{};
+
+		const auto finishColumn = [&] {
+			if (columnTokenCount == 1 && !columnName.empty())
+			{
+				if (pendingColumnCount == MaxPendingColumns)
+				{
+					return false;
+				}
+				pendingColumns[pendingColumnCount++] = { columnIndex, columnName };
+			}
+			++columnIndex;
+			columnName = {};
+			columnTokenCount = 0;
+			return true;
+		};
+
+		while (true)
+		{
+			token = tokenizer.Next();
+			if (token.Type == TokenType::End || token.Type == TokenType::Invalid)
+			{
+				return false;
+			}
+			if (token.Is(TokenType::Word, u"FROM"sv))
+			{
+				if (!finishColumn())
+				{
+					return false;
+				}
+				break;
+			}
+			if (token.Is(TokenType::Punctuation, u","sv))
+			{
+				if (!finishColumn())
+				{
+					return false;
+				}
+				continue;
+			}
+			if (token.Type == TokenType::QuotedIdentifier)
+			{
+				columnName = token.Text;
+			}
+			++columnTokenCount;
+		}
+
+		token = tokenizer.Next();
+		if (token.Type != TokenType::QuotedIdentifier || !receiver.Table(token.Text))
+		{
+			return false;
+		}
+
+		for (std::size_t i = 0; i < pendingColumnCount; ++i)
+		{
+			receiver.Column(pendingColumns[i].Index, pendingColumns[i].Name);
+		}
+
+		token = tokenizer.Next();
+		if (token.Is(TokenType::Word, u"WHERE"sv))
+		{
+			// 每个 ? 对应一个绑定参数，参数名取其前最近的列名
+			std::size_t paramIndex = 1;
+			std::u16string_view lastColumn;
+			while (true)
+			{
+				token = tokenizer.Next();
+				if (token.Type == TokenType::End || token.Type == TokenType::Invalid)
+				{
+					return false;
+				}
+				if (token.Is(TokenType::Punctuation, u";"sv))
+				{
+					break;
+				}
+				if (token.Type == TokenType::QuotedIdentifier)
+				{
+					lastColumn = token.Text;
+				}
+				else if (token.Is(TokenType::Punctuation, u"?"sv))
+				{
+					receiver.Param(paramIndex++, lastColumn);
+				}
+			}
+		}
+		else if (!token.Is(TokenType::Punctuation, u";"sv))
+		{
+			return false;
+		}
+
+		return tokenizer.Next().Type == TokenType::End;
+	}
+} // namespace UmaPyogin::Sql
+
+#endif
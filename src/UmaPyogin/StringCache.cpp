@@ -0,0 +1,111 @@
+#include "StringCache.h"
+
+#include <cstring>
+#include <functional>
+
+namespace UmaPyogin
+{
+	using namespace Il2CppSymbols;
+
+	std::size_t Il2CppStringCache::KeyHash::operator()(CacheKey const& key) const
+	{
+		return std::hash<const char16_t*>()(key.Data) ^ (key.Length * 0x9E3779B97F4A7C15ull);
+	}
+
+	Il2CppStringCache& Il2CppStringCache::GetInstance()
+	{
+		static Il2CppStringCache s_Instance;
+		return s_Instance;
+	}
+
+	void Il2CppStringCache::SetBudget(std::size_t bytes)
+	{
+		std::unique_lock lock(m_Mutex);
+		m_Budget = bytes;
+		EvictUntilWithinBudget();
+	}
+
+	Il2CppString* Il2CppStringCache::Get(std::u16string_view str)
+	{
+		std::unique_lock lock(m_Mutex);
+
+		if (!m_Budget)
+		{
+			lock.unlock();
+			return il2cpp_string_new_utf16(str.data(), str.size());
+		}
+
+		const CacheKey key{ str.data(), str.size() };
+		if (const auto iter = m_Index.find(key); iter != m_Index.end())
+		{
+			const auto entry = iter->second;
+			const auto cached =
+			    reinterpret_cast<Il2CppString*>(il2cpp_gchandle_get_target(entry->Handle));
+			if (cached && static_cast<std::size_t>(cached->length) == str.size() &&
+			    std::memcmp(cached->chars, str.data(), str.size() * sizeof(char16_t)) == 0)
+			{
+				++m_Hits;
+				m_Entries.splice(m_Entries.begin(), m_Entries, entry);
+				return cached;
+			}
+
+			// 原文本已被释放且地址被复用，丢弃旧项
+			il2cpp_gchandle_free(entry->Handle);
+			m_Bytes -= entry->Bytes;
+			m_Entries.erase(entry);
+			m_Index.erase(iter);
+		}
+
+		++m_Misses;
+		const auto result = il2cpp_string_new_utf16(str.data(), str.size());
+		if (!result)
+		{
+			return nullptr;
+		}
+
+		const auto bytes = sizeof(Il2CppString) + str.size() * sizeof(char16_t);
+		if (bytes > m_Budget)
+		{
+			return result;
+		}
+
+		const auto handle = il2cpp_gchandle_new(reinterpret_cast<Il2CppObject*>(result), false);
+		m_Entries.push_front({ key, handle, bytes });
+		m_Index.emplace(key, m_Entries.begin());
+		m_Bytes += bytes;
+		EvictUntilWithinBudget();
+
+		return result;
+	}
+
+	Il2CppStringCache::Statistics Il2CppStringCache::GetStatistics() const
+	{
+		std::unique_lock lock(m_Mutex);
+		return { m_Hits, m_Misses, m_Evictions, m_Entries.size(), m_Bytes };
+	}
+
+	void Il2CppStringCache::Clear()
+	{
+		std::unique_lock lock(m_Mutex);
+		for (const auto& entry : m_Entries)
+		{
+			il2cpp_gchandle_free(entry.Handle);
+		}
+		m_Entries.clear();
+		m_Index.clear();
+		m_Bytes = 0;
+	}
+
+	void Il2CppStringCache::EvictUntilWithinBudget()
+	{
+		while (m_Bytes > m_Budget && !m_Entries.empty())
+		{
+			const auto& entry = m_Entries.back();
+			il2cpp_gchandle_free(entry.Handle);
+			m_Bytes -= entry.Bytes;
+			m_Index.erase(entry.Key);
+			m_Entries.pop_back();
+			++m_Evictions;
+		}
+	}
+} // namespace UmaPyogin
@@ -0,0 +1,86 @@
+#ifndef UMAPYOGIN_STRING_CACHE_H
+#define UMAPYOGIN_STRING_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+#include "Il2Cpp.h"
+
+namespace UmaPyogin
+{
+	// 为本地化文本缓存托管字符串，避免每次查找都重新分配
+	// 以文本数据地址及长度为键，命中时仍会比较内容，因此文本存储被释放后不会返回错误的字符串
+	// 缓存的字符串由 GC 句柄保持存活，总大小超出预算时按最近最少使用淘汰
+	class Il2CppStringCache
+	{
+	public:
+		static constexpr std::size_t DefaultBudget = 8 * 1024 * 1024;
+
+		struct Statistics
+		{
+			std::uint64_t Hits;
+			std::uint64_t Misses;
+			std::uint64_t Evictions;
+			std::size_t Entries;
+			std::size_t Bytes;
+		};
+
+		static Il2CppStringCache& GetInstance();
+
+		// 预算为 0 时禁用缓存
+		void SetBudget(std::size_t bytes);
+
+		Il2CppString* Get(std::u16string_view str);
+
+		Statistics GetStatistics() const;
+
+		void Clear();
+
+		Il2CppStringCache(Il2CppStringCache const&) = delete;
+		Il2CppStringCache& operator=(Il2CppStringCache const&) = delete;
+
+	private:
+		Il2CppStringCache() = default;
+
+		struct CacheKey
+		{
+			const char16_t* Data;
+			std::size_t Length;
+
+			bool operator==(CacheKey const&) const = default;
+		};
+
+		struct KeyHash
+		{
+			std::size_t operator()(CacheKey const& key) const;
+		};
+
+		struct Entry
+		{
+			CacheKey Key;
+			std::uint32_t Handle;
+			std::size_t Bytes;
+		};
+
+		void EvictUntilWithinBudget();
+
+		// 调用方为 LocalizeJP.Get、Query.GetText 与剧情资源加载的钩子，均在游戏主线程上执行，
+		// 锁几乎不会发生竞争，其开销为两次原子操作，远小于未命中时分配托管字符串的开销
+		mutable std::mutex m_Mutex;
+		std::size_t m_Budget{};
+		std::size_t m_Bytes{};
+		// 头部为最近使用的项
+		std::list<Entry> m_Entries;
+		std::unordered_map<CacheKey, std::list<Entry>::iterator, KeyHash> m_Index;
+
+		std::uint64_t m_Hits{};
+		std::uint64_t m_Misses{};
+		std::uint64_t m_Evictions{};
+	};
+} // namespace UmaPyogin
+
+#endif
@@ -0,0 +1,145 @@
+#include "TextTable.h"
+#include "Misc.h"
+
+#include <bit>
+#include <cassert>
+
+namespace UmaPyogin::Localization
+{
+	bool TextTable::Add(std::uint64_t key, std::string_view text)
+	{
+		assert(!m_Sealed);
+
+		// 先按最坏情况扩展，转换后再截断到实际长度
+		const auto offset = m_Arena.size();
+		m_Arena.resize(offset + text.size());
+		const auto result = Misc::ToUTF16(text, m_Arena.data() + offset);
+		if (!result)
+		{
+			m_Arena.resize(offset);
+			return false;
+		}
+		m_Arena.resize(offset + result.Length);
+
+		m_Slots.push_back({ key, static_cast<std::uint32_t>(offset),
+		                    static_cast<std::uint32_t>(result.Length) });
+		return true;
+	}
+
+	bool TextTable::Add(std::uint64_t key, std::u16string_view text)
+	{
+		assert(!m_Sealed);
+
+		const auto offset = m_Arena.size();
+		m_Arena.append(text);
+		m_Slots.push_back(
+		    { key, static_cast<std::uint32_t>(offset), static_cast<std::uint32_t>(text.size()) });
+		return true;
+	}
+
+	void TextTable::Reserve(std::size_t codeUnits)
+	{
+		m_Arena.reserve(codeUnits);
+	}
+
+	void TextTable::Seal()
+	{
+		assert(!m_Sealed);
+
+		// 负载因子保持在 0.75 以下
+		const auto capacity = std::bit_ceil(m_Slots.size() * 4 / 3 + 1);
+		std::vector<Slot> slots(capacity, Slot{ 0, EmptyOffset, 0 });
+		m_Mask = capacity - 1;
+		m_Size = 0;
+
+		for (const auto& entry : m_Slots)
+		{
+			auto index = Probe(entry.Key);
+			while (slots[index].Offset != EmptyOffset)
+			{
+				if (slots[index].Key == entry.Key)
+				{
+					break;
+				}
+				index = (index + 1) & m_Mask;
+			}
+			if (slots[index].Offset == EmptyOffset)
+			{
+				slots[index] = entry;
+				++m_Size;
+			}
+		}
+
+		m_Slots = std::move(slots);
+		m_Arena.shrink_to_fit();
+		m_Sealed = true;
+	}
+
+	void TextTable::Clear()
+	{
+		m_Arena.clear();
+		m_Arena.shrink_to_fit();
+		m_Slots.clear();
+		m_Slots.shrink_to_fit();
+		m_Size = 0;
+		m_Mask = 0;
+		m_Sealed = false;
+	}
+
+	std::optional<std::u16string_view> TextTable::Find(std::uint64_t key) const
+	{
+		if (!m_Sealed)
+		{
+			return std::nullopt;
+		}
+
+		for (auto index = Probe(key);; index = (index + 1) & m_Mask)
+		{
+			const auto& slot = m_Slots[index];
+			if (slot.Offset == EmptyOffset)
+			{
+				return std::nullopt;
+			}
+			if (slot.Key == key)
+			{
+				return std::u16string_view(m_Arena.data() + slot.Offset, slot.Length);
+			}
+		}
+	}
+
+	std::size_t TextTable::GetSize() const
+	{
+		return m_Sealed ? m_Size : m_Slots.size();
+	}
+
+	std::size_t TextTable::GetMemoryUsage() const
+	{
+		return m_Arena.capacity() * sizeof(char16_t) + m_Slots.capacity() * sizeof(Slot);
+	}
+
+	std::size_t TextTable::EstimateNodeBasedMemoryUsage() const
+	{
+		// 以 libstdc++ 为准：每个节点包含 next 指针、键与 std::u16string，
+		// 超过 7 个代码单元的字符串另行分配，每次分配另计 16 字节开销
+		constexpr std::size_t AllocationOverhead = 16;
+		constexpr std::size_t NodeSize =
+		    sizeof(void*) + sizeof(std::size_t) + sizeof(std::u16string) + AllocationOverhead;
+		constexpr std::size_t SsoCapacity = 7;
+
+		std::size_t size = std::bit_ceil(GetSize()) * sizeof(void*);
+		ForEach([&](std::uint64_t, std::u16string_view text) {
+			size += NodeSize;
+			if (text.size() > SsoCapacity)
+			{
+				size += (text.size() + 1) * sizeof(char16_t) + AllocationOverhead;
+			}
+		});
+		return size;
+	}
+
+	std::size_t TextTable::Probe(std::uint64_t key) const
+	{
+		// Fibonacci 散列，使连续的 id 分散到不同的槽
+		return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & m_Mask;
+	}
+} // namespace UmaPyogin::Localization
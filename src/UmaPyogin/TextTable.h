@@ -0,0 +1,70 @@
+#ifndef UMAPYOGIN_TEXT_TABLE_H
+#define UMAPYOGIN_TEXT_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UmaPyogin::Localization
+{
+	// 以 64 位键查找文本的只读表
+	// 所有文本存放于同一块连续内存，以 32 位偏移引用，查找表采用线性探测的开放寻址
+	// 添加完成后需调用 Seal，之后只能查找，可在多个线程中并发查找
+	class TextTable
+	{
+	public:
+		// 键已存在时保留先添加的文本，text 为非法的 UTF-8 时返回 false
+		bool Add(std::uint64_t key, std::string_view text);
+		bool Add(std::uint64_t key, std::u16string_view text);
+
+		// 预留文本所需的空间（UTF-16 代码单元数），避免添加过程中反复扩容
+		void Reserve(std::size_t codeUnits);
+		void Seal();
+		void Clear();
+
+		std::optional<std::u16string_view> Find(std::uint64_t key) const;
+
+		std::size_t GetSize() const;
+		// 当前布局占用的内存（字节）
+		std::size_t GetMemoryUsage() const;
+		// 以 unordered_map<std::size_t, std::u16string> 保存相同内容时的估计内存占用（字节）
+		std::size_t EstimateNodeBasedMemoryUsage() const;
+
+		template <typename Visitor>
+		void ForEach(Visitor&& visitor) const
+		{
+			for (const auto& slot : m_Slots)
+			{
+				if (slot.Offset != EmptyOffset)
+				{
+					visitor(slot.Key,
+					        std::u16string_view(m_Arena.data() + slot.Offset, slot.Length));
+				}
+			}
+		}
+
+	private:
+		struct Slot
+		{
+			std::uint64_t Key;
+			std::uint32_t Offset;
+			std::uint32_t Length;
+		};
+
+		static constexpr std::uint32_t EmptyOffset = UINT32_MAX;
+
+		std::u16string m_Arena;
+		// Seal 之前按添加顺序记录，之后为查找表
+		std::vector<Slot> m_Slots;
+		std::size_t m_Size{};
+		std::size_t m_Mask{};
+		bool m_Sealed{};
+
+		std::size_t Probe(std::uint64_t key) const;
+	};
+} // namespace UmaPyogin::Localization
+
+#endif
@@ -0,0 +1,604 @@
+#include "Trace.h"
+#include "Log.h"
+#include "Misc.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#ifdef _WIN32
+#define PATH_STR(path) (path).string()
+#else
+#define PATH_STR(path) (path).native()
+#endif
+
+namespace UmaPyogin::Trace
+{
+	std::atomic<bool> Active;
+
+	namespace
+	{
+		constexpr const char* EventNames[] = {
+#define DEFINE_EVENT_NAME(name) #name,
+			UMAPYOGIN_TRACED_HOOKS(DEFINE_EVENT_NAME)
+#undef DEFINE_EVENT_NAME
+		};
+
+		// 文件由头部与连续的事件组成，整数均为本机字节序
+		// 每个事件依次为时间戳、线程编号、类型、负载长度与负载：
+		//   LocalizeJP_Get：id
+		//   AssetBundle_LoadAsset：资源名、类名
+		//   Query_ctor：Query 地址、SQL 语句
+		//   PreparedQuery_BindInt：Query 地址、序号、值
+		//   Query_Step：Query 地址、返回值、整数列数及各列的序号与值
+		//   Query_GetText：Query 地址、序号
+		//   Query_Dispose：Query 地址
+		// 字符串存放 16 位的长度与内容，资源名与 SQL 语句为 UTF-16，类名为 UTF-8
+		constexpr char TraceMagic[4] = { 'U', 'P', 'T', 'R' };
+		constexpr std::uint32_t TraceVersion = 1;
+
+		struct TraceHeader
+		{
+			char Magic[4];
+			std::uint32_t Version;
+		};
+
+		constexpr std::size_t EventHeaderSize = sizeof(std::uint64_t) + sizeof(std::uint32_t) +
+		                                        sizeof(EventType) + sizeof(std::uint16_t);
+
+		constexpr std::size_t BufferSize = 64 * 1024;
+		// 后台线程来不及写入时至多积压的缓冲区数，超出时丢弃新写满的缓冲区
+		constexpr std::size_t MaxPendingBuffers = 256;
+		constexpr std::size_t MaxFreeBuffers = 16;
+
+		using Buffer = std::vector<std::byte>;
+
+		// 由 Start 在设置 Active 之前写入
+		std::chrono::steady_clock::time_point StartTime;
+
+		// 每个线程独占一个缓冲区，缓冲区加入无锁链表后不再释放，线程退出后可被新线程接管，
+		// 接管时分配新的编号，使回放时能够区分先后使用同一缓冲区的线程
+		struct alignas(64) ThreadBuffer
+		{
+			std::uint32_t Index;
+			std::atomic<bool> InUse;
+			// 所属线程正在写入事件，Stop 取走剩余事件前需等待其完成
+			std::atomic<bool> Writing;
+			ThreadBuffer* Next;
+			Buffer Data;
+		};
+
+		std::atomic<ThreadBuffer*> ThreadBufferList;
+		std::atomic<std::uint32_t> ThreadBufferCount;
+
+		ThreadBuffer* AcquireThreadBuffer()
+		{
+			for (auto buffer = ThreadBufferList.load(std::memory_order_acquire); buffer;
+			     buffer = buffer->Next)
+			{
+				bool inUse = false;
+				if (!buffer->InUse.load(std::memory_order_relaxed) &&
+				    buffer->InUse.compare_exchange_strong(inUse, true, std::memory_order_acquire))
+				{
+					buffer->Index = ThreadBufferCount.fetch_add(1, std::memory_order_relaxed);
+					return buffer;
+				}
+			}
+
+			const auto buffer = new ThreadBuffer{};
+			buffer->Index = ThreadBufferCount.fetch_add(1, std::memory_order_relaxed);
+			buffer->InUse.store(true, std::memory_order_relaxed);
+			buffer->Data.reserve(BufferSize);
+			buffer->Next = ThreadBufferList.load(std::memory_order_relaxed);
+			while (!ThreadBufferList.compare_exchange_weak(
+			    buffer->Next, buffer, std::memory_order_release, std::memory_order_relaxed))
+			{
+			}
+			return buffer;
+		}
+
+		struct ThreadBufferHolder
+		{
+			ThreadBuffer* Buffer = AcquireThreadBuffer();
+
+			~ThreadBufferHolder();
+		};
+
+		class TraceWriter
+		{
+		public:
+			static TraceWriter& GetInstance()
+			{
+				static TraceWriter s_Instance;
+				return s_Instance;
+			}
+
+			bool Start(std::filesystem::path const& path)
+			{
+				std::unique_lock control(m_ControlMutex);
+				if (m_Thread.joinable())
+				{
+					return false;
+				}
+
+				m_File.open(path, std::ios::binary | std::ios::trunc);
+				TraceHeader header{};
+				std::memcpy(header.Magic, TraceMagic, sizeof(TraceMagic));
+				header.Version = TraceVersion;
+				m_File.write(reinterpret_cast<const char*>(&header), sizeof(header));
+				if (!m_File)
+				{
+					m_File.close();
+					return false;
+				}
+
+				m_WrittenSize = sizeof(header);
+				m_DroppedBufferCount = 0;
+				m_Stopping = false;
+				m_Thread = std::thread(&TraceWriter::Run, this);
+
+				StartTime = std::chrono::steady_clock::now();
+				Active.store(true, std::memory_order_seq_cst);
+				return true;
+			}
+
+			void Stop()
+			{
+				std::unique_lock control(m_ControlMutex);
+				if (!m_Thread.joinable())
+				{
+					return;
+				}
+
+				// 与 Append 相反的顺序保证清除 Active 之后不会再有线程写入缓冲区
+				Active.store(false, std::memory_order_seq_cst);
+				for (auto buffer = ThreadBufferList.load(std::memory_order_acquire); buffer;
+				     buffer = buffer->Next)
+				{
+					while (buffer->Writing.load(std::memory_order_seq_cst))
+					{
+						std::this_thread::yield();
+					}
+					if (!buffer->Data.empty())
+					{
+						Submit(buffer->Data);
+					}
+				}
+
+				{
+					std::unique_lock lock(m_Mutex);
+					m_Stopping = true;
+				}
+				m_Condition.notify_one();
+				m_Thread.join();
+
+				const auto succeeded = static_cast<bool>(m_File);
+				m_File.close();
+				if (!succeeded)
+				{
+					Log::Error("UmaPyogin: Failed to write trace file");
+				}
+				Log::Info("UmaPyogin: Trace stopped, wrote {} bytes, dropped {} buffers",
+				          m_WrittenSize, m_DroppedBufferCount);
+			}
+
+			// 将写满的缓冲区交给后台线程，并换回一个空缓冲区
+			void Submit(Buffer& buffer)
+			{
+				Buffer replacement;
+				{
+					std::unique_lock lock(m_Mutex);
+					if (m_Pending.size() >= MaxPendingBuffers)
+					{
+						++m_DroppedBufferCount;
+						buffer.clear();
+						return;
+					}
+
+					m_Pending.push_back(std::move(buffer));
+					if (!m_FreeBuffers.empty())
+					{
+						replacement = std::move(m_FreeBuffers.back());
+						m_FreeBuffers.pop_back();
+					}
+				}
+				m_Condition.notify_one();
+
+				replacement.reserve(BufferSize);
+				buffer = std::move(replacement);
+			}
+
+			TraceWriter(TraceWriter const&) = delete;
+			TraceWriter& operator=(TraceWriter const&) = delete;
+
+		private:
+			std::mutex m_ControlMutex;
+			std::thread m_Thread;
+			std::ofstream m_File;
+			// 仅由后台线程在录制期间访问
+			std::size_t m_WrittenSize{};
+
+			std::mutex m_Mutex;
+			std::condition_variable m_Condition;
+			std::deque<Buffer> m_Pending;
+			std::vector<Buffer> m_FreeBuffers;
+			std::size_t m_DroppedBufferCount{};
+			bool m_Stopping{};
+
+			TraceWriter() = default;
+
+			~TraceWriter()
+			{
+				Stop();
+			}
+
+			void Run()
+			{
+				std::deque<Buffer> buffers;
+				std::unique_lock lock(m_Mutex);
+				while (true)
+				{
+					m_Condition.wait(lock, [&] { return m_Stopping || !m_Pending.empty(); });
+					if (m_Pending.empty())
+					{
+						break;
+					}
+
+					buffers.swap(m_Pending);
+					lock.unlock();
+					for (auto& buffer : buffers)
+					{
+						m_File.write(reinterpret_cast<const char*>(buffer.data()),
+						             static_cast<std::streamsize>(buffer.size()));
+						m_WrittenSize += buffer.size();
+						buffer.clear();
+					}
+					lock.lock();
+
+					for (auto& buffer : buffers)
+					{
+						if (m_FreeBuffers.size() < MaxFreeBuffers)
+						{
+							m_FreeBuffers.push_back(std::move(buffer));
+						}
+					}
+					buffers.clear();
+				}
+			}
+		};
+
+		ThreadBufferHolder::~ThreadBufferHolder()
+		{
+			// 线程退出时交出剩余的事件，与 Append 相同，Stop 会等待此过程完成
+			Buffer->Writing.store(true, std::memory_order_seq_cst);
+			if (Active.load(std::memory_order_seq_cst) && !Buffer->Data.empty())
+			{
+				TraceWriter::GetInstance().Submit(Buffer->Data);
+			}
+			Buffer->Writing.store(false, std::memory_order_release);
+			Buffer->InUse.store(false, std::memory_order_release);
+		}
+
+		std::size_t EncodedSize(std::u16string_view str)
+		{
+			return sizeof(std::uint16_t) + std::min(str.size(), MaxStringLength) * sizeof(char16_t);
+		}
+
+		std::size_t EncodedSize(std::string_view str)
+		{
+			return sizeof(std::uint16_t) + std::min(str.size(), MaxStringLength);
+		}
+
+		class EventEncoder
+		{
+		public:
+			explicit EventEncoder(std::byte* data) : m_Data(data)
+			{
+			}
+
+			template <typename T>
+			void Write(T value)
+			{
+				std::memcpy(m_Data, &value, sizeof(value));
+				m_Data += sizeof(value);
+			}
+
+			template <typename CharT>
+			void WriteString(std::basic_string_view<CharT> str)
+			{
+				const auto length = std::min(str.size(), MaxStringLength);
+				Write(static_cast<std::uint16_t>(length));
+				std::memcpy(m_Data, str.data(), length * sizeof(CharT));
+				m_Data += length * sizeof(CharT);
+			}
+
+		private:
+			std::byte* m_Data;
+		};
+
+		std::uint64_t QueryKey(const void* query)
+		{
+			return static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(query));
+		}
+
+		// 不能放在 Append 中，否则每种事件各自实例化出一个线程局部缓冲区
+		ThreadBuffer* GetThreadBuffer()
+		{
+			thread_local ThreadBufferHolder holder;
+			return holder.Buffer;
+		}
+
+		template <typename Encoder>
+		void Append(EventType type, std::size_t payloadSize, Encoder&& encode)
+		{
+			const auto buffer = GetThreadBuffer();
+
+			buffer->Writing.store(true, std::memory_order_seq_cst);
+			if (Active.load(std::memory_order_seq_cst))
+			{
+				const auto timestamp = static_cast<std::uint64_t>(
+				    std::chrono::duration_cast<std::chrono::nanoseconds>(
+				        std::chrono::steady_clock::now() - StartTime)
+				        .count());
+
+				auto& data = buffer->Data;
+				const auto eventSize = EventHeaderSize + payloadSize;
+				if (data.size() + eventSize > BufferSize)
+				{
+					TraceWriter::GetInstance().Submit(data);
+				}
+
+				const auto offset = data.size();
+				data.resize(offset + eventSize);
+				EventEncoder encoder(data.data() + offset);
+				encoder.Write(timestamp);
+				encoder.Write(buffer->Index);
+				encoder.Write(type);
+				encoder.Write(static_cast<std::uint16_t>(payloadSize));
+				std::forward<Encoder>(encode)(encoder);
+			}
+			buffer->Writing.store(false, std::memory_order_release);
+		}
+
+		class EventDecoder
+		{
+		public:
+			EventDecoder(const std::byte* data, std::size_t size) : m_Data(data), m_Size(size)
+			{
+			}
+
+			bool AtEnd() const
+			{
+				return !m_Size;
+			}
+
+			template <typename T>
+			bool Read(T& value)
+			{
+				if (m_Size < sizeof(value))
+				{
+					return false;
+				}
+				std::memcpy(&value, m_Data, sizeof(value));
+				Skip(sizeof(value));
+				return true;
+			}
+
+			template <typename CharT>
+			bool ReadString(std::basic_string<CharT>& str)
+			{
+				std::uint16_t length;
+				if (!Read(length) || m_Size < length * sizeof(CharT))
+				{
+					return false;
+				}
+				str.resize(length);
+				std::memcpy(str.data(), m_Data, length * sizeof(CharT));
+				Skip(length * sizeof(CharT));
+				return true;
+			}
+
+			// 截取接下来的 size 字节作为新的解码器
+			bool Split(std::size_t size, EventDecoder& decoder)
+			{
+				if (m_Size < size)
+				{
+					return false;
+				}
+				decoder = EventDecoder(m_Data, size);
+				Skip(size);
+				return true;
+			}
+
+		private:
+			const std::byte* m_Data;
+			std::size_t m_Size;
+
+			void Skip(std::size_t size)
+			{
+				m_Data += size;
+				m_Size -= size;
+			}
+		};
+
+		bool DecodePayload(EventDecoder& decoder, Event& event)
+		{
+			switch (event.Type)
+			{
+			case EventType::LocalizeJP_Get:
+				return decoder.Read(event.Index);
+			case EventType::AssetBundle_LoadAsset:
+				return decoder.ReadString(event.Text) && decoder.ReadString(event.ClassName);
+			case EventType::Query_ctor:
+				return decoder.Read(event.Query) && decoder.ReadString(event.Text);
+			case EventType::PreparedQuery_BindInt:
+				return decoder.Read(event.Query) && decoder.Read(event.Index) &&
+				       decoder.Read(event.Value);
+			case EventType::Query_Step: {
+				std::uint8_t result;
+				std::uint8_t columnCount;
+				if (!decoder.Read(event.Query) || !decoder.Read(result) ||
+				    !decoder.Read(columnCount) || columnCount > MaxStepColumns)
+				{
+					return false;
+				}
+				event.Result = result;
+				event.ColumnCount = columnCount;
+				for (std::size_t i = 0; i < event.ColumnCount; ++i)
+				{
+					if (!decoder.Read(event.Columns[i].Index) ||
+					    !decoder.Read(event.Columns[i].Value))
+					{
+						return false;
+					}
+				}
+				return true;
+			}
+			case EventType::Query_GetText:
+				return decoder.Read(event.Query) && decoder.Read(event.Index);
+			case EventType::Query_Dispose:
+				return decoder.Read(event.Query);
+			default:
+				return false;
+			}
+		}
+	} // namespace
+
+	const char* GetEventName(EventType type)
+	{
+		return EventNames[static_cast<std::size_t>(type)];
+	}
+
+	bool Start(std::filesystem::path const& path)
+	{
+		if (!TraceWriter::GetInstance().Start(path))
+		{
+			Log::Error("UmaPyogin: Failed to start recording trace to {}", PATH_STR(path));
+			return false;
+		}
+		Log::Info("UmaPyogin: Recording trace to {}", PATH_STR(path));
+		return true;
+	}
+
+	void Stop()
+	{
+		TraceWriter::GetInstance().Stop();
+	}
+
+	void RecordLocalizeJP_Get(std::int32_t id)
+	{
+		Append(EventType::LocalizeJP_Get, sizeof(id),
+		       [&](EventEncoder& encoder) { encoder.Write(id); });
+	}
+
+	void RecordAssetBundle_LoadAsset(std::u16string_view name, std::string_view className)
+	{
+		Append(EventType::AssetBundle_LoadAsset, EncodedSize(name) + EncodedSize(className),
+		       [&](EventEncoder& encoder) {
+			       encoder.WriteString(name);
+			       encoder.WriteString(className);
+		       });
+	}
+
+	void RecordQuery_ctor(const void* query, std::u16string_view sql)
+	{
+		Append(EventType::Query_ctor, sizeof(std::uint64_t) + EncodedSize(sql),
+		       [&](EventEncoder& encoder) {
+			       encoder.Write(QueryKey(query));
+			       encoder.WriteString(sql);
+		       });
+	}
+
+	void RecordPreparedQuery_BindInt(const void* query, std::int32_t idx, std::int32_t value)
+	{
+		Append(EventType::PreparedQuery_BindInt,
+		       sizeof(std::uint64_t) + sizeof(idx) + sizeof(value), [&](EventEncoder& encoder) {
+			       encoder.Write(QueryKey(query));
+			       encoder.Write(idx);
+			       encoder.Write(value);
+		       });
+	}
+
+	void RecordQuery_Step(const void* query, bool result, std::span<const ColumnValue> columns)
+	{
+		const auto columnCount = std::min(columns.size(), MaxStepColumns);
+		Append(EventType::Query_Step,
+		       sizeof(std::uint64_t) + 2 * sizeof(std::uint8_t) +
+		           columnCount * 2 * sizeof(std::int32_t),
+		       [&](EventEncoder& encoder) {
+			       encoder.Write(QueryKey(query));
+			       encoder.Write(static_cast<std::uint8_t>(result));
+			       encoder.Write(static_cast<std::uint8_t>(columnCount));
+			       for (std::size_t i = 0; i < columnCount; ++i)
+			       {
+				       encoder.Write(columns[i].Index);
+				       encoder.Write(columns[i].Value);
+			       }
+		       });
+	}
+
+	void RecordQuery_GetText(const void* query, std::int32_t idx)
+	{
+		Append(EventType::Query_GetText, sizeof(std::uint64_t) + sizeof(idx),
+		       [&](EventEncoder& encoder) {
+			       encoder.Write(QueryKey(query));
+			       encoder.Write(idx);
+		       });
+	}
+
+	void RecordQuery_Dispose(const void* query)
+	{
+		Append(EventType::Query_Dispose, sizeof(std::uint64_t),
+		       [&](EventEncoder& encoder) { encoder.Write(QueryKey(query)); });
+	}
+
+	bool ReadTraceFile(std::filesystem::path const& path, std::vector<Event>& events)
+	{
+		const Misc::MappedFile file(path);
+		if (!file.IsOpen() || file.Size() < sizeof(TraceHeader))
+		{
+			Log::Error("UmaPyogin: Failed to read trace {}", PATH_STR(path));
+			return false;
+		}
+
+		TraceHeader header;
+		std::memcpy(&header, file.Data(), sizeof(header));
+		if (std::memcmp(header.Magic, TraceMagic, sizeof(TraceMagic)) != 0 ||
+		    header.Version != TraceVersion)
+		{
+			Log::Error("UmaPyogin: {} is not a supported trace", PATH_STR(path));
+			return false;
+		}
+
+		events.clear();
+		EventDecoder decoder(file.Data() + sizeof(header), file.Size() - sizeof(header));
+		while (!decoder.AtEnd())
+		{
+			Event event{};
+			std::uint16_t payloadSize;
+			EventDecoder payload(nullptr, 0);
+			if (!decoder.Read(event.Timestamp) || !decoder.Read(event.ThreadIndex) ||
+			    !decoder.Read(event.Type) || !decoder.Read(payloadSize) ||
+			    !decoder.Split(payloadSize, payload) || !DecodePayload(payload, event))
+			{
+				// 录制中途退出时最后的事件可能不完整，保留之前的事件
+				Log::Warn("UmaPyogin: Trace {} is truncated after {} events", PATH_STR(path),
+				          events.size());
+				break;
+			}
+			events.push_back(std::move(event));
+		}
+
+		// 文件中的事件按线程缓冲区分组，同一线程内的事件已按时间排列
+		std::stable_sort(events.begin(), events.end(), [](const auto& a, const auto& b) {
+			return a.Timestamp < b.Timestamp;
+		});
+		return true;
+	}
+} // namespace UmaPyogin::Trace
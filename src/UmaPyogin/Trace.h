@@ -0,0 +1,100 @@
+#ifndef UMAPYOGIN_TRACE_H
+#define UMAPYOGIN_TRACE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 录制钩子收到的调用序列，供 UmaPyoginTraceReplay 在游戏之外回放
+#define UMAPYOGIN_TRACED_HOOKS(X)                                                                  \
+	X(LocalizeJP_Get)                                                                              \
+	X(AssetBundle_LoadAsset)                                                                       \
+	X(Query_ctor)                                                                                  \
+	X(PreparedQuery_BindInt)                                                                       \
+	X(Query_Step)                                                                                  \
+	X(Query_GetText)                                                                               \
+	X(Query_Dispose)
+
+namespace UmaPyogin::Trace
+{
+	enum class EventType : std::uint8_t
+	{
+#define DEFINE_EVENT_TYPE(name) name,
+		UMAPYOGIN_TRACED_HOOKS(DEFINE_EVENT_TYPE)
+#undef DEFINE_EVENT_TYPE
+		Count,
+	};
+
+	constexpr std::size_t EventTypeCount = static_cast<std::size_t>(EventType::Count);
+
+	const char* GetEventName(EventType type);
+
+	// Query.Step 中读取的整数列
+	struct ColumnValue
+	{
+		std::int32_t Index;
+		std::int32_t Value;
+	};
+
+	// 每次 Step 至多记录的整数列数，现有查询至多读取一列
+	constexpr std::size_t MaxStepColumns = 4;
+
+	// 超过此长度的字符串在录制时截断
+	constexpr std::size_t MaxStringLength = 4096;
+
+	extern std::atomic<bool> Active;
+
+	// 钩子应先检查此值，未在录制时不计算参数
+	inline bool IsActive()
+	{
+		return Active.load(std::memory_order_relaxed);
+	}
+
+	// 事件先写入各线程独占的缓冲区，缓冲区写满后交由后台线程写入文件
+	// 文件已在录制时返回 false
+	bool Start(std::filesystem::path const& path);
+	// 写入各线程缓冲区中剩余的事件并关闭文件，退出时自动调用
+	void Stop();
+
+	void RecordLocalizeJP_Get(std::int32_t id);
+	// className 为加载得到的资源的类名，未加载到资源时为空
+	void RecordAssetBundle_LoadAsset(std::u16string_view name, std::string_view className);
+	void RecordQuery_ctor(const void* query, std::u16string_view sql);
+	void RecordPreparedQuery_BindInt(const void* query, std::int32_t idx, std::int32_t value);
+	void RecordQuery_Step(const void* query, bool result, std::span<const ColumnValue> columns);
+	void RecordQuery_GetText(const void* query, std::int32_t idx);
+	void RecordQuery_Dispose(const void* query);
+
+	struct Event
+	{
+		// 自开始录制起的纳秒数
+		std::uint64_t Timestamp;
+		// 按线程首次记录事件的顺序编号，先后录制的不同线程编号不同
+		std::uint32_t ThreadIndex;
+		EventType Type;
+		// 录制时 Query 对象的地址，仅用于区分不同的查询
+		std::uint64_t Query;
+		// LocalizeJP_Get 的 id，或 BindInt 与 GetText 的序号
+		std::int32_t Index;
+		// BindInt 绑定的值
+		std::int32_t Value;
+		// Step 的返回值
+		bool Result;
+		std::size_t ColumnCount;
+		std::array<ColumnValue, MaxStepColumns> Columns;
+		// SQL 语句或资源名
+		std::u16string Text;
+		std::string ClassName;
+	};
+
+	// 读取整个 Trace 文件，事件按时间排序
+	bool ReadTraceFile(std::filesystem::path const& path, std::vector<Event>& events);
+} // namespace UmaPyogin::Trace
+
+#endif
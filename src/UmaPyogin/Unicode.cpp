@@ -0,0 +1,908 @@
+#include "Misc.h"
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#define UMAPYOGIN_UNICODE_SSE2 1
+// GCC/Clang 可为单个函数启用 SSSE3 与 AVX2，并在运行时选择实现
+#if defined(__GNUC__) || defined(__clang__)
+#define UMAPYOGIN_UNICODE_SSSE3 1
+#define UMAPYOGIN_UNICODE_AVX2 1
+#endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define UMAPYOGIN_UNICODE_NEON 1
+#endif
+
+namespace UmaPyogin::Misc
+{
+	namespace
+	{
+		constexpr bool IsContinuation(unsigned char c)
+		{
+			return (c & 0xC0) == 0x80;
+		}
+
+		// 以三字节 UTF-8 序列编码的 UTF-16 代码单元，即 U+0800 起除代理项以外的字符
+		constexpr bool IsThreeByteUnit(char16_t c)
+		{
+			return c >= 0x800 && (c < 0xD800 || c > 0xDFFF);
+		}
+
+		// 解码以非 ASCII 字节开头的一个序列，返回其字节数，非法时返回 0
+		// 拒绝过长编码、代理项以及超出 U+10FFFF 的码点
+		std::size_t DecodeSequence(const unsigned char* input, std::size_t size,
+		                           char32_t& codePoint)
+		{
+			const auto lead = input[0];
+			if (lead < 0xC2)
+			{
+				return 0;
+			}
+			if (lead < 0xE0)
+			{
+				if (size < 2 || !IsContinuation(input[1]))
+				{
+					return 0;
+				}
+				codePoint = (char32_t(lead & 0x1F) << 6) | (input[1] & 0x3F);
+				return 2;
+			}
+			if (lead < 0xF0)
+			{
+				if (size < 3 || !IsContinuation(input[1]) || !IsContinuation(input[2]))
+				{
+					return 0;
+				}
+				codePoint = (char32_t(lead & 0x0F) << 12) | (char32_t(input[1] & 0x3F) << 6) |
+				            (input[2] & 0x3F);
+				if (codePoint < 0x800 || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+				{
+					return 0;
+				}
+				return 3;
+			}
+			if (lead < 0xF5)
+			{
+				if (size < 4 || !IsContinuation(input[1]) || !IsContinuation(input[2]) ||
+				    !IsContinuation(input[3]))
+				{
+					return 0;
+				}
+				codePoint = (char32_t(lead & 0x07) << 18) | (char32_t(input[1] & 0x3F) << 12) |
+				            (char32_t(input[2] & 0x3F) << 6) | (input[3] & 0x3F);
+				if (codePoint < 0x10000 || codePoint > 0x10FFFF)
+				{
+					return 0;
+				}
+				return 4;
+			}
+			return 0;
+		}
+
+		// 以下函数转换输入开头的 ASCII 部分，返回转换的代码单元数
+		using WidenAsciiFunction = std::size_t (*)(const char* input, std::size_t size,
+		                                           char16_t* output);
+		using NarrowAsciiFunction = std::size_t (*)(const char16_t* input, std::size_t size,
+		                                            char* output);
+		// 以下函数转换输入开头连续的合法双字节或三字节序列，返回转换的字符数
+		// 向量实现按块处理，不足一块的部分留给调用方逐个转换
+		using DecodeFunction = std::size_t (*)(const unsigned char* input, std::size_t size,
+		                                       char16_t* output);
+		using EncodeFunction = std::size_t (*)(const char16_t* input, std::size_t size,
+		                                       char* output);
+
+		std::size_t WidenAsciiScalar(const char* input, std::size_t size, char16_t* output)
+		{
+			std::size_t i = 0;
+			while (i < size && static_cast<unsigned char>(input[i]) < 0x80)
+			{
+				output[i] = static_cast<char16_t>(input[i]);
+				++i;
+			}
+			return i;
+		}
+
+		std::size_t NarrowAsciiScalar(const char16_t* input, std::size_t size, char* output)
+		{
+			std::size_t i = 0;
+			while (i < size && input[i] < 0x80)
+			{
+				output[i] = static_cast<char>(input[i]);
+				++i;
+			}
+			return i;
+		}
+
+		// 以下为不支持向量指令时的实现，x86 仅使用其中三字节的版本，ARM 全部使用 NEON 实现
+#if !UMAPYOGIN_UNICODE_SSE2 && !UMAPYOGIN_UNICODE_NEON
+		std::size_t DecodeTwoByteScalar(const unsigned char* input, std::size_t size,
+		                                char16_t* output)
+		{
+			std::size_t count = 0;
+			for (; count * 2 + 2 <= size; ++count)
+			{
+				const auto lead = input[count * 2];
+				const auto trail = input[count * 2 + 1];
+				if (lead < 0xC2 || lead >= 0xE0 || !IsContinuation(trail))
+				{
+					break;
+				}
+				output[count] = static_cast<char16_t>(((lead & 0x1F) << 6) | (trail & 0x3F));
+			}
+			return count;
+		}
+#endif
+
+#if !UMAPYOGIN_UNICODE_NEON
+		std::size_t DecodeThreeByteScalar(const unsigned char* input, std::size_t size,
+		                                  char16_t* output)
+		{
+			std::size_t count = 0;
+			char32_t codePoint;
+			for (; count * 3 + 3 <= size; ++count)
+			{
+				if ((input[count * 3] & 0xF0) != 0xE0 ||
+				    !DecodeSequence(input + count * 3, size - count * 3, codePoint))
+				{
+					break;
+				}
+				output[count] = static_cast<char16_t>(codePoint);
+			}
+			return count;
+		}
+#endif
+
+#if !UMAPYOGIN_UNICODE_SSE2 && !UMAPYOGIN_UNICODE_NEON
+		std::size_t EncodeTwoByteScalar(const char16_t* input, std::size_t size, char* output)
+		{
+			std::size_t count = 0;
+			for (; count < size && input[count] >= 0x80 && input[count] < 0x800; ++count)
+			{
+				output[count * 2] = static_cast<char>(0xC0 | (input[count] >> 6));
+				output[count * 2 + 1] = static_cast<char>(0x80 | (input[count] & 0x3F));
+			}
+			return count;
+		}
+#endif
+
+#if !UMAPYOGIN_UNICODE_NEON
+		std::size_t EncodeThreeByteScalar(const char16_t* input, std::size_t size, char* output)
+		{
+			std::size_t count = 0;
+			for (; count < size && IsThreeByteUnit(input[count]); ++count)
+			{
+				output[count * 3] = static_cast<char>(0xE0 | (input[count] >> 12));
+				output[count * 3 + 1] = static_cast<char>(0x80 | ((input[count] >> 6) & 0x3F));
+				output[count * 3 + 2] = static_cast<char>(0x80 | (input[count] & 0x3F));
+			}
+			return count;
+		}
+#endif
+
+#if UMAPYOGIN_UNICODE_SSE2
+		std::size_t WidenAsciiSse2(const char* input, std::size_t size, char16_t* output)
+		{
+			const auto zero = _mm_setzero_si128();
+			std::size_t i = 0;
+			for (; i + 16 <= size; i += 16)
+			{
+				const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+				if (_mm_movemask_epi8(chunk))
+				{
+					break;
+				}
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i),
+				                 _mm_unpacklo_epi8(chunk, zero));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i + 8),
+				                 _mm_unpackhi_epi8(chunk, zero));
+			}
+			return i + WidenAsciiScalar(input + i, size - i, output + i);
+		}
+
+		std::size_t NarrowAsciiSse2(const char16_t* input, std::size_t size, char* output)
+		{
+			const auto zero = _mm_setzero_si128();
+			const auto nonAsciiMask = _mm_set1_epi16(static_cast<short>(0xFF80));
+			std::size_t i = 0;
+			for (; i + 8 <= size; i += 8)
+			{
+				const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+				const auto isAscii = _mm_cmpeq_epi16(_mm_and_si128(chunk, nonAsciiMask), zero);
+				if (_mm_movemask_epi8(isAscii) != 0xFFFF)
+				{
+					break;
+				}
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(output + i),
+				                 _mm_packus_epi16(chunk, chunk));
+			}
+			return i + NarrowAsciiScalar(input + i, size - i, output + i);
+		}
+
+		// 每次处理 8 个字符，即 16 个字节
+		std::size_t DecodeTwoByteSse2(const unsigned char* input, std::size_t size,
+		                              char16_t* output)
+		{
+			const auto zero = _mm_setzero_si128();
+			// 每个 16 位通道的低字节为首字节，高字节为后续字节
+			const auto patternMask = _mm_set1_epi16(static_cast<short>(0xC0E0));
+			const auto pattern = _mm_set1_epi16(static_cast<short>(0x80C0));
+			std::size_t count = 0;
+			for (; count * 2 + 16 <= size; count += 8)
+			{
+				const auto chunk =
+				    _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + count * 2));
+				const auto matches = _mm_cmpeq_epi8(_mm_and_si128(chunk, patternMask), pattern);
+				const auto codeUnits = _mm_or_si128(
+				    _mm_slli_epi16(_mm_and_si128(chunk, _mm_set1_epi16(0x1F)), 6),
+				    _mm_and_si128(_mm_srli_epi16(chunk, 8), _mm_set1_epi16(0x3F)));
+				// 首字节为 C0 或 C1 的过长编码解码后小于 0x80
+				const auto overlong =
+				    _mm_cmpeq_epi16(_mm_and_si128(codeUnits, _mm_set1_epi16(0x780)), zero);
+				if (_mm_movemask_epi8(matches) != 0xFFFF || _mm_movemask_epi8(overlong))
+				{
+					break;
+				}
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(output + count), codeUnits);
+			}
+			return count;
+		}
+
+		// 每次处理 8 个代码单元，写入 16 个字节
+		std::size_t EncodeTwoByteSse2(const char16_t* input, std::size_t size, char* output)
+		{
+			const auto zero = _mm_setzero_si128();
+			std::size_t count = 0;
+			for (; count + 8 <= size; count += 8)
+			{
+				const auto chunk =
+				    _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + count));
+				const auto fits = _mm_cmpeq_epi16(
+				    _mm_and_si128(chunk, _mm_set1_epi16(static_cast<short>(0xF800))), zero);
+				const auto isAscii = _mm_cmpeq_epi16(
+				    _mm_and_si128(chunk, _mm_set1_epi16(static_cast<short>(0xFF80))), zero);
+				if (_mm_movemask_epi8(fits) != 0xFFFF || _mm_movemask_epi8(isAscii))
+				{
+					break;
+				}
+				const auto lead = _mm_or_si128(_mm_srli_epi16(chunk, 6), _mm_set1_epi16(0xC0));
+				const auto trail = _mm_or_si128(_mm_and_si128(chunk, _mm_set1_epi16(0x3F)),
+				                                _mm_set1_epi16(0x80));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(output + count * 2),
+				                 _mm_or_si128(lead, _mm_slli_epi16(trail, 8)));
+			}
+			return count;
+		}
+
+		// 返回每个 16 位通道是否不能以三字节序列编码，即小于 0x800 或为代理项
+		inline __m128i IsNotThreeByteUnit(__m128i codeUnits)
+		{
+			const auto high = _mm_and_si128(codeUnits, _mm_set1_epi16(static_cast<short>(0xF800)));
+			return _mm_or_si128(_mm_cmpeq_epi16(high, _mm_setzero_si128()),
+			                    _mm_cmpeq_epi16(high, _mm_set1_epi16(static_cast<short>(0xD800))));
+		}
+
+#endif
+
+#if UMAPYOGIN_UNICODE_SSSE3
+		// 每次读取 16 个字节，转换其中的 4 个字符
+		__attribute__((target("ssse3"))) std::size_t
+		DecodeThreeByteSsse3(const unsigned char* input, std::size_t size, char16_t* output)
+		{
+			const auto patternMask = _mm_setr_epi8(
+			    char(0xF0), char(0xC0), char(0xC0), char(0xF0), char(0xC0), char(0xC0), char(0xF0),
+			    char(0xC0), char(0xC0), char(0xF0), char(0xC0), char(0xC0), 0, 0, 0, 0);
+			const auto pattern = _mm_setr_epi8(
+			    char(0xE0), char(0x80), char(0x80), char(0xE0), char(0x80), char(0x80), char(0xE0),
+			    char(0x80), char(0x80), char(0xE0), char(0x80), char(0x80), 0, 0, 0, 0);
+			// 前者的每个 16 位通道为 (第二字节 << 8) | 第三字节，后者为首字节
+			const auto trailShuffle =
+			    _mm_setr_epi8(2, 1, 5, 4, 8, 7, 11, 10, -1, -1, -1, -1, -1, -1, -1, -1);
+			const auto leadShuffle =
+			    _mm_setr_epi8(0, -1, 3, -1, 6, -1, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+			std::size_t count = 0;
+			for (; count * 3 + 16 <= size; count += 4)
+			{
+				const auto chunk =
+				    _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + count * 3));
+				const auto matches = _mm_cmpeq_epi8(_mm_and_si128(chunk, patternMask), pattern);
+				if (_mm_movemask_epi8(matches) != 0xFFFF)
+				{
+					break;
+				}
+
+				const auto trails = _mm_shuffle_epi8(chunk, trailShuffle);
+				const auto leads = _mm_shuffle_epi8(chunk, leadShuffle);
+				const auto codeUnits = _mm_or_si128(
+				    _mm_or_si128(_mm_slli_epi16(_mm_and_si128(leads, _mm_set1_epi16(0x0F)), 12),
+				                 _mm_srli_epi16(_mm_and_si128(trails, _mm_set1_epi16(0x3F00)), 2)),
+				    _mm_and_si128(trails, _mm_set1_epi16(0x3F)));
+				// 过长编码与代理项，只检查有效的 4 个通道
+				if (_mm_movemask_epi8(IsNotThreeByteUnit(codeUnits)) & 0xFF)
+				{
+					break;
+				}
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(output + count), codeUnits);
+			}
+			return count;
+		}
+
+		// 每次处理 8 个代码单元，写入 24 个字节
+		__attribute__((target("ssse3"))) std::size_t
+		EncodeThreeByteSsse3(const char16_t* input, std::size_t size, char* output)
+		{
+			// 输出的第 3k、3k + 1 字节取自 leadMiddle 的第 2k、2k + 1 字节，第 3k + 2 字节取自
+			// trails 的第 k 字节
+			const auto leadMiddleShuffle0 =
+			    _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10);
+			const auto trailShuffle0 =
+			    _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1);
+			const auto leadMiddleShuffle1 =
+			    _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+			const auto trailShuffle1 =
+			    _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, -1, -1, -1, -1, -1, -1);
+			std::size_t count = 0;
+			for (; count + 8 <= size; count += 8)
+			{
+				const auto chunk =
+				    _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + count));
+				if (_mm_movemask_epi8(IsNotThreeByteUnit(chunk)))
+				{
+					break;
+				}
+
+				const auto leads = _mm_or_si128(_mm_srli_epi16(chunk, 12), _mm_set1_epi16(0xE0));
+				const auto middles = _mm_or_si128(
+				    _mm_and_si128(_mm_srli_epi16(chunk, 6), _mm_set1_epi16(0x3F)),
+				    _mm_set1_epi16(0x80));
+				const auto leadMiddle = _mm_or_si128(leads, _mm_slli_epi16(middles, 8));
+				const auto trailWords = _mm_or_si128(_mm_and_si128(chunk, _mm_set1_epi16(0x3F)),
+				                                     _mm_set1_epi16(0x80));
+				const auto trails = _mm_packus_epi16(trailWords, trailWords);
+
+				const auto out = output + count * 3;
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+				                 _mm_or_si128(_mm_shuffle_epi8(leadMiddle, leadMiddleShuffle0),
+				                              _mm_shuffle_epi8(trails, trailShuffle0)));
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(out + 16),
+				                 _mm_or_si128(_mm_shuffle_epi8(leadMiddle, leadMiddleShuffle1),
+				                              _mm_shuffle_epi8(trails, trailShuffle1)));
+			}
+			return count;
+		}
+#endif
+
+#if UMAPYOGIN_UNICODE_AVX2
+		__attribute__((target("avx2"))) std::size_t
+		WidenAsciiAvx2(const char* input, std::size_t size, char16_t* output)
+		{
+			std::size_t i = 0;
+			for (; i + 32 <= size; i += 32)
+			{
+				const auto chunk =
+				    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+				if (_mm256_movemask_epi8(chunk))
+				{
+					break;
+				}
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i),
+				                    _mm256_cvtepu8_epi16(_mm256_castsi256_si128(chunk)));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i + 16),
+				                    _mm256_cvtepu8_epi16(_mm256_extracti128_si256(chunk, 1)));
+			}
+			return i + WidenAsciiSse2(input + i, size - i, output + i);
+		}
+
+		__attribute__((target("avx2"))) std::size_t
+		NarrowAsciiAvx2(const char16_t* input, std::size_t size, char* output)
+		{
+			const auto nonAsciiMask = _mm256_set1_epi16(static_cast<short>(0xFF80));
+			std::size_t i = 0;
+			for (; i + 16 <= size; i += 16)
+			{
+				const auto chunk =
+				    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+				if (!_mm256_testz_si256(chunk, nonAsciiMask))
+				{
+					break;
+				}
+				// packus 在每个 128 位通道内独立收窄，需要把两个通道的低 64 位拼接起来
+				const auto packed =
+				    _mm256_permute4x64_epi64(_mm256_packus_epi16(chunk, chunk), 0b1000);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(output + i),
+				                 _mm256_castsi256_si128(packed));
+			}
+			return i + NarrowAsciiSse2(input + i, size - i, output + i);
+		}
+#endif
+
+#if UMAPYOGIN_UNICODE_NEON
+		std::size_t WidenAsciiNeon(const char* input, std::size_t size, char16_t* output)
+		{
+			std::size_t i = 0;
+			for (; i + 16 <= size; i += 16)
+			{
+				const auto chunk = vld1q_u8(reinterpret_cast<const std::uint8_t*>(input + i));
+				if (vmaxvq_u8(chunk) >= 0x80)
+				{
+					break;
+				}
+				const auto out = reinterpret_cast<std::uint16_t*>(output + i);
+				vst1q_u16(out, vmovl_u8(vget_low_u8(chunk)));
+				vst1q_u16(out + 8, vmovl_high_u8(chunk));
+			}
+			return i + WidenAsciiScalar(input + i, size - i, output + i);
+		}
+
+		std::size_t NarrowAsciiNeon(const char16_t* input, std::size_t size, char* output)
+		{
+			std::size_t i = 0;
+			for (; i + 8 <= size; i += 8)
+			{
+				const auto chunk = vld1q_u16(reinterpret_cast<const std::uint16_t*>(input + i));
+				if (vmaxvq_u16(chunk) >= 0x80)
+				{
+					break;
+				}
+				vst1_u8(reinterpret_cast<std::uint8_t*>(output + i), vmovn_u16(chunk));
+			}
+			return i + NarrowAsciiScalar(input + i, size - i, output + i);
+		}
+
+		inline uint8x16_t IsContinuationNeon(uint8x16_t bytes)
+		{
+			return vceqq_u8(vandq_u8(bytes, vdupq_n_u8(0xC0)), vdupq_n_u8(0x80));
+		}
+
+		inline uint16x8_t IsNotThreeByteUnitNeon(uint16x8_t codeUnits)
+		{
+			const auto high = vandq_u16(codeUnits, vdupq_n_u16(0xF800));
+			return vorrq_u16(vceqq_u16(high, vdupq_n_u16(0)), vceqq_u16(high, vdupq_n_u16(0xD800)));
+		}
+
+		// 每次以 vld2 读取 16 个字符的首字节与后续字节
+		std::size_t DecodeTwoByteNeon(const unsigned char* input, std::size_t size,
+		                              char16_t* output)
+		{
+			std::size_t count = 0;
+			for (; count * 2 + 32 <= size; count += 16)
+			{
+				const auto bytes = vld2q_u8(input + count * 2);
+				const auto valid =
+				    vandq_u8(vandq_u8(vceqq_u8(vandq_u8(bytes.val[0], vdupq_n_u8(0xE0)),
+				                               vdupq_n_u8(0xC0)),
+				                      vcgeq_u8(bytes.val[0], vdupq_n_u8(0xC2))),
+				             IsContinuationNeon(bytes.val[1]));
+				if (vminvq_u8(valid) != 0xFF)
+				{
+					break;
+				}
+
+				const auto leads = vandq_u8(bytes.val[0], vdupq_n_u8(0x1F));
+				const auto trails = vandq_u8(bytes.val[1], vdupq_n_u8(0x3F));
+				const auto out = reinterpret_cast<std::uint16_t*>(output + count);
+				vst1q_u16(out, vorrq_u16(vshll_n_u8(vget_low_u8(leads), 6),
+				                         vmovl_u8(vget_low_u8(trails))));
+				vst1q_u16(out + 8,
+				          vorrq_u16(vshll_n_u8(vget_high_u8(leads), 6), vmovl_high_u8(trails)));
+			}
+			return count;
+		}
+
+		// 每次以 vld3 读取 16 个字符的三个字节
+		std::size_t DecodeThreeByteNeon(const unsigned char* input, std::size_t size,
+		                                char16_t* output)
+		{
+			std::size_t count = 0;
+			for (; count * 3 + 48 <= size; count += 16)
+			{
+				const auto bytes = vld3q_u8(input + count * 3);
+				const auto valid = vandq_u8(
+				    vceqq_u8(vandq_u8(bytes.val[0], vdupq_n_u8(0xF0)), vdupq_n_u8(0xE0)),
+				    vandq_u8(IsContinuationNeon(bytes.val[1]), IsContinuationNeon(bytes.val[2])));
+				if (vminvq_u8(valid) != 0xFF)
+				{
+					break;
+				}
+
+				const auto leads = vandq_u8(bytes.val[0], vdupq_n_u8(0x0F));
+				const auto middles = vandq_u8(bytes.val[1], vdupq_n_u8(0x3F));
+				const auto trails = vandq_u8(bytes.val[2], vdupq_n_u8(0x3F));
+				const auto low = vorrq_u16(vorrq_u16(vshlq_n_u16(vmovl_u8(vget_low_u8(leads)), 12),
+				                                     vshll_n_u8(vget_low_u8(middles), 6)),
+				                           vmovl_u8(vget_low_u8(trails)));
+				const auto high = vorrq_u16(vorrq_u16(vshlq_n_u16(vmovl_high_u8(leads), 12),
+				                                      vshll_n_u8(vget_high_u8(middles), 6)),
+				                            vmovl_high_u8(trails));
+				// 过长编码与代理项
+				if (vmaxvq_u16(
+				        vorrq_u16(IsNotThreeByteUnitNeon(low), IsNotThreeByteUnitNeon(high))))
+				{
+					break;
+				}
+
+				const auto out = reinterpret_cast<std::uint16_t*>(output + count);
+				vst1q_u16(out, low);
+				vst1q_u16(out + 8, high);
+			}
+			return count;
+		}
+
+		// 每次处理 16 个代码单元，以 vst2 交错写入首字节与后续字节
+		std::size_t EncodeTwoByteNeon(const char16_t* input, std::size_t size, char* output)
+		{
+			std::size_t count = 0;
+			for (; count + 16 <= size; count += 16)
+			{
+				const auto in = reinterpret_cast<const std::uint16_t*>(input + count);
+				const auto low = vld1q_u16(in);
+				const auto high = vld1q_u16(in + 8);
+				const auto invalid = vorrq_u16(vorrq_u16(vcltq_u16(low, vdupq_n_u16(0x80)),
+				                                         vcgeq_u16(low, vdupq_n_u16(0x800))),
+				                               vorrq_u16(vcltq_u16(high, vdupq_n_u16(0x80)),
+				                                         vcgeq_u16(high, vdupq_n_u16(0x800))));
+				if (vmaxvq_u16(invalid))
+				{
+					break;
+				}
+
+				uint8x16x2_t bytes;
+				bytes.val[0] = vorrq_u8(vcombine_u8(vshrn_n_u16(low, 6), vshrn_n_u16(high, 6)),
+				                        vdupq_n_u8(0xC0));
+				bytes.val[1] = vorrq_u8(
+				    vandq_u8(vcombine_u8(vmovn_u16(low), vmovn_u16(high)), vdupq_n_u8(0x3F)),
+				    vdupq_n_u8(0x80));
+				vst2q_u8(reinterpret_cast<std::uint8_t*>(output + count * 2), bytes);
+			}
+			return count;
+		}
+
+		// 每次处理 16 个代码单元，以 vst3 交错写入三个字节
+		std::size_t EncodeThreeByteNeon(const char16_t* input, std::size_t size, char* output)
+		{
+			std::size_t count = 0;
+			for (; count + 16 <= size; count += 16)
+			{
+				const auto in = reinterpret_cast<const std::uint16_t*>(input + count);
+				const auto low = vld1q_u16(in);
+				const auto high = vld1q_u16(in + 8);
+				if (vmaxvq_u16(
+				        vorrq_u16(IsNotThreeByteUnitNeon(low), IsNotThreeByteUnitNeon(high))))
+				{
+					break;
+				}
+
+				uint8x16x3_t bytes;
+				bytes.val[0] = vorrq_u8(vcombine_u8(vmovn_u16(vshrq_n_u16(low, 12)),
+				                                    vmovn_u16(vshrq_n_u16(high, 12))),
+				                        vdupq_n_u8(0xE0));
+				bytes.val[1] =
+				    vorrq_u8(vandq_u8(vcombine_u8(vshrn_n_u16(low, 6), vshrn_n_u16(high, 6)),
+				                      vdupq_n_u8(0x3F)),
+				             vdupq_n_u8(0x80));
+				bytes.val[2] = vorrq_u8(
+				    vandq_u8(vcombine_u8(vmovn_u16(low), vmovn_u16(high)), vdupq_n_u8(0x3F)),
+				    vdupq_n_u8(0x80));
+				vst3q_u8(reinterpret_cast<std::uint8_t*>(output + count * 3), bytes);
+			}
+			return count;
+		}
+#endif
+
+		// 向量实现一次处理的字符数，以及解码三字节序列时一次读取的字节数
+		// 同类字符连续不足一块时直接逐个转换，不经由函数指针调用向量实现
+#if UMAPYOGIN_UNICODE_NEON
+		constexpr std::size_t WidenBlock = 16;
+		constexpr std::size_t NarrowBlock = 8;
+		constexpr std::size_t TwoByteBlock = 16;
+		constexpr std::size_t DecodeThreeByteBlock = 16;
+		constexpr std::size_t DecodeThreeByteLoad = 48;
+		constexpr std::size_t EncodeThreeByteBlock = 16;
+#elif UMAPYOGIN_UNICODE_SSE2
+		constexpr std::size_t WidenBlock = 16;
+		constexpr std::size_t NarrowBlock = 8;
+		constexpr std::size_t TwoByteBlock = 8;
+		constexpr std::size_t DecodeThreeByteBlock = 4;
+		constexpr std::size_t DecodeThreeByteLoad = 16;
+		constexpr std::size_t EncodeThreeByteBlock = 8;
+#else
+		constexpr std::size_t WidenBlock = 1;
+		constexpr std::size_t NarrowBlock = 1;
+		constexpr std::size_t TwoByteBlock = 1;
+		constexpr std::size_t DecodeThreeByteBlock = 1;
+		constexpr std::size_t DecodeThreeByteLoad = 3;
+		constexpr std::size_t EncodeThreeByteBlock = 1;
+#endif
+
+		struct TranscodeFunctions
+		{
+			WidenAsciiFunction WidenAscii;
+			NarrowAsciiFunction NarrowAscii;
+			DecodeFunction DecodeTwoByte;
+			DecodeFunction DecodeThreeByte;
+			EncodeFunction EncodeTwoByte;
+			EncodeFunction EncodeThreeByte;
+		};
+
+		TranscodeFunctions SelectTranscodeFunctions()
+		{
+#if UMAPYOGIN_UNICODE_SSE2
+			TranscodeFunctions functions{
+				WidenAsciiSse2,      NarrowAsciiSse2,   DecodeTwoByteSse2,
+				DecodeThreeByteScalar, EncodeTwoByteSse2, EncodeThreeByteScalar,
+			};
+#if UMAPYOGIN_UNICODE_SSSE3
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("ssse3"))
+			{
+				functions.DecodeThreeByte = DecodeThreeByteSsse3;
+				functions.EncodeThreeByte = EncodeThreeByteSsse3;
+			}
+#endif
+#if UMAPYOGIN_UNICODE_AVX2
+			if (__builtin_cpu_supports("avx2"))
+			{
+				functions.WidenAscii = WidenAsciiAvx2;
+				functions.NarrowAscii = NarrowAsciiAvx2;
+			}
+#endif
+			return functions;
+#elif UMAPYOGIN_UNICODE_NEON
+			return { WidenAsciiNeon,      NarrowAsciiNeon,   DecodeTwoByteNeon,
+				     DecodeThreeByteNeon, EncodeTwoByteNeon, EncodeThreeByteNeon };
+#else
+			return { WidenAsciiScalar,      NarrowAsciiScalar,   DecodeTwoByteScalar,
+				     DecodeThreeByteScalar, EncodeTwoByteScalar, EncodeThreeByteScalar };
+#endif
+		}
+
+		// 首次转换时才检测 CPU 特性，不依赖其他翻译单元中静态初始化的顺序
+		TranscodeFunctions const& GetTranscodeFunctions()
+		{
+			static const auto functions = SelectTranscodeFunctions();
+			return functions;
+		}
+
+		// Replace 为 true 时以 U+FFFD 替换非法字节并继续，否则在首个非法序列处停止
+		// 每个输入字节至多产生一个输出代码单元
+		template <bool Replace>
+		TranscodeResult DecodeUTF8(std::string_view str, char16_t* output)
+		{
+			const auto& functions = GetTranscodeFunctions();
+			const auto input = reinterpret_cast<const unsigned char*>(str.data());
+			const auto size = str.size();
+			std::size_t i = 0;
+			std::size_t o = 0;
+			while (i < size)
+			{
+				// 块内最后一个字符与当前字符同类时才调用向量实现，其余字符由向量实现验证
+				const auto lead = input[i];
+				if (lead < 0x80)
+				{
+					if (size - i >= WidenBlock && input[i + WidenBlock - 1] < 0x80)
+					{
+						const auto count =
+						    functions.WidenAscii(str.data() + i, size - i, output + o);
+						i += count;
+						o += count;
+						continue;
+					}
+					output[o++] = lead;
+					++i;
+					continue;
+				}
+
+				if ((lead & 0xF0) == 0xE0 && size - i >= DecodeThreeByteLoad &&
+				    (input[i + (DecodeThreeByteBlock - 1) * 3] & 0xF0) == 0xE0)
+				{
+					if (const auto count =
+					        functions.DecodeThreeByte(input + i, size - i, output + o))
+					{
+						i += count * 3;
+						o += count;
+						continue;
+					}
+				}
+				else if ((lead & 0xE0) == 0xC0 && size - i >= TwoByteBlock * 2 &&
+				         (input[i + (TwoByteBlock - 1) * 2] & 0xE0) == 0xC0)
+				{
+					if (const auto count =
+					        functions.DecodeTwoByte(input + i, size - i, output + o))
+					{
+						i += count * 2;
+						o += count;
+						continue;
+					}
+				}
+
+				char32_t codePoint;
+				const auto length = DecodeSequence(input + i, size - i, codePoint);
+				if (!length)
+				{
+					if constexpr (Replace)
+					{
+						output[o++] = u'\uFFFD';
+						++i;
+						continue;
+					}
+					else
+					{
+						return { o, i };
+					}
+				}
+
+				if (codePoint >= 0x10000)
+				{
+					codePoint -= 0x10000;
+					output[o++] = static_cast<char16_t>(0xD800 + (codePoint >> 10));
+					output[o++] = static_cast<char16_t>(0xDC00 + (codePoint & 0x3FF));
+				}
+				else
+				{
+					output[o++] = static_cast<char16_t>(codePoint);
+				}
+				i += length;
+			}
+			return { o, TranscodeResult::npos };
+		}
+
+		// 每个输入代码单元至多产生 3 个输出字节
+		template <bool Replace>
+		TranscodeResult EncodeUTF8(std::u16string_view str, char* output)
+		{
+			const auto& functions = GetTranscodeFunctions();
+			const auto size = str.size();
+			std::size_t i = 0;
+			std::size_t o = 0;
+			while (i < size)
+			{
+				const char32_t c = str[i];
+				if (c < 0x80)
+				{
+					if (size - i >= NarrowBlock && str[i + NarrowBlock - 1] < 0x80)
+					{
+						const auto count =
+						    functions.NarrowAscii(str.data() + i, size - i, output + o);
+						i += count;
+						o += count;
+						continue;
+					}
+					output[o++] = static_cast<char>(c);
+					++i;
+					continue;
+				}
+
+				if (c < 0x800)
+				{
+					const auto last = size - i >= TwoByteBlock ? str[i + TwoByteBlock - 1] : 0;
+					if (last >= 0x80 && last < 0x800)
+					{
+						if (const auto count =
+						        functions.EncodeTwoByte(str.data() + i, size - i, output + o))
+						{
+							i += count;
+							o += count * 2;
+							continue;
+						}
+					}
+
+					output[o++] = static_cast<char>(0xC0 | (c >> 6));
+					output[o++] = static_cast<char>(0x80 | (c & 0x3F));
+					++i;
+					continue;
+				}
+
+				if (c >= 0xD800 && c <= 0xDFFF)
+				{
+					if (c <= 0xDBFF && i + 1 < size && str[i + 1] >= 0xDC00 &&
+					    str[i + 1] <= 0xDFFF)
+					{
+						const auto codePoint =
+						    0x10000 + ((c - 0xD800) << 10) + (str[i + 1] - 0xDC00);
+						output[o++] = static_cast<char>(0xF0 | (codePoint >> 18));
+						output[o++] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+						output[o++] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+						output[o++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+						i += 2;
+						continue;
+					}
+
+					if constexpr (Replace)
+					{
+						output[o++] = static_cast<char>(0xEF);
+						output[o++] = static_cast<char>(0xBF);
+						output[o++] = static_cast<char>(0xBD);
+						++i;
+						continue;
+					}
+					else
+					{
+						return { o, i };
+					}
+				}
+
+				if (size - i >= EncodeThreeByteBlock &&
+				    IsThreeByteUnit(str[i + EncodeThreeByteBlock - 1]))
+				{
+					if (const auto count =
+					        functions.EncodeThreeByte(str.data() + i, size - i, output + o))
+					{
+						i += count;
+						o += count * 3;
+						continue;
+					}
+				}
+
+				output[o++] = static_cast<char>(0xE0 | (c >> 12));
+				output[o++] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+				output[o++] = static_cast<char>(0x80 | (c & 0x3F));
+				++i;
+			}
+			return { o, TranscodeResult::npos };
+		}
+	} // namespace
+
+	namespace
+	{
+		// 不超过此长度的字符串先写入线程局部缓冲区，再复制为长度恰好的字符串，避免按最坏情况分配；
+		// 更长的字符串直接写入结果，使缓冲区不会因偶尔出现的长字符串而一直占用大量内存
+		constexpr std::size_t MaxBufferedLength = 4096;
+	} // namespace
+
+	std::u16string ToUTF16(const std::string_view& str)
+	{
+		if (str.size() > MaxBufferedLength)
+		{
+			std::u16string result(str.size(), u'\0');
+			result.resize(DecodeUTF8<true>(str, result.data()).Length);
+			return result;
+		}
+
+		thread_local std::u16string buffer;
+		buffer.resize(str.size());
+		const auto result = DecodeUTF8<true>(str, buffer.data());
+		return std::u16string(buffer.data(), result.Length);
+	}
+
+	std::string ToUTF8(const std::u16string_view& str)
+	{
+		if (str.size() > MaxBufferedLength)
+		{
+			std::string result(str.size() * 3, '\0');
+			result.resize(EncodeUTF8<true>(str, result.data()).Length);
+			return result;
+		}
+
+		thread_local std::string buffer;
+		buffer.resize(str.size() * 3);
+		const auto result = EncodeUTF8<true>(str, buffer.data());
+		return std::string(buffer.data(), result.Length);
+	}
+
+	TranscodeResult ToUTF16(std::string_view str, char16_t* output)
+	{
+		return DecodeUTF8<false>(str, output);
+	}
+
+	TranscodeResult ToUTF16(std::string_view str, std::u16string& output)
+	{
+		output.resize(str.size());
+		const auto result = DecodeUTF8<false>(str, output.data());
+		output.resize(result.Length);
+		return result;
+	}
+
+	TranscodeResult ToUTF8(std::u16string_view str, char* output)
+	{
+		return EncodeUTF8<false>(str, output);
+	}
+
+	TranscodeResult ToUTF8(std::u16string_view str, std::string& output)
+	{
+		output.resize(str.size() * 3);
+		const auto result = EncodeUTF8<false>(str, output.data());
+		output.resize(result.Length);
+		return result;
+	}
+} // namespace UmaPyogin::Misc
@@ -0,0 +1,282 @@
+#include "Watcher.h"
+#include "Config.h"
+#include "Localization.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <set>
+
+#ifdef __linux__
+#include <cerrno>
+#include <map>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+#define PATH_STR(path) (path).string()
+#else
+#define PATH_STR(path) (path).native()
+#endif
+
+namespace UmaPyogin::Localization
+{
+	namespace
+	{
+		std::filesystem::path NormalizePath(std::string const& path)
+		{
+			if (path.empty())
+			{
+				return {};
+			}
+			std::error_code ec;
+			auto result = std::filesystem::absolute(path, ec);
+			return ec ? std::filesystem::path() : result.lexically_normal();
+		}
+
+		bool IsUnder(std::filesystem::path const& path, std::filesystem::path const& dir)
+		{
+			if (dir.empty())
+			{
+				return false;
+			}
+			const auto relative = path.lexically_relative(dir);
+			return !relative.empty() && *relative.begin() != "..";
+		}
+	} // namespace
+
+	LocalizationWatcher& LocalizationWatcher::GetInstance()
+	{
+		static LocalizationWatcher s_Instance;
+		return s_Instance;
+	}
+
+	LocalizationWatcher::~LocalizationWatcher()
+	{
+		Stop();
+	}
+
+	void LocalizationWatcher::Start(Config const& config)
+	{
+#ifdef __linux__
+		if (m_Thread.joinable())
+		{
+			return;
+		}
+
+		m_StaticLocalizationFilePath = NormalizePath(config.StaticLocalizationFilePath);
+		m_StoryLocalizationDirPath = NormalizePath(config.StoryLocalizationDirPath);
+		m_ConfiguredStoryLocalizationDirPath = config.StoryLocalizationDirPath;
+		m_ConfiguredDictPaths[0] = config.TextDataDictPath;
+		m_ConfiguredDictPaths[1] = config.CharacterSystemTextDataDictPath;
+		m_ConfiguredDictPaths[2] = config.RaceJikkyoCommentDataDictPath;
+		m_ConfiguredDictPaths[3] = config.RaceJikkyoMessageDataDictPath;
+		for (std::size_t i = 0; i < std::size(m_DictPaths); ++i)
+		{
+			m_DictPaths[i] = NormalizePath(m_ConfiguredDictPaths[i].string());
+		}
+
+		const auto fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (fd == -1)
+		{
+			Log::Error("UmaPyogin: Failed to initialize inotify(errno: {})", errno);
+			return;
+		}
+
+		m_Stopping.store(false, std::memory_order_relaxed);
+		m_Thread = std::thread([this, fd] { Run(fd); });
+		Log::Info("UmaPyogin: Watching localization files for changes");
+#else
+		static_cast<void>(config);
+		Log::Warn("UmaPyogin: Hot reload is not supported on this platform");
+#endif
+	}
+
+	void LocalizationWatcher::Stop()
+	{
+		if (!m_Thread.joinable())
+		{
+			return;
+		}
+		m_Stopping.store(true, std::memory_order_relaxed);
+		m_Thread.join();
+	}
+
+	void LocalizationWatcher::Run(int fd)
+	{
+#ifdef __linux__
+		// 以监视描述符查找所在目录，事件中只包含文件名
+		std::map<int, std::filesystem::path> watchedDirs;
+		const auto addWatch = [&](std::filesystem::path const& dir) {
+			const auto wd = inotify_add_watch(fd, dir.c_str(),
+			                                  IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM |
+			                                      IN_CREATE | IN_DELETE | IN_ONLYDIR);
+			if (wd == -1)
+			{
+				Log::Warn("UmaPyogin: Failed to watch {}(errno: {})", PATH_STR(dir), errno);
+				return;
+			}
+			watchedDirs.insert_or_assign(wd, dir);
+		};
+		const auto addWatchRecursive = [&](std::filesystem::path const& dir) {
+			addWatch(dir);
+			std::error_code ec;
+			for (std::filesystem::recursive_directory_iterator iter(dir, ec), end;
+			     !ec && iter != end; iter.increment(ec))
+			{
+				if (iter->is_directory(ec))
+				{
+					addWatch(iter->path());
+				}
+			}
+		};
+
+		std::set<std::filesystem::path> fileDirs;
+		for (const auto& path : { m_StaticLocalizationFilePath, m_DictPaths[0], m_DictPaths[1],
+		                          m_DictPaths[2], m_DictPaths[3] })
+		{
+			if (!path.empty() && !IsUnder(path, m_StoryLocalizationDirPath))
+			{
+				fileDirs.insert(path.parent_path());
+			}
+		}
+		for (const auto& dir : fileDirs)
+		{
+			addWatch(dir);
+		}
+		if (!m_StoryLocalizationDirPath.empty())
+		{
+			addWatchRecursive(m_StoryLocalizationDirPath);
+		}
+
+		const auto reload = [&](std::filesystem::path const& path) {
+			if (path.empty())
+			{
+				return;
+			}
+
+			try
+			{
+				if (path == m_StaticLocalizationFilePath)
+				{
+					StaticLocalization::GetInstance().Reload();
+				}
+				else if (const auto iter =
+				             std::find(std::begin(m_DictPaths), std::end(m_DictPaths), path);
+				         iter != std::end(m_DictPaths))
+				{
+					DatabaseLocalization::GetInstance().Reload(
+					    m_ConfiguredDictPaths[iter - std::begin(m_DictPaths)]);
+				}
+				else if (IsUnder(path, m_StoryLocalizationDirPath))
+				{
+					// 加载时记录的是配置中的路径，需换算回去才能与索引比较
+					StoryLocalization::GetInstance().ReloadFile(
+					    m_ConfiguredStoryLocalizationDirPath /
+					    path.lexically_relative(m_StoryLocalizationDirPath));
+				}
+				else
+				{
+					return;
+				}
+				Log::Info("UmaPyogin: Reloaded {}", PATH_STR(path));
+			}
+			catch (const std::exception& e)
+			{
+				Log::Error("UmaPyogin: Failed to reload {}: {}", PATH_STR(path), e.what());
+			}
+		};
+
+		// 编辑器保存时往往产生多个事件，等待一段时间内没有新事件后再重新加载
+		std::set<std::filesystem::path> pendingPaths;
+		alignas(inotify_event) char buffer[4096];
+		while (!m_Stopping.load(std::memory_order_relaxed))
+		{
+			pollfd pfd{ fd, POLLIN, 0 };
+			const auto ready = poll(&pfd, 1, pendingPaths.empty() ? 500 : 200);
+			if (ready == -1)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				Log::Error("UmaPyogin: Failed to poll inotify(errno: {})", errno);
+				break;
+			}
+
+			if (!ready)
+			{
+				for (const auto& path : pendingPaths)
+				{
+					reload(path);
+				}
+				pendingPaths.clear();
+				continue;
+			}
+
+			ssize_t length;
+			while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+			{
+				for (auto ptr = buffer; ptr < buffer + length;)
+				{
+					const auto event = reinterpret_cast<const inotify_event*>(ptr);
+					ptr += sizeof(inotify_event) + event->len;
+
+					if (event->mask & IN_Q_OVERFLOW)
+					{
+						// 丢失了事件，全部重新加载
+						Log::Warn("UmaPyogin: inotify queue overflowed, reloading all files");
+						pendingPaths.insert(m_StaticLocalizationFilePath);
+						pendingPaths.insert(std::begin(m_DictPaths), std::end(m_DictPaths));
+						if (!m_StoryLocalizationDirPath.empty())
+						{
+							pendingPaths.insert(m_StoryLocalizationDirPath / "index.json");
+						}
+						continue;
+					}
+
+					const auto iter = watchedDirs.find(event->wd);
+					if (iter == watchedDirs.end())
+					{
+						continue;
+					}
+					if (event->mask & IN_IGNORED)
+					{
+						watchedDirs.erase(iter);
+						continue;
+					}
+					if (!event->len)
+					{
+						continue;
+					}
+
+					const auto path = iter->second / event->name;
+					if (event->mask & IN_ISDIR)
+					{
+						// 新建或移入的剧情子目录需要单独监视，其中已有的文件也需要加载
+						if (event->mask & (IN_CREATE | IN_MOVED_TO) &&
+						    IsUnder(path, m_StoryLocalizationDirPath))
+						{
+							addWatchRecursive(path);
+							std::error_code ec;
+							for (std::filesystem::recursive_directory_iterator file(path, ec),
+							     end;
+							     !ec && file != end; file.increment(ec))
+							{
+								pendingPaths.insert(file->path());
+							}
+						}
+						continue;
+					}
+					pendingPaths.insert(path);
+				}
+			}
+		}
+
+		close(fd);
+#else
+		static_cast<void>(fd);
+#endif
+	}
+} // namespace UmaPyogin::Localization
@@ -0,0 +1,47 @@
+#ifndef UMAPYOGIN_WATCHER_H
+#define UMAPYOGIN_WATCHER_H
+
+#include <atomic>
+#include <filesystem>
+#include <thread>
+
+namespace UmaPyogin
+{
+	struct Config;
+}
+
+namespace UmaPyogin::Localization
+{
+	// 监视本地化文件，文件变化时在后台线程中只重新加载变化的部分
+	// 新数据通过 RCU 发布，查询无需加锁，目前仅支持 Linux（inotify）
+	class LocalizationWatcher
+	{
+	public:
+		static LocalizationWatcher& GetInstance();
+
+		void Start(Config const& config);
+		void Stop();
+
+		LocalizationWatcher(LocalizationWatcher const&) = delete;
+		LocalizationWatcher& operator=(LocalizationWatcher const&) = delete;
+
+	private:
+		LocalizationWatcher() = default;
+		~LocalizationWatcher();
+
+		void Run(int fd);
+
+		// 以下路径均为规范化的绝对路径，用于与事件中的路径比较
+		std::filesystem::path m_StaticLocalizationFilePath;
+		std::filesystem::path m_StoryLocalizationDirPath;
+		std::filesystem::path m_DictPaths[4];
+		// 配置中的原始路径，重新加载时使用
+		std::filesystem::path m_ConfiguredStoryLocalizationDirPath;
+		std::filesystem::path m_ConfiguredDictPaths[4];
+
+		std::thread m_Thread;
+		std::atomic<bool> m_Stopping{};
+	};
+} // namespace UmaPyogin::Localization
+
+#endif
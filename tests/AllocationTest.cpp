@@ -0,0 +1,143 @@
+#include "Support/LocalizationFiles.h"
+#include "Support/Test.h"
+
+#include "UmaPyogin/Localization.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace UmaPyogin;
+using namespace UmaPyogin::Fake;
+
+namespace
+{
+	std::atomic<std::size_t> s_AllocationCount;
+} // namespace
+
+// 替换全局的分配函数以统计堆分配次数，对齐的版本默认转发至此
+// 数组与 nothrow 的版本同样替换并转发至此，否则使用 AddressSanitizer 时会与其替换的版本混用
+void* operator new(std::size_t size)
+{
+	s_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+	if (const auto memory = std::malloc(size ? size : 1))
+	{
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	operator delete(memory);
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	operator delete(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+	operator delete(memory);
+}
+
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept
+{
+	try
+	{
+		return operator new(size);
+	}
+	catch (const std::bad_alloc&)
+	{
+		return nullptr;
+	}
+}
+
+void* operator new[](std::size_t size, std::nothrow_t const& tag) noexcept
+{
+	return operator new(size, tag);
+}
+
+void operator delete(void* memory, std::nothrow_t const&) noexcept
+{
+	operator delete(memory);
+}
+
+void operator delete[](void* memory, std::nothrow_t const&) noexcept
+{
+	operator delete(memory);
+}
+
+namespace
+{
+	constexpr std::uint64_t FirstStoryId = 100000000;
+
+	std::vector<StoryBlock> MakeBlocks(std::size_t count, std::size_t choiceInterval)
+	{
+		Test::TextGenerator chinese(Test::Script::Chinese);
+		std::vector<StoryBlock> blocks(count);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			blocks[i].Name = chinese.Next(3);
+			blocks[i].Text = chinese.Next(50);
+			if (choiceInterval && i % choiceInterval == 0)
+			{
+				blocks[i].ChoiceDataList = { chinese.Next(10), chinese.Next(10) };
+			}
+		}
+		return blocks;
+	}
+
+	// 首次加载 id 对应的剧情时的堆分配次数
+	std::size_t CountLoadAllocations(std::uint64_t id)
+	{
+		const auto before = s_AllocationCount.load();
+		const auto data = Localization::StoryLocalization::GetInstance().GetStoryTextData(id);
+		const auto count = s_AllocationCount.load() - before;
+		REQUIRE(data);
+		return count;
+	}
+} // namespace
+
+TEST(StoryTextAllocationsDoNotGrowWithBlocks)
+{
+	const Test::TemporaryDirectory directory;
+	const auto& root = directory.GetPath();
+
+	// 第一个剧情最大，使线程中复用的解析器与缓冲区在测量前达到所需的容量
+	const std::size_t blockCounts[] = { 1000, 10, 500 };
+	for (std::size_t i = 0; i < std::size(blockCounts); ++i)
+	{
+		Test::WriteStoryTimeline(root, FirstStoryId + i, u"标题", MakeBlocks(blockCounts[i], 0));
+		Test::WriteStoryTimeline(root, FirstStoryId + 10 + i, u"标题",
+		                         MakeBlocks(blockCounts[i], 5));
+	}
+
+	auto& storyLocalization = Localization::StoryLocalization::GetInstance();
+	storyLocalization.SetCacheBudget(0);
+	storyLocalization.LoadFrom(root);
+	CountLoadAllocations(FirstStoryId);
+
+	// 文本全部存放于每个文件的一块内存中，分配次数与块数无关
+	const auto smallStory = CountLoadAllocations(FirstStoryId + 1);
+	const auto largeStory = CountLoadAllocations(FirstStoryId + 2);
+	CHECK(largeStory == smallStory);
+
+	// 全部块的选项共用一个列表，仅多分配一次
+	CountLoadAllocations(FirstStoryId + 10);
+	const auto smallStoryWithChoices = CountLoadAllocations(FirstStoryId + 11);
+	const auto largeStoryWithChoices = CountLoadAllocations(FirstStoryId + 12);
+	CHECK(smallStoryWithChoices == smallStory + 1);
+	CHECK(largeStoryWithChoices == smallStoryWithChoices);
+}
@@ -0,0 +1,119 @@
+#include "Support/Test.h"
+
+#include "UmaPyogin/AssetNameIndex.h"
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace UmaPyogin;
+
+namespace
+{
+	std::u16string MakeName(std::size_t i)
+	{
+		std::u16string name = u"assets/_gallopresources/bundle/resources/";
+		for (const auto c : std::to_string(i))
+		{
+			name += static_cast<char16_t>(c);
+		}
+		return name + u".prefab";
+	}
+} // namespace
+
+TEST(EmptyIndexContainsNothing)
+{
+	AssetNameIndex index;
+	CHECK(!index.Contains(u""));
+	CHECK(!index.Contains(u"assets/a.png"));
+
+	index.Build();
+	CHECK(index.GetSize() == 0);
+	CHECK(!index.Contains(u""));
+	CHECK(!index.Contains(u"assets/a.png"));
+}
+
+TEST(FindsAddedNamesOnly)
+{
+	AssetNameIndex index;
+	std::unordered_set<std::u16string> names;
+	for (std::size_t i = 0; i < 3000; i += 3)
+	{
+		names.insert(MakeName(i));
+		index.Add(MakeName(i));
+	}
+	// 重复的名称只计一次
+	index.Add(MakeName(0));
+	index.Add(u"");
+	index.Add(u"字体/思源黑体");
+	index.Build();
+	CHECK(index.GetSize() == names.size() + 2);
+
+	for (std::size_t i = 0; i < 3000; ++i)
+	{
+		CHECK(index.Contains(MakeName(i)) == names.contains(MakeName(i)));
+	}
+	CHECK(index.Contains(u""));
+	CHECK(index.Contains(u"字体/思源黑体"));
+
+	// 与已有名称仅差一个字符、互为前缀或长度不同的名称均不命中
+	const auto name = MakeName(3);
+	CHECK(!index.Contains(name.substr(0, name.size() - 1)));
+	CHECK(!index.Contains(name + u"x"));
+	CHECK(!index.Contains(u"A" + name.substr(1)));
+	CHECK(!index.Contains(u"字体/思源黑"));
+	CHECK(!index.Contains(std::u16string(1, u'\0')));
+}
+
+TEST(ProbesPastCollidingSlots)
+{
+	// 挑选首选槽位相同的名称，使它们在表中连续排列并在末尾回绕
+	constexpr std::size_t NameCount = 8;
+	constexpr std::size_t Capacity = 16;
+	const auto slot = Capacity - 2;
+	std::vector<std::u16string> names;
+	std::vector<std::u16string> absentNames;
+	for (std::size_t i = 0; names.size() < NameCount || absentNames.size() < NameCount; ++i)
+	{
+		auto name = MakeName(i);
+		if ((HashAssetName(name) & (Capacity - 1)) == slot)
+		{
+			(names.size() < NameCount ? names : absentNames).push_back(std::move(name));
+		}
+	}
+
+	AssetNameIndex index;
+	for (const auto& name : names)
+	{
+		index.Add(name);
+	}
+	index.Build();
+	REQUIRE(index.GetCapacity() == Capacity);
+	CHECK(index.GetSize() == NameCount);
+
+	for (const auto& name : names)
+	{
+		CHECK(index.Contains(name));
+	}
+	for (const auto& name : absentNames)
+	{
+		CHECK(!index.Contains(name));
+	}
+}
+
+TEST(HashesEveryCharacter)
+{
+	// 长度不是 4 的倍数时末尾的字符同样参与计算
+	for (std::size_t length = 1; length <= 12; ++length)
+	{
+		std::u16string name(length, u'a');
+		const auto hash = HashAssetName(name);
+		for (std::size_t i = 0; i < length; ++i)
+		{
+			auto changed = name;
+			changed[i] = u'b';
+			CHECK(HashAssetName(changed) != hash);
+		}
+		CHECK(HashAssetName(name + u'\0') != hash);
+	}
+}
@@ -0,0 +1,82 @@
+#include "Support/FakeIl2Cpp.h"
+#include "Support/LocalizationFiles.h"
+#include "Support/Test.h"
+
+#include "UmaPyogin/Localization.h"
+
+using namespace UmaPyogin;
+using namespace UmaPyogin::Fake;
+
+namespace
+{
+	// 以后台加载的默认配置启动，查询等待加载完成
+	struct Environment
+	{
+		Test::TemporaryDirectory Directory;
+		RecordingHookInstaller* Installer;
+
+		Environment()
+		{
+			const auto& root = Directory.GetPath();
+
+			const std::pair<std::u16string, std::u16string> staticEntries[] = {
+				{ u"はい", u"是" },
+			};
+			Test::WriteStaticLocalization(root / "static.json", staticEntries);
+			const Test::NestedDictionaryEntry textData[] = { { 6, 1001, u"特别周" } };
+			Test::WriteNestedDictionary(root / "text_data.json", textData);
+
+			Game::GetInstance().SetStaticSources({ u"はい", u"いいえ" });
+
+			Config config{};
+			config.StaticLocalizationFilePath = (root / "static.json").string();
+			config.TextDataDictPath = (root / "text_data.json").string();
+			config.LocalizationWaitTimeout = 60000;
+
+			Installer = &InstallPlugin(std::move(config));
+			InitIl2Cpp(*Installer);
+		}
+	};
+
+	Environment& GetEnvironment()
+	{
+		static Environment environment;
+		return environment;
+	}
+} // namespace
+
+TEST(CapturesStaticSourcesOnGameThread)
+{
+	GetEnvironment();
+
+	// 原文在 il2cpp_init 返回前取得，加载线程不调用游戏的函数
+	const auto threads = Game::GetInstance().GetLocalizeJP_GetThreads();
+	REQUIRE(threads.size() == 1);
+	CHECK(threads[0] == std::this_thread::get_id());
+}
+
+TEST(HooksWaitForBackgroundLoading)
+{
+	const auto& installer = *GetEnvironment().Installer;
+
+	const auto localizedString = installer.Resolve(&Game::LocalizeJP_Get)(0);
+	CHECK(ToStringView(localizedString) == u"是");
+
+	const auto query = Game::GetInstance().NewQuery();
+	installer.Resolve(&Game::Query_ctor)(
+	    query, nullptr,
+	    Runtime::GetInstance().NewString(
+	        u"SELECT `text` FROM `text_data` WHERE `category`=? AND `index`=?;"));
+	installer.Resolve(&Game::PreparedQuery_BindInt)(query, 1, 6);
+	installer.Resolve(&Game::PreparedQuery_BindInt)(query, 2, 1001);
+	REQUIRE(installer.Resolve(&Game::Query_Step)(query));
+	CHECK(ToStringView(installer.Resolve(&Game::Query_GetText)(query, 0)) == u"特别周");
+	installer.Resolve(&Game::Query_Dispose)(query);
+
+	auto& status = Localization::LoadingStatus::GetInstance();
+	for (const auto dataset : { Localization::Dataset::Static, Localization::Dataset::Story,
+	                            Localization::Dataset::Database })
+	{
+		CHECK(status.WaitUntilReady(dataset));
+	}
+}
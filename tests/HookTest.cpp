@@ -0,0 +1,408 @@
+#include "Support/FakeIl2Cpp.h"
+#include "Support/LocalizationFiles.h"
+#include "Support/Test.h"
+
+#include "UmaPyogin/Hook.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace UmaPyogin;
+using namespace UmaPyogin::Fake;
+
+namespace
+{
+	constexpr char16_t StoryAssetName[] = u"story/data/10/0001/storytimeline_100001001";
+	constexpr char16_t RaceAssetName[] = u"race/storyrace/text/storyrace_1001";
+	constexpr char16_t ExtraAssetName[] = u"assets/extra/texture.png";
+	constexpr char ReplaceFontPath[] = "assets/extra/font.ttf";
+
+	// 所有用例共享同一个已初始化的插件，首次使用时写入翻译文件并模拟游戏启动
+	struct Environment
+	{
+		Test::TemporaryDirectory Directory;
+		RecordingHookInstaller* Installer;
+		Il2CppObject* GameAssetBundle;
+		Il2CppObject* ExtraAsset;
+		Il2CppObject* ReplaceFont;
+
+		Environment()
+		{
+			const auto& root = Directory.GetPath();
+
+			const std::pair<std::u16string, std::u16string> staticEntries[] = {
+				{ u"はい", u"是" },
+				{ u"いいえ", u"否" },
+				{ u"\"引用\"", u"“引用”" },
+				{ u"おわり", u"结束" },
+			};
+			Test::WriteStaticLocalization(root / "static.json", staticEntries);
+
+			const StoryBlock storyBlocks[] = {
+				{ u"名前", u"本文", { u"選択肢1", u"選択肢2" }, { u"色" } },
+				{},
+				{ u"名前2", u"本文2", {}, {} },
+			};
+			Test::WriteStoryTimeline(root / "story" / "10", 100001001, u"标题", storyBlocks);
+			const std::u16string raceTexts[] = { u"比赛1", u"比赛2" };
+			Test::WriteStoryRace(root / "story" / "race", 1001, raceTexts);
+
+			const Test::NestedDictionaryEntry textData[] = {
+				{ 6, 1001, u"特别周" },
+				{ 6, 1002, u"无声铃鹿" },
+				{ 47, 1, u"文本" },
+			};
+			Test::WriteNestedDictionary(root / "text_data.json", textData);
+			const Test::NestedDictionaryEntry characterSystemText[] = {
+				{ 1001, 2, u"训练员" },
+			};
+			Test::WriteNestedDictionary(root / "character_system_text.json",
+			                            characterSystemText);
+			const Test::DictionaryEntry raceJikkyoComment[] = { { 5, u"解说" } };
+			Test::WriteDictionary(root / "race_jikkyo_comment.json", raceJikkyoComment);
+			const Test::DictionaryEntry raceJikkyoMessage[] = { { 7, u"实况" } };
+			Test::WriteDictionary(root / "race_jikkyo_message.json", raceJikkyoMessage);
+
+			auto& game = Game::GetInstance();
+			// id 3、5 与 6 没有原文，连续的空缺之后仍有文本
+			game.SetStaticSources(
+			    { u"はい", u"いいえ", u"そのまま", u"", u"\"引用\"", u"", u"", u"おわり" });
+
+			GameAssetBundle = game.AddAssetBundle("data/game.bundle");
+			const auto extraAssetBundle = game.AddAssetBundle((root / "extra.bundle").string());
+			ExtraAsset = Runtime::GetInstance().NewObject(game.FontClass);
+			game.AddAsset(extraAssetBundle, ExtraAssetName, ExtraAsset);
+			ReplaceFont = game.NewFont();
+			game.AddAsset(extraAssetBundle, u"assets/extra/font.ttf", ReplaceFont);
+
+			Config config{};
+			config.StaticLocalizationFilePath = (root / "static.json").string();
+			config.StoryLocalizationDirPath = (root / "story").string();
+			config.TextDataDictPath = (root / "text_data.json").string();
+			config.CharacterSystemTextDataDictPath = (root / "character_system_text.json").string();
+			config.RaceJikkyoCommentDataDictPath = (root / "race_jikkyo_comment.json").string();
+			config.RaceJikkyoMessageDataDictPath = (root / "race_jikkyo_message.json").string();
+			config.ExtraAssetBundlePath = (root / "extra.bundle").string();
+			config.ReplaceFontPath = ReplaceFontPath;
+			config.OverrideFPS = 120;
+			config.LoadLocalizationSynchronously = true;
+			config.LogLevel = static_cast<std::int64_t>(Log::Level::Warn);
+
+			Installer = &InstallPlugin(std::move(config));
+			InitIl2Cpp(*Installer);
+		}
+	};
+
+	Environment& GetEnvironment()
+	{
+		static Environment environment;
+		return environment;
+	}
+
+	Il2CppString* NewString(std::u16string_view str)
+	{
+		return Runtime::GetInstance().NewString(str);
+	}
+
+	template <typename Function>
+	Function Resolve(Function function)
+	{
+		return GetEnvironment().Installer->Resolve(function);
+	}
+
+	Il2CppObject* LoadAsset(Il2CppObject* assetBundle, std::u16string_view name)
+	{
+		return Resolve(&Game::AssetBundle_LoadAsset)(assetBundle, NewString(name), nullptr);
+	}
+
+	// 按游戏的调用顺序执行一次查询，返回 GetText(textColumn) 的结果
+	std::u16string RunQuery(std::u16string_view sql, std::span<const std::int32_t> params,
+	                        std::span<const std::int32_t> intColumns, std::int32_t textColumn)
+	{
+		const auto query = Game::GetInstance().NewQuery();
+		for (std::size_t i = 0; i < intColumns.size(); ++i)
+		{
+			Game::SetQueryInt(query, static_cast<std::int32_t>(i), intColumns[i]);
+		}
+
+		Resolve(&Game::Query_ctor)(query, nullptr, NewString(sql));
+		for (std::size_t i = 0; i < params.size(); ++i)
+		{
+			Resolve(&Game::PreparedQuery_BindInt)(query, static_cast<std::int32_t>(i + 1),
+			                                      params[i]);
+		}
+		std::u16string result;
+		if (Resolve(&Game::Query_Step)(query))
+		{
+			result = ToStringView(Resolve(&Game::Query_GetText)(query, textColumn));
+		}
+		Resolve(&Game::Query_Dispose)(query);
+		return result;
+	}
+} // namespace
+
+TEST(InstallsAllHooksOnInit)
+{
+	const auto& environment = GetEnvironment();
+	const auto& installer = *environment.Installer;
+
+	CHECK(Runtime::GetInstance().IsInitialized());
+	for (const auto function : {
+	         reinterpret_cast<OpaqueFunctionPointer>(&Game::LocalizeJP_Get),
+	         reinterpret_cast<OpaqueFunctionPointer>(&Game::AssetBundle_LoadAsset),
+	         reinterpret_cast<OpaqueFunctionPointer>(&Game::Query_ctor),
+	         reinterpret_cast<OpaqueFunctionPointer>(&Game::PreparedQuery_BindInt),
+	         reinterpret_cast<OpaqueFunctionPointer>(&Game::Query_Step),
+	         reinterpret_cast<OpaqueFunctionPointer>(&Game::Query_GetText),
+	         reinterpret_cast<OpaqueFunctionPointer>(&Game::Query_Dispose),
+	         reinterpret_cast<OpaqueFunctionPointer>(&Game::TextCommon_Awake),
+	         reinterpret_cast<OpaqueFunctionPointer>(&Game::Application_set_targetFrameRate),
+	     })
+	{
+		CHECK(installer.IsHooked(function));
+	}
+	// 以及 il2cpp_init 本身
+	CHECK(installer.GetHookCount() == 10);
+}
+
+TEST(LocalizesStaticText)
+{
+	const auto get = Resolve(&Game::LocalizeJP_Get);
+	CHECK(ToStringView(get(0)) == u"是");
+	CHECK(ToStringView(get(1)) == u"否");
+	CHECK(ToStringView(get(2)) == u"そのまま");
+	CHECK(get(3) == nullptr);
+	CHECK(ToStringView(get(4)) == u"“引用”");
+	CHECK(get(5) == nullptr);
+	CHECK(get(6) == nullptr);
+	CHECK(ToStringView(get(7)) == u"结束");
+	CHECK(get(100) == nullptr);
+
+	// 与游戏中一样经由 Hook::LocalizeJP_Get 取得的是原文
+	CHECK(ToStringView(Hook::LocalizeJP_Get(0)) == u"はい");
+}
+
+TEST(LocalizesStoryTimelineData)
+{
+	auto& environment = GetEnvironment();
+	auto& game = Game::GetInstance();
+
+	const StoryBlock blocks[] = {
+		{ u"name", u"text", { u"choice1", u"choice2" }, { u"color" } },
+		{ u"name1", u"text1", {}, {} },
+		{ u"name2", u"text2", {}, {} },
+	};
+	const auto timeline = game.NewStoryTimelineData(u"100001001", u"title", blocks);
+	game.AddAsset(environment.GameAssetBundle, StoryAssetName, timeline);
+
+	REQUIRE(LoadAsset(environment.GameAssetBundle, StoryAssetName) == timeline);
+
+	const auto timelineClass = game.StoryTimelineDataClass;
+	CHECK(GetStringField(timeline, timelineClass->FindField("Title")) == u"标题");
+
+	const auto blockList =
+	    GetItems(GetObjectField(timeline, timelineClass->FindField("BlockList")));
+	REQUIRE(blockList.size() == 3);
+	const auto getClip = [&](Il2CppObject* block) {
+		const auto textTrack =
+		    GetObjectField(block, game.StoryTimelineBlockDataClass->FindField("TextTrack"));
+		return GetItems(GetObjectField(
+		    textTrack, game.StoryTimelineTextTrackDataClass->FindField("ClipList")))[0];
+	};
+	const auto clipClass = game.StoryTimelineTextClipDataClass;
+
+	const auto clip0 = getClip(blockList[0]);
+	CHECK(GetStringField(clip0, clipClass->FindField("Name")) == u"名前");
+	CHECK(GetStringField(clip0, clipClass->FindField("Text")) == u"本文");
+	const auto choices = GetItems(GetObjectField(clip0, clipClass->FindField("ChoiceDataList")));
+	REQUIRE(choices.size() == 2);
+	CHECK(GetStringField(choices[0], game.ChoiceDataClass->FindField("Text")) == u"選択肢1");
+	CHECK(GetStringField(choices[1], game.ChoiceDataClass->FindField("Text")) == u"選択肢2");
+	const auto colorTexts =
+	    GetItems(GetObjectField(clip0, clipClass->FindField("ColorTextInfoList")));
+	REQUIRE(colorTexts.size() == 1);
+	CHECK(GetStringField(colorTexts[0], game.ColorTextInfoClass->FindField("Text")) == u"色");
+
+	// 翻译文件中为 null 的块保留原文
+	const auto clip1 = getClip(blockList[1]);
+	CHECK(GetStringField(clip1, clipClass->FindField("Name")) == u"name1");
+	CHECK(GetStringField(clip1, clipClass->FindField("Text")) == u"text1");
+
+	const auto clip2 = getClip(blockList[2]);
+	CHECK(GetStringField(clip2, clipClass->FindField("Text")) == u"本文2");
+}
+
+TEST(KeepsStoryWithoutLocalization)
+{
+	auto& environment = GetEnvironment();
+	auto& game = Game::GetInstance();
+
+	const StoryBlock blocks[] = { { u"name", u"text", {}, {} } };
+	const auto timeline = game.NewStoryTimelineData(u"100001002", u"title", blocks);
+	constexpr char16_t AssetName[] = u"story/data/10/0001/storytimeline_100001002";
+	game.AddAsset(environment.GameAssetBundle, AssetName, timeline);
+
+	REQUIRE(LoadAsset(environment.GameAssetBundle, AssetName) == timeline);
+	CHECK(GetStringField(timeline, game.StoryTimelineDataClass->FindField("Title")) == u"title");
+}
+
+TEST(LocalizesStoryRaceTextAsset)
+{
+	auto& environment = GetEnvironment();
+	auto& game = Game::GetInstance();
+
+	const std::u16string texts[] = { u"race1", u"race2" };
+	const auto asset = game.NewStoryRaceTextAsset(texts);
+	game.AddAsset(environment.GameAssetBundle, RaceAssetName, asset);
+
+	REQUIRE(LoadAsset(environment.GameAssetBundle, RaceAssetName) == asset);
+	const auto keys =
+	    GetItems(GetObjectField(asset, game.StoryRaceTextAssetClass->FindField("textData")));
+	REQUIRE(keys.size() == 2);
+	CHECK(GetStringField(keys[0], game.KeyClass->FindField("text")) == u"比赛1");
+	CHECK(GetStringField(keys[1], game.KeyClass->FindField("text")) == u"比赛2");
+}
+
+TEST(LoadsAssetsFromExtraAssetBundle)
+{
+	auto& environment = GetEnvironment();
+
+	CHECK(LoadAsset(environment.GameAssetBundle, ExtraAssetName) == environment.ExtraAsset);
+	CHECK(LoadAsset(environment.GameAssetBundle, u"assets/extra/missing.png") == nullptr);
+}
+
+TEST(LocalizesTextDataQuery)
+{
+	constexpr auto Sql = u"SELECT `text` FROM `text_data` WHERE `category`=? AND `index`=?;";
+	const std::int32_t found[] = { 6, 1002 };
+	CHECK(RunQuery(Sql, found, {}, 0) == u"无声铃鹿");
+	const std::int32_t missing[] = { 6, 9999 };
+	CHECK(RunQuery(Sql, missing, {}, 0) == Game::GetOriginalQueryText());
+}
+
+TEST(LocalizesCharacterSystemTextQuery)
+{
+	constexpr auto Sql =
+	    u"SELECT `voice_id`,`text` FROM `character_system_text` WHERE `character_id`=?;";
+	const std::int32_t params[] = { 1001 };
+	const std::int32_t voiceIds[] = { 2 };
+	CHECK(RunQuery(Sql, params, voiceIds, 1) == u"训练员");
+	const std::int32_t otherVoiceIds[] = { 3 };
+	CHECK(RunQuery(Sql, params, otherVoiceIds, 1) == Game::GetOriginalQueryText());
+}
+
+TEST(LocalizesRaceJikkyoQueries)
+{
+	const std::int32_t commentIds[] = { 5 };
+	CHECK(RunQuery(u"SELECT `id`,`message` FROM `race_jikkyo_comment`;", {}, commentIds, 1) ==
+	      u"解说");
+	const std::int32_t messageIds[] = { 7 };
+	CHECK(RunQuery(u"SELECT `message` FROM `race_jikkyo_message` WHERE `id`=?;", messageIds, {},
+	               0) == u"实况");
+}
+
+TEST(LocalizesManyInterleavedQueries)
+{
+	// 同时存在的查询超过查询表的初始容量
+	constexpr auto Sql = u"SELECT `text` FROM `text_data` WHERE `category`=? AND `index`=?;";
+	constexpr std::size_t QueryCount = 3000;
+	auto& game = Game::GetInstance();
+	std::vector<Il2CppObject*> queries(QueryCount);
+	for (std::size_t i = 0; i < QueryCount; ++i)
+	{
+		queries[i] = game.NewQuery();
+		Resolve(&Game::Query_ctor)(queries[i], nullptr, NewString(Sql));
+		Resolve(&Game::PreparedQuery_BindInt)(queries[i], 1, 6);
+		Resolve(&Game::PreparedQuery_BindInt)(queries[i], 2, i % 2 ? 1002 : 1001);
+	}
+
+	for (std::size_t i = 0; i < QueryCount; ++i)
+	{
+		// 按不同的顺序读取并释放，使表中留下墓碑
+		const auto query = queries[i * 7 % QueryCount];
+		REQUIRE(Resolve(&Game::Query_Step)(query));
+		CHECK(ToStringView(Resolve(&Game::Query_GetText)(query, 0)) ==
+		      (i * 7 % QueryCount % 2 ? u"无声铃鹿" : u"特别周"));
+		Resolve(&Game::Query_Dispose)(query);
+	}
+
+	const std::int32_t params[] = { 6, 1001 };
+	CHECK(RunQuery(Sql, params, {}, 0) == u"特别周");
+}
+
+TEST(KeepsQueriesUsableWhileTableGrows)
+{
+	GetEnvironment();
+	constexpr auto Sql = u"SELECT `text` FROM `text_data` WHERE `category`=? AND `index`=?;";
+
+	// 另一线程反复执行查询，同时本线程打开大量查询使表扩容
+	std::atomic<bool> stop{};
+	std::atomic<std::size_t> failureCount{};
+	std::thread reader([&] {
+		const auto key = reinterpret_cast<void*>(std::uintptr_t(0x10));
+		while (!stop.load(std::memory_order_relaxed))
+		{
+			const auto localized = Hook::ReplayQuery_ctor(key, Sql) &&
+			                       Hook::ReplayPreparedQuery_BindInt(key, 1, 6) &&
+			                       Hook::ReplayPreparedQuery_BindInt(key, 2, 1001) &&
+			                       Hook::ReplayQuery_Step(key, nullptr) &&
+			                       Hook::ReplayQuery_GetText(key, 0);
+			if (!localized)
+			{
+				failureCount.fetch_add(1, std::memory_order_relaxed);
+			}
+			Hook::ReplayQuery_Dispose(key);
+		}
+	});
+
+	constexpr std::size_t QueryCount = 5000;
+	for (std::size_t i = 0; i < QueryCount; ++i)
+	{
+		CHECK(Hook::ReplayQuery_ctor(reinterpret_cast<void*>((i + 1) << 8), Sql));
+		std::this_thread::yield();
+	}
+	for (std::size_t i = 0; i < QueryCount; ++i)
+	{
+		Hook::ReplayQuery_Dispose(reinterpret_cast<void*>((i + 1) << 8));
+	}
+	stop.store(true, std::memory_order_relaxed);
+	reader.join();
+
+	CHECK(failureCount.load() == 0);
+}
+
+TEST(PassesThroughOtherTables)
+{
+	const auto rejectedBefore = Hook::GetRejectedQueryCount();
+	const std::int32_t params[] = { 1 };
+	CHECK(RunQuery(u"SELECT `name` FROM `chara_data` WHERE `id`=?;", params, {}, 0) ==
+	      Game::GetOriginalQueryText());
+	CHECK(Hook::GetRejectedQueryCount() == rejectedBefore + 1);
+}
+
+TEST(ReplacesFontOnTextCommonAwake)
+{
+	auto& environment = GetEnvironment();
+	const auto text = Game::GetInstance().NewText();
+
+	Resolve(&Game::TextCommon_Awake)(text);
+	const auto& state = Game::GetTextState(text);
+	CHECK(state.Font == environment.ReplaceFont);
+	CHECK(!state.DefaultFontAssigned);
+	CHECK(state.HorizontalOverflow == 1);
+	CHECK(state.VerticalOverflow == 1);
+	CHECK(state.FontStyle == 1);
+	CHECK(state.LineSpacing == 1.03f);
+
+	// 之后的调用复用已加载的字体，不再创建新的句柄
+	const auto handleCount = Runtime::GetInstance().GetLiveGCHandleCount();
+	Resolve(&Game::TextCommon_Awake)(Game::GetInstance().NewText());
+	CHECK(Runtime::GetInstance().GetLiveGCHandleCount() == handleCount);
+}
+
+TEST(OverridesTargetFrameRate)
+{
+	Resolve(&Game::Application_set_targetFrameRate)(30);
+	CHECK(Game::GetInstance().GetTargetFrameRate() == 120);
+}
@@ -0,0 +1,102 @@
+#include "Support/Test.h"
+
+#include "UmaPyogin/IdIndex.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace UmaPyogin::Localization;
+
+namespace
+{
+	// 与按 id 二分查找得到的下标比较，检查每个 id 及其前后的 id
+	void CheckAgainstReference(IdIndex const& index, std::vector<std::uint64_t> const& ids)
+	{
+		CHECK(index.GetSize() == ids.size());
+		for (std::size_t i = 0; i < ids.size(); ++i)
+		{
+			for (std::uint64_t delta = 0; delta <= 130; ++delta)
+			{
+				for (const auto id : { ids[i] + delta, ids[i] - std::min(ids[i], delta) })
+				{
+					const auto iter = std::lower_bound(ids.begin(), ids.end(), id);
+					const auto found = index.Find(id);
+					if (iter != ids.end() && *iter == id)
+					{
+						REQUIRE(found);
+						CHECK(*found == static_cast<std::size_t>(iter - ids.begin()));
+					}
+					else
+					{
+						CHECK(!found);
+					}
+				}
+			}
+		}
+	}
+} // namespace
+
+TEST(EmptyIndexFindsNothing)
+{
+	IdIndex index;
+	CHECK(index.GetSize() == 0);
+	CHECK(!index.Find(0));
+	CHECK(!index.Find(100000001));
+
+	index.Build({});
+	CHECK(!index.Find(0));
+}
+
+TEST(FindsIdsAcrossBlockAndPageBoundaries)
+{
+	// 页大小为 1024，块大小为 64，覆盖每个边界两侧的 id
+	std::vector<std::uint64_t> ids = { 0, 1, 62, 63, 64, 65, 127, 128, 1022, 1023, 1024, 1025 };
+	for (std::uint64_t id = 2047; id <= 2200; id += 3)
+	{
+		ids.push_back(id);
+	}
+	// 位于第 64 页之后，使第一级位图跨越多个块
+	ids.push_back(64 * 1024 + 5);
+	ids.push_back(200 * 1024 - 1);
+
+	IdIndex index;
+	index.Build(ids);
+	CheckAgainstReference(index, ids);
+}
+
+TEST(FindsClusteredStoryIds)
+{
+	// 剧情 id 成簇分布，簇之间相隔很远
+	std::vector<std::uint64_t> ids;
+	for (const std::uint64_t base : { 100000001, 100100001, 400001001, 501002001, 904100001 })
+	{
+		for (std::uint64_t i = 0; i < 300; ++i)
+		{
+			if (i % 7 != 3)
+			{
+				ids.push_back(base + i);
+			}
+		}
+	}
+
+	IdIndex index;
+	index.Build(ids);
+	CheckAgainstReference(index, ids);
+
+	// 第一级位图每页一位，第二级位图仅为含有 id 的页分配
+	CHECK(index.GetMemoryUsage() < 256 * 1024);
+}
+
+TEST(RebuildReplacesPreviousIds)
+{
+	IdIndex index;
+	index.Build(std::vector<std::uint64_t>{ 5000, 5001, 9000 });
+	index.Build(std::vector<std::uint64_t>{ 10, 20 });
+	CHECK(!index.Find(5000));
+	CHECK(!index.Find(9000));
+	CHECK(index.Find(20) == std::optional<std::size_t>(1));
+
+	index.Clear();
+	CHECK(index.GetSize() == 0);
+	CHECK(!index.Find(10));
+}
@@ -0,0 +1,30 @@
+#include "Support/FakeIl2Cpp.h"
+#include "Support/Test.h"
+
+using namespace UmaPyogin;
+using namespace UmaPyogin::Fake;
+
+// 用例依次在同一进程中安装插件，需按定义顺序执行
+
+TEST(MissingSymbolAbortsInstallation)
+{
+	Runtime::GetInstance().HideSymbol("il2cpp_class_get_nested_types");
+	const auto& installer = InstallPlugin(Config{});
+	Runtime::GetInstance().ClearHiddenSymbols();
+
+	CHECK(installer.GetHookCount() == 0);
+}
+
+TEST(InstallsInitHookThenGameHooks)
+{
+	Config config{};
+	config.LoadLocalizationSynchronously = true;
+	auto& installer = InstallPlugin(std::move(config));
+	CHECK(installer.GetHookCount() == 1);
+
+	// 翻译文件均不存在时仍应完成初始化并挂钩全部函数
+	CHECK(InitIl2Cpp(installer) == 1);
+	CHECK(Runtime::GetInstance().IsInitialized());
+	CHECK(installer.GetHookCount() == 10);
+	CHECK(installer.IsHooked(reinterpret_cast<OpaqueFunctionPointer>(&Game::LocalizeJP_Get)));
+}
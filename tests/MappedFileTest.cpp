@@ -0,0 +1,189 @@
+#include "Support/LocalizationFiles.h"
+#include "Support/Test.h"
+
+#include "UmaPyogin/Localization.h"
+#include "UmaPyogin/LocalizationPack.h"
+#include "UmaPyogin/Misc.h"
+
+#include <cstring>
+#include <string>
+
+using namespace UmaPyogin;
+
+namespace
+{
+	// 以换行符填充至 size 字节，使文件结尾落在页内的各个位置
+	std::string MakeTextData(std::u16string_view text, std::size_t size)
+	{
+		auto content = R"({"6":{"1001":)" + Test::ToJsonString(text) + "}}";
+		REQUIRE(content.size() <= size);
+		content.resize(size, '\n');
+		return content;
+	}
+} // namespace
+
+TEST(MapsFilesAroundPageBoundaries)
+{
+	const Test::TemporaryDirectory directory;
+	const auto pageSize = Test::GetPageSize(directory.GetPath());
+	const auto path = directory.GetPath() / "file";
+
+	for (const auto size : { std::size_t(1), pageSize - 1, pageSize, pageSize + 1, 3 * pageSize })
+	{
+		std::string content(size, '\0');
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			content[i] = static_cast<char>('a' + i % 26);
+		}
+		Test::WriteFile(path, content);
+
+		const Misc::MappedFile file(path);
+		REQUIRE(file.IsOpen());
+		CHECK(file.Size() == size);
+		CHECK(std::string_view(reinterpret_cast<const char*>(file.Data()), size) == content);
+
+		// 末页中超出文件的部分可读且为 0
+		CHECK((file.Size() + file.TailSize()) % pageSize == 0);
+		CHECK(file.TailSize() < pageSize);
+		for (std::size_t i = 0; i < file.TailSize(); ++i)
+		{
+			REQUIRE(file.Data()[size + i] == std::byte{ 0 });
+		}
+	}
+}
+
+TEST(FailsOnMissingAndEmptyFiles)
+{
+	const Test::TemporaryDirectory directory;
+	const Misc::MappedFile missing(directory.GetPath() / "missing");
+	CHECK(!missing.IsOpen());
+	CHECK(missing.TailSize() == 0);
+
+	Test::WriteFile(directory.GetPath() / "empty", "");
+	const Misc::MappedFile empty(directory.GetPath() / "empty");
+	CHECK(!empty.IsOpen());
+
+	// 移动后原对象不再持有映射
+	Test::WriteFile(directory.GetPath() / "file", "content");
+	Misc::MappedFile file(directory.GetPath() / "file");
+	const auto moved = std::move(file);
+	CHECK(!file.IsOpen());
+	CHECK(moved.IsOpen() && moved.Size() == 7);
+}
+
+TEST(ParsesJsonEndingAnywhereInLastPage)
+{
+	const Test::TemporaryDirectory directory;
+	const auto& root = directory.GetPath();
+	const auto pageSize = Test::GetPageSize(root);
+	const auto textDataPath = root / "text_data_dict.json";
+	for (const auto name : { "character_system_text_dict.json", "race_jikkyo_comment_dict.json",
+	                         "race_jikkyo_message_dict.json" })
+	{
+		Test::WriteFile(root / name, "{}");
+	}
+
+	auto& databaseLocalization = Localization::DatabaseLocalization::GetInstance();
+	Test::TextGenerator chinese(Test::Script::Chinese);
+
+	// 末页剩余不足 simdjson 所需的填充时复制到缓冲区，否则直接解析映射，两侧均需覆盖
+	for (const auto pageEnd : { pageSize, 2 * pageSize })
+	{
+		for (auto size = pageEnd - 100; size <= pageEnd + 2; ++size)
+		{
+			const auto text = chinese.Next(10);
+			Test::WriteFile(textDataPath, MakeTextData(text, size));
+			databaseLocalization.LoadFrom(textDataPath, root / "character_system_text_dict.json",
+			                              root / "race_jikkyo_comment_dict.json",
+			                              root / "race_jikkyo_message_dict.json");
+
+			const Misc::Rcu::ReadGuard guard;
+			CHECK(Test::Copy(databaseLocalization.GetTextData(6, 1001)) == text);
+			CHECK(!databaseLocalization.GetTextData(6, 1002));
+		}
+	}
+}
+
+TEST(ReadsWrittenLocalizationPack)
+{
+	const Test::TemporaryDirectory directory;
+	const auto path = directory.GetPath() / "localization.pack";
+
+	Localization::LocalizationPackWriter writer;
+	writer.AddStatic(u"はい", u"是的");
+	writer.AddStatic(u"いいえ", u"不是");
+	writer.AddTextData(6, 1001, u"特别周");
+	writer.AddTextData(6, 1002, u"无声铃鹿");
+	writer.AddCharacterSystemTextData(1001, 20, u"训练员！");
+	writer.AddRaceJikkyoCommentData(5, u"最后的直线！");
+	writer.AddRaceJikkyoMessageData(7, u"冲线了！");
+
+	Localization::StoryLocalization::StoryTextData story;
+	story.Title = u"标题";
+	story.StringList = { u"选项一", u"选项二", u"红色" };
+	story.TextBlockList.push_back(
+	    Localization::StoryLocalization::StoryTextBlock{ u"特别周", u"你好", 0, 2, 2, 1 });
+	story.TextBlockList.push_back(std::nullopt);
+	writer.AddStoryTextData(100000001, story);
+
+	Localization::StoryLocalization::RaceTextData race;
+	race.textData = { u"第一句", u"第二句", u"第一句" };
+	writer.AddRaceTextData(3, race);
+	REQUIRE(writer.WriteTo(path));
+
+	const auto pack = Localization::LocalizationPack::Open(path);
+	REQUIRE(pack);
+	CHECK(Test::Copy(pack->FindStatic(u"はい")) == u"是的");
+	CHECK(Test::Copy(pack->FindStatic(u"いいえ")) == u"不是");
+	CHECK(!pack->FindStatic(u"ええ"));
+	CHECK(Test::Copy(pack->FindTextData(6, 1002)) == u"无声铃鹿");
+	CHECK(!pack->FindTextData(6, 1003));
+	CHECK(!pack->FindTextData(7, 1001));
+	CHECK(Test::Copy(pack->FindCharacterSystemTextData(1001, 20)) == u"训练员！");
+	CHECK(Test::Copy(pack->FindRaceJikkyoCommentData(5)) == u"最后的直线！");
+	CHECK(Test::Copy(pack->FindRaceJikkyoMessageData(7)) == u"冲线了！");
+	CHECK(!pack->FindRaceJikkyoMessageData(5));
+
+	const auto packedStory = pack->FindStoryTextData(100000001);
+	REQUIRE(packedStory);
+	CHECK(packedStory->Title == u"标题");
+	REQUIRE(packedStory->TextBlockList.size() == 2);
+	const auto& block = packedStory->TextBlockList[0];
+	REQUIRE(block);
+	CHECK(block->Name == u"特别周" && block->Text == u"你好");
+	const auto choices = packedStory->GetChoiceDataList(*block);
+	CHECK(choices.size() == 2 && choices[1] == u"选项二");
+	const auto colors = packedStory->GetColorTextInfoList(*block);
+	CHECK(colors.size() == 1 && colors[0] == u"红色");
+	CHECK(!packedStory->TextBlockList[1]);
+	CHECK(!pack->FindStoryTextData(100000002));
+
+	const auto packedRace = pack->FindRaceTextData(3);
+	REQUIRE(packedRace);
+	CHECK(packedRace->textData.size() == 3 && packedRace->textData[2] == u"第一句");
+	CHECK(!pack->FindRaceTextData(4));
+}
+
+TEST(RejectsMalformedPacks)
+{
+	const Test::TemporaryDirectory directory;
+	const auto path = directory.GetPath() / "localization.pack";
+
+	Test::WriteFile(path, "UMAPACK");
+	CHECK(!Localization::LocalizationPack::Open(path));
+
+	Test::WriteFile(path, std::string(sizeof(Localization::Pack::Header), 'x'));
+	CHECK(!Localization::LocalizationPack::Open(path));
+
+	// 段的范围超出文件
+	Localization::Pack::Header header{};
+	std::memcpy(header.Magic, Localization::Pack::Magic, sizeof(header.Magic));
+	header.Version = Localization::Pack::Version;
+	header.SectionCount = static_cast<std::uint32_t>(Localization::Pack::SectionKind::Count);
+	header.Sections[0] = { sizeof(header), 1024 };
+	Test::WriteFile(path,
+	                std::string_view(reinterpret_cast<const char*>(&header), sizeof(header)));
+	CHECK(!Localization::LocalizationPack::Open(path));
+
+	CHECK(!Localization::LocalizationPack::Open(directory.GetPath() / "missing.pack"));
+}
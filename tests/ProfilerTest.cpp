@@ -0,0 +1,140 @@
+#include "Support/Test.h"
+
+#include "UmaPyogin/Profiler.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace UmaPyogin::Profiler;
+
+namespace
+{
+	// 检查 value 落在所属桶的上下界之间，且桶宽不超过下界的 1/4，最小的几个耗时各占一个桶
+	void CheckBucket(std::uint64_t value)
+	{
+		const auto index = Histogram::GetBucketIndex(value);
+		REQUIRE(index < Histogram::BucketCount);
+		const auto lower = Histogram::GetBucketLowerBound(index);
+		CHECK(lower <= value);
+		if (index + 1 < Histogram::BucketCount)
+		{
+			const auto upper = Histogram::GetBucketLowerBound(index + 1);
+			CHECK(value < upper);
+			const auto width = upper - lower;
+			CHECK(value < Histogram::SubBucketCount ? width == 1
+			                                        : width * Histogram::SubBucketCount <= lower);
+		}
+	}
+
+	HookStatistics const& GetHook(std::array<HookStatistics, HookCount> const& statistics,
+	                              HookId hook)
+	{
+		return statistics[static_cast<std::size_t>(hook)];
+	}
+} // namespace
+
+TEST(BucketsCoverEveryValue)
+{
+	for (std::uint64_t value = 0; value < 100000; ++value)
+	{
+		CheckBucket(value);
+	}
+	for (std::size_t exponent = 2; exponent < Histogram::MaxExponent; ++exponent)
+	{
+		const auto power = std::uint64_t(1) << exponent;
+		for (const auto value : { power - 1, power, power + 1, power + power / 2 })
+		{
+			CheckBucket(value);
+		}
+	}
+
+	// 下界随下标严格递增，超出范围的耗时计入最后一个桶
+	for (std::size_t i = 1; i < Histogram::BucketCount; ++i)
+	{
+		CHECK(Histogram::GetBucketLowerBound(i - 1) < Histogram::GetBucketLowerBound(i));
+	}
+	const auto last = Histogram::BucketCount - 1;
+	CHECK(Histogram::GetBucketIndex(std::uint64_t(1) << Histogram::MaxExponent) == last);
+	CHECK(Histogram::GetBucketIndex(~std::uint64_t(0)) == last);
+}
+
+TEST(PercentilesBoundRecordedValues)
+{
+	Histogram histogram;
+	CHECK(histogram.GetPercentile(0.5) == 0);
+
+	// 1 至 1000 纳秒各一次
+	for (std::uint64_t value = 1; value <= 1000; ++value)
+	{
+		++histogram.Buckets[Histogram::GetBucketIndex(value)];
+	}
+	CHECK(histogram.GetCount() == 1000);
+
+	// 返回的是所在桶的上界，不小于真实值且误差不超过 25%
+	for (const auto& [ratio, expected] : { std::pair{ 0.5, 500.0 }, std::pair{ 0.99, 990.0 },
+	                                       std::pair{ 0.999, 999.0 }, std::pair{ 1.0, 1000.0 } })
+	{
+		const auto percentile = static_cast<double>(histogram.GetPercentile(ratio));
+		CHECK(percentile >= expected);
+		CHECK(percentile <= expected * 1.25);
+	}
+	CHECK(histogram.GetPercentile(0.0) == Histogram::GetBucketLowerBound(2));
+
+	Histogram other;
+	++other.Buckets[Histogram::GetBucketIndex(1000000)];
+	histogram += other;
+	CHECK(histogram.GetCount() == 1001);
+	CHECK(histogram.GetPercentile(1.0) > 1000000);
+}
+
+TEST(CollectsPerThreadCounters)
+{
+	const auto before = Collect();
+
+	constexpr std::size_t ThreadCount = 4;
+	std::vector<std::thread> threads;
+	for (std::size_t i = 0; i < ThreadCount; ++i)
+	{
+		threads.emplace_back([i] {
+			for (std::size_t j = 0; j < 100; ++j)
+			{
+				Record(HookId::Query_Step, 10 * (j + 1), Outcome::None);
+			}
+			Record(HookId::LocalizeJP_Get, 50, Outcome::Hit);
+			Record(HookId::LocalizeJP_Get, 5000 * (i + 1), Outcome::Miss);
+		});
+	}
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	const auto after = Collect();
+	const auto& step = GetHook(after, HookId::Query_Step);
+	const auto& stepBefore = GetHook(before, HookId::Query_Step);
+	CHECK(step.CallCount - stepBefore.CallCount == ThreadCount * 100);
+	CHECK(step.HitCount == stepBefore.HitCount && step.MissCount == stepBefore.MissCount);
+	CHECK(step.TotalNanoseconds - stepBefore.TotalNanoseconds == ThreadCount * 50500);
+	CHECK(step.Latency.GetCount() - stepBefore.Latency.GetCount() == ThreadCount * 100);
+
+	const auto& get = GetHook(after, HookId::LocalizeJP_Get);
+	const auto& getBefore = GetHook(before, HookId::LocalizeJP_Get);
+	CHECK(get.CallCount - getBefore.CallCount == ThreadCount * 2);
+	CHECK(get.HitCount - getBefore.HitCount == ThreadCount);
+	CHECK(get.MissCount - getBefore.MissCount == ThreadCount);
+	CHECK(get.MaxNanoseconds >= 5000 * ThreadCount);
+
+	// 各线程的统计之和等于汇总结果，线程退出后记录由新线程接管，编号不重复
+	const auto perThread = CollectPerThread();
+	CHECK(perThread.size() <= ThreadCount + 1);
+	HookStatistics sum{};
+	for (std::size_t i = 0; i < perThread.size(); ++i)
+	{
+		CHECK(i == 0 || perThread[i - 1].ThreadIndex < perThread[i].ThreadIndex);
+		sum += perThread[i].Hooks[static_cast<std::size_t>(HookId::Query_Step)];
+	}
+	CHECK(sum.CallCount == step.CallCount);
+	CHECK(sum.TotalNanoseconds == step.TotalNanoseconds);
+}
@@ -0,0 +1,188 @@
+#include "Support/FakeIl2Cpp.h"
+#include "Support/LocalizationFiles.h"
+#include "Support/Test.h"
+
+#include "UmaPyogin/Localization.h"
+
+#include <algorithm>
+#include <thread>
+
+using namespace UmaPyogin;
+using namespace UmaPyogin::Fake;
+
+namespace
+{
+	constexpr std::size_t ReaderCount = 4;
+
+	// 读取方在 Replace 循环期间持续读取，直至 stop 被设置
+	template <typename Reader>
+	std::vector<std::thread> StartReaders(std::atomic<bool> const& stop, Reader reader)
+	{
+		std::vector<std::thread> readers;
+		for (std::size_t i = 0; i < ReaderCount; ++i)
+		{
+			readers.emplace_back([&stop, reader] {
+				while (!stop.load(std::memory_order_relaxed))
+				{
+					reader();
+				}
+			});
+		}
+		return readers;
+	}
+
+	void StopReaders(std::atomic<bool>& stop, std::vector<std::thread>& readers)
+	{
+		stop.store(true, std::memory_order_relaxed);
+		for (auto& reader : readers)
+		{
+			reader.join();
+		}
+	}
+
+	// 每个元素均为同一代号，析构时写入 Freed，读到混合的代号或 Freed 即说明读到了被替换或已释放的数据
+	struct Payload
+	{
+		static constexpr std::uint64_t Freed = ~std::uint64_t{};
+
+		std::uint64_t Values[64];
+
+		explicit Payload(std::uint64_t generation)
+		{
+			std::fill(std::begin(Values), std::end(Values), generation);
+		}
+
+		~Payload()
+		{
+			for (auto& value : Values)
+			{
+				reinterpret_cast<volatile std::uint64_t&>(value) = Freed;
+			}
+		}
+	};
+
+	bool IsConsistent(Payload const& payload)
+	{
+		const auto generation = payload.Values[0];
+		if (generation == Payload::Freed)
+		{
+			return false;
+		}
+
+		// 在读端内让出时间片，使 Replace 有机会在读取中途发生
+		std::this_thread::yield();
+		return std::all_of(std::begin(payload.Values), std::end(payload.Values),
+		                   [&](std::uint64_t value) { return value == generation; });
+	}
+} // namespace
+
+TEST(ReplaceWaitsForReaders)
+{
+	std::atomic<const Payload*> target{ new Payload(0) };
+	std::atomic<std::size_t> readCount{};
+	std::atomic<std::size_t> badReadCount{};
+
+	std::atomic<bool> stop{};
+	auto readers = StartReaders(stop, [&] {
+		const Misc::Rcu::ReadGuard guard;
+		if (!IsConsistent(*target.load(std::memory_order_acquire)))
+		{
+			badReadCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// 嵌套的读端不应提前结束外层读端
+		{
+			const Misc::Rcu::ReadGuard nested;
+		}
+		if (!IsConsistent(*target.load(std::memory_order_acquire)))
+		{
+			badReadCount.fetch_add(1, std::memory_order_relaxed);
+		}
+		readCount.fetch_add(1, std::memory_order_relaxed);
+	});
+
+	// 单核时读取线程可能尚未运行，替换次数与读取次数均达到要求后才停止
+	std::uint64_t generation = 0;
+	while (generation < 2000 || readCount.load(std::memory_order_relaxed) < 2000)
+	{
+		Misc::Rcu::Replace(target, std::make_unique<const Payload>(++generation));
+	}
+	StopReaders(stop, readers);
+
+	CHECK(badReadCount.load() == 0);
+	CHECK(target.load()->Values[0] == generation);
+	delete target.load();
+}
+
+TEST(ReloadWhileHooksRead)
+{
+	const Test::TemporaryDirectory directory;
+	const auto& root = directory.GetPath();
+	const auto staticPath = root / "static.json";
+	const auto textDataPath = root / "text_data.json";
+
+	// 两个版本的译文交替写入，读取方只应读到其中之一的完整文本
+	const std::u16string staticTexts[] = { u"是的，训练员", u"好的，训练员先生" };
+	const std::u16string textDataTexts[] = { u"特别周", u"无声铃鹿与特别周" };
+	const auto writeVersion = [&](std::size_t version) {
+		const std::pair<std::u16string, std::u16string> staticEntries[] = {
+			{ u"はい", staticTexts[version] },
+		};
+		Test::WriteStaticLocalization(staticPath, staticEntries);
+		const Test::NestedDictionaryEntry textData[] = { { 6, 1001, textDataTexts[version] } };
+		Test::WriteNestedDictionary(textDataPath, textData);
+	};
+	writeVersion(0);
+
+	Game::GetInstance().SetStaticSources({ u"はい" });
+
+	Config config{};
+	config.StaticLocalizationFilePath = staticPath.string();
+	config.TextDataDictPath = textDataPath.string();
+	config.LoadLocalizationSynchronously = true;
+	auto& installer = InstallPlugin(std::move(config));
+	InitIl2Cpp(installer);
+
+	auto& staticLocalization = Localization::StaticLocalization::GetInstance();
+	auto& databaseLocalization = Localization::DatabaseLocalization::GetInstance();
+	const auto localizeJPGet = installer.Resolve(&Game::LocalizeJP_Get);
+
+	std::atomic<std::size_t> badReadCount{};
+	const auto checkText = [&](std::u16string const& text, std::u16string const(&expected)[2]) {
+		if (text != expected[0] && text != expected[1])
+		{
+			badReadCount.fetch_add(1, std::memory_order_relaxed);
+		}
+	};
+
+	std::atomic<std::size_t> readCount{};
+	std::atomic<bool> stop{};
+	auto readers = StartReaders(stop, [&] {
+		// 钩子返回的字符串已复制到托管字符串中，不受替换影响
+		checkText(std::u16string(ToStringView(localizeJPGet(0))), staticTexts);
+
+		const Misc::Rcu::ReadGuard guard;
+		const auto staticText = staticLocalization.Localize(0);
+		const auto textData = databaseLocalization.GetTextData(6, 1001);
+		std::this_thread::yield();
+		checkText(Test::Copy(staticText), staticTexts);
+		checkText(Test::Copy(textData), textDataTexts);
+		readCount.fetch_add(1, std::memory_order_relaxed);
+	});
+
+	// 以偶数次重新加载结束，最终为第一个版本
+	std::size_t reloadCount = 0;
+	while (reloadCount < 200 || reloadCount % 2 || readCount.load(std::memory_order_relaxed) < 200)
+	{
+		writeVersion(++reloadCount % 2);
+		staticLocalization.Reload();
+		databaseLocalization.Reload(textDataPath);
+	}
+	StopReaders(stop, readers);
+
+	CHECK(badReadCount.load() == 0);
+
+	const Misc::Rcu::ReadGuard guard;
+	CHECK(Test::Copy(staticLocalization.Localize(0)) == staticTexts[0]);
+	CHECK(Test::Copy(databaseLocalization.GetTextData(6, 1001)) == textDataTexts[0]);
+}
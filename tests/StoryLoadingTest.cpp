@@ -0,0 +1,189 @@
+#include "Support/LocalizationFiles.h"
+#include "Support/Test.h"
+
+#include "UmaPyogin/Localization.h"
+#include "UmaPyogin/Misc.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace UmaPyogin;
+using namespace UmaPyogin::Fake;
+
+namespace
+{
+	constexpr std::uint64_t FirstStoryId = 100000000;
+
+	// 加载全部剧情，返回期间读取缓冲区与解析器的分配次数
+	Localization::LoadAllocationStatistics LoadAllStories(std::size_t expectedCount)
+	{
+		const auto before = Localization::GetLoadAllocationStatistics();
+		std::size_t visitCount = 0;
+		Localization::StoryLocalization::GetInstance().ForEachStoryTextData(
+		    [&](std::size_t, auto const&) { ++visitCount; });
+		CHECK(visitCount == expectedCount);
+
+		const auto after = Localization::GetLoadAllocationStatistics();
+		return { after.ReadBuffers - before.ReadBuffers, after.Parsers - before.Parsers };
+	}
+
+	// 在文件末尾追加换行符，使末页剩余的字节不足 simdjson 所需的填充，加载时须复制到缓冲区
+	void PadToPageEnd(std::filesystem::path const& path, std::size_t pageSize)
+	{
+		const auto size = std::filesystem::file_size(path);
+		const auto padding = (pageSize - size % pageSize + pageSize - 8) % pageSize;
+		std::ofstream(path, std::ios::binary | std::ios::app) << std::string(padding, '\n');
+	}
+
+	std::filesystem::path GetTimelinePath(std::filesystem::path const& dir, std::uint64_t id)
+	{
+		return dir / ("storytimeline_" + std::to_string(id) + ".json");
+	}
+} // namespace
+
+TEST(ReusesParsersAcrossFiles)
+{
+	const Test::TemporaryDirectory directory;
+	const auto& root = directory.GetPath();
+	const auto pageSize = Test::GetPageSize(root);
+
+	constexpr std::size_t StoryCount = 300;
+	Test::TextGenerator chinese(Test::Script::Chinese);
+	for (std::size_t i = 0; i < StoryCount; ++i)
+	{
+		std::vector<StoryBlock> blocks(20);
+		for (auto& block : blocks)
+		{
+			block.Name = chinese.Next(3);
+			block.Text = chinese.Next(40);
+		}
+		Test::WriteStoryTimeline(root, FirstStoryId + i, u"标题", blocks);
+		PadToPageEnd(GetTimelinePath(root, FirstStoryId + i), pageSize);
+	}
+
+	auto& storyLocalization = Localization::StoryLocalization::GetInstance();
+	storyLocalization.LoadFrom(root);
+
+	// 每个线程只在首次加载时分配，分配次数与文件数无关
+	const auto threadLimit = Misc::Parallel::ThreadPool::GetInstance().GetThreadCount() + 1;
+	const auto first = LoadAllStories(StoryCount);
+	CHECK(first.ReadBuffers >= 1 && first.ReadBuffers <= threadLimit);
+	CHECK(first.Parsers >= 1 && first.Parsers <= threadLimit);
+
+	const auto second = LoadAllStories(StoryCount);
+	CHECK(second.ReadBuffers <= threadLimit);
+	CHECK(second.Parsers <= threadLimit);
+	CHECK(first.ReadBuffers + second.ReadBuffers <= threadLimit);
+	CHECK(first.Parsers + second.Parsers <= threadLimit);
+}
+
+TEST(ReleasesParsersForLargeFiles)
+{
+	const Test::TemporaryDirectory directory;
+	const auto& root = directory.GetPath();
+
+	// 超过缓冲区上限的剧情之后，较小的剧情仍能正常加载
+	Test::TextGenerator japanese(Test::Script::Japanese);
+	for (std::uint64_t i = 0; i < 4; ++i)
+	{
+		std::vector<StoryBlock> blocks(i % 2 ? 5000 : 10);
+		for (auto& block : blocks)
+		{
+			block.Text = japanese.Next(30);
+		}
+		Test::WriteStoryTimeline(root, FirstStoryId + i, u"タイトル", blocks);
+	}
+
+	auto& storyLocalization = Localization::StoryLocalization::GetInstance();
+	storyLocalization.LoadFrom(root);
+	for (std::uint64_t i = 0; i < 4; ++i)
+	{
+		const auto data = storyLocalization.GetStoryTextData(FirstStoryId + i);
+		REQUIRE(data);
+		CHECK(data->TextBlockList.size() == (i % 2 ? 5000 : 10));
+	}
+}
+
+TEST(LoadsAllFilesAcrossChunks)
+{
+	auto& storyLocalization = Localization::StoryLocalization::GetInstance();
+	Test::TextGenerator chinese(Test::Script::Chinese);
+
+	// 每块 32 个文件，覆盖不足一块、恰好一块与多块且最后一块不满的情况
+	for (const std::size_t storyCount : { 0, 1, 31, 32, 33, 100 })
+	{
+		const Test::TemporaryDirectory directory;
+		const auto& root = directory.GetPath();
+		for (std::size_t i = 0; i < storyCount; ++i)
+		{
+			std::vector<StoryBlock> blocks(1 + i % 5);
+			for (auto& block : blocks)
+			{
+				block.Text = chinese.Next(10);
+			}
+			// id 不连续，且写入顺序与 id 顺序不同
+			Test::WriteStoryTimeline(root, FirstStoryId + (storyCount - i) * 7, chinese.Next(4),
+			                         blocks);
+			const std::u16string raceTexts[] = { chinese.Next(5), chinese.Next(5) };
+			Test::WriteStoryRace(root, 1000 + i * 3, raceTexts);
+		}
+		storyLocalization.LoadFrom(root);
+
+		// 按 id 顺序访问，内容与按需加载的结果相同
+		std::vector<std::size_t> storyIds;
+		storyLocalization.ForEachStoryTextData([&](std::size_t id, auto const& data) {
+			CHECK(storyIds.empty() || storyIds.back() < id);
+			storyIds.push_back(id);
+			const auto expected = storyLocalization.GetStoryTextData(id);
+			REQUIRE(expected);
+			CHECK(data.Title == expected->Title);
+			REQUIRE(data.TextBlockList.size() == expected->TextBlockList.size());
+			for (std::size_t i = 0; i < data.TextBlockList.size(); ++i)
+			{
+				CHECK(data.TextBlockList[i]->Text == expected->TextBlockList[i]->Text);
+			}
+		});
+		CHECK(storyIds.size() == storyCount);
+
+		std::size_t raceCount = 0;
+		storyLocalization.ForEachRaceTextData([&](std::size_t id, auto const& data) {
+			CHECK(id == 1000 + raceCount * 3);
+			++raceCount;
+			const auto expected = storyLocalization.GetRaceTextData(id);
+			REQUIRE(expected);
+			CHECK(data.textData == expected->textData);
+		});
+		CHECK(raceCount == storyCount);
+	}
+}
+
+TEST(SkipsBrokenFilesWhenLoadingAll)
+{
+	const Test::TemporaryDirectory directory;
+	const auto& root = directory.GetPath();
+	for (std::size_t i = 0; i < 70; ++i)
+	{
+		const std::vector<StoryBlock> blocks(2, StoryBlock{ u"名字", u"文本", {}, {} });
+		Test::WriteStoryTimeline(root, FirstStoryId + i, u"标题", blocks);
+	}
+	// 损坏的文件分别位于第一块、块的边界与最后一块
+	for (const std::size_t i : { 3, 31, 32, 69 })
+	{
+		Test::WriteFile(GetTimelinePath(root, FirstStoryId + i), "{\"Title\":");
+	}
+
+	auto& storyLocalization = Localization::StoryLocalization::GetInstance();
+	storyLocalization.LoadFrom(root);
+
+	std::vector<std::size_t> storyIds;
+	storyLocalization.ForEachStoryTextData(
+	    [&](std::size_t id, auto const&) { storyIds.push_back(id); });
+	REQUIRE(storyIds.size() == 66);
+	CHECK(std::is_sorted(storyIds.begin(), storyIds.end()));
+	for (const std::size_t i : { 3, 31, 32, 69 })
+	{
+		CHECK(std::find(storyIds.begin(), storyIds.end(), FirstStoryId + i) == storyIds.end());
+	}
+}
@@ -0,0 +1,143 @@
+#include "Support/FakeIl2Cpp.h"
+#include "Support/Test.h"
+
+#include "UmaPyogin/Plugin.h"
+#include "UmaPyogin/StringCache.h"
+
+#include <string>
+#include <vector>
+
+using namespace UmaPyogin;
+using namespace UmaPyogin::Fake;
+
+namespace
+{
+	// 缓存通过插件取得的 il2cpp 函数分配字符串，需先完成安装
+	Il2CppStringCache& GetCache()
+	{
+		static const auto installed = [] {
+			Config config{};
+			config.LoadLocalizationSynchronously = true;
+			return InitIl2Cpp(InstallPlugin(std::move(config)));
+		}();
+		REQUIRE(installed);
+
+		auto& cache = Il2CppStringCache::GetInstance();
+		cache.Clear();
+		cache.SetBudget(Il2CppStringCache::DefaultBudget);
+		return cache;
+	}
+
+	std::size_t GetEntryBytes(std::size_t length)
+	{
+		return sizeof(Il2CppString) + length * sizeof(char16_t);
+	}
+} // namespace
+
+TEST(ReturnsSameStringForSameText)
+{
+	auto& cache = GetCache();
+	const auto before = cache.GetStatistics();
+	const std::u16string text = u"训练员";
+
+	const auto first = cache.Get(text);
+	REQUIRE(first);
+	CHECK(ToStringView(first) == text);
+	CHECK(cache.Get(text) == first);
+
+	// 以文本的地址为键，内容相同但位于别处的文本另行缓存
+	const std::u16string copy = text;
+	const auto other = cache.Get(copy);
+	CHECK(other != first);
+	CHECK(ToStringView(other) == text);
+
+	const auto after = cache.GetStatistics();
+	CHECK(after.Hits - before.Hits == 1);
+	CHECK(after.Misses - before.Misses == 2);
+	CHECK(after.Entries == 2);
+	CHECK(after.Bytes == 2 * GetEntryBytes(text.size()));
+
+	const auto plugin = Plugin::GetInstance().GetStringCacheStatistics();
+	CHECK(plugin.Hits == after.Hits && plugin.Misses == after.Misses);
+}
+
+TEST(EvictionFreesGCHandles)
+{
+	auto& cache = GetCache();
+	auto& runtime = Runtime::GetInstance();
+	const auto handleCount = runtime.GetLiveGCHandleCount();
+
+	// 预算恰好容纳 3 项
+	std::vector<std::u16string> texts;
+	for (std::size_t i = 0; i < 5; ++i)
+	{
+		texts.push_back(u"文本" + std::u16string(1, static_cast<char16_t>(u'0' + i)));
+	}
+	cache.SetBudget(3 * GetEntryBytes(texts[0].size()));
+	const auto before = cache.GetStatistics();
+
+	std::vector<Il2CppString*> strings;
+	for (std::size_t i = 0; i < 3; ++i)
+	{
+		strings.push_back(cache.Get(texts[i]));
+	}
+	CHECK(runtime.GetLiveGCHandleCount() == handleCount + 3);
+
+	// 使用过 0 之后，最久未使用的是 1
+	CHECK(cache.Get(texts[0]) == strings[0]);
+	cache.Get(texts[3]);
+	cache.Get(texts[4]);
+	CHECK(cache.GetStatistics().Evictions - before.Evictions == 2);
+	CHECK(cache.GetStatistics().Entries == 3);
+	CHECK(runtime.GetLiveGCHandleCount() == handleCount + 3);
+	CHECK(cache.Get(texts[0]) == strings[0]);
+	CHECK(cache.Get(texts[1]) != strings[1]);
+
+	// 超出预算的文本不缓存
+	const std::u16string longText(64, u'长');
+	CHECK(cache.Get(longText) != cache.Get(longText));
+
+	// 缩小预算与清空缓存均释放句柄
+	cache.SetBudget(GetEntryBytes(texts[0].size()));
+	CHECK(runtime.GetLiveGCHandleCount() == handleCount + 1);
+	cache.Clear();
+	CHECK(runtime.GetLiveGCHandleCount() == handleCount);
+	CHECK(cache.GetStatistics().Entries == 0);
+	CHECK(cache.GetStatistics().Bytes == 0);
+}
+
+TEST(ReusedAddressFailsContentCheck)
+{
+	auto& cache = GetCache();
+	auto& runtime = Runtime::GetInstance();
+
+	// 文本被释放后其地址存放了等长的其他文本
+	std::u16string text = u"特别周";
+	const auto first = cache.Get(text);
+	const auto handleCount = runtime.GetLiveGCHandleCount();
+	text = u"无声铃";
+
+	const auto second = cache.Get(text);
+	CHECK(second != first);
+	CHECK(ToStringView(second) == u"无声铃");
+	CHECK(ToStringView(first) == u"特别周");
+	// 旧项的句柄已释放
+	CHECK(runtime.GetLiveGCHandleCount() == handleCount);
+	CHECK(cache.GetStatistics().Entries == 1);
+	CHECK(cache.Get(text) == second);
+}
+
+TEST(ZeroBudgetDisablesCache)
+{
+	auto& cache = GetCache();
+	cache.SetBudget(0);
+	const auto before = cache.GetStatistics();
+
+	const std::u16string text = u"是";
+	const auto first = cache.Get(text);
+	const auto second = cache.Get(text);
+	CHECK(first != second);
+	CHECK(ToStringView(first) == text && ToStringView(second) == text);
+	CHECK(cache.GetStatistics().Entries == 0);
+	CHECK(cache.GetStatistics().Misses == before.Misses);
+}
@@ -0,0 +1,1028 @@
+#include "FakeIl2Cpp.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "UmaPyogin/Misc.h"
+
+namespace UmaPyogin::Fake
+{
+	namespace
+	{
+		struct QueryState
+		{
+			Il2CppString* Sql;
+			std::int32_t BoundInts[8];
+			std::int32_t Ints[8];
+			std::int32_t RowCount;
+			std::int32_t StepCount;
+			bool Disposed;
+		};
+
+		template <typename State>
+		State& GetState(void* object)
+		{
+			return *reinterpret_cast<State*>(static_cast<Il2CppObject*>(object) + 1);
+		}
+
+		Class* ToClass(const Il2CppClass* klass)
+		{
+			return reinterpret_cast<Class*>(const_cast<Il2CppClass*>(klass));
+		}
+
+		Field* ToField(FieldInfo* field)
+		{
+			return reinterpret_cast<Field*>(field);
+		}
+
+		// 迭代器中存放下一个元素的序号
+		template <typename T>
+		T* Iterate(std::vector<T*> const& items, void** iter)
+		{
+			const auto index = reinterpret_cast<std::uintptr_t>(*iter);
+			if (index >= items.size())
+			{
+				return nullptr;
+			}
+			*iter = reinterpret_cast<void*>(index + 1);
+			return items[index];
+		}
+
+		template <typename T>
+		T* Iterate(std::vector<std::unique_ptr<T>> const& items, void** iter)
+		{
+			const auto index = reinterpret_cast<std::uintptr_t>(*iter);
+			if (index >= items.size())
+			{
+				return nullptr;
+			}
+			*iter = reinterpret_cast<void*>(index + 1);
+			return items[index].get();
+		}
+
+		Il2CppObject** GetElements(Il2CppArray* array)
+		{
+			return reinterpret_cast<Il2CppObject**>(array + 1);
+		}
+
+		std::int32_t List_get_Count(Il2CppObject* self)
+		{
+			return *reinterpret_cast<std::int32_t*>(
+			    reinterpret_cast<std::byte*>(self) +
+			    Runtime::GetInstance().GetListClass()->FindField("_size")->Info.offset);
+		}
+
+		Il2CppObject* List_get_Item(Il2CppObject* self, std::int32_t index)
+		{
+			const auto items = reinterpret_cast<Il2CppArray*>(GetObjectField(
+			    self, Runtime::GetInstance().GetListClass()->FindField("_items")));
+			return GetElements(items)[index];
+		}
+
+		std::int32_t Array_get_Count(Il2CppObject* self)
+		{
+			return static_cast<std::int32_t>(reinterpret_cast<Il2CppArray*>(self)->max_length);
+		}
+
+		Il2CppObject* Array_get_Item(Il2CppObject* self, std::int32_t index)
+		{
+			return GetElements(reinterpret_cast<Il2CppArray*>(self))[index];
+		}
+
+		Il2CppString* Environment_get_StackTrace()
+		{
+			return Runtime::GetInstance().NewString(u"");
+		}
+
+		bool Object_IsNativeObjectAlive(Il2CppObject* object)
+		{
+			return object != nullptr;
+		}
+
+		void Text_set_font(Il2CppObject* self, Il2CppObject* font)
+		{
+			GetState<Game::TextState>(self).Font = font;
+		}
+
+		void Text_AssignDefaultFont(Il2CppObject* self)
+		{
+			GetState<Game::TextState>(self).DefaultFontAssigned = true;
+		}
+
+		void Text_set_horizontalOverflow(Il2CppObject* self, std::int32_t value)
+		{
+			GetState<Game::TextState>(self).HorizontalOverflow = value;
+		}
+
+		void Text_set_verticalOverflow(Il2CppObject* self, std::int32_t value)
+		{
+			GetState<Game::TextState>(self).VerticalOverflow = value;
+		}
+
+		void Text_set_fontStyle(Il2CppObject* self, std::int32_t value)
+		{
+			GetState<Game::TextState>(self).FontStyle = value;
+		}
+
+		void Text_set_lineSpacing(Il2CppObject* self, float value)
+		{
+			GetState<Game::TextState>(self).LineSpacing = value;
+		}
+
+		template <typename Function>
+		Il2CppMethodPointer ToMethodPointer(Function function)
+		{
+			return reinterpret_cast<Il2CppMethodPointer>(function);
+		}
+	} // namespace
+
+	// 与 Il2CppSymbols 中的函数同名同签名，由 LookupSymbol 返回
+	namespace Api
+	{
+		int il2cpp_init(const char*)
+		{
+			Runtime::GetInstance().Initialized.store(true);
+			return 1;
+		}
+
+		Il2CppDomain* il2cpp_domain_get()
+		{
+			return reinterpret_cast<Il2CppDomain*>(&Runtime::GetInstance());
+		}
+
+		const Il2CppAssembly* il2cpp_domain_assembly_open(Il2CppDomain*, const char* name)
+		{
+			const auto image = Runtime::GetInstance().FindImage(name);
+			return image ? &image->Assembly : nullptr;
+		}
+
+		const Il2CppImage* il2cpp_get_corlib()
+		{
+			return reinterpret_cast<const Il2CppImage*>(Runtime::GetInstance().GetCorlib());
+		}
+
+		const Il2CppImage* il2cpp_assembly_get_image(const Il2CppAssembly* assembly)
+		{
+			return static_cast<const Il2CppImage*>(assembly->image);
+		}
+
+		Il2CppClass* il2cpp_class_from_name(const Il2CppImage* image, const char* name_space,
+		                                    const char* name)
+		{
+			const auto fakeImage = reinterpret_cast<const Image*>(image);
+			for (const auto klass : fakeImage->Classes)
+			{
+				if (klass->Namespace == name_space && klass->Name == name)
+				{
+					return klass->AsIl2CppClass();
+				}
+			}
+			return nullptr;
+		}
+
+		const MethodInfo* il2cpp_class_get_methods(Il2CppClass* klass, void** iter)
+		{
+			const auto method = Iterate(ToClass(klass)->Methods, iter);
+			return method ? &method->Info : nullptr;
+		}
+
+		const MethodInfo* il2cpp_class_get_method_from_name(Il2CppClass* klass, const char* name,
+		                                                   int paramCount)
+		{
+			for (const auto& method : ToClass(klass)->Methods)
+			{
+				if (method->Name == name && (paramCount == -1 || method->ParamCount == paramCount))
+				{
+					return &method->Info;
+				}
+			}
+			return nullptr;
+		}
+
+		const Il2CppType* il2cpp_class_get_type(Il2CppClass* klass)
+		{
+			return reinterpret_cast<const Il2CppType*>(&ToClass(klass)->TypeHandle);
+		}
+
+		Il2CppString* il2cpp_string_new(const char* str)
+		{
+			return Runtime::GetInstance().NewString(Misc::ToUTF16(str));
+		}
+
+		Il2CppString* il2cpp_string_new_utf16(const Il2CppChar* text, int32_t len)
+		{
+			return Runtime::GetInstance().NewString(
+			    std::u16string_view(text, static_cast<std::size_t>(len)));
+		}
+
+		Il2CppClass* il2cpp_class_get_nested_types(Il2CppClass* klass, void** iter)
+		{
+			const auto nestedClass = Iterate(ToClass(klass)->NestedTypes, iter);
+			return nestedClass ? nestedClass->AsIl2CppClass() : nullptr;
+		}
+
+		FieldInfo* il2cpp_class_get_field_from_name(Il2CppClass* klass, const char* name)
+		{
+			const auto field = ToClass(klass)->FindField(name);
+			return field ? &field->Info : nullptr;
+		}
+
+		void il2cpp_field_get_value(Il2CppObject* obj, FieldInfo* field, void* value)
+		{
+			const auto size = ToField(field)->Type == FieldType::Int32 ? sizeof(std::int32_t)
+			                                                            : sizeof(Il2CppObject*);
+			std::memcpy(value, reinterpret_cast<std::byte*>(obj) + field->offset, size);
+		}
+
+		Il2CppObject* il2cpp_field_get_value_object(FieldInfo* field, Il2CppObject* obj)
+		{
+			return GetObjectField(obj, ToField(field));
+		}
+
+		void il2cpp_field_set_value(Il2CppObject* obj, FieldInfo* field, void* value)
+		{
+			const auto size = ToField(field)->Type == FieldType::Int32 ? sizeof(std::int32_t)
+			                                                            : sizeof(Il2CppObject*);
+			std::memcpy(reinterpret_cast<std::byte*>(obj) + field->offset, value, size);
+		}
+
+		void il2cpp_field_set_value_object(Il2CppObject* instance, FieldInfo* field,
+		                                   Il2CppObject* value)
+		{
+			SetObjectField(instance, ToField(field), value);
+		}
+
+		Il2CppClass* il2cpp_object_get_class(Il2CppObject* obj)
+		{
+			return static_cast<Il2CppClass*>(obj->klass);
+		}
+
+		uint32_t il2cpp_gchandle_new(Il2CppObject* obj, bool)
+		{
+			return Runtime::GetInstance().NewGCHandle(obj);
+		}
+
+		Il2CppObject* il2cpp_gchandle_get_target(uint32_t gchandle)
+		{
+			return Runtime::GetInstance().GetGCHandleTarget(gchandle);
+		}
+
+		void il2cpp_gchandle_free(uint32_t gchandle)
+		{
+			Runtime::GetInstance().FreeGCHandle(gchandle);
+		}
+
+		Il2CppObject* il2cpp_type_get_object(const Il2CppType* type)
+		{
+			// type 指向 Class::TypeHandle
+			const auto klass = *reinterpret_cast<Class* const*>(type);
+			return reinterpret_cast<Il2CppObject*>(klass->TypeObject);
+		}
+
+		bool il2cpp_class_is_assignable_from(Il2CppClass* klass, Il2CppClass* oklass)
+		{
+			const auto target = ToClass(klass);
+			const auto source = ToClass(oklass);
+			return target == source || std::find(source->Interfaces.begin(),
+			                                     source->Interfaces.end(),
+			                                     target) != source->Interfaces.end();
+		}
+
+		const char* il2cpp_class_get_name(Il2CppClass* klass)
+		{
+			return ToClass(klass)->Name.c_str();
+		}
+
+		int il2cpp_array_element_size(const Il2CppClass* array_class)
+		{
+			return ToClass(array_class)->ElementSize;
+		}
+
+		void il2cpp_gc_wbarrier_set_field(Il2CppObject*, void** targetAddress, void* object)
+		{
+			Runtime::GetInstance().WriteBarrierCount.fetch_add(1, std::memory_order_relaxed);
+			*targetAddress = object;
+		}
+	} // namespace Api
+
+	Field* Class::AddField(std::string name, FieldType type)
+	{
+		auto& field = *Fields.emplace_back(std::make_unique<Field>());
+		field.Type = type;
+		field.Name = std::move(name);
+		field.Info.name = field.Name.c_str();
+		field.Info.parent = this;
+		field.Info.offset = static_cast<std::int32_t>(InstanceSize);
+		InstanceSize += 8;
+		return &field;
+	}
+
+	Method* Class::AddMethod(std::string name, int paramCount, Il2CppMethodPointer pointer)
+	{
+		auto& method = *Methods.emplace_back(std::make_unique<Method>());
+		method.Name = std::move(name);
+		method.ParamCount = paramCount;
+		method.Info.methodPointer = pointer;
+		method.Info.name = method.Name.c_str();
+		method.Info.klass = this;
+		method.Info.parameters_count = static_cast<std::uint8_t>(paramCount);
+		return &method;
+	}
+
+	Field* Class::FindField(std::string_view name) const
+	{
+		for (const auto& field : Fields)
+		{
+			if (field->Name == name)
+			{
+				return field.get();
+			}
+		}
+		return nullptr;
+	}
+
+	Il2CppClass* Class::AsIl2CppClass()
+	{
+		return reinterpret_cast<Il2CppClass*>(this);
+	}
+
+	Runtime& Runtime::GetInstance()
+	{
+		static Runtime s_Instance;
+		return s_Instance;
+	}
+
+	Runtime::Runtime()
+	{
+		const auto corlib = AddImage("mscorlib.dll");
+
+		m_IListClass = AddClass(corlib, "System.Collections", "IList");
+
+		m_ListClass = AddClass(corlib, "System.Collections.Generic", "List`1");
+		m_ListClass->AddField("_items");
+		m_ListClass->AddField("_size", FieldType::Int32);
+		m_ListClass->AddMethod("get_Count", 0, ToMethodPointer(&List_get_Count));
+		m_ListClass->AddMethod("get_Item", 1, ToMethodPointer(&List_get_Item));
+		m_ListClass->Interfaces.push_back(m_IListClass);
+
+		// 数组以显式接口实现提供 IList 的方法
+		m_ArrayClass = AddClass(corlib, "System", "Object[]");
+		m_ArrayClass->ElementSize = sizeof(Il2CppObject*);
+		m_ArrayClass->AddMethod("System.Collections.ICollection.get_Count", 0,
+		                        ToMethodPointer(&Array_get_Count));
+		m_ArrayClass->AddMethod("System.Collections.IList.get_Item", 1,
+		                        ToMethodPointer(&Array_get_Item));
+		m_ArrayClass->Interfaces.push_back(m_IListClass);
+
+		const auto environmentClass = AddClass(corlib, "System", "Environment");
+		environmentClass->AddMethod("get_StackTrace", 0,
+		                            ToMethodPointer(&Environment_get_StackTrace));
+	}
+
+	OpaqueFunctionPointer Runtime::LookupSymbol(std::string_view name) const
+	{
+		static const std::unordered_map<std::string_view, OpaqueFunctionPointer> symbols = {
+			{ "il2cpp_init", reinterpret_cast<OpaqueFunctionPointer>(&Api::il2cpp_init) },
+#define SYMBOL_ENTRY(returnType, name, params)                                                     \
+	{ #name,                                                                                       \
+	  reinterpret_cast<OpaqueFunctionPointer>(static_cast<returnType(*) params>(&Api::name)) },
+			LOAD_FUNCTIONS(SYMBOL_ENTRY) LOAD_OPTIONAL_FUNCTIONS(SYMBOL_ENTRY)
+#undef SYMBOL_ENTRY
+		};
+
+		{
+			std::unique_lock lock(m_Mutex);
+			if (std::find(m_HiddenSymbols.begin(), m_HiddenSymbols.end(), name) !=
+			    m_HiddenSymbols.end())
+			{
+				return nullptr;
+			}
+		}
+
+		const auto iter = symbols.find(name);
+		return iter != symbols.end() ? iter->second : nullptr;
+	}
+
+	void Runtime::HideSymbol(std::string name)
+	{
+		std::unique_lock lock(m_Mutex);
+		m_HiddenSymbols.push_back(std::move(name));
+	}
+
+	void Runtime::ClearHiddenSymbols()
+	{
+		std::unique_lock lock(m_Mutex);
+		m_HiddenSymbols.clear();
+	}
+
+	Image* Runtime::AddImage(std::string name)
+	{
+		auto& image = m_Images.emplace_back();
+		image.Name = std::move(name);
+		image.Assembly.image = &image;
+		image.Assembly.aname.name = image.Name.c_str();
+		return &image;
+	}
+
+	Image* Runtime::FindImage(std::string_view name) const
+	{
+		for (auto& image : m_Images)
+		{
+			if (image.Name == name)
+			{
+				return const_cast<Image*>(&image);
+			}
+		}
+		return nullptr;
+	}
+
+	Image* Runtime::GetCorlib() const
+	{
+		return const_cast<Image*>(&m_Images.front());
+	}
+
+	Class* Runtime::AddClass(Image* image, std::string namespaze, std::string name)
+	{
+		auto& klass = m_Classes.emplace_back();
+		klass.Namespace = std::move(namespaze);
+		klass.Name = std::move(name);
+		klass.Head.image = image;
+		klass.Head.name = klass.Name.c_str();
+		klass.Head.namespaze = klass.Namespace.c_str();
+		klass.TypeObject = reinterpret_cast<Il2CppReflectionType*>(
+		    Allocate(sizeof(Il2CppReflectionType)));
+		klass.TypeObject->type = reinterpret_cast<const Il2CppType*>(&klass.TypeHandle);
+		if (image)
+		{
+			image->Classes.push_back(&klass);
+		}
+		return &klass;
+	}
+
+	Class* Runtime::AddNestedClass(Class* declaringClass, std::string name)
+	{
+		// 嵌套类不能通过 il2cpp_class_from_name 找到
+		const auto klass = AddClass(nullptr, declaringClass->Namespace, std::move(name));
+		klass->Head.image = declaringClass->Head.image;
+		declaringClass->NestedTypes.push_back(klass);
+		return klass;
+	}
+
+	std::byte* Runtime::Allocate(std::size_t size)
+	{
+		auto memory = std::make_unique<std::byte[]>(size);
+		const auto result = memory.get();
+		std::unique_lock lock(m_Mutex);
+		m_Allocations.push_back(std::move(memory));
+		return result;
+	}
+
+	Il2CppObject* Runtime::NewObject(Class* klass)
+	{
+		const auto object = reinterpret_cast<Il2CppObject*>(Allocate(klass->InstanceSize));
+		object->klass = klass;
+		return object;
+	}
+
+	Il2CppString* Runtime::NewString(std::u16string_view str)
+	{
+		const auto result = reinterpret_cast<Il2CppString*>(
+		    Allocate(sizeof(Il2CppString) + str.size() * sizeof(char16_t)));
+		result->length = static_cast<std::int32_t>(str.size());
+		std::memcpy(result->chars, str.data(), str.size() * sizeof(char16_t));
+		AllocatedStringCount.fetch_add(1, std::memory_order_relaxed);
+		return result;
+	}
+
+	Il2CppArray* Runtime::NewArray(std::span<Il2CppObject* const> items)
+	{
+		const auto array = reinterpret_cast<Il2CppArray*>(
+		    Allocate(sizeof(Il2CppArray) + items.size() * sizeof(Il2CppObject*)));
+		array->obj.klass = m_ArrayClass;
+		array->max_length = items.size();
+		std::copy(items.begin(), items.end(), GetElements(array));
+		return array;
+	}
+
+	Il2CppObject* Runtime::NewList(std::span<Il2CppObject* const> items)
+	{
+		const auto list = NewObject(m_ListClass);
+		SetObjectField(list, m_ListClass->FindField("_items"),
+		               reinterpret_cast<Il2CppObject*>(NewArray(items)));
+		auto size = static_cast<std::int32_t>(items.size());
+		Api::il2cpp_field_set_value(list, &m_ListClass->FindField("_size")->Info, &size);
+		return list;
+	}
+
+	Class* Runtime::GetIListClass() const
+	{
+		return m_IListClass;
+	}
+
+	Class* Runtime::GetListClass() const
+	{
+		return m_ListClass;
+	}
+
+	Class* Runtime::GetArrayClass() const
+	{
+		return m_ArrayClass;
+	}
+
+	bool Runtime::IsInitialized() const
+	{
+		return Initialized.load();
+	}
+
+	std::size_t Runtime::GetAllocatedStringCount() const
+	{
+		return AllocatedStringCount.load(std::memory_order_relaxed);
+	}
+
+	std::size_t Runtime::GetLiveGCHandleCount() const
+	{
+		std::unique_lock lock(m_Mutex);
+		return m_LiveGCHandleCount;
+	}
+
+	std::size_t Runtime::GetWriteBarrierCount() const
+	{
+		return WriteBarrierCount.load(std::memory_order_relaxed);
+	}
+
+	// 句柄为 m_GCHandles 中的序号加 1，0 不是有效的句柄
+	std::uint32_t Runtime::NewGCHandle(Il2CppObject* object)
+	{
+		std::unique_lock lock(m_Mutex);
+		++m_LiveGCHandleCount;
+		if (!m_FreeGCHandles.empty())
+		{
+			const auto handle = m_FreeGCHandles.back();
+			m_FreeGCHandles.pop_back();
+			m_GCHandles[handle - 1] = object;
+			return handle;
+		}
+		m_GCHandles.push_back(object);
+		return static_cast<std::uint32_t>(m_GCHandles.size());
+	}
+
+	Il2CppObject* Runtime::GetGCHandleTarget(std::uint32_t handle) const
+	{
+		std::unique_lock lock(m_Mutex);
+		return handle && handle <= m_GCHandles.size() ? m_GCHandles[handle - 1] : nullptr;
+	}
+
+	void Runtime::FreeGCHandle(std::uint32_t handle)
+	{
+		std::unique_lock lock(m_Mutex);
+		if (handle && handle <= m_GCHandles.size() && m_GCHandles[handle - 1])
+		{
+			m_GCHandles[handle - 1] = nullptr;
+			m_FreeGCHandles.push_back(handle);
+			--m_LiveGCHandleCount;
+		}
+	}
+
+	std::u16string_view ToStringView(const Il2CppString* str)
+	{
+		return str ? std::u16string_view(str->chars, static_cast<std::size_t>(str->length))
+		           : std::u16string_view();
+	}
+
+	Il2CppObject* GetObjectField(Il2CppObject* object, Field const* field)
+	{
+		return *reinterpret_cast<Il2CppObject**>(reinterpret_cast<std::byte*>(object) +
+		                                         field->Info.offset);
+	}
+
+	void SetObjectField(Il2CppObject* object, Field const* field, Il2CppObject* value)
+	{
+		*reinterpret_cast<Il2CppObject**>(reinterpret_cast<std::byte*>(object) +
+		                                  field->Info.offset) = value;
+	}
+
+	std::u16string_view GetStringField(Il2CppObject* object, Field const* field)
+	{
+		return ToStringView(reinterpret_cast<Il2CppString*>(GetObjectField(object, field)));
+	}
+
+	std::vector<Il2CppObject*> GetItems(Il2CppObject* list)
+	{
+		auto& runtime = Runtime::GetInstance();
+		auto array = reinterpret_cast<Il2CppArray*>(list);
+		std::size_t size = array->max_length;
+		if (list->klass == runtime.GetListClass())
+		{
+			array = reinterpret_cast<Il2CppArray*>(
+			    GetObjectField(list, runtime.GetListClass()->FindField("_items")));
+			size = static_cast<std::size_t>(List_get_Count(list));
+		}
+		return std::vector<Il2CppObject*>(GetElements(array), GetElements(array) + size);
+	}
+
+	Game& Game::GetInstance()
+	{
+		static Game s_Instance;
+		return s_Instance;
+	}
+
+	Game::Game()
+	{
+		auto& runtime = Runtime::GetInstance();
+
+		const auto umamusume = runtime.AddImage("umamusume.dll");
+
+		const auto localizeClass = runtime.AddClass(umamusume, "Gallop", "Localize");
+		const auto localizeJPClass = runtime.AddNestedClass(localizeClass, "JP");
+		localizeJPClass->AddMethod("Get", 1, ToMethodPointer(&LocalizeJP_Get));
+
+		StoryTimelineDataClass = runtime.AddClass(umamusume, "Gallop", "StoryTimelineData");
+		StoryTimelineDataClass->AddField("StoryId");
+		StoryTimelineDataClass->AddField("Title");
+		StoryTimelineDataClass->AddField("BlockList");
+
+		StoryTimelineTextClipDataClass =
+		    runtime.AddClass(umamusume, "Gallop", "StoryTimelineTextClipData");
+		StoryTimelineTextClipDataClass->AddField("Name");
+		StoryTimelineTextClipDataClass->AddField("Text");
+		StoryTimelineTextClipDataClass->AddField("ChoiceDataList");
+		StoryTimelineTextClipDataClass->AddField("ColorTextInfoList");
+		ChoiceDataClass = runtime.AddNestedClass(StoryTimelineTextClipDataClass, "ChoiceData");
+		ChoiceDataClass->AddField("Text");
+		ColorTextInfoClass =
+		    runtime.AddNestedClass(StoryTimelineTextClipDataClass, "ColorTextInfo");
+		ColorTextInfoClass->AddField("Text");
+
+		StoryTimelineBlockDataClass =
+		    runtime.AddClass(umamusume, "Gallop", "StoryTimelineBlockData");
+		StoryTimelineBlockDataClass->AddField("TextTrack");
+
+		StoryTimelineTextTrackDataClass =
+		    runtime.AddClass(umamusume, "Gallop", "StoryTimelineTextTrackData");
+		StoryTimelineTextTrackDataClass->AddField("ClipList");
+
+		StoryTimelineClipDataClass = runtime.AddClass(umamusume, "Gallop", "StoryTimelineClipData");
+
+		StoryRaceTextAssetClass = runtime.AddClass(umamusume, "Gallop", "StoryRaceTextAsset");
+		StoryRaceTextAssetClass->AddField("textData");
+		KeyClass = runtime.AddNestedClass(StoryRaceTextAssetClass, "Key");
+		KeyClass->AddField("text");
+
+		TextCommonClass = runtime.AddClass(umamusume, "Gallop", "TextCommon");
+		TextCommonClass->InstanceSize += sizeof(TextState);
+		TextCommonClass->AddMethod("Awake", 0, ToMethodPointer(&TextCommon_Awake));
+
+		const auto libNative = runtime.AddImage("LibNative.Runtime.dll");
+		QueryClass = runtime.AddClass(libNative, "LibNative.Sqlite3", "Query");
+		QueryClass->InstanceSize += sizeof(QueryState);
+		QueryClass->AddMethod(".ctor", 2, ToMethodPointer(&Query_ctor));
+		QueryClass->AddMethod("GetInt", 1, ToMethodPointer(&Query_GetInt));
+		QueryClass->AddMethod("GetText", 1, ToMethodPointer(&Query_GetText));
+		QueryClass->AddMethod("Step", 0, ToMethodPointer(&Query_Step));
+		QueryClass->AddMethod("Dispose", 0, ToMethodPointer(&Query_Dispose));
+		const auto preparedQueryClass =
+		    runtime.AddClass(libNative, "LibNative.Sqlite3", "PreparedQuery");
+		preparedQueryClass->AddMethod("BindInt", 2, ToMethodPointer(&PreparedQuery_BindInt));
+
+		const auto assetBundleModule = runtime.AddImage("UnityEngine.AssetBundleModule.dll");
+		m_AssetBundleClass = runtime.AddClass(assetBundleModule, "UnityEngine", "AssetBundle");
+		m_AssetBundleClass->AddMethod("LoadAsset", 2, ToMethodPointer(&AssetBundle_LoadAsset));
+		m_AssetBundleClass->AddMethod("LoadFromFile", 1,
+		                              ToMethodPointer(&AssetBundle_LoadFromFile));
+		m_AssetBundleClass->AddMethod("GetAllAssetNames", 0,
+		                              ToMethodPointer(&AssetBundle_GetAllAssetNames));
+
+		const auto coreModule = runtime.AddImage("UnityEngine.CoreModule.dll");
+		const auto objectClass = runtime.AddClass(coreModule, "UnityEngine", "Object");
+		objectClass->AddMethod("IsNativeObjectAlive", 1,
+		                       ToMethodPointer(&Object_IsNativeObjectAlive));
+		const auto applicationClass = runtime.AddClass(coreModule, "UnityEngine", "Application");
+		applicationClass->AddMethod("set_targetFrameRate", 1,
+		                            ToMethodPointer(&Application_set_targetFrameRate));
+
+		const auto ui = runtime.AddImage("UnityEngine.UI.dll");
+		const auto textClass = runtime.AddClass(ui, "UnityEngine.UI", "Text");
+		textClass->AddMethod("set_font", 1, ToMethodPointer(&Text_set_font));
+		textClass->AddMethod("AssignDefaultFont", 0, ToMethodPointer(&Text_AssignDefaultFont));
+		textClass->AddMethod("set_horizontalOverflow", 1,
+		                     ToMethodPointer(&Text_set_horizontalOverflow));
+		textClass->AddMethod("set_verticalOverflow", 1,
+		                     ToMethodPointer(&Text_set_verticalOverflow));
+		textClass->AddMethod("set_fontStyle", 1, ToMethodPointer(&Text_set_fontStyle));
+		textClass->AddMethod("set_lineSpacing", 1, ToMethodPointer(&Text_set_lineSpacing));
+
+		const auto textRenderingModule = runtime.AddImage("UnityEngine.TextRenderingModule.dll");
+		FontClass = runtime.AddClass(textRenderingModule, "UnityEngine", "Font");
+	}
+
+	void Game::SetStaticSources(std::vector<std::u16string> sources)
+	{
+		std::vector<Il2CppString*> strings;
+		for (const auto& source : sources)
+		{
+			strings.push_back(source.empty() ? nullptr : Runtime::GetInstance().NewString(source));
+		}
+		std::unique_lock lock(m_Mutex);
+		m_StaticSources = std::move(strings);
+	}
+
+	Il2CppObject* Game::AddAssetBundle(std::string path)
+	{
+		const auto object = Runtime::GetInstance().NewObject(m_AssetBundleClass);
+		std::unique_lock lock(m_Mutex);
+		auto& assetBundle = m_AssetBundles.emplace_back();
+		assetBundle.Path = std::move(path);
+		m_AssetBundleObjects.emplace(object, &assetBundle);
+		return object;
+	}
+
+	void Game::AddAsset(Il2CppObject* assetBundle, std::u16string name, Il2CppObject* asset)
+	{
+		std::unique_lock lock(m_Mutex);
+		m_AssetBundleObjects.at(assetBundle)->Assets.insert_or_assign(std::move(name), asset);
+	}
+
+	Il2CppObject* Game::NewStoryTimelineData(std::u16string_view storyId,
+	                                         std::u16string_view title,
+	                                         std::span<const StoryBlock> blocks)
+	{
+		auto& runtime = Runtime::GetInstance();
+		const auto newText = [&](Class* klass, std::u16string_view text) {
+			const auto object = runtime.NewObject(klass);
+			SetObjectField(object, klass->FindField("Text"),
+			               reinterpret_cast<Il2CppObject*>(runtime.NewString(text)));
+			return object;
+		};
+
+		std::vector<Il2CppObject*> blockObjects;
+		for (const auto& block : blocks)
+		{
+			const auto clip = runtime.NewObject(StoryTimelineTextClipDataClass);
+			SetObjectField(clip, StoryTimelineTextClipDataClass->FindField("Name"),
+			               reinterpret_cast<Il2CppObject*>(runtime.NewString(block.Name)));
+			SetObjectField(clip, StoryTimelineTextClipDataClass->FindField("Text"),
+			               reinterpret_cast<Il2CppObject*>(runtime.NewString(block.Text)));
+
+			std::vector<Il2CppObject*> choices;
+			for (const auto& choice : block.ChoiceDataList)
+			{
+				choices.push_back(newText(ChoiceDataClass, choice));
+			}
+			SetObjectField(clip, StoryTimelineTextClipDataClass->FindField("ChoiceDataList"),
+			               runtime.NewList(choices));
+
+			std::vector<Il2CppObject*> colorTexts;
+			for (const auto& colorText : block.ColorTextInfoList)
+			{
+				colorTexts.push_back(newText(ColorTextInfoClass, colorText));
+			}
+			SetObjectField(clip, StoryTimelineTextClipDataClass->FindField("ColorTextInfoList"),
+			               runtime.NewList(colorTexts));
+
+			const auto textTrack = runtime.NewObject(StoryTimelineTextTrackDataClass);
+			SetObjectField(textTrack, StoryTimelineTextTrackDataClass->FindField("ClipList"),
+			               runtime.NewList(std::span(&clip, 1)));
+
+			const auto blockObject = runtime.NewObject(StoryTimelineBlockDataClass);
+			SetObjectField(blockObject, StoryTimelineBlockDataClass->FindField("TextTrack"),
+			               textTrack);
+			blockObjects.push_back(blockObject);
+		}
+
+		const auto timeline = runtime.NewObject(StoryTimelineDataClass);
+		SetObjectField(timeline, StoryTimelineDataClass->FindField("StoryId"),
+		               reinterpret_cast<Il2CppObject*>(runtime.NewString(storyId)));
+		SetObjectField(timeline, StoryTimelineDataClass->FindField("Title"),
+		               reinterpret_cast<Il2CppObject*>(runtime.NewString(title)));
+		SetObjectField(timeline, StoryTimelineDataClass->FindField("BlockList"),
+		               runtime.NewList(blockObjects));
+		return timeline;
+	}
+
+	Il2CppObject* Game::NewStoryRaceTextAsset(std::span<const std::u16string> texts)
+	{
+		auto& runtime = Runtime::GetInstance();
+		std::vector<Il2CppObject*> keys;
+		for (const auto& text : texts)
+		{
+			const auto key = runtime.NewObject(KeyClass);
+			SetObjectField(key, KeyClass->FindField("text"),
+			               reinterpret_cast<Il2CppObject*>(runtime.NewString(text)));
+			keys.push_back(key);
+		}
+
+		const auto asset = runtime.NewObject(StoryRaceTextAssetClass);
+		SetObjectField(asset, StoryRaceTextAssetClass->FindField("textData"),
+		               runtime.NewList(keys));
+		return asset;
+	}
+
+	Il2CppObject* Game::NewQuery()
+	{
+		const auto query = Runtime::GetInstance().NewObject(QueryClass);
+		GetState<QueryState>(query).RowCount = 1;
+		return query;
+	}
+
+	Il2CppObject* Game::NewText()
+	{
+		return Runtime::GetInstance().NewObject(TextCommonClass);
+	}
+
+	Il2CppObject* Game::NewFont()
+	{
+		return Runtime::GetInstance().NewObject(FontClass);
+	}
+
+	void Game::SetQueryInt(Il2CppObject* query, std::int32_t idx, std::int32_t value)
+	{
+		GetState<QueryState>(query).Ints[idx] = value;
+	}
+
+	std::int32_t Game::GetQueryBoundInt(Il2CppObject* query, std::int32_t idx)
+	{
+		return GetState<QueryState>(query).BoundInts[idx];
+	}
+
+	std::u16string_view Game::GetOriginalQueryText()
+	{
+		return u"original text";
+	}
+
+	Game::TextState const& Game::GetTextState(Il2CppObject* text)
+	{
+		return GetState<TextState>(text);
+	}
+
+	std::int32_t Game::GetTargetFrameRate() const
+	{
+		return m_TargetFrameRate.load();
+	}
+
+	std::vector<std::thread::id> Game::GetLocalizeJP_GetThreads() const
+	{
+		std::unique_lock lock(m_Mutex);
+		return std::vector<std::thread::id>(m_LocalizeJP_GetThreads.begin(),
+		                                    m_LocalizeJP_GetThreads.end());
+	}
+
+	Il2CppString* Game::LocalizeJP_Get(std::int32_t id)
+	{
+		auto& game = GetInstance();
+		std::unique_lock lock(game.m_Mutex);
+		game.m_LocalizeJP_GetThreads.insert(std::this_thread::get_id());
+		if (id < 0 || static_cast<std::size_t>(id) >= game.m_StaticSources.size())
+		{
+			return nullptr;
+		}
+		return game.m_StaticSources[id];
+	}
+
+	Il2CppObject* Game::AssetBundle_LoadAsset(Il2CppObject* self, Il2CppString* name,
+	                                          Il2CppReflectionType*)
+	{
+		auto& game = GetInstance();
+		std::unique_lock lock(game.m_Mutex);
+		const auto assetBundle = game.m_AssetBundleObjects.find(self);
+		if (assetBundle == game.m_AssetBundleObjects.end())
+		{
+			return nullptr;
+		}
+		const auto& assets = assetBundle->second->Assets;
+		const auto asset = assets.find(std::u16string(ToStringView(name)));
+		return asset != assets.end() ? asset->second : nullptr;
+	}
+
+	Il2CppObject* Game::AssetBundle_LoadFromFile(Il2CppString* path)
+	{
+		auto& game = GetInstance();
+		const auto pathString = Misc::ToUTF8(ToStringView(path));
+		std::unique_lock lock(game.m_Mutex);
+		for (const auto& [object, assetBundle] : game.m_AssetBundleObjects)
+		{
+			if (assetBundle->Path == pathString)
+			{
+				return object;
+			}
+		}
+		return nullptr;
+	}
+
+	Il2CppObject* Game::AssetBundle_GetAllAssetNames(Il2CppObject* self)
+	{
+		auto& game = GetInstance();
+		auto& runtime = Runtime::GetInstance();
+		std::vector<Il2CppObject*> names;
+		{
+			std::unique_lock lock(game.m_Mutex);
+			for (const auto& [name, asset] : game.m_AssetBundleObjects.at(self)->Assets)
+			{
+				names.push_back(reinterpret_cast<Il2CppObject*>(runtime.NewString(name)));
+			}
+		}
+		return reinterpret_cast<Il2CppObject*>(runtime.NewArray(names));
+	}
+
+	// 测试可能复用同一对象执行多次查询，构造时重置除整数列以外的状态
+	void* Game::Query_ctor(void* self, void*, Il2CppString* sql)
+	{
+		auto& state = GetState<QueryState>(self);
+		state.Sql = sql;
+		std::fill(std::begin(state.BoundInts), std::end(state.BoundInts), 0);
+		state.StepCount = 0;
+		state.Disposed = false;
+		return self;
+	}
+
+	void Game::PreparedQuery_BindInt(void* self, std::int32_t idx, std::int32_t value)
+	{
+		GetState<QueryState>(self).BoundInts[idx] = value;
+	}
+
+	bool Game::Query_Step(void* self)
+	{
+		auto& state = GetState<QueryState>(self);
+		return state.StepCount++ < state.RowCount;
+	}
+
+	int Game::Query_GetInt(void* self, int idx)
+	{
+		return GetState<QueryState>(self).Ints[idx];
+	}
+
+	Il2CppString* Game::Query_GetText(void*, std::int32_t)
+	{
+		static const auto original = Runtime::GetInstance().NewString(GetOriginalQueryText());
+		return original;
+	}
+
+	void Game::Query_Dispose(void* self)
+	{
+		GetState<QueryState>(self).Disposed = true;
+	}
+
+	void Game::TextCommon_Awake(Il2CppObject*)
+	{
+	}
+
+	void Game::Application_set_targetFrameRate(int value)
+	{
+		GetInstance().m_TargetFrameRate.store(value);
+	}
+
+	void RecordingHookInstaller::InstallHook(OpaqueFunctionPointer addr,
+	                                         OpaqueFunctionPointer hook,
+	                                         OpaqueFunctionPointer* orig)
+	{
+		std::unique_lock lock(m_Mutex);
+		m_Hooks.insert_or_assign(addr, hook);
+		*orig = addr;
+	}
+
+	OpaqueFunctionPointer RecordingHookInstaller::LookupSymbol(const char* name)
+	{
+		return Runtime::GetInstance().LookupSymbol(name);
+	}
+
+	bool RecordingHookInstaller::IsHooked(OpaqueFunctionPointer function) const
+	{
+		std::unique_lock lock(m_Mutex);
+		return m_Hooks.contains(function);
+	}
+
+	std::size_t RecordingHookInstaller::GetHookCount() const
+	{
+		std::unique_lock lock(m_Mutex);
+		return m_Hooks.size();
+	}
+
+	OpaqueFunctionPointer
+	RecordingHookInstaller::ResolveOpaque(OpaqueFunctionPointer function) const
+	{
+		std::unique_lock lock(m_Mutex);
+		const auto iter = m_Hooks.find(function);
+		return iter != m_Hooks.end() ? iter->second : function;
+	}
+
+	RecordingHookInstaller& InstallPlugin(Config config)
+	{
+		// 先注册游戏的类，InjectFunctions 才能找到它们
+		Game::GetInstance();
+
+		auto installer = std::make_unique<RecordingHookInstaller>();
+		auto& result = *installer;
+		auto& plugin = Plugin::GetInstance();
+		plugin.LoadConfig(std::move(config));
+		plugin.InstallHook(std::move(installer));
+		return result;
+	}
+
+	int InitIl2Cpp(RecordingHookInstaller& installer)
+	{
+		using il2cpp_init_Type = int (*)(const char* domainName);
+		const auto il2cpp_init =
+		    reinterpret_cast<il2cpp_init_Type>(Runtime::GetInstance().LookupSymbol("il2cpp_init"));
+		return installer.Resolve(il2cpp_init)("IL2CPP Root Domain");
+	}
+} // namespace UmaPyogin::Fake
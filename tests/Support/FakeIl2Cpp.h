@@ -0,0 +1,288 @@
+#ifndef UMAPYOGIN_TESTS_FAKE_IL2CPP_H
+#define UMAPYOGIN_TESTS_FAKE_IL2CPP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "UmaPyogin/Il2Cpp.h"
+#include "UmaPyogin/Plugin.h"
+
+// 进程内模拟的 il2cpp 运行时，提供插件通过 HookInstaller::LookupSymbol 取得的全部函数，
+// 以及 InjectFunctions 需要的程序集、类、字段与方法，使 Hook.cpp 可在主机上完整运行
+// 对象在进程退出前不会释放，不模拟垃圾回收
+namespace UmaPyogin::Fake
+{
+	struct Class;
+
+	enum class FieldType
+	{
+		Object,
+		Int32,
+	};
+
+	struct Field
+	{
+		// 需为首个成员，插件取得的 FieldInfo* 即指向此处
+		FieldInfo Info;
+		FieldType Type;
+		std::string Name;
+	};
+
+	struct Method
+	{
+		// 需为首个成员，插件取得的 MethodInfo* 即指向此处
+		MethodInfo Info;
+		std::string Name;
+		int ParamCount;
+	};
+
+	struct Image
+	{
+		std::string Name;
+		Il2CppAssembly Assembly;
+		std::vector<Class*> Classes;
+	};
+
+	// 以 Il2CppClassHead 开头，插件会直接读取其中的类名与命名空间
+	struct Class
+	{
+		Il2CppClassHead Head;
+		std::string Namespace;
+		std::string Name;
+		std::vector<std::unique_ptr<Field>> Fields;
+		std::vector<std::unique_ptr<Method>> Methods;
+		std::vector<Class*> NestedTypes;
+		// il2cpp_class_is_assignable_from 仅检查类本身及此处列出的接口
+		std::vector<Class*> Interfaces;
+		std::size_t InstanceSize = sizeof(Il2CppObject);
+		// 数组类的元素大小，其他类为 0
+		int ElementSize{};
+		// il2cpp_class_get_type 返回此成员的地址，il2cpp_type_get_object 借此找到类
+		Class* TypeHandle{ this };
+		Il2CppReflectionType* TypeObject{};
+
+		// 字段依次排列在对象头之后，每个占 8 字节
+		Field* AddField(std::string name, FieldType type = FieldType::Object);
+		Method* AddMethod(std::string name, int paramCount, Il2CppMethodPointer pointer);
+		Field* FindField(std::string_view name) const;
+
+		Il2CppClass* AsIl2CppClass();
+	};
+
+	class Runtime
+	{
+	public:
+		static Runtime& GetInstance();
+
+		// 返回 il2cpp_init 或 Il2CppSymbols 中的函数，未知或已隐藏的名称返回 nullptr
+		OpaqueFunctionPointer LookupSymbol(std::string_view name) const;
+		// 使 LookupSymbol 对 name 返回 nullptr，用于模拟缺少符号的运行时
+		void HideSymbol(std::string name);
+		void ClearHiddenSymbols();
+
+		Image* AddImage(std::string name);
+		Image* FindImage(std::string_view name) const;
+		Image* GetCorlib() const;
+		Class* AddClass(Image* image, std::string namespaze, std::string name);
+		Class* AddNestedClass(Class* declaringClass, std::string name);
+
+		Il2CppObject* NewObject(Class* klass);
+		Il2CppString* NewString(std::u16string_view str);
+		Il2CppArray* NewArray(std::span<Il2CppObject* const> items);
+		// 元素为引用类型的 System.Collections.Generic.List<T>
+		Il2CppObject* NewList(std::span<Il2CppObject* const> items);
+
+		Class* GetIListClass() const;
+		Class* GetListClass() const;
+		Class* GetArrayClass() const;
+
+		bool IsInitialized() const;
+		std::size_t GetAllocatedStringCount() const;
+		std::size_t GetLiveGCHandleCount() const;
+		std::size_t GetWriteBarrierCount() const;
+
+		Runtime(Runtime const&) = delete;
+		Runtime& operator=(Runtime const&) = delete;
+
+		// 以下成员供模拟的 il2cpp 函数使用
+		std::atomic<bool> Initialized{};
+		std::atomic<std::size_t> AllocatedStringCount{};
+		std::atomic<std::size_t> WriteBarrierCount{};
+
+		std::byte* Allocate(std::size_t size);
+
+		std::uint32_t NewGCHandle(Il2CppObject* object);
+		Il2CppObject* GetGCHandleTarget(std::uint32_t handle) const;
+		void FreeGCHandle(std::uint32_t handle);
+
+	private:
+		Runtime();
+
+		mutable std::mutex m_Mutex;
+		std::deque<std::unique_ptr<std::byte[]>> m_Allocations;
+		std::vector<Il2CppObject*> m_GCHandles;
+		std::vector<std::uint32_t> m_FreeGCHandles;
+		std::size_t m_LiveGCHandleCount{};
+
+		std::deque<Image> m_Images;
+		std::deque<Class> m_Classes;
+		std::vector<std::string> m_HiddenSymbols;
+
+		Class* m_IListClass;
+		Class* m_ListClass;
+		Class* m_ArrayClass;
+	};
+
+	std::u16string_view ToStringView(const Il2CppString* str);
+
+	Il2CppObject* GetObjectField(Il2CppObject* object, Field const* field);
+	void SetObjectField(Il2CppObject* object, Field const* field, Il2CppObject* value);
+	std::u16string_view GetStringField(Il2CppObject* object, Field const* field);
+
+	// 返回 List<T> 或数组中的元素
+	std::vector<Il2CppObject*> GetItems(Il2CppObject* list);
+
+	struct StoryBlock
+	{
+		std::u16string Name;
+		std::u16string Text;
+		std::vector<std::u16string> ChoiceDataList;
+		std::vector<std::u16string> ColorTextInfoList;
+	};
+
+	// 模拟游戏中被插件挂钩或调用的部分，即 InjectFunctions 查找的全部类与方法
+	// 静态成员函数即为游戏中对应方法的原始实现，测试通过 RecordingHookInstaller::Resolve
+	// 取得游戏实际调用的函数
+	class Game
+	{
+	public:
+		static Game& GetInstance();
+
+		// LocalizeJP_Get 返回的原文，下标为 id，空字符串表示该 id 不存在
+		void SetStaticSources(std::vector<std::u16string> sources);
+
+		// 创建资源包，AssetBundle.LoadFromFile(path) 将返回它
+		Il2CppObject* AddAssetBundle(std::string path);
+		void AddAsset(Il2CppObject* assetBundle, std::u16string name, Il2CppObject* asset);
+
+		Il2CppObject* NewStoryTimelineData(std::u16string_view storyId, std::u16string_view title,
+		                                   std::span<const StoryBlock> blocks);
+		Il2CppObject* NewStoryRaceTextAsset(std::span<const std::u16string> texts);
+		Il2CppObject* NewQuery();
+		Il2CppObject* NewText();
+		Il2CppObject* NewFont();
+
+		// 设置 Query.GetInt 对该列返回的值
+		static void SetQueryInt(Il2CppObject* query, std::int32_t idx, std::int32_t value);
+		static std::int32_t GetQueryBoundInt(Il2CppObject* query, std::int32_t idx);
+		// Query.GetText 在未被替换时返回的文本
+		static std::u16string_view GetOriginalQueryText();
+
+		struct TextState
+		{
+			Il2CppObject* Font;
+			bool DefaultFontAssigned;
+			std::int32_t HorizontalOverflow;
+			std::int32_t VerticalOverflow;
+			std::int32_t FontStyle;
+			float LineSpacing;
+		};
+
+		static TextState const& GetTextState(Il2CppObject* text);
+
+		std::int32_t GetTargetFrameRate() const;
+		// 调用过 LocalizeJP_Get 原函数的线程
+		std::vector<std::thread::id> GetLocalizeJP_GetThreads() const;
+
+		static Il2CppString* LocalizeJP_Get(std::int32_t id);
+		static Il2CppObject* AssetBundle_LoadAsset(Il2CppObject* self, Il2CppString* name,
+		                                           Il2CppReflectionType* type);
+		static Il2CppObject* AssetBundle_LoadFromFile(Il2CppString* path);
+		static Il2CppObject* AssetBundle_GetAllAssetNames(Il2CppObject* self);
+		static void* Query_ctor(void* self, void* conn, Il2CppString* sql);
+		static void PreparedQuery_BindInt(void* self, std::int32_t idx, std::int32_t value);
+		static bool Query_Step(void* self);
+		static int Query_GetInt(void* self, int idx);
+		static Il2CppString* Query_GetText(void* self, std::int32_t idx);
+		static void Query_Dispose(void* self);
+		static void TextCommon_Awake(Il2CppObject* self);
+		static void Application_set_targetFrameRate(int value);
+
+		Class* StoryTimelineDataClass;
+		Class* StoryTimelineBlockDataClass;
+		Class* StoryTimelineTextTrackDataClass;
+		Class* StoryTimelineClipDataClass;
+		Class* StoryTimelineTextClipDataClass;
+		Class* ChoiceDataClass;
+		Class* ColorTextInfoClass;
+		Class* StoryRaceTextAssetClass;
+		Class* KeyClass;
+		Class* QueryClass;
+		Class* TextCommonClass;
+		Class* FontClass;
+
+		Game(Game const&) = delete;
+		Game& operator=(Game const&) = delete;
+
+	private:
+		Game();
+
+		struct AssetBundle
+		{
+			std::string Path;
+			std::unordered_map<std::u16string, Il2CppObject*> Assets;
+		};
+
+		mutable std::mutex m_Mutex;
+		std::vector<Il2CppString*> m_StaticSources;
+		std::unordered_set<std::thread::id> m_LocalizeJP_GetThreads;
+		std::deque<AssetBundle> m_AssetBundles;
+		std::unordered_map<Il2CppObject*, AssetBundle*> m_AssetBundleObjects;
+		Class* m_AssetBundleClass;
+		std::atomic<std::int32_t> m_TargetFrameRate{};
+	};
+
+	// 仅记录安装的钩子，调用原函数时直接调用被挂钩的函数本身
+	class RecordingHookInstaller : public HookInstaller
+	{
+	public:
+		void InstallHook(OpaqueFunctionPointer addr, OpaqueFunctionPointer hook,
+		                 OpaqueFunctionPointer* orig) override;
+		OpaqueFunctionPointer LookupSymbol(const char* name) override;
+
+		// 游戏调用 function 时实际执行的函数，已挂钩时为钩子，否则为 function 本身
+		template <typename Function>
+		Function Resolve(Function function) const
+		{
+			return reinterpret_cast<Function>(
+			    ResolveOpaque(reinterpret_cast<OpaqueFunctionPointer>(function)));
+		}
+
+		bool IsHooked(OpaqueFunctionPointer function) const;
+		std::size_t GetHookCount() const;
+
+	private:
+		OpaqueFunctionPointer ResolveOpaque(OpaqueFunctionPointer function) const;
+
+		mutable std::mutex m_Mutex;
+		std::unordered_map<OpaqueFunctionPointer, OpaqueFunctionPointer> m_Hooks;
+	};
+
+	// 加载配置并以新的 RecordingHookInstaller 调用 Plugin::InstallHook，返回的安装器在下次调用前有效
+	RecordingHookInstaller& InstallPlugin(Config config);
+	// 以 InstallPlugin 安装后模拟游戏调用 il2cpp_init
+	int InitIl2Cpp(RecordingHookInstaller& installer);
+} // namespace UmaPyogin::Fake
+
+#endif
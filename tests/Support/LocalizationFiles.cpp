@@ -0,0 +1,273 @@
+#include "LocalizationFiles.h"
+
+#include <fstream>
+#include <stdexcept>
+
+#include "UmaPyogin/Misc.h"
+
+namespace UmaPyogin::Test
+{
+	TemporaryDirectory::TemporaryDirectory()
+	{
+		std::random_device device;
+		const auto base = std::filesystem::temp_directory_path();
+		for (int i = 0; i < 16; ++i)
+		{
+			auto path = base / ("UmaPyoginTest-" + std::to_string(device()));
+			if (std::filesystem::create_directory(path))
+			{
+				m_Path = std::move(path);
+				return;
+			}
+		}
+		throw std::runtime_error("Failed to create temporary directory");
+	}
+
+	TemporaryDirectory::~TemporaryDirectory()
+	{
+		std::error_code ec;
+		std::filesystem::remove_all(m_Path, ec);
+	}
+
+	std::filesystem::path const& TemporaryDirectory::GetPath() const
+	{
+		return m_Path;
+	}
+
+	void WriteFile(std::filesystem::path const& path, std::string_view content)
+	{
+		std::filesystem::create_directories(path.parent_path());
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(content.data(), static_cast<std::streamsize>(content.size()));
+		if (!file)
+		{
+			throw std::runtime_error("Failed to write " + path.string());
+		}
+	}
+
+	std::size_t GetPageSize(std::filesystem::path const& dir)
+	{
+		const auto path = dir / "page";
+		WriteFile(path, "x");
+		std::size_t pageSize;
+		{
+			const Misc::MappedFile file(path);
+			if (!file.IsOpen())
+			{
+				throw std::runtime_error("Failed to map " + path.string());
+			}
+			pageSize = file.Size() + file.TailSize();
+		}
+		std::filesystem::remove(path);
+		return pageSize;
+	}
+
+	std::u16string Copy(std::optional<std::u16string_view> text)
+	{
+		return text ? std::u16string(*text) : u"<missing>";
+	}
+
+	std::string ToJsonString(std::u16string_view str)
+	{
+		std::string result = "\"";
+		for (const auto c : Misc::ToUTF8(str))
+		{
+			switch (c)
+			{
+			case '"':
+				result += "\\\"";
+				break;
+			case '\\':
+				result += "\\\\";
+				break;
+			case '\n':
+				result += "\\n";
+				break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20)
+				{
+					constexpr char Hex[] = "0123456789abcdef";
+					result += "\\u00";
+					result += Hex[c >> 4];
+					result += Hex[c & 0xF];
+				}
+				else
+				{
+					result += c;
+				}
+				break;
+			}
+		}
+		result += '"';
+		return result;
+	}
+
+	void WriteStaticLocalization(
+	    std::filesystem::path const& path,
+	    std::span<const std::pair<std::u16string, std::u16string>> entries)
+	{
+		std::string content = "{";
+		for (const auto& [source, translated] : entries)
+		{
+			if (content.size() > 1)
+			{
+				content += ',';
+			}
+			content += ToJsonString(source);
+			content += ':';
+			content += ToJsonString(translated);
+		}
+		content += '}';
+		WriteFile(path, content);
+	}
+
+	void WriteStoryTimeline(std::filesystem::path const& dir, std::uint64_t storyId,
+	                        std::u16string_view title, std::span<const Fake::StoryBlock> blocks)
+	{
+		const auto appendList = [](std::string& content, std::vector<std::u16string> const& list) {
+			content += '[';
+			for (std::size_t i = 0; i < list.size(); ++i)
+			{
+				if (i)
+				{
+					content += ',';
+				}
+				content += ToJsonString(list[i]);
+			}
+			content += ']';
+		};
+
+		std::string content = "{\"Title\":" + ToJsonString(title) + ",\"TextBlockList\":[";
+		for (std::size_t i = 0; i < blocks.size(); ++i)
+		{
+			const auto& block = blocks[i];
+			if (i)
+			{
+				content += ',';
+			}
+			if (block.Name.empty() && block.Text.empty())
+			{
+				content += "null";
+				continue;
+			}
+			content += "{\"Name\":" + ToJsonString(block.Name);
+			content += ",\"Text\":" + ToJsonString(block.Text);
+			content += ",\"ChoiceDataList\":";
+			appendList(content, block.ChoiceDataList);
+			content += ",\"ColorTextInfoList\":";
+			appendList(content, block.ColorTextInfoList);
+			content += '}';
+		}
+		content += "]}";
+		WriteFile(dir / ("storytimeline_" + std::to_string(storyId) + ".json"), content);
+	}
+
+	void WriteStoryRace(std::filesystem::path const& dir, std::uint64_t raceId,
+	                    std::span<const std::u16string> texts)
+	{
+		std::string content = "[";
+		for (std::size_t i = 0; i < texts.size(); ++i)
+		{
+			if (i)
+			{
+				content += ',';
+			}
+			content += ToJsonString(texts[i]);
+		}
+		content += ']';
+		WriteFile(dir / ("storyrace_" + std::to_string(raceId) + ".json"), content);
+	}
+
+	void WriteDictionary(std::filesystem::path const& path,
+	                     std::span<const DictionaryEntry> entries)
+	{
+		std::string content = "{";
+		for (const auto& entry : entries)
+		{
+			if (content.size() > 1)
+			{
+				content += ',';
+			}
+			content += '"' + std::to_string(entry.Key) + "\":" + ToJsonString(entry.Value);
+		}
+		content += '}';
+		WriteFile(path, content);
+	}
+
+	void WriteNestedDictionary(std::filesystem::path const& path,
+	                           std::span<const NestedDictionaryEntry> entries)
+	{
+		std::string content = "{";
+		for (std::size_t i = 0; i < entries.size(); ++i)
+		{
+			const auto& entry = entries[i];
+			const auto newKey = !i || entries[i - 1].Key != entry.Key;
+			if (newKey)
+			{
+				if (i)
+				{
+					content += "},";
+				}
+				content += '"' + std::to_string(entry.Key) + "\":{";
+			}
+			else
+			{
+				content += ',';
+			}
+			content += '"' + std::to_string(entry.SubKey) + "\":" + ToJsonString(entry.Value);
+		}
+		content += entries.empty() ? "}" : "}}";
+		WriteFile(path, content);
+	}
+
+	TextGenerator::TextGenerator(Script script, std::uint32_t seed)
+	    : m_Script(script), m_Engine(seed)
+	{
+	}
+
+	std::u16string TextGenerator::Next(std::size_t length)
+	{
+		// 日文约一半为假名，中文几乎全为汉字，两者均夹杂少量标点与 ASCII 字符
+		std::uniform_int_distribution<int> percent(0, 99);
+		std::uniform_int_distribution<int> hiragana(0x3041, 0x3093);
+		std::uniform_int_distribution<int> katakana(0x30A1, 0x30F3);
+		std::uniform_int_distribution<int> kanji(0x4E00, 0x9FA5);
+		std::uniform_int_distribution<int> ascii(0x41, 0x7A);
+		constexpr std::u16string_view JapanesePunctuation = u"、。「」！？…";
+		constexpr std::u16string_view ChinesePunctuation = u"，。“”！？…";
+
+		const auto& punctuation =
+		    m_Script == Script::Japanese ? JapanesePunctuation : ChinesePunctuation;
+		std::uniform_int_distribution<std::size_t> punctuationIndex(0, punctuation.size() - 1);
+
+		std::u16string result;
+		result.reserve(length);
+		for (std::size_t i = 0; i < length; ++i)
+		{
+			const auto value = percent(m_Engine);
+			char16_t c;
+			if (value < 3)
+			{
+				c = static_cast<char16_t>(ascii(m_Engine));
+			}
+			else if (value < 10)
+			{
+				c = punctuation[punctuationIndex(m_Engine)];
+			}
+			else if (m_Script == Script::Chinese || value < 50)
+			{
+				c = static_cast<char16_t>(kanji(m_Engine));
+			}
+			else if (value < 85)
+			{
+				c = static_cast<char16_t>(hiragana(m_Engine));
+			}
+			else
+			{
+				c = static_cast<char16_t>(katakana(m_Engine));
+			}
+			result += c;
+		}
+		return result;
+	}
+} // namespace UmaPyogin::Test
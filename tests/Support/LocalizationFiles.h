@@ -0,0 +1,98 @@
+#ifndef UMAPYOGIN_TESTS_LOCALIZATION_FILES_H
+#define UMAPYOGIN_TESTS_LOCALIZATION_FILES_H
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "FakeIl2Cpp.h"
+
+// 生成测试与性能测试使用的翻译文件，格式与插件读取的 JSON 文件相同
+namespace UmaPyogin::Test
+{
+	// 在系统临时目录下创建唯一的目录，析构时连同内容一并删除
+	class TemporaryDirectory
+	{
+	public:
+		TemporaryDirectory();
+		~TemporaryDirectory();
+
+		std::filesystem::path const& GetPath() const;
+
+		TemporaryDirectory(TemporaryDirectory const&) = delete;
+		TemporaryDirectory& operator=(TemporaryDirectory const&) = delete;
+
+	private:
+		std::filesystem::path m_Path;
+	};
+
+	void WriteFile(std::filesystem::path const& path, std::string_view content);
+
+	// 映射 dir 下的临时文件，取得 Misc::MappedFile 映射的页大小
+	std::size_t GetPageSize(std::filesystem::path const& dir);
+
+	// 复制查找到的译文以便比较，找不到时返回 u"<missing>"
+	std::u16string Copy(std::optional<std::u16string_view> text);
+
+	// 转换为 UTF-8 并加上引号，转义引号、反斜杠与控制字符
+	std::string ToJsonString(std::u16string_view str);
+
+	// {"原文":"译文"}
+	void WriteStaticLocalization(
+	    std::filesystem::path const& path,
+	    std::span<const std::pair<std::u16string, std::u16string>> entries);
+
+	// 写入 dir/storytimeline_<storyId>.json，Name 与 Text 均为空的块写为 null
+	void WriteStoryTimeline(std::filesystem::path const& dir, std::uint64_t storyId,
+	                        std::u16string_view title, std::span<const Fake::StoryBlock> blocks);
+	// 写入 dir/storyrace_<raceId>.json
+	void WriteStoryRace(std::filesystem::path const& dir, std::uint64_t raceId,
+	                    std::span<const std::u16string> texts);
+
+	struct DictionaryEntry
+	{
+		std::uint64_t Key;
+		std::u16string Value;
+	};
+
+	struct NestedDictionaryEntry
+	{
+		std::uint64_t Key;
+		std::uint64_t SubKey;
+		std::u16string Value;
+	};
+
+	// {"key":"value"}，用于 race_jikkyo_comment 与 race_jikkyo_message
+	void WriteDictionary(std::filesystem::path const& path,
+	                     std::span<const DictionaryEntry> entries);
+	// {"key":{"subKey":"value"}}，用于 text_data 与 character_system_text，相同的 Key 需相邻
+	void WriteNestedDictionary(std::filesystem::path const& path,
+	                           std::span<const NestedDictionaryEntry> entries);
+
+	enum class Script
+	{
+		Japanese,
+		Chinese,
+	};
+
+	// 以固定的种子生成由对应文字的常用字符组成的文本，用于得到可重复的测试数据
+	class TextGenerator
+	{
+	public:
+		explicit TextGenerator(Script script, std::uint32_t seed = 1);
+
+		std::u16string Next(std::size_t length);
+
+	private:
+		Script m_Script;
+		std::mt19937 m_Engine;
+	};
+} // namespace UmaPyogin::Test
+
+#endif
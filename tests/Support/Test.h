@@ -0,0 +1,43 @@
+#ifndef UMAPYOGIN_TESTS_TEST_H
+#define UMAPYOGIN_TESTS_TEST_H
+
+// 最小的测试框架，每个测试文件编译为一个可执行文件并注册为一个 CTest 测试
+// TEST 定义的用例按定义顺序在同一进程中执行，命令行参数可指定只运行名称中含有该子串的用例
+// CHECK 失败时记录并继续执行，REQUIRE 失败时结束当前用例
+namespace UmaPyogin::Test
+{
+	using TestFunction = void (*)();
+
+	struct Registrar
+	{
+		Registrar(const char* name, TestFunction function);
+	};
+
+	// REQUIRE 失败时抛出，由 main 捕获
+	struct RequireFailure
+	{
+	};
+
+	void ReportFailure(const char* file, int line, const char* expression);
+} // namespace UmaPyogin::Test
+
+#define TEST(name)                                                                                 \
+	static void name();                                                                            \
+	static const ::UmaPyogin::Test::Registrar name##_Registrar(#name, &name);                      \
+	static void name()
+
+#define CHECK(expr)                                                                                \
+	((expr) ? static_cast<void>(0)                                                                 \
+	        : ::UmaPyogin::Test::ReportFailure(__FILE__, __LINE__, #expr))
+
+#define REQUIRE(expr)                                                                              \
+	do                                                                                             \
+	{                                                                                              \
+		if (!(expr))                                                                               \
+		{                                                                                          \
+			::UmaPyogin::Test::ReportFailure(__FILE__, __LINE__, #expr);                           \
+			throw ::UmaPyogin::Test::RequireFailure{};                                             \
+		}                                                                                          \
+	} while (false)
+
+#endif
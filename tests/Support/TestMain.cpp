@@ -0,0 +1,98 @@
+#include "Test.h"
+
+#include <cstdio>
+#include <exception>
+#include <string_view>
+#include <vector>
+
+#include "UmaPyogin/Log.h"
+
+namespace UmaPyogin::Test
+{
+	namespace
+	{
+		struct TestCase
+		{
+			const char* Name;
+			TestFunction Function;
+		};
+
+		// 注册发生在静态初始化期间，需避免初始化顺序问题
+		std::vector<TestCase>& GetTestCases()
+		{
+			static std::vector<TestCase> testCases;
+			return testCases;
+		}
+
+		std::size_t FailureCount;
+
+		void PrintLog(Log::Level level, const char* message)
+		{
+			// 测试中的预期错误同样会输出，仅用于失败时排查
+			if (level >= Log::Level::Warn)
+			{
+				std::fprintf(stderr, "    log: %s\n", message);
+			}
+		}
+	} // namespace
+
+	Registrar::Registrar(const char* name, TestFunction function)
+	{
+		GetTestCases().push_back({ name, function });
+	}
+
+	void ReportFailure(const char* file, int line, const char* expression)
+	{
+		++FailureCount;
+		std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+	}
+} // namespace UmaPyogin::Test
+
+int main(int argc, char** argv)
+{
+	using namespace UmaPyogin;
+
+	Log::SetLogHandler(Test::PrintLog);
+
+	const std::string_view filter = argc > 1 ? argv[1] : "";
+	std::size_t failedCount{};
+	std::size_t runCount{};
+	for (const auto& testCase : Test::GetTestCases())
+	{
+		if (std::string_view(testCase.Name).find(filter) == std::string_view::npos)
+		{
+			continue;
+		}
+
+		++runCount;
+		std::printf("[ RUN  ] %s\n", testCase.Name);
+		std::fflush(stdout);
+		const auto failuresBefore = Test::FailureCount;
+		try
+		{
+			testCase.Function();
+		}
+		catch (const Test::RequireFailure&)
+		{
+		}
+		catch (const std::exception& e)
+		{
+			++Test::FailureCount;
+			std::fprintf(stderr, "unexpected exception: %s\n", e.what());
+		}
+
+		if (Test::FailureCount != failuresBefore)
+		{
+			++failedCount;
+			std::printf("[ FAIL ] %s\n", testCase.Name);
+		}
+		else
+		{
+			std::printf("[  OK  ] %s\n", testCase.Name);
+		}
+		std::fflush(stdout);
+	}
+
+	std::printf("%zu/%zu test cases passed\n", runCount - failedCount, runCount);
+	return failedCount ? 1 : 0;
+}
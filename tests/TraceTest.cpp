@@ -0,0 +1,171 @@
+#include "Support/LocalizationFiles.h"
+#include "Support/Test.h"
+
+#include "UmaPyogin/Trace.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace UmaPyogin;
+
+namespace
+{
+	// 按 Index 区分各线程的事件，每个线程录制 count 组调用
+	void RecordCalls(std::int32_t thread, std::size_t count)
+	{
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			const auto query = reinterpret_cast<const void*>((thread + 1) * 0x10000 + i * 16);
+			const auto index = static_cast<std::int32_t>(thread * 100000 + i);
+			Trace::RecordQuery_ctor(query, u"SELECT text FROM text_data WHERE category=?");
+			Trace::RecordPreparedQuery_BindInt(query, 1, index);
+			const Trace::ColumnValue columns[] = { { 0, index }, { 2, -index } };
+			Trace::RecordQuery_Step(query, true, columns);
+			Trace::RecordQuery_GetText(query, 1);
+			Trace::RecordQuery_Step(query, false, {});
+			Trace::RecordQuery_Dispose(query);
+			Trace::RecordLocalizeJP_Get(index);
+		}
+	}
+} // namespace
+
+TEST(ReadsRecordedEventsBack)
+{
+	const Test::TemporaryDirectory directory;
+	const auto path = directory.GetPath() / "trace.bin";
+	REQUIRE(Trace::Start(path));
+	CHECK(!Trace::Start(path));
+
+	// 超过录制长度上限的字符串被截断
+	const std::u16string longName(Trace::MaxStringLength + 10, u'名');
+	Trace::RecordAssetBundle_LoadAsset(u"assets/_gallopresources/bundle/resources/ui/a.prefab",
+	                                   "GameObject");
+	Trace::RecordAssetBundle_LoadAsset(longName, "");
+
+	// 每个线程的事件超过一个缓冲区，写满的缓冲区在录制期间写入文件
+	constexpr std::size_t CallCount = 2000;
+	constexpr std::int32_t ThreadCount = 3;
+	std::vector<std::thread> threads;
+	for (std::int32_t thread = 1; thread <= ThreadCount; ++thread)
+	{
+		threads.emplace_back(RecordCalls, thread, CallCount);
+	}
+	RecordCalls(0, CallCount);
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+	Trace::Stop();
+	Trace::RecordLocalizeJP_Get(-1);
+
+	std::vector<Trace::Event> events;
+	REQUIRE(Trace::ReadTraceFile(path, events));
+	REQUIRE(events.size() == 2 + (ThreadCount + 1) * CallCount * 7);
+	CHECK(std::is_sorted(events.begin(), events.end(), [](const auto& a, const auto& b) {
+		return a.Timestamp < b.Timestamp;
+	}));
+
+	CHECK(events[0].Type == Trace::EventType::AssetBundle_LoadAsset);
+	CHECK(events[0].Text == u"assets/_gallopresources/bundle/resources/ui/a.prefab");
+	CHECK(events[0].ClassName == "GameObject");
+	CHECK(events[1].Text == std::u16string_view(longName).substr(0, Trace::MaxStringLength));
+	CHECK(events[1].ClassName.empty());
+
+	// 同一线程的事件编号相同且保持录制顺序
+	std::map<std::uint32_t, std::vector<const Trace::Event*>> threadEvents;
+	for (const auto& event : events)
+	{
+		threadEvents[event.ThreadIndex].push_back(&event);
+	}
+	CHECK(threadEvents.size() == ThreadCount + 1);
+	for (const auto& [threadIndex, list] : threadEvents)
+	{
+		const auto offset = list[0]->Type == Trace::EventType::AssetBundle_LoadAsset ? 2 : 0;
+		REQUIRE(list.size() == offset + CallCount * 7);
+		const auto thread = list[offset + 6]->Index / 100000;
+		for (std::size_t i = 0; i < CallCount; ++i)
+		{
+			const auto call = list.begin() + offset + i * 7;
+			const auto index = static_cast<std::int32_t>(thread * 100000 + i);
+			const auto query = static_cast<std::uint64_t>((thread + 1) * 0x10000 + i * 16);
+
+			REQUIRE(call[0]->Type == Trace::EventType::Query_ctor);
+			CHECK(call[0]->Query == query);
+			CHECK(call[0]->Text == u"SELECT text FROM text_data WHERE category=?");
+			REQUIRE(call[1]->Type == Trace::EventType::PreparedQuery_BindInt);
+			CHECK(call[1]->Query == query && call[1]->Index == 1 && call[1]->Value == index);
+			REQUIRE(call[2]->Type == Trace::EventType::Query_Step);
+			CHECK(call[2]->Result && call[2]->ColumnCount == 2);
+			CHECK(call[2]->Columns[0].Index == 0 && call[2]->Columns[0].Value == index);
+			CHECK(call[2]->Columns[1].Index == 2 && call[2]->Columns[1].Value == -index);
+			REQUIRE(call[3]->Type == Trace::EventType::Query_GetText);
+			CHECK(call[3]->Query == query && call[3]->Index == 1);
+			REQUIRE(call[4]->Type == Trace::EventType::Query_Step);
+			CHECK(!call[4]->Result && call[4]->ColumnCount == 0);
+			REQUIRE(call[5]->Type == Trace::EventType::Query_Dispose);
+			CHECK(call[5]->Query == query);
+			REQUIRE(call[6]->Type == Trace::EventType::LocalizeJP_Get);
+			CHECK(call[6]->Index == index);
+		}
+	}
+}
+
+TEST(KeepsEventsBeforeTruncation)
+{
+	const Test::TemporaryDirectory directory;
+	const auto path = directory.GetPath() / "trace.bin";
+	REQUIRE(Trace::Start(path));
+	for (std::int32_t id = 0; id < 10; ++id)
+	{
+		Trace::RecordLocalizeJP_Get(id);
+	}
+	Trace::Stop();
+
+	// 最后一个事件缺少一个字节
+	std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+	std::vector<Trace::Event> events;
+	REQUIRE(Trace::ReadTraceFile(path, events));
+	REQUIRE(events.size() == 9);
+	for (std::int32_t id = 0; id < 9; ++id)
+	{
+		CHECK(events[id].Type == Trace::EventType::LocalizeJP_Get && events[id].Index == id);
+	}
+
+	Test::WriteFile(path, "UPTR");
+	CHECK(!Trace::ReadTraceFile(path, events));
+	Test::WriteFile(path, "NOTATRACEFILE");
+	CHECK(!Trace::ReadTraceFile(path, events));
+	CHECK(!Trace::ReadTraceFile(directory.GetPath() / "missing.bin", events));
+}
+
+TEST(GivesEachThreadItsOwnIndex)
+{
+	const Test::TemporaryDirectory directory;
+	const auto path = directory.GetPath() / "trace.bin";
+	REQUIRE(Trace::Start(path));
+
+	// 先后启动的线程接管同一缓冲区，退出时剩余的事件交给后台线程
+	for (std::int32_t thread = 0; thread < 4; ++thread)
+	{
+		std::thread([thread] { RecordCalls(thread, 3); }).join();
+	}
+	Trace::Stop();
+
+	std::vector<Trace::Event> events;
+	REQUIRE(Trace::ReadTraceFile(path, events));
+	REQUIRE(events.size() == 4 * 3 * 7);
+	std::map<std::uint32_t, std::int32_t> threads;
+	for (const auto& event : events)
+	{
+		if (event.Type == Trace::EventType::LocalizeJP_Get)
+		{
+			const auto thread = event.Index / 100000;
+			CHECK(threads.emplace(event.ThreadIndex, thread).first->second == thread);
+		}
+	}
+	CHECK(threads.size() == 4);
+}
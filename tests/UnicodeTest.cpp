@@ -0,0 +1,180 @@
+#include "Support/LocalizationFiles.h"
+#include "Support/Test.h"
+
+#include "UmaPyogin/Misc.h"
+
+#include <string>
+
+using namespace UmaPyogin;
+
+namespace
+{
+	// 逐个字符编码的参照实现，非法的代理项编码为 U+FFFD
+	std::string EncodeReference(std::u16string_view str)
+	{
+		std::string result;
+		for (std::size_t i = 0; i < str.size(); ++i)
+		{
+			char32_t c = str[i];
+			if (c >= 0xD800 && c <= 0xDFFF)
+			{
+				if (c <= 0xDBFF && i + 1 < str.size() && str[i + 1] >= 0xDC00 &&
+				    str[i + 1] <= 0xDFFF)
+				{
+					c = 0x10000 + ((c - 0xD800) << 10) + (str[++i] - 0xDC00);
+				}
+				else
+				{
+					c = 0xFFFD;
+				}
+			}
+
+			if (c < 0x80)
+			{
+				result += static_cast<char>(c);
+			}
+			else if (c < 0x800)
+			{
+				result += static_cast<char>(0xC0 | (c >> 6));
+				result += static_cast<char>(0x80 | (c & 0x3F));
+			}
+			else if (c < 0x10000)
+			{
+				result += static_cast<char>(0xE0 | (c >> 12));
+				result += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+				result += static_cast<char>(0x80 | (c & 0x3F));
+			}
+			else
+			{
+				result += static_cast<char>(0xF0 | (c >> 18));
+				result += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+				result += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+				result += static_cast<char>(0x80 | (c & 0x3F));
+			}
+		}
+		return result;
+	}
+
+	// 检查 text 的每个后缀均能正确地双向转换，使同类字符的连续段从各个位置开始并在各个位置结束
+	void CheckRoundTrip(std::u16string_view text)
+	{
+		std::u16string utf16;
+		std::string utf8;
+		for (std::size_t start = 0; start < text.size(); ++start)
+		{
+			// 不从代理对的中间开始
+			if (text[start] >= 0xDC00 && text[start] <= 0xDFFF)
+			{
+				continue;
+			}
+
+			const auto source = text.substr(start);
+			const auto expected = EncodeReference(source);
+			CHECK(Misc::ToUTF8(source) == expected);
+			CHECK(Misc::ToUTF8(source, utf8));
+			CHECK(utf8 == expected);
+
+			CHECK(Misc::ToUTF16(expected) == source);
+			CHECK(Misc::ToUTF16(expected, utf16));
+			CHECK(utf16 == source);
+		}
+	}
+
+	std::u16string Repeat(std::u16string_view text, std::size_t count)
+	{
+		std::u16string result;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			result += text;
+		}
+		return result;
+	}
+} // namespace
+
+TEST(RoundTripsJapaneseAndChineseText)
+{
+	Test::TextGenerator japanese(Test::Script::Japanese);
+	Test::TextGenerator chinese(Test::Script::Chinese);
+	CheckRoundTrip(japanese.Next(200));
+	CheckRoundTrip(chinese.Next(200));
+	CheckRoundTrip(Repeat(u"日本語の文章", 20));
+	CheckRoundTrip(Repeat(u"\u0800\uD7FF\uE000\uFFFF", 20));
+}
+
+TEST(RoundTripsMixedLengthSequences)
+{
+	CheckRoundTrip(Repeat(u"Привет, мир! Ünïcödé ", 8));
+	CheckRoundTrip(Repeat(u"\u0080\u07FF", 40));
+	CheckRoundTrip(Repeat(u"abcdefghijklmnopqrstuvwxyz0123456789", 4) + u"トレーナー" +
+	               Repeat(u"Ωμέγα", 6) + u"😀特别周😀" + Repeat(u"ウマ娘", 10));
+}
+
+TEST(ReportsInvalidSequencesInsideRuns)
+{
+	// 在较长的同类字符段中的各个位置插入非法序列，以覆盖向量实现处理的每个位置
+	const std::pair<std::string, std::string> cases[] = {
+		{ "\xE3\x81\x82", "\xE0\x80\x80" },     // 三字节的过长编码
+		{ "\xE3\x81\x82", "\xED\xA0\x80" },     // 代理项
+		{ "\xE3\x81\x82", "\xE3\x81\x41" },     // 缺少后续字节
+		{ "\xD0\x96", "\xC0\x80" },             // 双字节的过长编码
+		{ "\xD0\x96", "\xD0\xC0" },             // 缺少后续字节
+		{ "a", "\x80" },                        // 单独的后续字节
+	};
+
+	for (const auto& [valid, invalid] : cases)
+	{
+		for (std::size_t position = 0; position < 40; ++position)
+		{
+			std::string input;
+			for (std::size_t i = 0; i < position; ++i)
+			{
+				input += valid;
+			}
+			const auto errorPosition = input.size();
+			input += invalid;
+			for (std::size_t i = 0; i < 40; ++i)
+			{
+				input += valid;
+			}
+
+			std::u16string output;
+			const auto result = Misc::ToUTF16(input, output);
+			CHECK(!result);
+			CHECK(result.ErrorPosition == errorPosition);
+			CHECK(output.size() == position);
+
+			const auto replaced = Misc::ToUTF16(input);
+			CHECK(replaced.size() > position && replaced[position] == u'\xFFFD');
+			CHECK(replaced.find(u'\xFFFD', position + 3) == std::u16string::npos);
+		}
+	}
+}
+
+TEST(ReportsLoneSurrogatesInsideRuns)
+{
+	for (const auto valid : { u'あ', u'Ж', u'a' })
+	{
+		for (std::size_t position = 0; position < 40; ++position)
+		{
+			std::u16string input(position, valid);
+			input += u'\xD800';
+			input.append(40, valid);
+
+			std::string output;
+			const auto result = Misc::ToUTF8(input, output);
+			CHECK(!result);
+			CHECK(result.ErrorPosition == position);
+			CHECK(Misc::ToUTF8(input) == EncodeReference(input));
+		}
+	}
+}
+
+TEST(ConvertsLongStrings)
+{
+	// 超过线程局部缓冲区上限的字符串直接写入结果
+	Test::TextGenerator chinese(Test::Script::Chinese);
+	const auto text = chinese.Next(10000);
+	const auto utf8 = Misc::ToUTF8(text);
+	CHECK(utf8 == EncodeReference(text));
+	CHECK(Misc::ToUTF16(utf8) == text);
+}
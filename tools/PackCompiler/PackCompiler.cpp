@@ -0,0 +1,193 @@
+// 将 JSON 翻译文件编译为预编译翻译包
+// 用法：UmaPyoginPackCompiler -o <output> [--static <file>] [--story <dir>]
+//       [--text-data <file>] [--character-system-text <file>]
+//       [--race-jikkyo-comment <file>] [--race-jikkyo-message <file>]
+// 或：UmaPyoginPackCompiler --story-index <dir>，为剧情目录生成 index.bin
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+#include <simdjson.h>
+
+#include "UmaPyogin/Localization.h"
+#include "UmaPyogin/LocalizationPack.h"
+#include "UmaPyogin/Log.h"
+#include "UmaPyogin/Misc.h"
+
+using namespace UmaPyogin;
+
+namespace
+{
+	void PrintLog(Log::Level level, const char* message)
+	{
+		static constexpr const char* LevelNames[] = {
+#define LEVEL_NAME(name) #name,
+			LOG_LEVELS(LEVEL_NAME)
+#undef LEVEL_NAME
+		};
+		std::fprintf(stderr, "[%s] %s\n", LevelNames[static_cast<int>(level)], message);
+	}
+
+	bool CompileStatic(std::filesystem::path const& path,
+	                   Localization::LocalizationPackWriter& writer)
+	{
+		simdjson::dom::parser parser;
+		simdjson::dom::object document;
+		if (const auto error = parser.load(path.string()).get(document))
+		{
+			Log::Error("Failed to parse {}(error: {})", path.string(),
+			           simdjson::error_message(error));
+			return false;
+		}
+
+		for (const auto& [source, text] : document)
+		{
+			if (text.is_string())
+			{
+				writer.AddStatic(Misc::ToUTF16(source), Misc::ToUTF16(text.get_string()));
+			}
+		}
+
+		return true;
+	}
+
+	void PrintUsage(const char* program)
+	{
+		std::fprintf(stderr,
+		             "Usage: %s -o <output> [--static <file>] [--story <dir>] "
+		             "[--text-data <file>] [--character-system-text <file>] "
+		             "[--race-jikkyo-comment <file>] [--race-jikkyo-message <file>]\n"
+		             "       %s --story-index <dir>\n",
+		             program, program);
+	}
+} // namespace
+
+int main(int argc, char** argv)
+{
+	Log::SetLogHandler(PrintLog);
+
+	std::filesystem::path outputPath;
+	std::filesystem::path staticPath;
+	std::filesystem::path storyPath;
+	std::filesystem::path storyIndexPath;
+	std::filesystem::path textDataPath;
+	std::filesystem::path characterSystemTextPath;
+	std::filesystem::path raceJikkyoCommentPath;
+	std::filesystem::path raceJikkyoMessagePath;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string_view arg = argv[i];
+		if (i + 1 >= argc)
+		{
+			PrintUsage(argv[0]);
+			return 1;
+		}
+
+		const char* value = argv[++i];
+		if (arg == "-o")
+		{
+			outputPath = value;
+		}
+		else if (arg == "--static")
+		{
+			staticPath = value;
+		}
+		else if (arg == "--story")
+		{
+			storyPath = value;
+		}
+		else if (arg == "--story-index")
+		{
+			storyIndexPath = value;
+		}
+		else if (arg == "--text-data")
+		{
+			textDataPath = value;
+		}
+		else if (arg == "--character-system-text")
+		{
+			characterSystemTextPath = value;
+		}
+		else if (arg == "--race-jikkyo-comment")
+		{
+			raceJikkyoCommentPath = value;
+		}
+		else if (arg == "--race-jikkyo-message")
+		{
+			raceJikkyoMessagePath = value;
+		}
+		else
+		{
+			PrintUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (!storyIndexPath.empty())
+	{
+		if (!Localization::StoryLocalization::WriteIndexFile(storyIndexPath))
+		{
+			return 1;
+		}
+		Log::Info("Story index written to {}", (storyIndexPath / "index.bin").string());
+		if (outputPath.empty())
+		{
+			return 0;
+		}
+	}
+
+	if (outputPath.empty())
+	{
+		PrintUsage(argv[0]);
+		return 1;
+	}
+
+	Localization::LocalizationPackWriter writer;
+
+	if (!staticPath.empty() && !CompileStatic(staticPath, writer))
+	{
+		return 1;
+	}
+
+	if (!storyPath.empty())
+	{
+		auto& storyLocalization = Localization::StoryLocalization::GetInstance();
+		storyLocalization.LoadFrom(storyPath);
+		storyLocalization.ForEachStoryTextData(
+		    [&](std::size_t id, auto const& data) { writer.AddStoryTextData(id, data); });
+		storyLocalization.ForEachRaceTextData(
+		    [&](std::size_t id, auto const& data) { writer.AddRaceTextData(id, data); });
+	}
+
+	auto& databaseLocalization = Localization::DatabaseLocalization::GetInstance();
+	databaseLocalization.LoadFrom(textDataPath, characterSystemTextPath, raceJikkyoCommentPath,
+	                              raceJikkyoMessagePath);
+	databaseLocalization.ForEachTextData(
+	    [&](std::size_t category, std::size_t index, std::u16string_view text) {
+		    writer.AddTextData(category, index, text);
+	    });
+	databaseLocalization.ForEachCharacterSystemTextData(
+	    [&](std::size_t characterId, std::size_t voiceId, std::u16string_view text) {
+		    writer.AddCharacterSystemTextData(characterId, voiceId, text);
+	    });
+	databaseLocalization.ForEachRaceJikkyoCommentData(
+	    [&](std::size_t id, std::u16string_view text) {
+		    writer.AddRaceJikkyoCommentData(id, text);
+	    });
+	databaseLocalization.ForEachRaceJikkyoMessageData(
+	    [&](std::size_t id, std::u16string_view text) {
+		    writer.AddRaceJikkyoMessageData(id, text);
+	    });
+
+	if (!writer.WriteTo(outputPath))
+	{
+		return 1;
+	}
+
+	Log::Info("Localization pack written to {}", outputPath.string());
+	return 0;
+}
@@ -0,0 +1,267 @@
+// 回放 Plugin::StartTrace 录制的钩子调用，在游戏之外测量查找译文的吞吐量与耗时分布
+// 用法：UmaPyoginTraceReplay <trace> [--pack <file>] [--story <dir>] [--text-data <file>]
+//       [--character-system-text <file>] [--race-jikkyo-comment <file>]
+//       [--race-jikkyo-message <file>] [--repeat <n>]
+// 静态翻译需要游戏提供原文，无法在游戏之外加载，LocalizeJP_Get 总是未命中
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "UmaPyogin/Hook.h"
+#include "UmaPyogin/Localization.h"
+#include "UmaPyogin/LocalizationPack.h"
+#include "UmaPyogin/Log.h"
+#include "UmaPyogin/Profiler.h"
+#include "UmaPyogin/Trace.h"
+
+using namespace UmaPyogin;
+
+namespace
+{
+	void PrintLog(Log::Level level, const char* message)
+	{
+		static constexpr const char* LevelNames[] = {
+#define LEVEL_NAME(name) #name,
+			LOG_LEVELS(LEVEL_NAME)
+#undef LEVEL_NAME
+		};
+		std::fprintf(stderr, "[%s] %s\n", LevelNames[static_cast<int>(level)], message);
+	}
+
+	void PrintUsage(const char* program)
+	{
+		std::fprintf(stderr,
+		             "Usage: %s <trace> [--pack <file>] [--story <dir>] [--text-data <file>] "
+		             "[--character-system-text <file>] [--race-jikkyo-comment <file>] "
+		             "[--race-jikkyo-message <file>] [--repeat <n>]\n",
+		             program);
+	}
+
+	// 当前回放的 Query_Step 事件，其中记录了录制时 Step 读取的整数列
+	const Trace::Event* CurrentStepEvent;
+
+	int ReplayQueryGetInt(void*, int idx)
+	{
+		for (std::size_t i = 0; i < CurrentStepEvent->ColumnCount; ++i)
+		{
+			if (CurrentStepEvent->Columns[i].Index == idx)
+			{
+				return CurrentStepEvent->Columns[i].Value;
+			}
+		}
+		return 0;
+	}
+
+	void* QueryFromKey(std::uint64_t key)
+	{
+		return reinterpret_cast<void*>(static_cast<std::uintptr_t>(key));
+	}
+
+	bool Replay(Trace::Event const& event)
+	{
+		const auto query = QueryFromKey(event.Query);
+		switch (event.Type)
+		{
+		case Trace::EventType::LocalizeJP_Get:
+			return Hook::ReplayLocalizeJP_Get(event.Index);
+		case Trace::EventType::AssetBundle_LoadAsset:
+			return Hook::ReplayAssetBundle_LoadAsset(event.Text, event.ClassName);
+		case Trace::EventType::Query_ctor:
+			return Hook::ReplayQuery_ctor(query, event.Text);
+		case Trace::EventType::PreparedQuery_BindInt:
+			return Hook::ReplayPreparedQuery_BindInt(query, event.Index, event.Value);
+		case Trace::EventType::Query_Step:
+			CurrentStepEvent = &event;
+			return Hook::ReplayQuery_Step(query, ReplayQueryGetInt);
+		case Trace::EventType::Query_GetText:
+			return Hook::ReplayQuery_GetText(query, event.Index);
+		case Trace::EventType::Query_Dispose:
+			Hook::ReplayQuery_Dispose(query);
+			return false;
+		default:
+			return false;
+		}
+	}
+
+	struct EventStatistics
+	{
+		std::uint64_t Count;
+		std::uint64_t HitCount;
+		std::uint64_t TotalNanoseconds;
+		std::uint64_t MaxNanoseconds;
+		Profiler::Histogram Latency;
+	};
+} // namespace
+
+int main(int argc, char** argv)
+{
+	Log::SetLogHandler(PrintLog);
+
+	if (argc < 2)
+	{
+		PrintUsage(argv[0]);
+		return 1;
+	}
+
+	const std::filesystem::path tracePath = argv[1];
+	std::filesystem::path packPath;
+	std::filesystem::path storyPath;
+	std::filesystem::path textDataPath;
+	std::filesystem::path characterSystemTextPath;
+	std::filesystem::path raceJikkyoCommentPath;
+	std::filesystem::path raceJikkyoMessagePath;
+	std::size_t repeat = 1;
+
+	for (int i = 2; i < argc; ++i)
+	{
+		const std::string_view arg = argv[i];
+		if (i + 1 >= argc)
+		{
+			PrintUsage(argv[0]);
+			return 1;
+		}
+
+		const char* value = argv[++i];
+		if (arg == "--pack")
+		{
+			packPath = value;
+		}
+		else if (arg == "--story")
+		{
+			storyPath = value;
+		}
+		else if (arg == "--text-data")
+		{
+			textDataPath = value;
+		}
+		else if (arg == "--character-system-text")
+		{
+			characterSystemTextPath = value;
+		}
+		else if (arg == "--race-jikkyo-comment")
+		{
+			raceJikkyoCommentPath = value;
+		}
+		else if (arg == "--race-jikkyo-message")
+		{
+			raceJikkyoMessagePath = value;
+		}
+		else if (arg == "--repeat")
+		{
+			repeat = std::max<std::size_t>(std::strtoull(value, nullptr, 10), 1);
+		}
+		else
+		{
+			PrintUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	std::vector<Trace::Event> events;
+	if (!Trace::ReadTraceFile(tracePath, events))
+	{
+		return 1;
+	}
+	Log::Info("Read {} events from {}", events.size(), tracePath.string());
+
+	auto& storyLocalization = Localization::StoryLocalization::GetInstance();
+	auto& databaseLocalization = Localization::DatabaseLocalization::GetInstance();
+	if (!packPath.empty())
+	{
+		const auto pack = Localization::LocalizationPack::Open(packPath);
+		if (!pack)
+		{
+			return 1;
+		}
+		storyLocalization.LoadFrom(pack);
+		databaseLocalization.LoadFrom(pack);
+	}
+	else
+	{
+		if (!storyPath.empty())
+		{
+			storyLocalization.LoadFrom(storyPath);
+		}
+		databaseLocalization.LoadFrom(textDataPath, characterSystemTextPath,
+		                              raceJikkyoCommentPath, raceJikkyoMessagePath);
+	}
+
+	std::array<EventStatistics, Trace::EventTypeCount> statistics{};
+	std::unordered_set<std::uint64_t> activeQueries;
+	std::uint64_t totalNanoseconds{};
+
+	// 每轮之间清除未 Dispose 的查询，使各轮的状态相同
+	for (std::size_t round = 0; round < repeat; ++round)
+	{
+		const auto roundStart = std::chrono::steady_clock::now();
+		for (const auto& event : events)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			const auto hit = Replay(event);
+			const auto nanoseconds = static_cast<std::uint64_t>(
+			    std::chrono::duration_cast<std::chrono::nanoseconds>(
+			        std::chrono::steady_clock::now() - start)
+			        .count());
+
+			auto& eventStatistics = statistics[static_cast<std::size_t>(event.Type)];
+			++eventStatistics.Count;
+			eventStatistics.HitCount += hit;
+			eventStatistics.TotalNanoseconds += nanoseconds;
+			eventStatistics.MaxNanoseconds = std::max(eventStatistics.MaxNanoseconds, nanoseconds);
+			++eventStatistics.Latency.Buckets[Profiler::Histogram::GetBucketIndex(nanoseconds)];
+		}
+		totalNanoseconds += static_cast<std::uint64_t>(
+		    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+		                                                         roundStart)
+		        .count());
+
+		for (const auto& event : events)
+		{
+			if (event.Type == Trace::EventType::Query_ctor)
+			{
+				activeQueries.insert(event.Query);
+			}
+			else if (event.Type == Trace::EventType::Query_Dispose)
+			{
+				activeQueries.erase(event.Query);
+			}
+		}
+		for (const auto query : activeQueries)
+		{
+			Hook::ReplayQuery_Dispose(QueryFromKey(query));
+		}
+		activeQueries.clear();
+	}
+
+	// 总耗时包含计时本身的开销，各类事件的耗时亦然
+	const auto eventCount = static_cast<std::uint64_t>(events.size()) * repeat;
+	Log::Info("Replayed {} events in {}ms, {:.0f} events/s", eventCount,
+	          totalNanoseconds / 1000000,
+	          totalNanoseconds ? static_cast<double>(eventCount) * 1e9 / totalNanoseconds : 0.0);
+	for (std::size_t i = 0; i < Trace::EventTypeCount; ++i)
+	{
+		const auto& eventStatistics = statistics[i];
+		if (!eventStatistics.Count)
+		{
+			continue;
+		}
+
+		Log::Info("{}: {} events, {} hits, mean {}ns, p50 {}ns, p99 {}ns, p99.9 {}ns, max {}ns",
+		          Trace::GetEventName(static_cast<Trace::EventType>(i)), eventStatistics.Count,
+		          eventStatistics.HitCount,
+		          eventStatistics.TotalNanoseconds / eventStatistics.Count,
+		          eventStatistics.Latency.GetPercentile(0.5),
+		          eventStatistics.Latency.GetPercentile(0.99),
+		          eventStatistics.Latency.GetPercentile(0.999), eventStatistics.MaxNanoseconds);
+	}
+
+	return 0;
+}